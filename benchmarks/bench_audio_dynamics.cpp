@@ -0,0 +1,52 @@
+// Compressor/limiter cost per sample: the scalar reference against the
+// vectorized path, on 256-frame blocks of noise that keeps the compressor
+// working, for mono and stereo.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/audio/audio_dynamics.h"
+
+namespace {
+
+constexpr size_t BLOCK_FRAMES = 256;
+constexpr size_t BLOCKS = 40000;
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double ns_per_sample(int channels, Fn&& process) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> noise(-1.5f, 1.5f);
+    std::vector<float> source(BLOCK_FRAMES * channels);
+    for (float& s : source) s = noise(rng);
+    std::vector<float> block(source.size());
+
+    AudioDynamics dynamics;
+    dynamics.configure(-12.0f, 4.0f, 10.0f, 100.0f, 48000);
+    double elapsed = 0;
+    for (size_t i = 0; i < BLOCKS; ++i) {
+        block = source;
+        auto start = Clock::now();
+        process(dynamics, block.data(), BLOCK_FRAMES, channels);
+        elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    return elapsed / (static_cast<double>(BLOCKS) * BLOCK_FRAMES * channels);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%zu blocks of %zu frames\n", BLOCKS, BLOCK_FRAMES);
+    for (int channels : {1, 2}) {
+        double scalar = ns_per_sample(channels, [](AudioDynamics& d, float* s, size_t n, int c) {
+            d.process_scalar(s, n, c);
+        });
+        double simd = ns_per_sample(channels, [](AudioDynamics& d, float* s, size_t n, int c) {
+            d.process(s, n, c);
+        });
+        std::printf("%d ch   scalar %6.3f ns/sample   vector %6.3f ns/sample   (%.2fx)\n", channels, scalar, simd,
+                    scalar / simd);
+    }
+    return 0;
+}
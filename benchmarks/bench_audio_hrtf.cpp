@@ -0,0 +1,60 @@
+// Tempest HRTF cost per 128-frame block at 48 kHz for 16, 64 and 256
+// sources, with every source orbiting (filter re-interpolated each block)
+// and with every source parked (cached filter), as time per block and as
+// a share of the 2.67 ms the block lasts.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/audio/audio_hrtf.h"
+
+namespace {
+
+constexpr size_t BLOCK_FRAMES = 128;
+constexpr int SAMPLE_RATE = 48000;
+constexpr size_t BLOCKS = 400;
+
+using Clock = std::chrono::steady_clock;
+
+double us_per_block(const AudioHRIRSet& set, size_t source_count, bool moving) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> inputs(source_count * BLOCK_FRAMES);
+    for (float& s : inputs) s = noise(rng);
+
+    std::vector<AudioHRTFSource> sources(source_count);
+    for (size_t i = 0; i < source_count; ++i) {
+        sources[i] = {static_cast<int>(i), i * 0.37f, -0.5f + (i % 7) * 0.2f, 0.1f,
+                      inputs.data() + i * BLOCK_FRAMES};
+    }
+
+    AudioHRTFEngine engine(set, BLOCK_FRAMES);
+    std::vector<float> left(BLOCK_FRAMES), right(BLOCK_FRAMES);
+    engine.process(sources, left.data(), right.data());   // allocate voices
+
+    auto start = Clock::now();
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        if (moving) {
+            for (auto& source : sources) source.azimuth += 0.01f;
+        }
+        engine.process(sources, left.data(), right.data());
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / BLOCKS;
+}
+
+} // namespace
+
+int main() {
+    AudioHRIRSet set;
+    set.make_spherical_head(SAMPLE_RATE);
+    const double budget_us = 1e6 * BLOCK_FRAMES / SAMPLE_RATE;
+    std::printf("%zu-frame blocks, %zu-tap responses, %.0f us per block of audio\n", BLOCK_FRAMES, set.length(),
+                budget_us);
+    for (size_t count : {16, 64, 256}) {
+        double moving = us_per_block(set, count, true);
+        double parked = us_per_block(set, count, false);
+        std::printf("%3zu sources   moving %8.1f us (%5.1f%%)   parked %8.1f us (%5.1f%%)   %.2f us/source\n", count,
+                    moving, 100.0 * moving / budget_us, parked, 100.0 * parked / budget_us, moving / count);
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Resampler cost per 128-frame block at 48 kHz: Doppler for 16, 64 and 256
+// sources whose ratios sweep across many table buckets, sinc and linear,
+// and the global 48 -> 44.1 kHz stereo conversion, as time per block and
+// as a share of the 2.67 ms the block lasts.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/audio/audio_resampler.h"
+
+namespace {
+
+constexpr size_t BLOCK_FRAMES = 128;
+constexpr int SAMPLE_RATE = 48000;
+constexpr size_t BLOCKS = 2000;
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<float> noise_block(size_t samples) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> block(samples);
+    for (float& s : block) s = noise(rng);
+    return block;
+}
+
+double doppler_us_per_block(size_t source_count, AudioResampleQuality quality) {
+    std::vector<float> input = noise_block(BLOCK_FRAMES);
+    AudioDoppler doppler(SAMPLE_RATE, BLOCK_FRAMES, quality);
+    volatile float sink = 0;
+
+    auto start = Clock::now();
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        doppler.push(input.data());
+        for (size_t i = 0; i < source_count; ++i) {
+            // Each source swings between 0.8x and 1.2x on its own phase
+            float ratio = 1.0f + 0.2f * std::sin(0.01f * b + 0.7f * i);
+            sink = sink + doppler.render(i, static_cast<int>(i), 5.0f + i, ratio)[0];
+        }
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / BLOCKS;
+}
+
+double convert_us_per_block(AudioResampleQuality quality) {
+    AudioResampler resampler;
+    resampler.configure(2, quality);
+    resampler.set_ratio(48000.0 / 44100.0);
+    std::vector<float> input = noise_block(2 * (BLOCK_FRAMES + AudioResampler::TAPS) * 2);
+    std::vector<float> output(BLOCK_FRAMES * 2);
+
+    auto start = Clock::now();
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        resampler.process(input.data(), output.data(), BLOCK_FRAMES);
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / BLOCKS;
+}
+
+} // namespace
+
+int main() {
+    const double budget_us = 1e6 * BLOCK_FRAMES / SAMPLE_RATE;
+    std::printf("%zu-frame blocks, %d-tap sinc, %.0f us per block of audio\n", BLOCK_FRAMES, AudioResampler::TAPS,
+                budget_us);
+    for (size_t count : {16, 64, 256}) {
+        double sinc = doppler_us_per_block(count, AudioResampleQuality::Sinc);
+        double linear = doppler_us_per_block(count, AudioResampleQuality::Linear);
+        std::printf("doppler %3zu sources   sinc %8.1f us (%5.1f%%)   linear %8.1f us (%5.1f%%)\n", count, sinc,
+                    100.0 * sinc / budget_us, linear, 100.0 * linear / budget_us);
+    }
+    double sinc = convert_us_per_block(AudioResampleQuality::Sinc);
+    double linear = convert_us_per_block(AudioResampleQuality::Linear);
+    std::printf("48 -> 44.1 kHz stereo  sinc %8.1f us (%5.1f%%)   linear %8.1f us (%5.1f%%)\n", sinc,
+                100.0 * sinc / budget_us, linear, 100.0 * linear / budget_us);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Audio push latency: the old mutex + per-push vector queue against the
+// SPSC ring. Each side pushes one video frame of 48 kHz stereo (800 frames)
+// at a time while a consumer thread drains 256-frame periods, and the time
+// spent inside each push is recorded.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/audio/audio_ring.h"
+
+namespace {
+
+constexpr size_t CHANNELS = 2;
+constexpr size_t PUSH_FRAMES = 800;
+constexpr size_t PERIOD_FRAMES = 256;
+constexpr size_t PUSHES = 20000;
+
+using Clock = std::chrono::steady_clock;
+
+// The queue Audio used before the ring
+class LegacyQueue {
+public:
+    struct Buffer {
+        std::vector<float> data;
+        size_t frames;
+    };
+
+    void push(const float* samples, size_t frames) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Buffer buffer;
+        buffer.frames = frames;
+        buffer.data.resize(frames * CHANNELS);
+        std::memcpy(buffer.data.data(), samples, frames * CHANNELS * sizeof(float));
+        queue_.push_back(std::move(buffer));
+        cv_.notify_one();
+    }
+
+    bool pop(std::vector<float>& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !queue_.empty() || done_; });
+        if (queue_.empty()) return false;
+        Buffer buffer = std::move(queue_.front());
+        queue_.erase(queue_.begin());
+        lock.unlock();
+        out.swap(buffer.data);
+        return true;
+    }
+
+    void finish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::vector<Buffer> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_ = false;
+};
+
+void report(const char* name, std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    double total = 0;
+    for (double v : ns) total += v;
+    std::printf("%-8s avg %8.0f ns  p50 %8.0f ns  p99 %8.0f ns  max %9.0f ns\n", name, total / ns.size(),
+                ns[ns.size() / 2], ns[ns.size() * 99 / 100], ns.back());
+}
+
+std::vector<double> run_legacy(const std::vector<float>& source) {
+    LegacyQueue queue;
+    std::thread consumer([&] {
+        std::vector<float> buffer;
+        volatile float sink = 0;
+        while (queue.pop(buffer)) {
+            sink = sink + buffer[0];
+        }
+    });
+
+    std::vector<double> ns;
+    ns.reserve(PUSHES);
+    for (size_t i = 0; i < PUSHES; ++i) {
+        auto start = Clock::now();
+        queue.push(source.data(), PUSH_FRAMES);
+        ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+    queue.finish();
+    consumer.join();
+    return ns;
+}
+
+std::vector<double> run_ring(const std::vector<float>& source) {
+    AudioRingBuffer ring(8192, CHANNELS);
+    std::atomic<bool> done{false};
+    std::thread consumer([&] {
+        volatile float sink = 0;
+        for (;;) {
+            uint32_t seen = ring.data_signal();
+            bool finished = done.load();
+            if (ring.read_available() < PERIOD_FRAMES) {
+                if (finished) break;
+                ring.wait_for_data(seen);
+                continue;
+            }
+            AudioRingBuffer::Region r = ring.prepare_read(PERIOD_FRAMES);
+            sink = sink + r.first[0];
+            ring.commit_read(r.frames());
+        }
+    });
+
+    std::vector<double> ns;
+    ns.reserve(PUSHES);
+    for (size_t i = 0; i < PUSHES; ++i) {
+        size_t written = 0;
+        while (written < PUSH_FRAMES) {
+            auto start = Clock::now();
+            size_t count = ring.write(source.data() + written * CHANNELS, PUSH_FRAMES - written);
+            ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            written += count;
+            if (count == 0) {
+                std::this_thread::yield();   // full: the real path drops instead
+            }
+        }
+    }
+    done = true;
+    ring.wake();
+    consumer.join();
+    return ns;
+}
+
+} // namespace
+
+int main() {
+    std::vector<float> source(PUSH_FRAMES * CHANNELS);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<float>(i % 97) / 97.0f;
+    }
+
+    std::printf("%zu pushes of %zu stereo frames, consumer drains %zu-frame periods\n", PUSHES, PUSH_FRAMES,
+                PERIOD_FRAMES);
+    auto legacy = run_legacy(source);
+    report("mutex", legacy);
+    auto ring = run_ring(source);
+    report("ring", ring);
+    return 0;
+}
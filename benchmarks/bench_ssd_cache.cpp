@@ -0,0 +1,172 @@
+// SSD block cache trace replay: feeds an LBA trace through SSDReader with
+// no cache, a cache alone, and a cache with read-ahead, and reports time,
+// hit rate, read-ahead use and SSD bytes. Pass an image and a trace
+// ("lba compressed_size raw_size" per line) to replay a recording;
+// otherwise a synthetic one is built: 512 packed 64 KiB texture blocks,
+// streamed level by level with levels revisited, interleaved with hot
+// audio-bank blocks and random texture pulls.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../src/io/ssd_cache.h"
+#include "../src/io/ssd_codec.h"
+#include "../src/io/ssd_reader.h"
+
+namespace {
+
+constexpr size_t BLOCKS = 512;
+constexpr size_t LEVEL_BLOCKS = 48;
+constexpr size_t LEVELS = 8;
+constexpr size_t AUDIO_BLOCKS = 16;
+constexpr size_t TRACE_REQUESTS = 6000;
+constexpr size_t IN_FLIGHT = 4;
+
+using Clock = std::chrono::steady_clock;
+
+struct Request {
+    uint64_t lba;
+    uint32_t compressed_size;
+    uint32_t raw_size;
+};
+
+std::vector<uint8_t> texture_like(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> data(size);
+    uint16_t c0 = static_cast<uint16_t>(rng()), c1 = static_cast<uint16_t>(rng());
+    uint32_t indices = 0;
+    for (size_t block = 0; block * 8 < size; ++block) {
+        if (rng() % 4 == 0) {
+            c0 = static_cast<uint16_t>(c0 + rng() % 64 - 32);
+            c1 = static_cast<uint16_t>(c1 + rng() % 64 - 32);
+        }
+        if (rng() % 2) indices = rng();
+        std::memcpy(data.data() + block * 8, &c0, 2);
+        std::memcpy(data.data() + block * 8 + 2, &c1, 2);
+        std::memcpy(data.data() + block * 8 + 4, &indices, 4);
+    }
+    return data;
+}
+
+std::string make_synthetic(std::vector<Request>& trace) {
+    std::string path = "/tmp/psx5_bench_ssd_cache_" + std::to_string(getpid()) + ".img";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::mt19937 rng(21);
+    SSDCodec codec;
+    std::vector<uint8_t> compressed;
+    std::vector<Request> blocks;
+    uint64_t lba = 0;
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        codec.compress(texture_like(SSDCodec::CHUNK_SIZE, rng).data(), SSDCodec::CHUNK_SIZE, compressed);
+        blocks.push_back({lba, static_cast<uint32_t>(compressed.size()), static_cast<uint32_t>(SSDCodec::CHUNK_SIZE)});
+        uint64_t sectors = (compressed.size() + SSDQueue::SECTOR_SIZE - 1) / SSDQueue::SECTOR_SIZE;
+        compressed.resize(sectors * SSDQueue::SECTOR_SIZE, 0);
+        std::fwrite(compressed.data(), compressed.size(), 1, file);
+        lba += sectors;
+    }
+    std::fclose(file);
+
+    // Levels early in the game are revisited more often
+    std::discrete_distribution<size_t> level_pick({8, 6, 5, 4, 3, 2, 2, 1});
+    const size_t audio_base = LEVELS * LEVEL_BLOCKS;
+    while (trace.size() < TRACE_REQUESTS) {
+        size_t level = level_pick(rng);
+        for (size_t b = 0; b < LEVEL_BLOCKS && trace.size() < TRACE_REQUESTS; ++b) {
+            trace.push_back(blocks[level * LEVEL_BLOCKS + b]);
+            if (rng() % 5 == 0) trace.push_back(blocks[audio_base + rng() % AUDIO_BLOCKS]);
+            if (rng() % 10 == 0) trace.push_back(blocks[rng() % BLOCKS]);
+        }
+    }
+    trace.resize(TRACE_REQUESTS);
+    return path;
+}
+
+bool load_trace(const std::string& path, std::vector<Request>& trace) {
+    std::ifstream file(path);
+    Request request;
+    while (file >> request.lba >> request.compressed_size >> request.raw_size) trace.push_back(request);
+    return !trace.empty();
+}
+
+void replay(const char* name, const std::string& image, const std::vector<Request>& trace, size_t cache_bytes,
+            uint32_t read_ahead) {
+    SSDQueue queue;
+    if (!queue.open(image, SSDQueue::Config())) {
+        std::printf("cannot open %s\n", image.c_str());
+        return;
+    }
+    SSDBlockCache::Config config;
+    config.capacity = cache_bytes;
+    SSDBlockCache cache(config);
+    SSDReader reader(queue);
+    if (cache_bytes > 0) reader.set_cache(&cache, read_ahead);
+
+    uint32_t max_raw = 0;
+    for (const Request& request : trace) max_raw = std::max(max_raw, request.raw_size);
+    std::vector<std::vector<uint8_t>> outputs(IN_FLIGHT, std::vector<uint8_t>(max_raw));
+    std::vector<size_t> free_outputs;
+    for (size_t i = 0; i < IN_FLIGHT; ++i) free_outputs.push_back(i);
+    size_t failures = 0;
+    uint64_t raw_bytes = 0;
+
+    auto start = Clock::now();
+    for (const Request& request : trace) {
+        while (free_outputs.empty()) {
+            if (queue.poll() == 0) std::this_thread::yield();
+        }
+        size_t slot = free_outputs.back();
+        free_outputs.pop_back();
+        auto done = [&, slot](bool ok) {
+            failures += !ok;
+            free_outputs.push_back(slot);
+        };
+        while (!reader.submit(request.lba, request.compressed_size, outputs[slot].data(), request.raw_size, done)) {
+            queue.poll();
+        }
+        raw_bytes += request.raw_size;
+    }
+    queue.drain();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    SSDReader::Stats stats = reader.get_stats();
+    SSDBlockCache::Stats cached = cache.get_stats();
+    double hit_rate = 100.0 * cached.hits / trace.size();
+    double used = cached.read_ahead_inserts ? 100.0 * cached.read_ahead_used / cached.read_ahead_inserts : 0.0;
+    std::printf("%-18s %7.1f ms %7.0f MB/s   hits %5.1f%% (joined %4llu)   read-ahead used %5.1f%% of %4llu   "
+                "SSD read %6.1f MB   saved %6.1f MB%s\n",
+                name, seconds * 1e3, raw_bytes / seconds / 1e6, hit_rate,
+                static_cast<unsigned long long>(stats.read_ahead_joined), used,
+                static_cast<unsigned long long>(cached.read_ahead_inserts),
+                (stats.compressed_bytes + stats.read_ahead_bytes) / 1e6, cached.bytes_saved / 1e6,
+                failures ? "   FAILED" : "");
+    queue.close();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Request> trace;
+    const bool synthetic = argc < 3;
+    std::string image = synthetic ? make_synthetic(trace) : argv[1];
+    if (!synthetic && !load_trace(argv[2], trace)) {
+        std::printf("empty trace %s\n", argv[2]);
+        return 1;
+    }
+
+    uint64_t raw_total = 0;
+    for (const Request& request : trace) raw_total += request.raw_size;
+    std::printf("%zu requests, %.1f MB decompressed, %zu in flight\n", trace.size(), raw_total / 1e6, IN_FLIGHT);
+    replay("no cache", image, trace, 0, 0);
+    replay("cache 64 MiB", image, trace, 64u << 20, 0);
+    replay("cache + ahead 4", image, trace, 64u << 20, 4);
+    replay("cache + ahead 8", image, trace, 64u << 20, 8);
+    replay("16 MiB + ahead 4", image, trace, 16u << 20, 4);
+
+    if (synthetic) std::remove(image.c_str());
+    return 0;
+}
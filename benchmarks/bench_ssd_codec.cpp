@@ -0,0 +1,92 @@
+// SSD codec throughput on one thread: ratio, compression MB/s and
+// decompression GB/s for 16 MiB of synthetic texture-like (BC1 blocks) and
+// mesh-like (vertex floats plus an index buffer) data, with memcpy of the
+// same bytes as the ceiling.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../src/io/ssd_codec.h"
+
+namespace {
+
+constexpr size_t DATA_BYTES = 16u << 20;
+constexpr int DECODE_PASSES = 10;
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<uint8_t> texture_like(size_t size) {
+    std::mt19937 rng(11);
+    std::vector<uint8_t> data(size);
+    uint16_t c0 = 0x7BEF, c1 = 0x39E7;
+    uint32_t indices = 0;
+    for (size_t block = 0; block * 8 < size; ++block) {
+        if (rng() % 4 == 0) {
+            c0 = static_cast<uint16_t>(c0 + rng() % 64 - 32);
+            c1 = static_cast<uint16_t>(c1 + rng() % 64 - 32);
+        }
+        if (rng() % 2) indices = rng();
+        uint8_t bytes[8];
+        std::memcpy(bytes, &c0, 2);
+        std::memcpy(bytes + 2, &c1, 2);
+        std::memcpy(bytes + 4, &indices, 4);
+        std::memcpy(data.data() + block * 8, bytes, std::min<size_t>(8, size - block * 8));
+    }
+    return data;
+}
+
+std::vector<uint8_t> mesh_like(size_t size) {
+    std::mt19937 rng(12);
+    std::vector<uint8_t> data(size);
+    size_t vertex_bytes = size * 3 / 4 / 32 * 32;
+    for (size_t v = 0; v * 32 < vertex_bytes; ++v) {
+        float u = (v % 64) / 64.0f, w = (v / 64 % 64) / 64.0f;
+        float attributes[8] = {u, std::sin(u * 6.0f) * std::cos(w * 4.0f), w, 0.0f, 1.0f, 0.0f, u, w};
+        std::memcpy(data.data() + v * 32, attributes, 32);
+    }
+    uint16_t index = 0;
+    for (size_t i = vertex_bytes; i + 1 < size; i += 2) {
+        index = static_cast<uint16_t>(index + rng() % 8);
+        std::memcpy(data.data() + i, &index, 2);
+    }
+    return data;
+}
+
+void run(const char* name, const std::vector<uint8_t>& data) {
+    SSDCodec codec;
+    std::vector<uint8_t> compressed;
+    auto start = Clock::now();
+    codec.compress(data.data(), data.size(), compressed);
+    double compress_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint8_t> output(data.size());
+    bool ok = true;
+    start = Clock::now();
+    for (int pass = 0; pass < DECODE_PASSES; ++pass) {
+        ok &= SSDCodec::decompress(compressed.data(), compressed.size(), output.data(), output.size());
+    }
+    double decode_s = std::chrono::duration<double>(Clock::now() - start).count() / DECODE_PASSES;
+    ok &= output == data;
+
+    start = Clock::now();
+    for (int pass = 0; pass < DECODE_PASSES; ++pass) {
+        std::memcpy(output.data(), data.data(), data.size());
+    }
+    double copy_s = std::chrono::duration<double>(Clock::now() - start).count() / DECODE_PASSES;
+
+    std::printf("%-8s ratio %5.1f%%   compress %6.0f MB/s   decompress %5.2f GB/s   memcpy %5.2f GB/s%s\n", name,
+                100.0 * compressed.size() / data.size(), data.size() / compress_s / 1e6, data.size() / decode_s / 1e9,
+                data.size() / copy_s / 1e9, ok ? "" : "   MISMATCH");
+}
+
+} // namespace
+
+int main() {
+    std::printf("%zu MiB per data set, %zu KiB chunks, decode averaged over %d passes\n", DATA_BYTES >> 20,
+                SSDCodec::CHUNK_SIZE >> 10, DECODE_PASSES);
+    run("texture", texture_like(DATA_BYTES));
+    run("mesh", mesh_like(DATA_BYTES));
+    return 0;
+}
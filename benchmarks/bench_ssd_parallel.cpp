@@ -0,0 +1,100 @@
+// Chunk-parallel SSD decompression: decode GB/s of texture-like frames from
+// 64 KiB to 64 MiB on the calling thread alone and with 1-8 scheduler
+// workers helping. Frames below SSDCodec::PARALLEL_THRESHOLD stay on the
+// single-thread path, so those columns should match the first one.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../src/core/scheduler.h"
+#include "../src/io/ssd_codec.h"
+
+namespace {
+
+constexpr size_t READ_SIZES[] = {64u << 10, 128u << 10, 256u << 10, 1u << 20, 4u << 20, 16u << 20, 64u << 20};
+constexpr int WORKER_COUNTS[] = {0, 1, 2, 4, 8};
+constexpr double MIN_SECONDS = 0.2;
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<uint8_t> texture_like(size_t size) {
+    std::mt19937 rng(11);
+    std::vector<uint8_t> data(size);
+    uint16_t c0 = 0x7BEF, c1 = 0x39E7;
+    uint32_t indices = 0;
+    for (size_t block = 0; block * 8 < size; ++block) {
+        if (rng() % 4 == 0) {
+            c0 = static_cast<uint16_t>(c0 + rng() % 64 - 32);
+            c1 = static_cast<uint16_t>(c1 + rng() % 64 - 32);
+        }
+        if (rng() % 2) indices = rng();
+        uint8_t bytes[8];
+        std::memcpy(bytes, &c0, 2);
+        std::memcpy(bytes + 2, &c1, 2);
+        std::memcpy(bytes + 4, &indices, 4);
+        std::memcpy(data.data() + block * 8, bytes, std::min<size_t>(8, size - block * 8));
+    }
+    return data;
+}
+
+// Decodes the frame repeatedly for at least MIN_SECONDS; returns GB/s
+double decode_rate(const std::vector<uint8_t>& compressed, std::vector<uint8_t>& output, Scheduler* scheduler,
+                   bool& ok) {
+    int passes = 0;
+    auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        ok &= SSDCodec::decompress(compressed.data(), compressed.size(), output.data(), output.size(), scheduler);
+        ++passes;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < MIN_SECONDS);
+    return output.size() * static_cast<double>(passes) / elapsed / 1e9;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<uint8_t> data = texture_like(READ_SIZES[std::size(READ_SIZES) - 1]);
+    SSDCodec codec;
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t size : READ_SIZES) {
+        frames.emplace_back();
+        codec.compress(data.data(), size, frames.back());
+    }
+
+    std::printf("decode GB/s, %u hardware threads, parallel from %zu KiB\n", std::thread::hardware_concurrency(),
+                SSDCodec::PARALLEL_THRESHOLD >> 10);
+    std::printf("%-10s", "read");
+    for (int workers : WORKER_COUNTS) {
+        if (workers == 0) std::printf("%12s", "caller");
+        else std::printf("%9d wk", workers);
+    }
+    std::printf("\n");
+
+    // rates[size][column]
+    std::vector<std::vector<double>> rates(std::size(READ_SIZES));
+    bool ok = true;
+    for (int workers : WORKER_COUNTS) {
+        Scheduler scheduler;
+        if (workers > 0) scheduler.initialize(workers);
+        for (size_t i = 0; i < std::size(READ_SIZES); ++i) {
+            std::vector<uint8_t> output(READ_SIZES[i]);
+            rates[i].push_back(decode_rate(frames[i], output, workers > 0 ? &scheduler : nullptr, ok));
+            ok &= std::equal(output.begin(), output.end(), data.begin());
+        }
+        if (workers > 0) scheduler.shutdown();
+    }
+
+    for (size_t i = 0; i < std::size(READ_SIZES); ++i) {
+        if (READ_SIZES[i] >= (1u << 20)) std::printf("%6zu MiB", READ_SIZES[i] >> 20);
+        else std::printf("%6zu KiB", READ_SIZES[i] >> 10);
+        for (double rate : rates[i]) std::printf("%12.2f", rate);
+        std::printf("\n");
+    }
+    if (!ok) std::printf("MISMATCH\n");
+    return ok ? 0 : 1;
+}
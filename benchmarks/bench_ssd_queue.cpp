@@ -0,0 +1,102 @@
+// SSD queue throughput: 4 KiB random reads from a 64 MiB backing file kept
+// at queue depth 1, 32 and 128, through io_uring and the pread thread pool,
+// as IOPS and as p50/p99 latency from submit to callback. The file sits in
+// the page cache after the first pass, so this measures the queueing
+// machinery rather than the host disk.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../src/io/ssd_queue.h"
+
+namespace {
+
+constexpr uint64_t FILE_BYTES = 64ull << 20;
+constexpr uint32_t READ_SECTORS = 4096 / SSDQueue::SECTOR_SIZE;
+constexpr size_t READS = 200000;
+
+using Clock = std::chrono::steady_clock;
+
+std::string make_image() {
+    std::string path = "/tmp/psx5_bench_ssd_" + std::to_string(getpid()) + ".img";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::vector<uint8_t> chunk(1 << 20);
+    std::mt19937 rng(9);
+    for (uint8_t& b : chunk) b = static_cast<uint8_t>(rng());
+    for (uint64_t written = 0; written < FILE_BYTES; written += chunk.size()) {
+        std::fwrite(chunk.data(), chunk.size(), 1, file);
+    }
+    std::fclose(file);
+    return path;
+}
+
+struct Result {
+    double iops;
+    double p50_us;
+    double p99_us;
+};
+
+bool run(const std::string& path, SSDQueue::Backend backend, uint32_t depth, Result& result) {
+    SSDQueue queue;
+    SSDQueue::Config config;
+    config.queue_depth = depth;
+    config.backend = backend;
+    if (!queue.open(path, config)) return false;
+
+    const uint64_t blocks = FILE_BYTES / 4096;
+    std::mt19937_64 rng(depth);
+    std::vector<std::vector<uint8_t>> buffers(depth, std::vector<uint8_t>(4096));
+    std::vector<Clock::time_point> issued_at(depth);
+    std::vector<double> latencies;
+    latencies.reserve(READS);
+    size_t issued = 0;
+
+    std::function<void(size_t)> issue = [&](size_t b) {
+        if (issued == READS) return;
+        ++issued;
+        issued_at[b] = Clock::now();
+        queue.submit_read((rng() % blocks) * READ_SECTORS, READ_SECTORS, buffers[b].data(), [&, b](bool) {
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - issued_at[b]).count());
+            issue(b);
+        });
+    };
+
+    auto start = Clock::now();
+    for (size_t b = 0; b < depth; ++b) issue(b);
+    while (queue.pending() > 0) {
+        if (queue.poll() == 0) std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    result.iops = READS / seconds;
+    result.p50_us = latencies[latencies.size() / 2];
+    result.p99_us = latencies[latencies.size() * 99 / 100];
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::string path = make_image();
+    std::printf("%zu random 4 KiB reads from a %llu MiB file per run\n", READS,
+                static_cast<unsigned long long>(FILE_BYTES >> 20));
+    for (uint32_t depth : {1u, 32u, 128u}) {
+        for (auto backend : {SSDQueue::Backend::IoUring, SSDQueue::Backend::ThreadPool}) {
+            const char* name = backend == SSDQueue::Backend::IoUring ? "io_uring" : "threads ";
+            Result r;
+            if (!run(path, backend, depth, r)) {
+                std::printf("QD %3u  %s  unavailable\n", depth, name);
+                continue;
+            }
+            std::printf("QD %3u  %s  %9.0f IOPS   p50 %8.1f us   p99 %8.1f us\n", depth, name, r.iops, r.p50_us,
+                        r.p99_us);
+        }
+    }
+    std::remove(path.c_str());
+    return 0;
+}
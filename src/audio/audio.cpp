@@ -1,5 +1,7 @@
 #include "audio.h"
+#include "audio_devices.h"
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
 #include <cstring>
 
@@ -9,13 +11,17 @@
 #include <dsound.h>
 #pragma comment(lib, "dsound.lib")
 #pragma comment(lib, "winmm.lib")
-#elif defined(__linux__)
+#elif defined(__linux__) && defined(PSX5_ENABLE_ALSA)
 #include <alsa/asoundlib.h>
 #elif defined(__APPLE__)
 #include <AudioToolbox/AudioToolbox.h>
 #include <CoreAudio/CoreAudio.h>
 #endif
 
+#ifdef PSX5_ENABLE_SDL2
+#include <SDL2/SDL.h>
+#endif
+
 
 #ifdef _WIN32
 class DirectSoundDevice : public AudioDevice {
@@ -122,9 +128,255 @@ public:
 };
 #endif
 
-#ifdef __linux__
+#if defined(__linux__) && defined(PSX5_ENABLE_ALSA)
+// snd_pcm in mmap mode, pull model: a playback thread waits for a free
+// period and has Audio render straight into the mapped buffer (through a
+// scratch block when the device only takes 16-bit)
 class ALSADevice : public AudioDevice {
-    // TODO: ALSA implementation details needs to be added
+private:
+    static constexpr unsigned int PERIODS = 2;
+    static constexpr snd_pcm_uframes_t DEFAULT_PERIOD_FRAMES = 256;
+
+    snd_pcm_t* pcm = nullptr;
+    AudioFormat format;
+    bool float_samples = true;
+    snd_pcm_uframes_t period_frames = 0;
+    snd_pcm_uframes_t buffer_frames = 0;
+    AudioRenderCallback render;
+    std::vector<float> scratch;
+    std::thread playback_thread;
+    std::atomic<bool> running{false};
+    std::atomic<int64_t> delay_frames{-1};
+
+    bool configure_hw() {
+        snd_pcm_hw_params_t* hw;
+        snd_pcm_hw_params_alloca(&hw);
+        snd_pcm_hw_params_any(pcm, hw);
+        if (snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0) {
+            return false;
+        }
+        float_samples = snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_FLOAT) == 0;
+        if (!float_samples && snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16) < 0) {
+            return false;
+        }
+        if (snd_pcm_hw_params_set_channels(pcm, hw, format.channels) < 0) {
+            return false;
+        }
+        // Any rate the hardware offers; Audio resamples to it
+        unsigned int rate = format.sample_rate;
+        if (snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, nullptr) < 0) {
+            return false;
+        }
+        format.sample_rate = static_cast<int>(rate);
+        snd_pcm_uframes_t period = format.period_frames > 0 ? format.period_frames : DEFAULT_PERIOD_FRAMES;
+        snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, nullptr);
+        unsigned int periods = PERIODS;
+        snd_pcm_hw_params_set_periods_near(pcm, hw, &periods, nullptr);
+        if (snd_pcm_hw_params(pcm, hw) < 0) {
+            return false;
+        }
+        return snd_pcm_get_params(pcm, &buffer_frames, &period_frames) == 0;
+    }
+
+    bool configure_sw() {
+        snd_pcm_sw_params_t* sw;
+        snd_pcm_sw_params_alloca(&sw);
+        snd_pcm_sw_params_current(pcm, sw);
+        // Start once the whole buffer is primed, wake once a period is free
+        snd_pcm_sw_params_set_start_threshold(pcm, sw, buffer_frames);
+        snd_pcm_sw_params_set_avail_min(pcm, sw, period_frames);
+        return snd_pcm_sw_params(pcm, sw) == 0;
+    }
+
+    // Renders up to `frames` into the mmap area; negative errno if the
+    // stream broke
+    int fill(snd_pcm_uframes_t frames) {
+        const snd_pcm_channel_area_t* areas;
+        snd_pcm_uframes_t offset;
+        int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+        if (err < 0) {
+            return err;
+        }
+        // Interleaved access: one area, every channel in `step`-bit frames
+        char* base = static_cast<char*>(areas[0].addr) + areas[0].first / 8 + offset * (areas[0].step / 8);
+        if (float_samples) {
+            render(reinterpret_cast<float*>(base), frames);
+        } else {
+            render(scratch.data(), frames);
+            int16_t* dst = reinterpret_cast<int16_t*>(base);
+            for (size_t i = 0; i < frames * format.channels; i++) {
+                dst[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, scratch[i])) * 32767.0f);
+            }
+        }
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, frames);
+        if (committed < 0) {
+            return static_cast<int>(committed);
+        }
+        return static_cast<snd_pcm_uframes_t>(committed) == frames ? 0 : -EPIPE;
+    }
+
+    void playback_loop() {
+        while (running) {
+            snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+            if (avail < 0) {
+                snd_pcm_recover(pcm, static_cast<int>(avail), 1);
+                continue;
+            }
+            if (static_cast<snd_pcm_uframes_t>(avail) < period_frames) {
+                if (snd_pcm_state(pcm) != SND_PCM_STATE_RUNNING) {
+                    snd_pcm_start(pcm);
+                }
+                snd_pcm_wait(pcm, 100);
+                continue;
+            }
+            // One period per pass keeps the render block size constant
+            int err = fill(period_frames);
+            if (err < 0) {
+                snd_pcm_recover(pcm, err, 1);
+                continue;
+            }
+            snd_pcm_sframes_t delay;
+            if (snd_pcm_delay(pcm, &delay) == 0) {
+                delay_frames.store(delay, std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    bool initialize(const AudioFormat& fmt) override {
+        format = fmt;
+        if (snd_pcm_open(&pcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+            pcm = nullptr;
+            return false;
+        }
+        if (!configure_hw() || !configure_sw()) {
+            snd_pcm_close(pcm);
+            pcm = nullptr;
+            return false;
+        }
+        scratch.assign(period_frames * format.channels, 0.0f);
+        return snd_pcm_prepare(pcm) == 0;
+    }
+
+    bool set_render_callback(AudioRenderCallback callback) override {
+        render = std::move(callback);
+        return true;
+    }
+
+    void start() override {
+        if (!pcm || !render || running) return;
+        running = true;
+        playback_thread = std::thread(&ALSADevice::playback_loop, this);
+    }
+
+    void stop() override {
+        running = false;
+        if (playback_thread.joinable()) {
+            playback_thread.join();
+        }
+        if (pcm) {
+            snd_pcm_drop(pcm);
+            snd_pcm_prepare(pcm);
+        }
+        delay_frames.store(-1, std::memory_order_relaxed);
+    }
+
+    // Pull only: Audio renders from the playback thread
+    void write_samples(const float*, size_t) override {}
+
+    size_t get_buffer_size() const override { return buffer_frames; }
+
+    // snd_pcm_delay() counts every frame between the application pointer
+    // and the DAC, queued periods included; until the first measurement the
+    // configured period x periods stands in for it
+    double get_latency() const override {
+        int64_t delay = delay_frames.load(std::memory_order_relaxed);
+        if (delay < 0) delay = static_cast<int64_t>(buffer_frames);
+        return static_cast<double>(delay) / format.sample_rate;
+    }
+
+    int get_sample_rate() const override { return format.sample_rate; }
+
+    ~ALSADevice() {
+        stop();
+        if (pcm) snd_pcm_close(pcm);
+    }
+};
+#endif
+
+#ifdef PSX5_ENABLE_SDL2
+// SDL2 audio callback, pull model. SDL runs the callback on its own thread
+// whenever the device needs `samples` more frames.
+class SDL2Device : public AudioDevice {
+private:
+    SDL_AudioDeviceID device_id = 0;
+    SDL_AudioSpec obtained = {};
+    AudioRenderCallback render;
+
+    static void callback(void* userdata, Uint8* stream, int len) {
+        SDL2Device* self = static_cast<SDL2Device*>(userdata);
+        float* output = reinterpret_cast<float*>(stream);
+        size_t frames = static_cast<size_t>(len) / (sizeof(float) * self->obtained.channels);
+        if (self->render) {
+            self->render(output, frames);
+        } else {
+            std::memset(stream, 0, len);
+        }
+    }
+
+public:
+    bool initialize(const AudioFormat& format) override {
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+            return false;
+        }
+        SDL_AudioSpec want;
+        SDL_zero(want);
+        want.freq = format.sample_rate;
+        want.format = AUDIO_F32SYS;
+        want.channels = static_cast<Uint8>(format.channels);
+        want.samples = static_cast<Uint16>(format.period_frames > 0 ? format.period_frames : 256);
+        want.callback = &SDL2Device::callback;
+        want.userdata = this;
+        // The layout is fixed, so SDL converts that; the rate may follow the
+        // device and Audio resamples to it
+        device_id = SDL_OpenAudioDevice(nullptr, 0, &want, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+        if (!device_id) {
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return false;
+        }
+        return true;
+    }
+
+    bool set_render_callback(AudioRenderCallback callback) override {
+        render = std::move(callback);
+        return true;
+    }
+
+    void start() override {
+        if (device_id) SDL_PauseAudioDevice(device_id, 0);
+    }
+
+    void stop() override {
+        if (device_id) SDL_PauseAudioDevice(device_id, 1);
+    }
+
+    void write_samples(const float*, size_t) override {}
+
+    size_t get_buffer_size() const override { return obtained.samples; }
+
+    // SDL exposes no device delay; its own buffer plus the one being played
+    double get_latency() const override {
+        return obtained.freq ? 2.0 * obtained.samples / obtained.freq : 0.0;
+    }
+
+    int get_sample_rate() const override { return obtained.freq; }
+
+    ~SDL2Device() {
+        if (device_id) {
+            SDL_CloseAudioDevice(device_id);
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
+    }
 };
 #endif
 
@@ -136,48 +388,108 @@ class CoreAudioDevice : public AudioDevice {
 
 Audio::Audio() : running(false) {
     // Initialize APU state
-    apu_state.master_volume = 1.0f;
     for (int i = 0; i < 8; i++) {
         apu_state.channel_volumes[i] = 1.0f;
         apu_state.channel_muted[i] = false;
     }
-    apu_state.reverb_type = 0;
-    apu_state.reverb_depth = 0.0f;
-    apu_state.surround_enabled = false;
+    std::fill(std::begin(apu_state.eq_bands), std::end(apu_state.eq_bands), 0);
     
-    // Initialize effects
-    effects.compressor_enabled = false;
-    effects.compressor_threshold = -12.0f;
-    effects.compressor_ratio = 4.0f;
-    effects.limiter_enabled = true;
-    effects.limiter_threshold = -0.1f;
-    effects.delay_buffer.resize(48000); // 1 second delay buffer at 48kHz
-    effects.delay_write_pos = 0;
+    // Effects chain, in processing order. The reverb runs once, after the 3D
+    // sources are mixed in, and the dynamics see the reverb tail.
+    dsp.add_node(std::make_unique<AudioGainNode>());
+    dsp.add_node(std::make_unique<AudioSpatializerNode>());
+    dsp.add_node(std::make_unique<AudioReverbNode>());
+    dsp.add_node(std::make_unique<AudioCompressorNode>());
+    dsp.add_node(std::make_unique<AudioLimiterNode>());
+    std::lock_guard<std::mutex> lock(params_mutex);
+    publish_params();
 }
 
 Audio::~Audio() {
     shutdown();
 }
 
-bool Audio::initialize(const AudioFormat& format) {
-    current_format = format;
-    
+bool Audio::initialize(const AudioFormat& format, AudioBackend backend) {
+    std::unique_ptr<AudioDevice> output;
+    switch (backend) {
+    case AudioBackend::SDL2:
+#ifdef PSX5_ENABLE_SDL2
+        output = std::make_unique<SDL2Device>();
+        break;
+#else
+        return false;
+#endif
+    case AudioBackend::ALSA:
+#if defined(__linux__) && defined(PSX5_ENABLE_ALSA)
+        output = std::make_unique<ALSADevice>();
+        break;
+#else
+        return false;
+#endif
+    case AudioBackend::Default:
 #ifdef _WIN32
-    device = std::make_unique<DirectSoundDevice>();
+        output = std::make_unique<DirectSoundDevice>();
+#elif defined(__linux__) && defined(PSX5_ENABLE_ALSA)
+        output = std::make_unique<ALSADevice>();
 #elif defined(__linux__)
-    device = std::make_unique<ALSADevice>();
+        // Built without libasound: play silently in real time
+        output = std::make_unique<NullAudioDevice>(NullAudioDevice::Pacing::RealTime);
 #elif defined(__APPLE__)
-    device = std::make_unique<CoreAudioDevice>();
+        output = std::make_unique<CoreAudioDevice>();
 #else
-    return false;
+        return false;
 #endif
-    
-    if (!device->initialize(format)) {
+        break;
+    case AudioBackend::Null:
+        output = std::make_unique<NullAudioDevice>(NullAudioDevice::Pacing::RealTime);
+        break;
+    case AudioBackend::NullUnthrottled:
+        output = std::make_unique<NullAudioDevice>(NullAudioDevice::Pacing::Unthrottled);
+        break;
+    }
+    return initialize(format, std::move(output));
+}
+
+bool Audio::initialize(const AudioFormat& format, std::unique_ptr<AudioDevice> output) {
+    std::lock_guard<std::mutex> device_lock(device_mutex);
+    current_format = format;
+    device = std::move(output);
+    AudioFormat device_format = format;
+    if (format.output_sample_rate > 0) {
+        device_format.sample_rate = format.output_sample_rate;
+    }
+    if (!device || !device->initialize(device_format)) {
+        device.reset();
         return false;
     }
+    output_rate = device->get_sample_rate() > 0 ? device->get_sample_rate() : device_format.sample_rate;
+    base_ratio = static_cast<double>(format.sample_rate) / output_rate;
+    
+    {
+        std::lock_guard<std::mutex> lock(params_mutex);
+        params.sample_rate = output_rate;
+        params.channels = format.channels;
+        publish_params();
+    }
     
+    ring = std::make_unique<AudioRingBuffer>(RING_CAPACITY_FRAMES, format.channels);
+    dsp_block.assign(PERIOD_FRAMES * format.channels, 0.0f);
+    underruns = 0;
+    stretch_ratio = 1.0;
     running = true;
-    audio_thread = std::thread(&Audio::audio_thread_func, this);
+    pacing = device->set_render_callback([this](float* output, size_t frames) { render(output, frames); });
+    resampling = pacing || output_rate != format.sample_rate;
+    if (resampling) {
+        resampler.configure(format.channels, format.resample_quality);
+        resampler.set_ratio(base_ratio);
+    }
+    if (pacing) {
+        latency.configure(format.sample_rate, format.latency_min_ms, format.latency_max_ms);
+        latency_target_frames = latency.target_frames();
+    } else {
+        latency_target_frames = 0;
+        audio_thread = std::thread(&Audio::audio_thread_func, this);
+    }
     device->start();
     
     return true;
@@ -186,12 +498,14 @@ bool Audio::initialize(const AudioFormat& format) {
 void Audio::shutdown() {
     if (running) {
         running = false;
-        buffer_cv.notify_all();
+        ring->wake();
         
         if (audio_thread.joinable()) {
             audio_thread.join();
         }
         
+        // Pull-model devices stop calling render() before this returns
+        std::lock_guard<std::mutex> lock(device_mutex);
         if (device) {
             device->stop();
             device.reset();
@@ -202,135 +516,106 @@ void Audio::shutdown() {
 void Audio::push_samples(const float* samples, int frame_count) {
     if (!running || !samples || frame_count <= 0) return;
     
-    std::lock_guard<std::mutex> lock(buffer_mutex);
-    
-    AudioBuffer buffer;
-    buffer.frames = frame_count;
-    buffer.channels = current_format.channels;
-    buffer.data.resize(frame_count * current_format.channels);
-    buffer.timestamp = 0.0; // Would be set by system clock
-    buffer.is_ready = true;
-    
-    // Copy and process samples
-    std::memcpy(buffer.data.data(), samples, frame_count * current_format.channels * sizeof(float));
-    
-    // Apply APU processing
-    process_audio_effects(buffer.data.data(), frame_count);
-    apply_3d_audio(buffer.data.data(), frame_count);
-    
-    buffer_queue.push_back(std::move(buffer));
-    buffer_cv.notify_one();
+    // Raw PCM only; effects run on the audio thread
+    size_t written = ring->write(samples, frame_count);
+    if (written < static_cast<size_t>(frame_count)) {
+        dropped_frames.fetch_add(frame_count - written, std::memory_order_relaxed);
+    }
 }
 
 void Audio::audio_thread_func() {
-    while (running) {
-        std::unique_lock<std::mutex> lock(buffer_mutex);
-        buffer_cv.wait(lock, [this] { return !buffer_queue.empty() || !running; });
-        
-        if (!running) break;
-        
-        if (!buffer_queue.empty()) {
-            AudioBuffer buffer = std::move(buffer_queue.front());
-            buffer_queue.erase(buffer_queue.begin());
-            lock.unlock();
-            
-            // Send to audio device
-            device->write_samples(buffer.data.data(), buffer.frames);
+    for (;;) {
+        // Sample the signal before `running` so the wake from shutdown()
+        // cannot slip in between the check and the wait
+        uint32_t seen = ring->data_signal();
+        bool stopping = !running;
+        size_t needed = resampling ? resampler.input_frames_needed(PERIOD_FRAMES) : PERIOD_FRAMES;
+        size_t available = ring->read_available();
+        if (available < needed) {
+            if (!stopping) {
+                ring->wait_for_data(seen);
+                continue;
+            }
+            // Everything queued at shutdown is played out, so file and null
+            // devices see every frame that was pushed: the partial last
+            // block goes out short, then the thread exits
+            size_t frames = drain_frames(available);
+            if (frames > 0) {
+                read_ring(dsp_block.data(), frames);
+                dsp.process(dsp_block.data(), frames);
+                device->write_samples(dsp_block.data(), frames);
+            }
+            break;
         }
+        
+        // Take the block out so the producer can refill while it is processed
+        read_ring(dsp_block.data(), PERIOD_FRAMES);
+        dsp.process(dsp_block.data(), PERIOD_FRAMES);
+        device->write_samples(dsp_block.data(), PERIOD_FRAMES);
     }
 }
 
-void Audio::process_audio_effects(float* samples, size_t frame_count) {
-    // Apply master volume
-    for (size_t i = 0; i < frame_count * current_format.channels; i++) {
-        samples[i] *= apu_state.master_volume;
+size_t Audio::drain_frames(size_t available) const {
+    if (!resampling) {
+        return available;
     }
-    
-    // Apply compressor
-    if (effects.compressor_enabled) {
-        float threshold_linear = std::pow(10.0f, effects.compressor_threshold / 20.0f);
-        float ratio_inv = 1.0f / effects.compressor_ratio;
-        
-        for (size_t i = 0; i < frame_count * current_format.channels; i++) {
-            float abs_sample = std::abs(samples[i]);
-            if (abs_sample > threshold_linear) {
-                float excess = abs_sample - threshold_linear;
-                float compressed_excess = excess * ratio_inv;
-                float sign = samples[i] >= 0 ? 1.0f : -1.0f;
-                samples[i] = sign * (threshold_linear + compressed_excess);
-            }
-        }
+    // The last output frame whose position still falls on a pushed frame;
+    // the filter's look-ahead past it reads the silence read_ring pads with
+    size_t limit = available + AudioResampler::HALF_TAPS;
+    size_t frames = PERIOD_FRAMES;
+    while (frames > 0 && resampler.input_frames_needed(frames) > limit) {
+        --frames;
     }
-    
-    // Apply limiter
-    if (effects.limiter_enabled) {
-        float limit_linear = std::pow(10.0f, effects.limiter_threshold / 20.0f);
-        for (size_t i = 0; i < frame_count * current_format.channels; i++) {
-            samples[i] = std::max(-limit_linear, std::min(limit_linear, samples[i]));
+    return frames;
+}
+
+// Pull-model devices: whatever the ring holds, silence for the rest, and
+// the whole block through the DSP chain so effect tails keep running
+void Audio::render(float* output, size_t frames) {
+    if (!latency.update(ring->read_available(), frames)) {
+        // Refilling after an underrun
+        std::fill(output, output + frames * current_format.channels, 0.0f);
+    } else {
+        resampler.set_ratio(base_ratio * latency.stretch());
+        if (!read_ring(output, frames)) {
+            latency.underrun();
+            underruns.fetch_add(1, std::memory_order_relaxed);
         }
     }
-    
-    // Apply reverb (simplified)
-    if (apu_state.reverb_depth > 0.0f) {
-        apply_room_reverb(samples, frame_count);
-    }
+    latency_target_frames.store(latency.target_frames(), std::memory_order_relaxed);
+    stretch_ratio.store(latency.stretch(), std::memory_order_relaxed);
+    dsp.process(output, frames);
 }
 
-void Audio::apply_3d_audio(float* samples, size_t frame_count) {
-    if (!apu_state.surround_enabled || current_format.channels < 2) return;
-    
-    for (const auto& source : audio_sources_) {
-        if (!source.second.active) continue;
-        
-        // Calculate 3D position relative to listener
-        float dx = source.second.position.x - listener_position_.x;
-        float dy = source.second.position.y - listener_position_.y; 
-        float dz = source.second.position.z - listener_position_.z;
-        
-        float distance = std::sqrt(dx*dx + dy*dy + dz*dz);
-        if (distance < 0.001f) distance = 0.001f;
-        
-        // Calculate azimuth and elevation for HRTF
-        float azimuth = std::atan2(dx, dz);
-        float elevation = std::atan2(dy, std::sqrt(dx*dx + dz*dz));
-        
-        // Apply distance attenuation
-        float attenuation = 1.0f / (1.0f + distance * 0.1f);
-        
-        // Apply HRTF (Head-Related Transfer Function) for spatial audio
-        for (size_t i = 0; i < frame_count; ++i) {
-            if (current_format.channels >= 2) {
-                float source_sample = source.second.volume * attenuation;
-                
-                // Simplified HRTF - real implementation would use measured HRTF data
-                float left_gain = 0.5f + 0.5f * std::cos(azimuth + 0.5f);
-                float right_gain = 0.5f + 0.5f * std::cos(azimuth - 0.5f);
-                
-                // Apply elevation filtering
-                float elevation_factor = std::cos(elevation);
-                left_gain *= elevation_factor;
-                right_gain *= elevation_factor;
-                
-                // Add to output with proper delay for ITD (Interaural Time Difference)
-                size_t delay_samples = static_cast<size_t>(std::abs(std::sin(azimuth)) * 0.0006f * current_format.sample_rate);
-                
-                if (i >= delay_samples) {
-                    samples[i * current_format.channels] += source_sample * left_gain;
-                    samples[i * current_format.channels + 1] += source_sample * right_gain;
-                }
-            }
-        }
+bool Audio::read_ring(float* output, size_t frames) {
+    const size_t channels = current_format.channels;
+    if (!resampling) {
+        size_t got = ring->read(output, frames);
+        std::fill(output + got * channels, output + frames * channels, 0.0f);
+        return got == frames;
     }
-    
-    // Apply room reverb simulation
-    // TODO: Implement room reverb no simulation
-    if (apu_state.reverb_depth > 0.0f) {
-        apply_room_reverb(samples, frame_count);
+    // Grows over the first few blocks; after that the count only wanders
+    // by a frame or two
+    size_t needed = resampler.input_frames_needed(frames);
+    if (resample_input.size() < needed * channels) {
+        resample_input.resize(needed * channels);
     }
+    size_t got = ring->read(resample_input.data(), needed);
+    std::fill(resample_input.begin() + got * channels, resample_input.begin() + needed * channels, 0.0f);
+    resampler.process(resample_input.data(), output, frames);
+    return got == needed;
+}
+
+// Caller holds params_mutex
+void Audio::publish_params() {
+    dsp.params().edit() = params;
+    dsp.params().publish();
 }
 
 void Audio::set_master_volume(float volume) {
-    apu_state.master_volume = std::max(0.0f, std::min(1.0f, volume));
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.master_volume = std::max(0.0f, std::min(1.0f, volume));
+    publish_params();
 }
 
 void Audio::set_channel_volume(int channel, float volume) {
@@ -346,144 +631,171 @@ void Audio::mute_channel(int channel, bool muted) {
 }
 
 void Audio::enable_surround(bool enabled) {
-    apu_state.surround_enabled = enabled;
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.surround_enabled = enabled;
+    publish_params();
 }
 
 void Audio::set_reverb(int type, float depth) {
-    apu_state.reverb_type = type;
-    apu_state.reverb_depth = std::max(0.0f, std::min(1.0f, depth));
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.reverb_type = type;
+    params.reverb_depth = std::max(0.0f, std::min(1.0f, depth));
+    publish_params();
+}
+
+void Audio::set_compressor(bool enabled, float threshold_db, float ratio, float attack_ms, float release_ms) {
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.compressor_enabled = enabled;
+    params.compressor_threshold = std::min(0.0f, threshold_db);
+    params.compressor_ratio = std::max(1.0f, ratio);
+    params.compressor_attack_ms = std::max(0.0f, attack_ms);
+    params.compressor_release_ms = std::max(0.0f, release_ms);
+    publish_params();
+}
+
+void Audio::set_limiter(bool enabled, float threshold_db, float release_ms) {
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.limiter_enabled = enabled;
+    params.limiter_threshold = std::min(0.0f, threshold_db);
+    params.limiter_release_ms = std::max(0.0f, release_ms);
+    publish_params();
 }
 
 void Audio::enable_3d_audio(bool enabled) {
-    apu_state.surround_enabled = enabled;
+    enable_surround(enabled);
 }
 
 void Audio::set_tempest_3d_params(float listener_x, float listener_y, float listener_z,
                                  float forward_x, float forward_y, float forward_z,
                                  float up_x, float up_y, float up_z) {
-    listener_position_ = {listener_x, listener_y, listener_z};
-    listener_forward_ = {forward_x, forward_y, forward_z};
-    listener_up_ = {up_x, up_y, up_z};
+    std::lock_guard<std::mutex> lock(params_mutex);
+    AudioVector3& forward = params.listener_forward;
+    AudioVector3& up = params.listener_up;
+    AudioVector3& right = params.listener_right;
+    params.listener_position = {listener_x, listener_y, listener_z};
+    forward = {forward_x, forward_y, forward_z};
+    up = {up_x, up_y, up_z};
     
     // Calculate right vector for 3D orientation
-    listener_right_.x = listener_forward_.y * listener_up_.z - listener_forward_.z * listener_up_.y;
-    listener_right_.y = listener_forward_.z * listener_up_.x - listener_forward_.x * listener_up_.z;
-    listener_right_.z = listener_forward_.x * listener_up_.y - listener_forward_.y * listener_up_.x;
+    right.x = forward.y * up.z - forward.z * up.y;
+    right.y = forward.z * up.x - forward.x * up.z;
+    right.z = forward.x * up.y - forward.y * up.x;
     
     // Normalize vectors
-    float forward_len = std::sqrt(listener_forward_.x*listener_forward_.x + listener_forward_.y*listener_forward_.y + listener_forward_.z*listener_forward_.z);
+    float forward_len = std::sqrt(forward.x*forward.x + forward.y*forward.y + forward.z*forward.z);
     if (forward_len > 0.001f) {
-        listener_forward_.x /= forward_len;
-        listener_forward_.y /= forward_len;
-        listener_forward_.z /= forward_len;
+        forward.x /= forward_len;
+        forward.y /= forward_len;
+        forward.z /= forward_len;
     }
     
-    float right_len = std::sqrt(listener_right_.x*listener_right_.x + listener_right_.y*listener_right_.y + listener_right_.z*listener_right_.z);
+    float right_len = std::sqrt(right.x*right.x + right.y*right.y + right.z*right.z);
     if (right_len > 0.001f) {
-        listener_right_.x /= right_len;
-        listener_right_.y /= right_len;
-        listener_right_.z /= right_len;
+        right.x /= right_len;
+        right.y /= right_len;
+        right.z /= right_len;
     }
+    publish_params();
 }
 
 void Audio::add_audio_source(int source_id, float x, float y, float z, float volume) {
     AudioSource3D source;
+    source.id = source_id;
     source.position = {x, y, z};
     source.volume = std::max(0.0f, std::min(1.0f, volume));
-    source.active = true;
     source.doppler_factor = 1.0f;
     source.last_position = source.position;
     
-    audio_sources_[source_id] = source;
+    std::lock_guard<std::mutex> lock(params_mutex);
+    auto it = std::find_if(params.sources.begin(), params.sources.end(),
+                           [source_id](const AudioSource3D& s) { return s.id == source_id; });
+    if (it != params.sources.end()) {
+        *it = source;
+    } else {
+        params.sources.push_back(source);
+    }
+    publish_params();
 }
 
 void Audio::update_audio_source(int source_id, float x, float y, float z) {
-    auto it = audio_sources_.find(source_id);
-    if (it != audio_sources_.end()) {
-        it->second.last_position = it->second.position;
-        it->second.position = {x, y, z};
-        
-        // Calculate Doppler effect
-        float dx = it->second.position.x - it->second.last_position.x;
-        float dy = it->second.position.y - it->second.last_position.y;
-        float dz = it->second.position.z - it->second.last_position.z;
-        
-        float velocity = std::sqrt(dx*dx + dy*dy + dz*dz) * current_format.sample_rate / 1024.0f; // Approximate velocity
-        float sound_speed = 343.0f; // m/s
-        
-        // Calculate relative velocity towards listener
-        float rel_dx = listener_position_.x - it->second.position.x;
-        float rel_dy = listener_position_.y - it->second.position.y;
-        float rel_dz = listener_position_.z - it->second.position.z;
-        float distance = std::sqrt(rel_dx*rel_dx + rel_dy*rel_dy + rel_dz*rel_dz);
-        
-        if (distance > 0.001f) {
-            float radial_velocity = (dx * rel_dx + dy * rel_dy + dz * rel_dz) / distance;
-            it->second.doppler_factor = sound_speed / (sound_speed - radial_velocity);
-            it->second.doppler_factor = std::max(0.5f, std::min(2.0f, it->second.doppler_factor)); // Clamp for stability
-        }
+    std::lock_guard<std::mutex> lock(params_mutex);
+    auto it = std::find_if(params.sources.begin(), params.sources.end(),
+                           [source_id](const AudioSource3D& s) { return s.id == source_id; });
+    if (it == params.sources.end()) {
+        return;
+    }
+    it->last_position = it->position;
+    it->position = {x, y, z};
+    
+    // Calculate Doppler effect
+    float dx = it->position.x - it->last_position.x;
+    float dy = it->position.y - it->last_position.y;
+    float dz = it->position.z - it->last_position.z;
+    
+    float sound_speed = 343.0f; // m/s
+    
+    // Calculate relative velocity towards listener
+    float rel_dx = params.listener_position.x - it->position.x;
+    float rel_dy = params.listener_position.y - it->position.y;
+    float rel_dz = params.listener_position.z - it->position.z;
+    float distance = std::sqrt(rel_dx*rel_dx + rel_dy*rel_dy + rel_dz*rel_dz);
+    
+    if (distance > 0.001f) {
+        float radial_velocity = (dx * rel_dx + dy * rel_dy + dz * rel_dz) / distance;
+        it->doppler_factor = sound_speed / (sound_speed - radial_velocity);
+        it->doppler_factor = std::max(0.5f, std::min(2.0f, it->doppler_factor)); // Clamp for stability
     }
+    publish_params();
 }
 
 void Audio::remove_audio_source(int source_id) {
-    auto it = audio_sources_.find(source_id);
-    if (it != audio_sources_.end()) {
-        it->second.active = false;
-        audio_sources_.erase(it);
-    }
+    std::lock_guard<std::mutex> lock(params_mutex);
+    params.sources.erase(std::remove_if(params.sources.begin(), params.sources.end(),
+                                        [source_id](const AudioSource3D& s) { return s.id == source_id; }),
+                         params.sources.end());
+    publish_params();
 }
 
 size_t Audio::get_queued_frames() const {
-    std::lock_guard<std::mutex> lock(buffer_mutex);
-    size_t total_frames = 0;
-    for (const auto& buffer : buffer_queue) {
-        total_frames += buffer.frames;
-    }
-    return total_frames;
+    return ring ? ring->read_available() : 0;
 }
 
-void Audio::apply_room_reverb(float* samples, size_t frame_count) {
-    // Real room reverb simulation with multiple delay lines
-    // TODO: Implement room reverb
-    static std::vector<float> delay_line1(4800, 0.0f); // 100ms
-    static std::vector<float> delay_line2(7200, 0.0f); // 150ms  
-    static std::vector<float> delay_line3(9600, 0.0f); // 200ms
-    static size_t delay_pos1 = 0, delay_pos2 = 0, delay_pos3 = 0;
-    
-    for (size_t i = 0; i < frame_count * current_format.channels; ++i) {
-        float input = samples[i];
-        
-        float delayed1 = delay_line1[delay_pos1];
-        float delayed2 = delay_line2[delay_pos2];
-        float delayed3 = delay_line3[delay_pos3];
-        
-        delay_line1[delay_pos1] = input + delayed1 * 0.3f;
-        delay_line2[delay_pos2] = input + delayed2 * 0.25f;
-        delay_line3[delay_pos3] = input + delayed3 * 0.2f;
-        
-        samples[i] += (delayed1 + delayed2 + delayed3) * apu_state.reverb_depth * 0.33f;
-        
-        delay_pos1 = (delay_pos1 + 1) % delay_line1.size();
-        delay_pos2 = (delay_pos2 + 1) % delay_line2.size();
-        delay_pos3 = (delay_pos3 + 1) % delay_line3.size();
+bool Audio::parse_backend(const std::string& name, AudioBackend& backend) {
+    if (name == "default") backend = AudioBackend::Default;
+    else if (name == "alsa") backend = AudioBackend::ALSA;
+    else if (name == "sdl2") backend = AudioBackend::SDL2;
+    else if (name == "null") backend = AudioBackend::Null;
+    else if (name == "null-fast") backend = AudioBackend::NullUnthrottled;
+    else return false;
+    return true;
+}
+
+bool Audio::parse_resample_quality(const std::string& name, AudioResampleQuality& quality) {
+    if (name == "sinc") quality = AudioResampleQuality::Sinc;
+    else if (name == "linear") quality = AudioResampleQuality::Linear;
+    else return false;
+    return true;
+}
+
+Audio::Stats Audio::get_stats() const {
+    Stats stats{};
+    stats.dropped_frames = dropped_frames.load(std::memory_order_relaxed);
+    stats.underruns = underruns.load(std::memory_order_relaxed);
+    stats.stretch = stretch_ratio.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(device_mutex);
+    if (running && ring && device) {
+        const double rate = current_format.sample_rate;
+        stats.latency_ms = 1000.0 * (ring->read_available() / rate + device->get_latency());
+        stats.target_ms = 1000.0 * latency_target_frames.load(std::memory_order_relaxed) / rate;
     }
+    return stats;
 }
 
-private:
-    struct Vector3 {
-        float x, y, z;
-    };
-    
-    struct AudioSource3D {
-        Vector3 position;
-        Vector3 last_position;
-        float volume;
-        float doppler_factor;
-        bool active;
-    };
-    
-    Vector3 listener_position_{0, 0, 0};
-    Vector3 listener_forward_{0, 0, -1};
-    Vector3 listener_up_{0, 1, 0};
-    Vector3 listener_right_{1, 0, 0};
-    std::unordered_map<int, AudioSource3D> audio_sources_;
+int Audio::get_output_sample_rate() const {
+    return running ? output_rate : 0;
+}
+
+double Audio::get_output_latency() const {
+    std::lock_guard<std::mutex> lock(device_mutex);
+    return running && device ? device->get_latency() : 0.0;
+}
@@ -1,27 +1,42 @@
 #pragma once
 
 #include <vector>
+#include <functional>
 #include <memory>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <mutex>
+#include <string>
+#include "audio_ring.h"
+#include "audio_dsp.h"
+#include "audio_latency.h"
+#include "audio_resampler.h"
 
 struct AudioFormat {
-    int sample_rate;
+    int sample_rate;         // of the pushed samples
     int channels;
     int bits_per_sample;
     bool is_float;
+    int period_frames = 0;   // device period ("Buffer Size" setting), 0 = backend default
+    int output_sample_rate = 0;   // rate to open the device at, 0 = sample_rate
+    AudioResampleQuality resample_quality = AudioResampleQuality::Sinc;
+    // Bounds for the adaptive ring latency of pull-model devices
+    int latency_min_ms = 20;
+    int latency_max_ms = 150;
 };
 
-struct AudioBuffer {
-    std::vector<float> data;
-    size_t frames;
-    int channels;
-    double timestamp;
-    bool is_ready;
+enum class AudioBackend {
+    Default,           // the platform's native device
+    ALSA,
+    SDL2,
+    Null,              // no output, paced like real hardware
+    NullUnthrottled,   // no output, consumes as fast as samples arrive
 };
 
+// Fills `frames` interleaved frames of output, called from the device's
+// own thread or driver callback
+using AudioRenderCallback = std::function<void(float* output, size_t frames)>;
+
 class AudioDevice {
 public:
     virtual ~AudioDevice() = default;
@@ -30,49 +45,80 @@ public:
     virtual void stop() = 0;
     virtual void write_samples(const float* samples, size_t frame_count) = 0;
     virtual size_t get_buffer_size() const = 0;
+    // Seconds from rendering a frame to hearing it
     virtual double get_latency() const = 0;
+    // The rate the device settled on, 0 if it took the requested one
+    virtual int get_sample_rate() const { return 0; }
+    // Pull-model devices take the callback and ask for audio whenever the
+    // hardware has room; they never see write_samples(). Set before start().
+    virtual bool set_render_callback(AudioRenderCallback render) { (void)render; return false; }
 };
 
 class Audio {
 private:
+    // Set up and torn down under device_mutex, so the getters other threads
+    // poll never see a device mid-destruction
     std::unique_ptr<AudioDevice> device;
+    mutable std::mutex device_mutex;
     AudioFormat current_format;
-    std::vector<AudioBuffer> buffer_queue;
-    std::mutex buffer_mutex;
-    std::condition_variable buffer_cv;
+    // Raw samples pushed by the emulation thread. Pull-model devices drain
+    // it through render(); for the others audio_thread reads PERIOD_FRAMES
+    // blocks, runs them through `dsp` and writes them to the device.
+    // Frames that do not fit are dropped and counted.
+    static constexpr size_t RING_CAPACITY_FRAMES = 8192;
+    static constexpr size_t PERIOD_FRAMES = 256;
+    std::unique_ptr<AudioRingBuffer> ring;
+    std::atomic<uint64_t> dropped_frames{0};
     std::thread audio_thread;
     std::atomic<bool> running;
     
     struct APUState {
-        float master_volume;
         float channel_volumes[8];
         bool channel_muted[8];
-        int reverb_type;
-        float reverb_depth;
-        bool surround_enabled;
         int eq_bands[10];
     } apu_state;
     
-    struct EffectsChain {
-        bool compressor_enabled;
-        float compressor_threshold;
-        float compressor_ratio;
-        bool limiter_enabled;
-        float limiter_threshold;
-        std::vector<float> delay_buffer;
-        size_t delay_write_pos;
-    } effects;
+    // Effect and Tempest 3D parameters. Setters edit `params` under
+    // params_mutex and publish a copy; the DSP side never locks.
+    AudioDSPGraph dsp;
+    AudioDSPParams params;
+    std::mutex params_mutex;
+    std::vector<float> dsp_block;
+    
+    // Pushed samples are converted to the device rate on the way out of
+    // the ring, before the DSP chain, which runs at the device rate
+    AudioResampler resampler;
+    int output_rate = 0;
+    double base_ratio = 1.0;   // pushed rate / device rate
+    bool resampling = false;
+    std::vector<float> resample_input;
+    
+    // Pull-model devices run on their own clock, so `latency` paces the
+    // ring for them by stretching the resample ratio. Push-model devices
+    // block the audio thread on the ring instead and never underrun here.
+    AudioLatencyController latency;
+    bool pacing = false;
+    std::atomic<uint64_t> underruns{0};
+    std::atomic<size_t> latency_target_frames{0};
+    std::atomic<double> stretch_ratio{1.0};
     
     void audio_thread_func();
-    void process_audio_effects(float* samples, size_t frame_count);
-    void apply_3d_audio(float* samples, size_t frame_count);
-    void mix_channels(float* output, const float* input, size_t frame_count, int src_channels, int dst_channels);
+    // Fills `frames` device-rate frames from the ring, silence past its
+    // end; false if it ran out
+    bool read_ring(float* output, size_t frames);
+    // Device-rate frames left in the `available` pushed frames, for the
+    // short block played at shutdown
+    size_t drain_frames(size_t available) const;
+    void render(float* output, size_t frames);
+    void publish_params();
 
 public:
     Audio();
     ~Audio();
     
-    bool initialize(const AudioFormat& format);
+    bool initialize(const AudioFormat& format, AudioBackend backend = AudioBackend::Default);
+    // Takes a device built by the caller, e.g. a WavFileAudioDevice
+    bool initialize(const AudioFormat& format, std::unique_ptr<AudioDevice> output);
     void shutdown();
     void push_samples(const float* samples, int frame_count);
     void set_master_volume(float volume);
@@ -80,6 +126,8 @@ public:
     void mute_channel(int channel, bool muted);
     void enable_surround(bool enabled);
     void set_reverb(int type, float depth);
+    void set_compressor(bool enabled, float threshold_db, float ratio, float attack_ms, float release_ms);
+    void set_limiter(bool enabled, float threshold_db, float release_ms);
     void enable_3d_audio(bool enabled);
     
     void set_tempest_3d_params(float listener_x, float listener_y, float listener_z,
@@ -90,6 +138,26 @@ public:
     void remove_audio_source(int source_id);
     
     AudioFormat get_current_format() const { return current_format; }
+    // Rate the device actually runs at, 0 when not running
+    int get_output_sample_rate() const;
     bool is_running() const { return running.load(); }
     size_t get_queued_frames() const;
+    // Measured device latency in seconds, 0 when not running; any thread
+    double get_output_latency() const;
+    
+    // Parses "default", "alsa", "sdl2", "null" or "null-fast"
+    static bool parse_backend(const std::string& name, AudioBackend& backend);
+    // Parses "sinc" or "linear"
+    static bool parse_resample_quality(const std::string& name, AudioResampleQuality& quality);
+    uint64_t get_dropped_frames() const { return dropped_frames.load(std::memory_order_relaxed); }
+    
+    // Audio health, safe to poll from any thread
+    struct Stats {
+        uint64_t dropped_frames;   // pushed while the ring was full
+        uint64_t underruns;        // device blocks that ran out of pushed samples
+        double latency_ms;         // ring plus device: how late a pushed frame is heard
+        double target_ms;          // ring fill the pacing aims for, 0 without pacing
+        double stretch;            // playback rate correction, 1 = none
+    };
+    Stats get_stats() const;
 };
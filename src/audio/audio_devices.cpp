@@ -0,0 +1,164 @@
+#include "audio_devices.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr size_t DEFAULT_PERIOD_FRAMES = 256;
+constexpr size_t WAV_HEADER_BYTES = 44;
+constexpr uint16_t WAVE_FORMAT_PCM_TAG = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT_TAG = 3;
+
+void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put_u32(uint8_t* p, uint32_t v) {
+    put_u16(p, static_cast<uint16_t>(v));
+    put_u16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+} // namespace
+
+NullAudioDevice::NullAudioDevice(Pacing pacing) : pacing_(pacing) {}
+
+NullAudioDevice::~NullAudioDevice() {
+    stop();
+}
+
+bool NullAudioDevice::initialize(const AudioFormat& format) {
+    format_ = format;
+    period_frames_ = format.period_frames > 0 ? static_cast<size_t>(format.period_frames) : DEFAULT_PERIOD_FRAMES;
+    block_.assign(period_frames_ * format.channels, 0.0f);
+    return format.sample_rate > 0 && format.channels > 0;
+}
+
+bool NullAudioDevice::set_render_callback(AudioRenderCallback render) {
+    if (pacing_ == Pacing::Unthrottled) {
+        return false;
+    }
+    render_ = std::move(render);
+    return true;
+}
+
+void NullAudioDevice::start() {
+    if (pacing_ != Pacing::RealTime || !render_ || running_) return;
+    running_ = true;
+    clock_thread_ = std::thread(&NullAudioDevice::clock_loop, this);
+}
+
+void NullAudioDevice::stop() {
+    running_ = false;
+    if (clock_thread_.joinable()) {
+        clock_thread_.join();
+    }
+}
+
+// Deadlines advance by whole periods from the start, so a late wakeup is
+// caught up on rather than drifting the simulated clock
+void NullAudioDevice::clock_loop() {
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(period_frames_) / format_.sample_rate));
+    auto deadline = Clock::now();
+    while (running_) {
+        render_(block_.data(), period_frames_);
+        frames_consumed_.fetch_add(period_frames_, std::memory_order_relaxed);
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+void NullAudioDevice::write_samples(const float*, size_t frame_count) {
+    frames_consumed_.fetch_add(frame_count, std::memory_order_relaxed);
+}
+
+double NullAudioDevice::get_latency() const {
+    if (pacing_ == Pacing::Unthrottled || format_.sample_rate <= 0) return 0.0;
+    return static_cast<double>(period_frames_) / format_.sample_rate;
+}
+
+WavFileAudioDevice::WavFileAudioDevice(std::string path) : path_(std::move(path)) {}
+
+WavFileAudioDevice::~WavFileAudioDevice() {
+    stop();
+}
+
+bool WavFileAudioDevice::initialize(const AudioFormat& format) {
+    format_ = format;
+    if (format.channels <= 0 || format.sample_rate <= 0) {
+        return false;
+    }
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    pending_.reserve(WRITE_CHUNK_BYTES);
+    data_bytes_ = 0;
+    // Placeholder sizes until stop()
+    return write_header();
+}
+
+bool WavFileAudioDevice::write_header() {
+    const uint16_t bytes_per_sample = format_.is_float ? 4 : 2;
+    const uint16_t block_align = static_cast<uint16_t>(bytes_per_sample * format_.channels);
+    const uint32_t data_size = static_cast<uint32_t>(std::min<uint64_t>(data_bytes_, UINT32_MAX - WAV_HEADER_BYTES));
+
+    uint8_t header[WAV_HEADER_BYTES];
+    std::memcpy(header, "RIFF", 4);
+    put_u32(header + 4, static_cast<uint32_t>(WAV_HEADER_BYTES - 8 + data_size));
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, format_.is_float ? WAVE_FORMAT_IEEE_FLOAT_TAG : WAVE_FORMAT_PCM_TAG);
+    put_u16(header + 22, static_cast<uint16_t>(format_.channels));
+    put_u32(header + 24, static_cast<uint32_t>(format_.sample_rate));
+    put_u32(header + 28, static_cast<uint32_t>(format_.sample_rate) * block_align);
+    put_u16(header + 32, block_align);
+    put_u16(header + 34, static_cast<uint16_t>(bytes_per_sample * 8));
+    std::memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_size);
+    return std::fwrite(header, 1, sizeof(header), file_) == sizeof(header);
+}
+
+void WavFileAudioDevice::write_samples(const float* samples, size_t frame_count) {
+    if (!file_) return;
+
+    const size_t count = frame_count * format_.channels;
+    size_t offset = pending_.size();
+    if (format_.is_float) {
+        pending_.resize(offset + count * sizeof(float));
+        std::memcpy(pending_.data() + offset, samples, count * sizeof(float));
+    } else {
+        pending_.resize(offset + count * sizeof(int16_t));
+        for (size_t i = 0; i < count; i++) {
+            float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+            int16_t v = static_cast<int16_t>(s * 32767.0f);
+            put_u16(pending_.data() + offset + i * 2, static_cast<uint16_t>(v));
+        }
+    }
+    frames_written_.fetch_add(frame_count, std::memory_order_relaxed);
+
+    if (pending_.size() >= WRITE_CHUNK_BYTES) {
+        flush();
+    }
+}
+
+bool WavFileAudioDevice::flush() {
+    if (pending_.empty()) return true;
+    size_t written = std::fwrite(pending_.data(), 1, pending_.size(), file_);
+    data_bytes_ += written;
+    bool ok = written == pending_.size();
+    pending_.clear();
+    return ok;
+}
+
+void WavFileAudioDevice::stop() {
+    if (!file_) return;
+    flush();
+    std::fseek(file_, 0, SEEK_SET);
+    write_header();
+    std::fclose(file_);
+    file_ = nullptr;
+}
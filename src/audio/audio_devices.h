@@ -0,0 +1,79 @@
+#pragma once
+#include "audio.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Output without a sound card, for CI and benchmarks
+// RealTime pulls one period per period of wall time, like hardware would,
+// so the producer and the audio path see realistic timing. Unthrottled
+// declines the render callback: Audio's own thread then feeds it as fast as
+// samples arrive, which is what DSP throughput measurements want.
+class NullAudioDevice : public AudioDevice {
+public:
+    enum class Pacing { RealTime, Unthrottled };
+
+    explicit NullAudioDevice(Pacing pacing = Pacing::RealTime);
+    ~NullAudioDevice() override;
+
+    bool initialize(const AudioFormat& format) override;
+    void start() override;
+    void stop() override;
+    void write_samples(const float* samples, size_t frame_count) override;
+    size_t get_buffer_size() const override { return period_frames_; }
+    double get_latency() const override;
+    bool set_render_callback(AudioRenderCallback render) override;
+
+    uint64_t get_frames_consumed() const { return frames_consumed_.load(std::memory_order_relaxed); }
+
+private:
+    void clock_loop();
+
+    Pacing pacing_;
+    AudioFormat format_{};
+    size_t period_frames_ = 0;
+    AudioRenderCallback render_;
+    std::vector<float> block_;
+    std::thread clock_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> frames_consumed_{0};
+};
+
+// Streams the processed output to a WAV file: 32-bit float when the format
+// is float, 16-bit PCM otherwise. Push model, so the file holds exactly the
+// frames that were pushed, in DSP-block order, which makes it usable as a
+// golden reference. Writes are batched; the header sizes are filled in by
+// stop().
+class WavFileAudioDevice : public AudioDevice {
+public:
+    explicit WavFileAudioDevice(std::string path);
+    ~WavFileAudioDevice() override;
+
+    WavFileAudioDevice(const WavFileAudioDevice&) = delete;
+    WavFileAudioDevice& operator=(const WavFileAudioDevice&) = delete;
+
+    bool initialize(const AudioFormat& format) override;
+    void start() override {}
+    void stop() override;
+    void write_samples(const float* samples, size_t frame_count) override;
+    size_t get_buffer_size() const override { return 0; }
+    double get_latency() const override { return 0.0; }
+
+    uint64_t get_frames_written() const { return frames_written_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t WRITE_CHUNK_BYTES = 64 * 1024;
+
+    bool flush();
+    bool write_header();
+
+    std::string path_;
+    AudioFormat format_{};
+    FILE* file_ = nullptr;
+    std::vector<uint8_t> pending_;
+    uint64_t data_bytes_ = 0;
+    std::atomic<uint64_t> frames_written_{0};
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "audio_dynamics.h"
+#include "audio_reverb.h"
+#include "audio_voices.h"
+
+struct AudioVector3 {
+    float x, y, z;
+};
+
+struct AudioSource3D {
+    int id;
+    AudioVector3 position;
+    AudioVector3 last_position;
+    float volume;
+    float doppler_factor;
+};
+
+// Everything the DSP graph reads. The emulation side edits its own copy and
+// publishes it whole; a block always sees one consistent set.
+struct AudioDSPParams {
+    int sample_rate = 48000;
+    int channels = 2;
+
+    float master_volume = 1.0f;
+    bool compressor_enabled = false;
+    float compressor_threshold = -12.0f;   // dB
+    float compressor_ratio = 4.0f;
+    float compressor_attack_ms = 10.0f;
+    float compressor_release_ms = 100.0f;
+    bool limiter_enabled = true;
+    float limiter_threshold = -0.1f;       // dB
+    float limiter_release_ms = 50.0f;
+    int reverb_type = 0;
+    float reverb_depth = 0.0f;
+
+    bool surround_enabled = false;
+    AudioVector3 listener_position{0, 0, 0};
+    AudioVector3 listener_forward{0, 0, -1};
+    AudioVector3 listener_up{0, 1, 0};
+    AudioVector3 listener_right{1, 0, 0};
+    std::vector<AudioSource3D> sources;
+};
+
+// Lock-free parameter handoff between one writer and one reader
+// Three slots: the writer fills its back slot and swaps it into the middle;
+// the reader swaps the middle with its front slot only when the writer has
+// published since. Neither side ever waits, the reader never sees a slot
+// that is being written, and intermediate publishes are simply skipped.
+template <typename T>
+class AudioParamSnapshot {
+public:
+    // Writer: the slot to fill before publish(). It holds stale data.
+    T& edit() { return slots_[back_]; }
+    void publish() {
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: the newest published value, stable until the next acquire()
+    const T& acquire() {
+        if (middle_.load(std::memory_order_relaxed) & FRESH) {
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return slots_[front_];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> slots_{};
+    uint8_t back_ = 0;
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t front_ = 2;
+};
+
+// One processing stage, run in place on interleaved float blocks
+class AudioDSPNode {
+public:
+    virtual ~AudioDSPNode() = default;
+    virtual void process(float* samples, size_t frames, const AudioDSPParams& params) = 0;
+};
+
+class AudioGainNode : public AudioDSPNode {
+public:
+    void process(float* samples, size_t frames, const AudioDSPParams& params) override;
+};
+
+class AudioCompressorNode : public AudioDSPNode {
+public:
+    void process(float* samples, size_t frames, const AudioDSPParams& params) override;
+private:
+    AudioDynamics dynamics_;
+};
+
+// Zero attack, infinite ratio: output never exceeds the threshold
+class AudioLimiterNode : public AudioDSPNode {
+public:
+    void process(float* samples, size_t frames, const AudioDSPParams& params) override;
+private:
+    AudioDynamics dynamics_;
+};
+
+// reverb_type picks the AudioReverb preset, reverb_depth is the wet level
+class AudioReverbNode : public AudioDSPNode {
+public:
+    void process(float* samples, size_t frames, const AudioDSPParams& params) override;
+private:
+    AudioReverb reverb_;
+    bool active_ = false;   // processed since the last reset
+};
+
+// Tempest 3D sources mixed on top of the block
+// Pan, elevation and distance gains and the interaural delay are worked out
+// once per source per block. Gains ramp linearly from the previous block's
+// values so moving sources do not zipper, and the ear facing away from the
+// source hears it through a fractional delay line that carries over between
+// blocks.
+class AudioSpatializerNode : public AudioDSPNode {
+public:
+    void process(float* samples, size_t frames, const AudioDSPParams& params) override;
+
+private:
+    static constexpr size_t MAX_ITD_FRAMES = 64;            // 0.6 ms fits up to 96 kHz
+    static constexpr size_t HISTORY = MAX_ITD_FRAMES + 1;   // + 1 for interpolation
+
+    // New sources fade in from silence over their first block
+    struct Voice {
+        float left_gain;    // reached at the end of the previous block
+        float right_gain;
+        std::array<float, HISTORY> history;   // last inputs, oldest first
+    };
+
+    AudioVoiceTable<Voice> voices_;
+    std::vector<float> input_;       // history followed by the block
+    std::vector<float> mix_left_;    // all sources, planar, added in at the end
+    std::vector<float> mix_right_;
+};
+
+// Block-based effects chain
+// Runs on the audio thread. Each block picks up the latest parameter
+// snapshot once and passes it through the nodes in the order they were
+// added, so a block never mixes two parameter sets and never takes a lock.
+class AudioDSPGraph {
+public:
+    void add_node(std::unique_ptr<AudioDSPNode> node) { nodes_.push_back(std::move(node)); }
+    AudioParamSnapshot<AudioDSPParams>& params() { return params_; }
+
+    void process(float* samples, size_t frames);
+
+private:
+    std::vector<std::unique_ptr<AudioDSPNode>> nodes_;
+    AudioParamSnapshot<AudioDSPParams> params_;
+};
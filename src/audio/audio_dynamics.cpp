@@ -0,0 +1,117 @@
+#include "audio_dynamics.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PSX5_AUDIO_SSE2 1
+#endif
+
+namespace {
+
+// One-pole smoothing coefficient for a time constant
+float time_coef(float ms, int sample_rate) {
+    if (ms <= 0.0f || sample_rate <= 0) return 0.0f;
+    return std::exp(-1.0f / (ms * 0.001f * sample_rate));
+}
+
+} // namespace
+
+void AudioDynamics::configure(float threshold_db, float ratio, float attack_ms, float release_ms, int sample_rate) {
+    if (threshold_db != threshold_db_) {
+        threshold_db_ = threshold_db;
+        threshold_ = std::pow(10.0f, threshold_db / 20.0f);
+    }
+    if (ratio != ratio_) {
+        ratio_ = ratio;
+        ratio_inv_ = ratio == RATIO_INFINITE ? 0.0f : 1.0f / std::max(ratio, 1.0f);
+    }
+    if (attack_ms != attack_ms_ || release_ms != release_ms_ || sample_rate != sample_rate_) {
+        attack_ms_ = attack_ms;
+        release_ms_ = release_ms;
+        sample_rate_ = sample_rate;
+        attack_coef_ = time_coef(attack_ms, sample_rate);
+        release_coef_ = time_coef(release_ms, sample_rate);
+    }
+}
+
+void AudioDynamics::follow_envelope(const float* samples, size_t frames, int channels) {
+    if (gains_.size() < frames) {
+        gains_.resize(frames);
+    }
+    float env = envelope_;
+    for (size_t i = 0; i < frames; ++i) {
+        float level = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            level = std::max(level, std::abs(samples[i * channels + c]));
+        }
+        float coef = level > env ? attack_coef_ : release_coef_;
+        env = level + coef * (env - level);
+        gains_[i] = env;
+    }
+    envelope_ = env;
+}
+
+void AudioDynamics::process_scalar(float* samples, size_t frames, int channels) {
+    follow_envelope(samples, frames, channels);
+    for (size_t i = 0; i < frames; ++i) {
+        float env = gains_[i];
+        float gain = 1.0f;
+        if (env > threshold_) {
+            gain = (threshold_ + (env - threshold_) * ratio_inv_) / env;
+        }
+        for (int c = 0; c < channels; ++c) {
+            samples[i * channels + c] *= gain;
+        }
+    }
+}
+
+void AudioDynamics::process(float* samples, size_t frames, int channels) {
+#ifdef PSX5_AUDIO_SSE2
+    if (channels != 1 && channels != 2) {
+        process_scalar(samples, frames, channels);
+        return;
+    }
+    follow_envelope(samples, frames, channels);
+
+    // gain = ratio_inv + threshold * (1 - ratio_inv) / env above the threshold
+    float* gains = gains_.data();
+    const __m128 threshold = _mm_set1_ps(threshold_);
+    const __m128 ratio_inv = _mm_set1_ps(ratio_inv_);
+    const __m128 knee = _mm_set1_ps(threshold_ * (1.0f - ratio_inv_));
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 env = _mm_loadu_ps(gains + i);
+        __m128 above = _mm_cmpgt_ps(env, threshold);
+        __m128 reduced = _mm_add_ps(ratio_inv, _mm_div_ps(knee, env));
+        _mm_storeu_ps(gains + i, _mm_or_ps(_mm_and_ps(above, reduced), _mm_andnot_ps(above, one)));
+    }
+    for (; i < frames; ++i) {
+        gains[i] = gains[i] > threshold_ ? ratio_inv_ + threshold_ * (1.0f - ratio_inv_) / gains[i] : 1.0f;
+    }
+
+    // Apply, 8 samples per iteration
+    size_t total = frames * channels;
+    size_t s = 0;
+    if (channels == 2) {
+        for (; s + 8 <= total; s += 8) {
+            __m128 g = _mm_loadu_ps(gains + s / 2);
+            __m128 lo = _mm_unpacklo_ps(g, g);   // g0 g0 g1 g1
+            __m128 hi = _mm_unpackhi_ps(g, g);   // g2 g2 g3 g3
+            _mm_storeu_ps(samples + s, _mm_mul_ps(_mm_loadu_ps(samples + s), lo));
+            _mm_storeu_ps(samples + s + 4, _mm_mul_ps(_mm_loadu_ps(samples + s + 4), hi));
+        }
+    } else {
+        for (; s + 8 <= total; s += 8) {
+            _mm_storeu_ps(samples + s, _mm_mul_ps(_mm_loadu_ps(samples + s), _mm_loadu_ps(gains + s)));
+            _mm_storeu_ps(samples + s + 4, _mm_mul_ps(_mm_loadu_ps(samples + s + 4), _mm_loadu_ps(gains + s + 4)));
+        }
+    }
+    for (; s < total; ++s) {
+        samples[s] *= gains[s / channels];
+    }
+#else
+    process_scalar(samples, frames, channels);
+#endif
+}
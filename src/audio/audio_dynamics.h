@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Feed-forward compressor/limiter
+// A linked peak detector (loudest channel of each frame) drives a one-pole
+// attack/release envelope; above the threshold the output level follows
+// threshold + (envelope - threshold) / ratio. An infinite ratio with zero
+// attack makes it a peak limiter that cannot overshoot the threshold.
+//
+// The envelope is inherently serial and runs per frame. Turning it into
+// gains and applying them to the interleaved samples is vectorized (SSE2,
+// 8 samples per iteration) for mono and stereo, scalar otherwise.
+class AudioDynamics {
+public:
+    static constexpr float RATIO_INFINITE = 0.0f;
+
+    // Cheap when nothing changed; the dB and time constant conversions only
+    // run when a value differs from the last call
+    void configure(float threshold_db, float ratio, float attack_ms, float release_ms, int sample_rate);
+    void reset() { envelope_ = 0.0f; }
+
+    void process(float* samples, size_t frames, int channels);
+    // Plain per-sample version of process(), kept as the reference
+    void process_scalar(float* samples, size_t frames, int channels);
+
+    float envelope() const { return envelope_; }
+    float threshold() const { return threshold_; }
+
+private:
+    void follow_envelope(const float* samples, size_t frames, int channels);
+
+    // Last configure() arguments; NaN never compares equal, so the first
+    // call always derives everything
+    static constexpr float UNSET = std::numeric_limits<float>::quiet_NaN();
+    float threshold_db_ = UNSET;
+    float ratio_ = UNSET;
+    float attack_ms_ = UNSET;
+    float release_ms_ = UNSET;
+    int sample_rate_ = 0;
+
+    // Derived coefficients
+    float threshold_ = 1.0f;
+    float ratio_inv_ = 1.0f;
+    float attack_coef_ = 0.0f;
+    float release_coef_ = 0.0f;
+
+    float envelope_ = 0.0f;
+    std::vector<float> gains_;   // per frame, reused across blocks
+};
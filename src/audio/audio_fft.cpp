@@ -0,0 +1,129 @@
+#include "audio_fft.h"
+#include <cmath>
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 4;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+AudioFFT::AudioFFT(size_t size) : size_(round_up_pow2(size)), half_(size_ / 2) {
+    const double pi = 3.14159265358979323846;
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < half_) ++bits;
+    bit_reverse_.resize(half_);
+    for (size_t i = 0; i < half_; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & (size_t(1) << b)) r |= size_t(1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = r;
+    }
+
+    twiddles_.resize(half_ / 2);
+    for (size_t k = 0; k < half_ / 2; ++k) {
+        double angle = -2.0 * pi * k / half_;
+        twiddles_[k] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+    }
+    split_twiddles_.resize(half_ + 1);
+    for (size_t k = 0; k <= half_; ++k) {
+        double angle = -2.0 * pi * k / size_;
+        split_twiddles_[k] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+    }
+    work_.resize(half_);
+}
+
+// In-place iterative radix-2; the inverse conjugates the twiddles and
+// leaves the 1/n scale to the caller. Products are written out by hand:
+// std::complex multiplication goes through the NaN-checking libcall.
+void AudioFFT::transform(std::complex<float>* data, bool inverse) const {
+    for (size_t i = 0; i < half_; ++i) {
+        size_t r = bit_reverse_[i];
+        if (r > i) std::swap(data[i], data[r]);
+    }
+    float* d = reinterpret_cast<float*>(data);
+    const float sign = inverse ? -1.0f : 1.0f;
+    // First two stages fused: twiddles are 1 and -i (+i inverse)
+    size_t first_span = half_ >= 4 ? 4 : 1;
+    for (size_t start = 0; first_span == 4 && start < half_; start += 4) {
+        float* x = d + 2 * start;
+        float s0r = x[0] + x[2], s0i = x[1] + x[3];
+        float d0r = x[0] - x[2], d0i = x[1] - x[3];
+        float s1r = x[4] + x[6], s1i = x[5] + x[7];
+        float d1r = x[4] - x[6], d1i = x[5] - x[7];
+        // d1 * -i = (d1i, -d1r)
+        float tr = d1i * sign, ti = -d1r * sign;
+        x[0] = s0r + s1r; x[1] = s0i + s1i;
+        x[4] = s0r - s1r; x[5] = s0i - s1i;
+        x[2] = d0r + tr;  x[3] = d0i + ti;
+        x[6] = d0r - tr;  x[7] = d0i - ti;
+    }
+    for (size_t span = first_span; span < half_; span <<= 1) {
+        size_t stride = half_ / (span * 2);
+        for (size_t start = 0; start < half_; start += span * 2) {
+            for (size_t j = 0; j < span; ++j) {
+                float wr = twiddles_[j * stride].real();
+                float wi = twiddles_[j * stride].imag() * sign;
+                float* a = d + 2 * (start + j);
+                float* b = d + 2 * (start + j + span);
+                float br = b[0] * wr - b[1] * wi;
+                float bi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+            }
+        }
+    }
+}
+
+void AudioFFT::forward(const float* input, float* re, float* im) {
+    std::complex<float>* z = work_.data();
+    for (size_t n = 0; n < half_; ++n) {
+        z[n] = {input[2 * n], input[2 * n + 1]};
+    }
+    transform(z, false);
+
+    // X[k] = E[k] + W^k O[k], with E and O recovered from Z[k] and Z[M-k]*
+    for (size_t k = 0; k <= half_; ++k) {
+        std::complex<float> zk = z[k % half_];
+        std::complex<float> zm = z[(half_ - k) % half_];
+        float even_re = 0.5f * (zk.real() + zm.real());
+        float even_im = 0.5f * (zk.imag() - zm.imag());
+        float odd_re = 0.5f * (zk.imag() + zm.imag());
+        float odd_im = -0.5f * (zk.real() - zm.real());
+        float wr = split_twiddles_[k].real();
+        float wi = split_twiddles_[k].imag();
+        re[k] = even_re + wr * odd_re - wi * odd_im;
+        im[k] = even_im + wr * odd_im + wi * odd_re;
+    }
+}
+
+void AudioFFT::inverse(const float* re, const float* im, float* output) {
+    std::complex<float>* z = work_.data();
+    for (size_t k = 0; k < half_; ++k) {
+        float even_re = 0.5f * (re[k] + re[half_ - k]);
+        float even_im = 0.5f * (im[k] - im[half_ - k]);
+        float diff_re = 0.5f * (re[k] - re[half_ - k]);
+        float diff_im = 0.5f * (im[k] + im[half_ - k]);
+        // odd = diff * conj(W^k)
+        float wr = split_twiddles_[k].real();
+        float wi = split_twiddles_[k].imag();
+        float odd_re = diff_re * wr + diff_im * wi;
+        float odd_im = diff_im * wr - diff_re * wi;
+        // Z = even + i * odd
+        z[k] = {even_re - odd_im, even_im + odd_re};
+    }
+    transform(z, true);
+
+    const float scale = 1.0f / static_cast<float>(half_);
+    for (size_t n = 0; n < half_; ++n) {
+        output[2 * n] = z[n].real() * scale;
+        output[2 * n + 1] = z[n].imag() * scale;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Real FFT of a fixed power-of-two size (rounded up, at least 4)
+// A size-N real transform runs as an N/2 complex radix-2 FFT on the even
+// and odd samples packed together, then splits the result. Spectra are kept
+// split into real and imaginary arrays of N/2 + 1 bins so the complex
+// multiply-accumulates that use them vectorize. Unnormalized forward,
+// inverse scaled so inverse(forward(x)) == x.
+class AudioFFT {
+public:
+    explicit AudioFFT(size_t size);
+
+    size_t size() const { return size_; }
+    size_t bins() const { return size_ / 2 + 1; }
+
+    // `input` holds size() samples; `re`/`im` receive bins() values
+    void forward(const float* input, float* re, float* im);
+    // `re`/`im` hold bins() values; `output` receives size() samples
+    void inverse(const float* re, const float* im, float* output);
+
+private:
+    void transform(std::complex<float>* data, bool inverse) const;
+
+    size_t size_;
+    size_t half_;
+    std::vector<size_t> bit_reverse_;
+    std::vector<std::complex<float>> twiddles_;        // half_-point FFT, forward
+    std::vector<std::complex<float>> split_twiddles_;  // W_N^k for the real split
+    std::vector<std::complex<float>> work_;
+};
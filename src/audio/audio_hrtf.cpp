@@ -0,0 +1,358 @@
+#include "audio_hrtf.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr float PI = 3.14159265358979323846f;
+
+// PSX5HRIR file layout, little-endian:
+//   char[8] magic "PSX5HRIR", u32 version (1), u32 sample_rate, u32 length,
+//   u32 azimuth_count, u32 elevation_count, f32 elevation_min,
+//   f32 elevation_step (degrees), then per elevation, per azimuth, the left
+//   and the right response as `length` f32 each
+constexpr char HRIR_MAGIC[8] = {'P', 'S', 'X', '5', 'H', 'R', 'I', 'R'};
+constexpr uint32_t HRIR_VERSION = 1;
+
+// Spherical head model
+constexpr float HEAD_RADIUS = 0.0875f;   // metres
+constexpr float SOUND_SPEED = 343.0f;    // m/s
+constexpr float ALPHA_MIN = 0.1f;        // shadow shelf depth
+constexpr float THETA_MIN = 150.0f * PI / 180.0f;
+constexpr size_t MODEL_LENGTH = 256;
+constexpr size_t MODEL_AZIMUTHS = 36;    // 10 degrees
+constexpr size_t MODEL_ELEVATIONS = 7;   // -40 to 80 in 20 degree steps
+constexpr float MODEL_ELEVATION_MIN = -40.0f;
+constexpr float MODEL_ELEVATION_STEP = 20.0f;
+constexpr int SINC_HALF = 8;             // taps either side of a fractional impulse
+
+// Adds a band-limited impulse of `gain` at fractional position `at`
+void add_impulse(float* ir, size_t length, float at, float gain) {
+    int centre = static_cast<int>(std::floor(at));
+    for (int n = centre - SINC_HALF + 1; n <= centre + SINC_HALF; ++n) {
+        if (n < 0 || n >= static_cast<int>(length)) continue;
+        float t = static_cast<float>(n) - at;
+        float sinc = std::abs(t) < 1e-6f ? 1.0f : std::sin(PI * t) / (PI * t);
+        float window = 0.5f + 0.5f * std::cos(PI * t / SINC_HALF);
+        ir[n] += gain * sinc * window;
+    }
+}
+
+// One ear: `cos_theta` is the cosine of the angle between the ear axis and
+// the source
+void model_ear(float* ir, size_t length, float cos_theta, float elevation, int sample_rate) {
+    const float head_time = HEAD_RADIUS / SOUND_SPEED;
+    float theta = std::acos(std::max(-1.0f, std::min(1.0f, cos_theta)));
+
+    // Path difference to the ear, around the sphere once the ear is shadowed;
+    // offset so the nearest possible source arrives at time zero
+    float delay = theta < PI * 0.5f ? -head_time * cos_theta : head_time * (theta - PI * 0.5f);
+    float arrival = (delay + head_time) * sample_rate + SINC_HALF;
+
+    std::fill(ir, ir + length, 0.0f);
+    add_impulse(ir, length, arrival, 1.0f);
+    // Pinna: a reflection that arrives later the lower the source
+    float pinna_ms = 0.1f + 0.2f * (1.0f - (elevation + PI * 0.5f) / PI);
+    add_impulse(ir, length, arrival + pinna_ms * 0.001f * sample_rate, 0.3f);
+
+    // Head shadow: (1 + a s/2w0) / (1 + s/2w0), bilinear transformed
+    float alpha = (1.0f + ALPHA_MIN * 0.5f) + (1.0f - ALPHA_MIN * 0.5f) * std::cos(theta / THETA_MIN * PI);
+    float k = sample_rate * head_time;   // fs / w0
+    float b0 = (1.0f + alpha * k) / (1.0f + k);
+    float b1 = (1.0f - alpha * k) / (1.0f + k);
+    float a1 = (1.0f - k) / (1.0f + k);
+    float x1 = 0.0f, y1 = 0.0f;
+    for (size_t n = 0; n < length; ++n) {
+        float x = ir[n];
+        float y = b0 * x + b1 * x1 - a1 * y1;
+        x1 = x;
+        y1 = y;
+        ir[n] = y;
+    }
+}
+
+template <typename T>
+bool read_pod(std::ifstream& file, T& value) {
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+void AudioHRIRSet::make_spherical_head(int sample_rate) {
+    sample_rate_ = sample_rate;
+    length_ = MODEL_LENGTH;
+    azimuth_count_ = MODEL_AZIMUTHS;
+    elevation_count_ = MODEL_ELEVATIONS;
+    elevation_min_ = MODEL_ELEVATION_MIN;
+    elevation_step_ = MODEL_ELEVATION_STEP;
+    data_.assign(elevation_count_ * azimuth_count_ * 2 * length_, 0.0f);
+
+    for (size_t e = 0; e < elevation_count_; ++e) {
+        float elevation = (elevation_min_ + e * elevation_step_) * PI / 180.0f;
+        for (size_t a = 0; a < azimuth_count_; ++a) {
+            float azimuth = a * azimuth_step() * PI / 180.0f;
+            // Interaural axis component; the right ear points along +x
+            float x = std::cos(elevation) * std::sin(azimuth);
+            model_ear(data_.data() + offset(e, a, 0), length_, -x, elevation, sample_rate);
+            model_ear(data_.data() + offset(e, a, 1), length_, x, elevation, sample_rate);
+        }
+    }
+}
+
+bool AudioHRIRSet::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[8];
+    uint32_t version, rate, length, azimuths, elevations;
+    float elevation_min, elevation_step;
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, HRIR_MAGIC, sizeof(magic)) != 0) return false;
+    if (!read_pod(file, version) || version != HRIR_VERSION) return false;
+    if (!read_pod(file, rate) || !read_pod(file, length) || !read_pod(file, azimuths) ||
+        !read_pod(file, elevations) || !read_pod(file, elevation_min) || !read_pod(file, elevation_step)) {
+        return false;
+    }
+    if (rate == 0 || length == 0 || length > 65536 || azimuths == 0 || azimuths > 3600 || elevations == 0 ||
+        elevations > 1800 || (elevations > 1 && !(elevation_step > 0.0f))) {
+        return false;
+    }
+
+    // The responses must all be in the file before anything is allocated
+    uint64_t count = static_cast<uint64_t>(elevations) * azimuths * 2 * length;
+    std::streamoff header_end = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff file_end = file.tellg();
+    if (header_end < 0 || file_end < header_end ||
+        count > static_cast<uint64_t>(file_end - header_end) / sizeof(float)) {
+        return false;
+    }
+    file.seekg(header_end);
+
+    std::vector<float> data(static_cast<size_t>(count));
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(float)));
+    if (!file) return false;
+
+    sample_rate_ = static_cast<int>(rate);
+    length_ = length;
+    azimuth_count_ = azimuths;
+    elevation_count_ = elevations;
+    elevation_min_ = elevation_min;
+    elevation_step_ = elevations > 1 ? elevation_step : 1.0f;
+    data_ = std::move(data);
+    return true;
+}
+
+AudioHRTFEngine::AudioHRTFEngine(const AudioHRIRSet& set, size_t block_frames)
+    : azimuth_count_(set.azimuth_count())
+    , elevation_count_(set.elevation_count())
+    , azimuth_step_(set.azimuth_step() * PI / 180.0f)
+    , elevation_min_(set.elevation_min() * PI / 180.0f)
+    , elevation_step_(set.elevation_step() * PI / 180.0f)
+    , fft_(2 * block_frames) {
+    // Overlap-save needs a 2B transform; AudioFFT rounds up, so B follows it
+    block_ = fft_.size() / 2;
+    bins_ = fft_.bins();
+    partitions_ = std::max<size_t>(1, (set.length() + block_ - 1) / block_);
+
+    const size_t directions = azimuth_count_ * elevation_count_;
+    const size_t per_ear = partitions_ * bins_;
+    grid_re_.assign(directions * 2 * per_ear, 0.0f);
+    grid_im_.assign(directions * 2 * per_ear, 0.0f);
+
+    // Each partition zero-padded to 2B, transformed once
+    std::vector<float> padded(fft_.size());
+    for (size_t e = 0; e < elevation_count_; ++e) {
+        for (size_t a = 0; a < azimuth_count_; ++a) {
+            size_t direction = e * azimuth_count_ + a;
+            for (int side = 0; side < 2; ++side) {
+                const float* ir = side == 0 ? set.left(e, a) : set.right(e, a);
+                for (size_t p = 0; p < partitions_; ++p) {
+                    std::fill(padded.begin(), padded.end(), 0.0f);
+                    size_t begin = p * block_;
+                    size_t count = std::min(block_, set.length() - std::min(begin, set.length()));
+                    std::copy(ir + begin, ir + begin + count, padded.begin());
+                    size_t offset = (direction * 2 + side) * per_ear + p * bins_;
+                    fft_.forward(padded.data(), grid_re_.data() + offset, grid_im_.data() + offset);
+                }
+            }
+        }
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        acc_re_[side].assign(bins_, 0.0f);
+        acc_im_[side].assign(bins_, 0.0f);
+        fade_re_[side].assign(bins_, 0.0f);
+        fade_im_[side].assign(bins_, 0.0f);
+    }
+    time_.assign(fft_.size(), 0.0f);
+}
+
+void AudioHRTFEngine::reset() {
+    voices_.clear();
+}
+
+// New sources fade in from silence over their first block
+AudioHRTFEngine::Voice AudioHRTFEngine::new_voice() const {
+    Voice voice{};
+    voice.history.assign(block_, 0.0f);
+    voice.fdl_re.assign(partitions_ * bins_, 0.0f);
+    voice.fdl_im.assign(partitions_ * bins_, 0.0f);
+    voice.filter_re.assign(2 * partitions_ * bins_, 0.0f);
+    voice.filter_im.assign(2 * partitions_ * bins_, 0.0f);
+    voice.previous_re.assign(2 * partitions_ * bins_, 0.0f);
+    voice.previous_im.assign(2 * partitions_ * bins_, 0.0f);
+    return voice;
+}
+
+// Four surrounding grid directions and their bilinear weights; elevations
+// past the grid clamp to its edge, azimuths wrap
+void AudioHRTFEngine::locate(float azimuth, float elevation, size_t corners[4], float weights[4]) const {
+    float a = azimuth / azimuth_step_;
+    a -= std::floor(a / azimuth_count_) * azimuth_count_;
+    size_t a0 = static_cast<size_t>(a) % azimuth_count_;
+    size_t a1 = (a0 + 1) % azimuth_count_;
+    float fa = a - std::floor(a);
+
+    float e = (elevation - elevation_min_) / elevation_step_;
+    e = std::max(0.0f, std::min(e, static_cast<float>(elevation_count_ - 1)));
+    size_t e0 = std::min(static_cast<size_t>(e), elevation_count_ - 1);
+    size_t e1 = std::min(e0 + 1, elevation_count_ - 1);
+    float fe = e - static_cast<float>(e0);
+
+    corners[0] = e0 * azimuth_count_ + a0;
+    corners[1] = e0 * azimuth_count_ + a1;
+    corners[2] = e1 * azimuth_count_ + a0;
+    corners[3] = e1 * azimuth_count_ + a1;
+    weights[0] = (1.0f - fe) * (1.0f - fa);
+    weights[1] = (1.0f - fe) * fa;
+    weights[2] = fe * (1.0f - fa);
+    weights[3] = fe * fa;
+}
+
+// Spectra are linear in the response, so weighting the grid spectra is the
+// same as interpolating the impulse responses
+bool AudioHRTFEngine::update_filter(Voice& voice, const size_t corners[4], const float weights[4]) {
+    bool fade = voice.filter_valid;
+    if (voice.filter_valid) {
+        bool same = true;
+        for (int c = 0; c < 4; ++c) {
+            same = same && voice.corners[c] == corners[c] && std::abs(voice.weights[c] - weights[c]) < 1e-4f;
+        }
+        if (same) return false;
+        voice.filter_re.swap(voice.previous_re);
+        voice.filter_im.swap(voice.previous_im);
+    }
+    const size_t per_voice = 2 * partitions_ * bins_;
+    float* re = voice.filter_re.data();
+    float* im = voice.filter_im.data();
+    std::fill(re, re + per_voice, 0.0f);
+    std::fill(im, im + per_voice, 0.0f);
+    for (int c = 0; c < 4; ++c) {
+        float w = weights[c];
+        voice.corners[c] = corners[c];
+        voice.weights[c] = w;
+        if (w == 0.0f) continue;
+        const float* grid_re = grid_re_.data() + corners[c] * per_voice;
+        const float* grid_im = grid_im_.data() + corners[c] * per_voice;
+        for (size_t i = 0; i < per_voice; ++i) {
+            re[i] += w * grid_re[i];
+            im[i] += w * grid_im[i];
+        }
+    }
+    voice.filter_valid = true;
+    return fade;
+}
+
+void AudioHRTFEngine::process(const std::vector<AudioHRTFSource>& sources, float* left, float* right) {
+    for (int side = 0; side < 2; ++side) {
+        std::fill(acc_re_[side].begin(), acc_re_[side].end(), 0.0f);
+        std::fill(acc_im_[side].begin(), acc_im_[side].end(), 0.0f);
+    }
+    bool fading = false;
+    voices_.begin_block();
+
+    const size_t per_ear = partitions_ * bins_;
+    for (size_t index = 0; index < sources.size(); ++index) {
+        const AudioHRTFSource& source = sources[index];
+        Voice& voice = voices_.get(index, source.id, [this] { return new_voice(); });
+
+        // Overlap-save input: last block, then this one with the gain ramped
+        std::copy(voice.history.begin(), voice.history.end(), time_.begin());
+        float* current = time_.data() + block_;
+        float step = (source.gain - voice.gain) / block_;
+        for (int i = 0; i < static_cast<int>(block_); ++i) {
+            current[i] = source.input[i] * (voice.gain + step * static_cast<float>(i + 1));
+        }
+        voice.gain = source.gain;
+        std::copy(current, current + block_, voice.history.begin());
+
+        float* x_re = voice.fdl_re.data() + voice.fdl_pos * bins_;
+        float* x_im = voice.fdl_im.data() + voice.fdl_pos * bins_;
+        fft_.forward(time_.data(), x_re, x_im);
+
+        size_t corners[4];
+        float weights[4];
+        locate(source.azimuth, source.elevation, corners, weights);
+        bool fade = update_filter(voice, corners, weights);
+        if (fade && !fading) {
+            fading = true;
+            for (int side = 0; side < 2; ++side) {
+                std::fill(fade_re_[side].begin(), fade_re_[side].end(), 0.0f);
+                std::fill(fade_im_[side].begin(), fade_im_[side].end(), 0.0f);
+            }
+        }
+
+        // Y += X[now - p] * H[p] for each partition p, and for a moved
+        // source D += X[now - p] * (H_old[p] - H[p])
+        for (int side = 0; side < 2; ++side) {
+            float* y_re = acc_re_[side].data();
+            float* y_im = acc_im_[side].data();
+            float* d_re = fade_re_[side].data();
+            float* d_im = fade_im_[side].data();
+            for (size_t p = 0; p < partitions_; ++p) {
+                size_t slot = (voice.fdl_pos + partitions_ - p) % partitions_;
+                const float* xr = voice.fdl_re.data() + slot * bins_;
+                const float* xi = voice.fdl_im.data() + slot * bins_;
+                const float* hr = voice.filter_re.data() + side * per_ear + p * bins_;
+                const float* hi = voice.filter_im.data() + side * per_ear + p * bins_;
+                for (size_t k = 0; k < bins_; ++k) {
+                    y_re[k] += xr[k] * hr[k] - xi[k] * hi[k];
+                    y_im[k] += xr[k] * hi[k] + xi[k] * hr[k];
+                }
+                if (!fade) continue;
+                const float* old_r = voice.previous_re.data() + side * per_ear + p * bins_;
+                const float* old_i = voice.previous_im.data() + side * per_ear + p * bins_;
+                for (size_t k = 0; k < bins_; ++k) {
+                    float dr = old_r[k] - hr[k];
+                    float di = old_i[k] - hi[k];
+                    d_re[k] += xr[k] * dr - xi[k] * di;
+                    d_im[k] += xr[k] * di + xi[k] * dr;
+                }
+            }
+        }
+        voice.fdl_pos = (voice.fdl_pos + 1) % partitions_;
+    }
+
+    voices_.end_block();
+
+    // The second half of each inverse transform is the valid output. Moved
+    // sources start on their old filter and end on the new one:
+    // out = new + (1 - ramp) * (old - new)
+    float* outputs[2] = {left, right};
+    for (int side = 0; side < 2; ++side) {
+        fft_.inverse(acc_re_[side].data(), acc_im_[side].data(), time_.data());
+        std::copy(time_.begin() + block_, time_.end(), outputs[side]);
+        if (!fading) continue;
+        fft_.inverse(fade_re_[side].data(), fade_im_[side].data(), time_.data());
+        const float* difference = time_.data() + block_;
+        for (size_t i = 0; i < block_; ++i) {
+            float old_weight = 1.0f - static_cast<float>(i + 1) / block_;
+            outputs[side][i] += old_weight * difference[i];
+        }
+    }
+}
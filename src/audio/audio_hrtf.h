@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "audio_fft.h"
+#include "audio_voices.h"
+
+// Head-related impulse responses on an azimuth x elevation grid
+// Azimuths cover the full circle in equal steps from straight ahead,
+// positive to the right; elevations run upwards from elevation_min().
+// Angles are in degrees here and in radians in AudioHRTFSource.
+class AudioHRIRSet {
+public:
+    // Brown-Duda spherical head: interaural delay, a head-shadow shelf per
+    // ear and one elevation-dependent pinna reflection. Used when no
+    // measured set is loaded.
+    void make_spherical_head(int sample_rate);
+    // "PSX5HRIR" file, layout in audio_hrtf.cpp
+    bool load(const std::string& path);
+
+    bool empty() const { return data_.empty(); }
+    int sample_rate() const { return sample_rate_; }
+    size_t length() const { return length_; }
+    size_t azimuth_count() const { return azimuth_count_; }
+    size_t elevation_count() const { return elevation_count_; }
+    float azimuth_step() const { return 360.0f / azimuth_count_; }
+    float elevation_min() const { return elevation_min_; }
+    float elevation_step() const { return elevation_step_; }
+
+    const float* left(size_t elevation, size_t azimuth) const { return ear(elevation, azimuth, 0); }
+    const float* right(size_t elevation, size_t azimuth) const { return ear(elevation, azimuth, 1); }
+
+private:
+    size_t offset(size_t elevation, size_t azimuth, int side) const {
+        return ((elevation * azimuth_count_ + azimuth) * 2 + side) * length_;
+    }
+    const float* ear(size_t elevation, size_t azimuth, int side) const {
+        return data_.data() + offset(elevation, azimuth, side);
+    }
+
+    int sample_rate_ = 0;
+    size_t length_ = 0;
+    size_t azimuth_count_ = 0;
+    size_t elevation_count_ = 0;
+    float elevation_min_ = 0.0f;
+    float elevation_step_ = 0.0f;
+    std::vector<float> data_;   // [elevation][azimuth][ear][length]
+};
+
+struct AudioHRTFSource {
+    int id;
+    float azimuth;        // radians, 0 ahead, positive to the right
+    float elevation;      // radians, positive up
+    float gain;
+    const float* input;   // block_frames() mono samples
+};
+
+// Binaural rendering by uniformly partitioned overlap-save convolution
+// Each grid HRIR is cut into block-sized partitions and transformed once
+// at construction. Per source per block: the gain ramps across the block,
+// the block is transformed once into that source's frequency-domain delay
+// line, and its HRIR pair is interpolated bilinearly between the four
+// nearest grid directions (skipped when the direction has not moved).
+// Every source's products accumulate into one spectrum per ear, so the
+// inverse transforms cost two per block however many sources play. A
+// block in which a source moved is rendered with both its old and its new
+// pair and crossfaded across the block, like the gain; the difference
+// accumulates into a second spectrum per ear, transformed only then.
+class AudioHRTFEngine {
+public:
+    AudioHRTFEngine(const AudioHRIRSet& set, size_t block_frames);
+
+    size_t block_frames() const { return block_; }
+
+    // Overwrites `left` and `right` (block_frames() each) with the mix.
+    // Sources are matched to their state by id; ids missing from a call
+    // are dropped.
+    void process(const std::vector<AudioHRTFSource>& sources, float* left, float* right);
+    void reset();
+
+private:
+    struct Voice {
+        float gain;
+        bool filter_valid;
+        size_t corners[4];           // grid directions
+        float weights[4];
+        std::vector<float> history;  // previous input block
+        std::vector<float> fdl_re;   // [partition][bin], ring of input spectra
+        std::vector<float> fdl_im;
+        size_t fdl_pos;
+        std::vector<float> filter_re;   // [ear][partition][bin]
+        std::vector<float> filter_im;
+        std::vector<float> previous_re; // filter before the last update
+        std::vector<float> previous_im;
+    };
+
+    Voice new_voice() const;
+    void locate(float azimuth, float elevation, size_t corners[4], float weights[4]) const;
+    // True if the filter changed from a previous one, which the block then
+    // fades out of
+    bool update_filter(Voice& voice, const size_t corners[4], const float weights[4]);
+
+    size_t azimuth_count_;
+    size_t elevation_count_;
+    float azimuth_step_;      // radians
+    float elevation_min_;
+    float elevation_step_;
+    AudioFFT fft_;
+    size_t block_;            // half the transform
+    size_t partitions_;
+    size_t bins_;
+
+    std::vector<float> grid_re_;   // [direction][ear][partition][bin]
+    std::vector<float> grid_im_;
+    AudioVoiceTable<Voice> voices_;
+    std::vector<float> acc_re_[2];
+    std::vector<float> acc_im_[2];
+    std::vector<float> fade_re_[2];   // old minus new filter products
+    std::vector<float> fade_im_[2];
+    std::vector<float> time_;      // 2 * block_ samples
+};
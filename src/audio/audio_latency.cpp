@@ -0,0 +1,64 @@
+#include "audio_latency.h"
+#include <algorithm>
+
+namespace {
+
+constexpr double SMOOTHING_SECONDS = 0.5;   // fill averaging time constant
+constexpr double GAIN = 0.02;               // stretch per unit of relative fill error
+constexpr double SLEW_PER_SECOND = 0.005;   // fastest the stretch may move
+
+} // namespace
+
+void AudioLatencyController::configure(int sample_rate, int min_ms, int max_ms) {
+    rate_ = sample_rate;
+    min_ = std::max(1, min_ms) * rate_ / 1000.0;
+    max_ = std::max(min_, max_ms * rate_ / 1000.0);
+    reset();
+}
+
+void AudioLatencyController::reset() {
+    target_ = min_;
+    fill_ = 0.0;
+    stretch_ = 1.0;
+    clean_frames_ = 0.0;
+    low_water_ = 0.0;
+    buffering_ = true;
+    underruns_ = 0;
+}
+
+bool AudioLatencyController::update(size_t queued, size_t frames) {
+    const double q = static_cast<double>(queued);
+    if (buffering_) {
+        if (q < target_) return false;
+        buffering_ = false;
+        fill_ = q;
+        low_water_ = q;
+    }
+    low_water_ = std::min(low_water_, q);
+
+    const double seconds = frames / rate_;
+    fill_ += (q - fill_) * std::min(1.0, seconds / SMOOTHING_SECONDS);
+
+    double wanted = 1.0 + GAIN * (fill_ - target_) / target_;
+    wanted = std::max(1.0 - MAX_STRETCH, std::min(1.0 + MAX_STRETCH, wanted));
+    const double slew = SLEW_PER_SECOND * seconds;
+    stretch_ += std::max(-slew, std::min(slew, wanted - stretch_));
+
+    clean_frames_ += frames;
+    if (clean_frames_ >= RELAX_SECONDS * rate_) {
+        const double step = STEP_MS * rate_ / 1000.0;
+        if (low_water_ > step + frames) {
+            target_ = std::max(min_, target_ - step);
+        }
+        clean_frames_ = 0.0;
+        low_water_ = q;
+    }
+    return true;
+}
+
+void AudioLatencyController::underrun() {
+    ++underruns_;
+    target_ = std::min(max_, target_ + STEP_MS * rate_ / 1000.0);
+    clean_frames_ = 0.0;
+    buffering_ = true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Adaptive ring latency for pull-model devices
+// The emulator pushes audio in bursts (a frame's worth, then a sleep) while
+// the device drains it at its own steady clock. Once per output block the
+// controller looks at how much is queued and:
+//  - keeps a target fill between the configured bounds, raising it a step
+//    on every underrun and lowering it a step after a stretch of clean
+//    playback in which the ring never came within a step of empty, so it
+//    settles just above the worst burst gap instead of probing below it;
+//  - after an underrun, holds off playback until the ring is back at the
+//    target, so a starved stream gives one gap instead of a run of clicks;
+//  - otherwise returns a playback rate within MAX_STRETCH of 1 that drains
+//    the ring a little faster when it sits above the target and a little
+//    slower below it. The rate follows the smoothed fill proportionally
+//    and is slew-limited, so bursts do not wobble the pitch; at 0.5% the
+//    shift stays under the threshold of hearing.
+class AudioLatencyController {
+public:
+    static constexpr double MAX_STRETCH = 0.005;
+    static constexpr double STEP_MS = 10.0;          // target change per step
+    static constexpr double RELAX_SECONDS = 10.0;    // clean playback before stepping down
+
+    void configure(int sample_rate, int min_ms, int max_ms);
+    void reset();
+
+    // Once per output block of `frames`, with the frames queued before it
+    // is read. False while (re)buffering: play silence and leave the ring.
+    bool update(size_t queued, size_t frames);
+    // The block's read came up short
+    void underrun();
+
+    // Input frames per output frame, to multiply into the resample ratio
+    double stretch() const { return stretch_; }
+    size_t target_frames() const { return static_cast<size_t>(target_); }
+    uint64_t underruns() const { return underruns_; }
+
+private:
+    double rate_ = 48000.0;
+    double min_ = 0.0;          // target bounds, frames
+    double max_ = 0.0;
+    double target_ = 0.0;
+    double fill_ = 0.0;         // smoothed queue length
+    double stretch_ = 1.0;
+    double clean_frames_ = 0.0;
+    double low_water_ = 0.0;    // least queued since the last target change
+    bool buffering_ = true;
+    uint64_t underruns_ = 0;
+};
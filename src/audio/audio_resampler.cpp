@@ -0,0 +1,240 @@
+#include "audio_resampler.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PSX5_AUDIO_SSE2 1
+#endif
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr int BUCKETS_PER_UNIT = 16;   // ratio buckets between 1 and 2
+constexpr int MAX_BUCKET = static_cast<int>((AudioResampler::MAX_RATIO - 1.0) * BUCKETS_PER_UNIT);
+constexpr double PASSBAND = 0.9;       // cutoff as a fraction of the lower Nyquist
+constexpr double HYSTERESIS = 0.01;    // ratio slack before leaving a bucket
+constexpr size_t ROW = 2 * AudioResampler::TAPS;
+
+int bucket_for(double ratio) {
+    if (ratio <= 1.0) return 0;
+    return std::min(MAX_BUCKET, static_cast<int>(std::ceil((ratio - 1.0) * BUCKETS_PER_UNIT)));
+}
+
+// Blackman-windowed sinc at PHASES + 1 offsets, each normalized to unity
+// gain at DC, then stored as PHASES rows of (taps, slope to the next offset)
+std::vector<float> build_table(int bucket) {
+    const int taps = AudioResampler::TAPS;
+    const int half = AudioResampler::HALF_TAPS;
+    const int phases = AudioResampler::PHASES;
+    const double cutoff = PASSBAND / (1.0 + static_cast<double>(bucket) / BUCKETS_PER_UNIT);
+
+    std::vector<double> kernel((phases + 1) * taps);
+    for (int p = 0; p <= phases; ++p) {
+        double frac = static_cast<double>(p) / phases;
+        double sum = 0;
+        for (int j = 0; j < taps; ++j) {
+            double t = (j - half + 1) - frac;
+            double x = cutoff * t;
+            double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(PI * x) / (PI * x);
+            double w = t / half;
+            double window = std::abs(w) >= 1.0 ? 0.0 : 0.42 + 0.5 * std::cos(PI * w) + 0.08 * std::cos(2.0 * PI * w);
+            kernel[p * taps + j] = sinc * window;
+            sum += sinc * window;
+        }
+        for (int j = 0; j < taps; ++j) kernel[p * taps + j] /= sum;
+    }
+
+    std::vector<float> table(phases * ROW);
+    for (int p = 0; p < phases; ++p) {
+        for (int j = 0; j < taps; ++j) {
+            table[p * ROW + j] = static_cast<float>(kernel[p * taps + j]);
+            table[p * ROW + taps + j] = static_cast<float>(kernel[(p + 1) * taps + j] - kernel[p * taps + j]);
+        }
+    }
+    return table;
+}
+
+// Built once per bucket, never freed, so the pointers stay valid for good
+const float* shared_table(int bucket) {
+    static std::mutex mutex;
+    static std::array<std::unique_ptr<std::vector<float>>, MAX_BUCKET + 1> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& table = tables[bucket];
+    if (!table) table = std::make_unique<std::vector<float>>(build_table(bucket));
+    return table->data();
+}
+
+// Dot product of the interpolated taps with TAPS input frames
+inline float convolve(const float* row, float w, const float* x) {
+#ifdef PSX5_AUDIO_SSE2
+    const __m128 weight = _mm_set1_ps(w);
+    __m128 acc = _mm_setzero_ps();
+    for (int j = 0; j < AudioResampler::TAPS; j += 4) {
+        __m128 c = _mm_add_ps(_mm_loadu_ps(row + j),
+                              _mm_mul_ps(weight, _mm_loadu_ps(row + AudioResampler::TAPS + j)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(c, _mm_loadu_ps(x + j)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#else
+    float sum = 0.0f;
+    for (int j = 0; j < AudioResampler::TAPS; ++j) {
+        sum += (row[j] + w * row[AudioResampler::TAPS + j]) * x[j];
+    }
+    return sum;
+#endif
+}
+
+} // namespace
+
+void AudioResampler::configure(int channels, AudioResampleQuality quality) {
+    channels_ = std::max(1, channels);
+    quality_ = quality;
+    history_.assign(channels_, std::vector<float>());
+    bucket_ = -1;
+    set_ratio(ratio_);
+    reset();
+}
+
+void AudioResampler::set_ratio(double ratio) {
+    ratio_ = std::max(1.0 / MAX_RATIO, std::min(MAX_RATIO, ratio));
+    if (quality_ != AudioResampleQuality::Sinc) return;
+    int bucket = bucket_for(ratio_);
+    // A ratio nudged back and forth across a bucket edge (adaptive
+    // latency) keeps its table rather than flipping cutoffs every block;
+    // 1% stays inside the passband's guard band
+    if (bucket_ >= 0 && bucket_for(ratio_ / (1.0 + HYSTERESIS)) <= bucket_ &&
+        bucket_ <= bucket_for(ratio_ * (1.0 + HYSTERESIS))) {
+        return;
+    }
+    if (bucket != bucket_) {
+        bucket_ = bucket;
+        table_ = shared_table(bucket);
+    }
+}
+
+// Stream histories start as HALF_TAPS - 1 frames of silence, so the first
+// output frame sits on the first input frame
+void AudioResampler::reset() {
+    for (auto& history : history_) {
+        history.assign(HALF_TAPS - 1, 0.0f);
+    }
+    buffered_ = HALF_TAPS - 1;
+    position_ = HALF_TAPS - 1;
+}
+
+void AudioResampler::read(const float* input, double position, double step, float* output, size_t frames) const {
+    if (quality_ == AudioResampleQuality::Linear) {
+        for (size_t k = 0; k < frames; ++k) {
+            double p = position + static_cast<double>(k) * step;
+            double base = std::floor(p);
+            const float* x = input + static_cast<ptrdiff_t>(base);
+            float frac = static_cast<float>(p - base);
+            output[k] = x[0] + frac * (x[1] - x[0]);
+        }
+        return;
+    }
+    for (size_t k = 0; k < frames; ++k) {
+        double p = position + static_cast<double>(k) * step;
+        double base = std::floor(p);
+        double offset = (p - base) * PHASES;
+        int phase = std::min(PHASES - 1, static_cast<int>(offset));
+        const float* x = input + static_cast<ptrdiff_t>(base) - (HALF_TAPS - 1);
+        output[k] = convolve(table_ + phase * ROW, static_cast<float>(offset - phase), x);
+    }
+}
+
+size_t AudioResampler::input_frames_needed(size_t output_frames) const {
+    if (output_frames == 0) return 0;
+    double last = position_ + static_cast<double>(output_frames - 1) * ratio_;
+    size_t end = static_cast<size_t>(last) + HALF_TAPS + 1;
+    return end > buffered_ ? end - buffered_ : 0;
+}
+
+void AudioResampler::process(const float* input, float* output, size_t output_frames) {
+    size_t needed = input_frames_needed(output_frames);
+    size_t total = buffered_ + needed;
+    channel_out_.resize(output_frames);
+    for (int c = 0; c < channels_; ++c) {
+        std::vector<float>& history = history_[c];
+        if (history.size() < total) history.resize(total);
+        for (size_t i = 0; i < needed; ++i) {
+            history[buffered_ + i] = input[i * channels_ + c];
+        }
+        read(history.data(), position_, ratio_, channel_out_.data(), output_frames);
+        for (size_t i = 0; i < output_frames; ++i) {
+            output[i * channels_ + c] = channel_out_[i];
+        }
+    }
+    buffered_ = total;
+
+    // Keep HALF_TAPS - 1 frames before the next position
+    position_ += static_cast<double>(output_frames) * ratio_;
+    size_t drop = static_cast<size_t>(position_) - (HALF_TAPS - 1);
+    if (drop > 0) {
+        for (auto& history : history_) {
+            std::copy(history.begin() + drop, history.begin() + buffered_, history.begin());
+        }
+        buffered_ -= drop;
+        position_ -= static_cast<double>(drop);
+    }
+}
+
+AudioDoppler::AudioDoppler(int sample_rate, size_t block_frames, AudioResampleQuality quality)
+    : sample_rate_(sample_rate), block_(block_frames), quality_(quality), history_(2 * HISTORY_FRAMES, 0.0f) {}
+
+void AudioDoppler::push(const float* block) {
+    const size_t mask = HISTORY_FRAMES - 1;
+    for (size_t i = 0; i < block_; ++i) {
+        size_t at = (written_ + i) & mask;
+        history_[at] = block[i];
+        history_[at + HISTORY_FRAMES] = block[i];
+    }
+    written_ += block_;
+
+    voices_.end_block();
+    voices_.begin_block();
+}
+
+// New sources start at the travel time for where they are
+AudioDoppler::Voice AudioDoppler::new_voice(float distance) const {
+    const double speed_of_sound = 343.0;
+    Voice voice{};
+    voice.delay = std::max<double>(MIN_DELAY_FRAMES,
+                                   std::min<double>(MAX_DELAY_FRAMES, distance / speed_of_sound * sample_rate_));
+    voice.resampler.configure(1, quality_);
+    voice.output.assign(block_, 0.0f);
+    return voice;
+}
+
+const float* AudioDoppler::render(size_t index, int id, float distance, float ratio) {
+    Voice& voice = voices_.get(index, id, [this, distance] { return new_voice(distance); });
+
+    // Output frame k of the block was played at live frame
+    // written_ - block_ + k and is heard delay frames later
+    const double block = static_cast<double>(block_);
+    double end_delay = voice.delay + (1.0 - ratio) * block;
+    end_delay = std::max<double>(MIN_DELAY_FRAMES, std::min<double>(MAX_DELAY_FRAMES, end_delay));
+    double step = 1.0 - (end_delay - voice.delay) / block;
+    double start = static_cast<double>(written_) - block - voice.delay;
+    voice.delay = end_delay;
+
+    // The window the block reads, out of the mirrored history
+    int64_t first = static_cast<int64_t>(std::floor(start)) - (AudioResampler::HALF_TAPS - 1);
+    const float* window = history_.data() + (static_cast<uint64_t>(first) & (HISTORY_FRAMES - 1));
+    voice.resampler.set_ratio(step);
+    voice.resampler.read(window, start - static_cast<double>(first), step, voice.output.data(), block_);
+    return voice.output.data();
+}
+
+void AudioDoppler::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    written_ = 0;
+    voices_.clear();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "audio_voices.h"
+
+enum class AudioResampleQuality {
+    Linear,   // two taps, for hosts that cannot spare the sinc filter
+    Sinc,     // 16-tap windowed sinc
+};
+
+// Polyphase windowed-sinc sample-rate converter
+// The kernel spans HALF_TAPS input frames either side of the output
+// position. It is tabulated at PHASES fractional offsets, each row stored
+// with its slope to the next so the taps for any offset are one
+// multiply-add away. A table depends only on its cutoff, and ratios are
+// grouped into buckets: every ratio up to 1 (upsampling) shares the
+// full-band table, higher ratios use the table of the next bucket up.
+// Tables are built on first use and shared by every instance, so a source
+// whose Doppler ratio wanders only swaps a pointer now and then, and a
+// ratio that hovers at a bucket edge keeps the table it has.
+//
+// read() interpolates a mono buffer at arbitrary positions and keeps no
+// state, for callers that own their history. process() is a streaming
+// converter for interleaved blocks.
+class AudioResampler {
+public:
+    static constexpr int HALF_TAPS = 8;
+    static constexpr int TAPS = 2 * HALF_TAPS;
+    static constexpr int PHASES = 128;
+    static constexpr double MAX_RATIO = 4.0;
+
+    void configure(int channels, AudioResampleQuality quality);
+    // Input frames per output frame, i.e. input rate / output rate,
+    // clamped to [1 / MAX_RATIO, MAX_RATIO]
+    void set_ratio(double ratio);
+    double ratio() const { return ratio_; }
+    // Clears the stream history
+    void reset();
+
+    // `frames` values at input positions position, position + step, ...
+    // Position p reads input[floor(p) - HALF_TAPS + 1] through
+    // input[floor(p) + HALF_TAPS].
+    void read(const float* input, double position, double step, float* output, size_t frames) const;
+
+    // Input frames the next process() of `output_frames` frames takes
+    size_t input_frames_needed(size_t output_frames) const;
+    // Takes exactly input_frames_needed(output_frames) interleaved frames.
+    // The filter looks HALF_TAPS frames ahead, so the first call takes
+    // that many more than the ratio alone would.
+    void process(const float* input, float* output, size_t output_frames);
+
+private:
+    AudioResampleQuality quality_ = AudioResampleQuality::Sinc;
+    int channels_ = 1;
+    double ratio_ = 1.0;
+    int bucket_ = -1;
+    const float* table_ = nullptr;   // [PHASES][coefficients, slopes][TAPS]
+
+    std::vector<std::vector<float>> history_;   // per channel
+    size_t buffered_ = 0;                       // frames in each history
+    double position_ = 0.0;                     // next output, in history frames
+    std::vector<float> channel_out_;
+};
+
+// Doppler for sources that all play one live mono stream
+// Each source reads the shared history through its own delay. The delay
+// starts at the sound's travel time for the source's distance and then
+// changes by (1 - ratio) frames per frame, so reading the stream ratio
+// times faster is what shifts the pitch. The delay is held between
+// MIN_DELAY_FRAMES and MAX_DELAY_FRAMES, so a source that keeps approaching
+// (or receding) long enough settles back to its natural pitch.
+class AudioDoppler {
+public:
+    static constexpr size_t HISTORY_FRAMES = 32768;   // power of two
+    static constexpr size_t MIN_DELAY_FRAMES = AudioResampler::HALF_TAPS + 1;   // the filter's lookahead
+    static constexpr size_t MAX_DELAY_FRAMES = 24000;
+
+    AudioDoppler(int sample_rate, size_t block_frames, AudioResampleQuality quality);
+
+    // Appends the block every source plays, and drops the sources that
+    // were not rendered since the previous push
+    void push(const float* block);
+    // The latest block as source `id` hears it; `index` is a hint to its
+    // slot. `distance` in metres sets the delay a new source starts with.
+    const float* render(size_t index, int id, float distance, float ratio);
+    void reset();
+
+private:
+    struct Voice {
+        double delay;          // frames behind the end of the newest block
+        AudioResampler resampler;
+        std::vector<float> output;
+    };
+
+    Voice new_voice(float distance) const;
+
+    int sample_rate_;
+    size_t block_;
+    AudioResampleQuality quality_;
+    std::vector<float> history_;   // HISTORY_FRAMES, written twice so any window is contiguous
+    size_t written_ = 0;
+    AudioVoiceTable<Voice> voices_;
+};
@@ -0,0 +1,188 @@
+#include "audio_reverb.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PSX5_AUDIO_SSE2 1
+#endif
+
+namespace {
+
+// Line lengths in frames at 48 kHz (primes, 21-57 ms) before preset scaling
+constexpr uint32_t BASE_DELAYS[AudioReverb::LINES] = {1031, 1327, 1523, 1787, 1951, 2213, 2459, 2741};
+
+struct PresetParams {
+    float size;      // delay length scale
+    float rt60;      // seconds to decay by 60 dB at low frequencies
+    float damping;   // low pass pole, higher = darker
+};
+
+constexpr PresetParams PRESETS[AudioReverb::PRESET_COUNT] = {
+    {0.6f, 0.5f, 0.45f},   // ROOM
+    {1.0f, 1.8f, 0.3f},    // HALL
+    {1.6f, 4.0f, 0.2f},    // CATHEDRAL
+};
+
+// Input polarity per line, so the lines do not start out correlated
+constexpr float INPUT_SIGN[AudioReverb::LINES] = {1, -1, 1, -1, -1, 1, -1, 1};
+
+// Hadamard matrix scale, keeps the feedback matrix orthonormal
+const float HADAMARD_SCALE = 1.0f / std::sqrt(8.0f);
+
+#ifdef PSX5_AUDIO_SSE2
+// 8-point fast Walsh-Hadamard transform on two registers
+inline void hadamard8(__m128& a, __m128& b) {
+    // Distance 4: across the registers
+    __m128 s = _mm_add_ps(a, b);
+    __m128 d = _mm_sub_ps(a, b);
+    // Distance 2: [x0 x1 x2 x3] -> [x0+x2, x1+x3, x0-x2, x1-x3]
+    const __m128 sign2 = _mm_set_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+    s = _mm_add_ps(_mm_movelh_ps(s, s), _mm_mul_ps(_mm_movehl_ps(s, s), sign2));
+    d = _mm_add_ps(_mm_movelh_ps(d, d), _mm_mul_ps(_mm_movehl_ps(d, d), sign2));
+    // Distance 1: [x0 x1 x2 x3] -> [x0+x1, x0-x1, x2+x3, x2-x3]
+    const __m128 sign1 = _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    a = _mm_add_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 0, 0)),
+                   _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 1, 1)), sign1));
+    b = _mm_add_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 0, 0)),
+                   _mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 1, 1)), sign1));
+}
+#else
+inline void hadamard8(float* x) {
+    for (int span = 4; span >= 1; span >>= 1) {
+        for (int i = 0; i < 8; i += span * 2) {
+            for (int j = i; j < i + span; ++j) {
+                float s = x[j] + x[j + span];
+                float d = x[j] - x[j + span];
+                x[j] = s;
+                x[j + span] = d;
+            }
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void AudioReverb::configure(int preset, int sample_rate) {
+    preset = std::clamp(preset, 0, PRESET_COUNT - 1);
+    if (preset == preset_ && sample_rate == sample_rate_) {
+        return;
+    }
+    preset_ = preset;
+    sample_rate_ = sample_rate;
+
+    const PresetParams& p = PRESETS[preset];
+    float rate_scale = static_cast<float>(sample_rate) / 48000.0f;
+    uint32_t longest = 0;
+    for (int i = 0; i < LINES; ++i) {
+        delays_[i] = std::max<uint32_t>(1, static_cast<uint32_t>(BASE_DELAYS[i] * p.size * rate_scale));
+        longest = std::max(longest, delays_[i]);
+        // -60 dB after rt60 seconds: gain per pass = 10^(-3 * delay / (rt60 * rate))
+        feedback_[i] = std::pow(10.0f, -3.0f * delays_[i] / (p.rt60 * sample_rate)) * HADAMARD_SCALE;
+        damping_[i] = p.damping;
+    }
+
+    size_t frames = 1;
+    while (frames <= longest) {
+        frames <<= 1;
+    }
+    if (buffer_.size() < frames * LINES) {
+        buffer_.resize(frames * LINES);
+    }
+    mask_ = frames - 1;
+    reset();
+}
+
+void AudioReverb::reset() {
+    std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+    lowpass_.fill(0.0f);
+    write_pos_ = 0;
+}
+
+void AudioReverb::process(float* samples, size_t frames, int channels, float wet) {
+    if (buffer_.empty() || channels < 1) {
+        return;
+    }
+
+    float* buffer = buffer_.data();
+    const float input_scale = 1.0f / channels;
+    const float output_scale = wet * 0.5f;   // four lines per output
+
+#ifdef PSX5_AUDIO_SSE2
+    const __m128 feedback_lo = _mm_load_ps(feedback_.data());
+    const __m128 feedback_hi = _mm_load_ps(feedback_.data() + 4);
+    const __m128 damping_lo = _mm_load_ps(damping_.data());
+    const __m128 damping_hi = _mm_load_ps(damping_.data() + 4);
+    const __m128 sign_lo = _mm_setr_ps(INPUT_SIGN[0], INPUT_SIGN[1], INPUT_SIGN[2], INPUT_SIGN[3]);
+    const __m128 sign_hi = _mm_setr_ps(INPUT_SIGN[4], INPUT_SIGN[5], INPUT_SIGN[6], INPUT_SIGN[7]);
+    __m128 lowpass_lo = _mm_load_ps(lowpass_.data());
+    __m128 lowpass_hi = _mm_load_ps(lowpass_.data() + 4);
+#endif
+
+    size_t pos = write_pos_;
+    for (size_t f = 0; f < frames; ++f) {
+        float* frame = samples + f * channels;
+        float input = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            input += frame[c];
+        }
+        input *= input_scale;
+
+        alignas(16) float taps[LINES];
+        for (int i = 0; i < LINES; ++i) {
+            taps[i] = buffer[((pos - delays_[i]) & mask_) * LINES + i];
+        }
+
+        float left, right;
+#ifdef PSX5_AUDIO_SSE2
+        // Damping: lowpass += (1 - damping) * (tap - lowpass)
+        __m128 lo = _mm_load_ps(taps);
+        __m128 hi = _mm_load_ps(taps + 4);
+        lowpass_lo = _mm_add_ps(lo, _mm_mul_ps(damping_lo, _mm_sub_ps(lowpass_lo, lo)));
+        lowpass_hi = _mm_add_ps(hi, _mm_mul_ps(damping_hi, _mm_sub_ps(lowpass_hi, hi)));
+
+        // Even lines to the left, odd lines to the right
+        alignas(16) float filtered[LINES];
+        _mm_store_ps(filtered, lowpass_lo);
+        _mm_store_ps(filtered + 4, lowpass_hi);
+        left = filtered[0] + filtered[2] + filtered[4] + filtered[6];
+        right = filtered[1] + filtered[3] + filtered[5] + filtered[7];
+
+        lo = lowpass_lo;
+        hi = lowpass_hi;
+        hadamard8(lo, hi);
+        __m128 in = _mm_set1_ps(input);
+        float* dst = buffer + (pos & mask_) * LINES;
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(in, sign_lo), _mm_mul_ps(lo, feedback_lo)));
+        _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_mul_ps(in, sign_hi), _mm_mul_ps(hi, feedback_hi)));
+#else
+        float mixed[LINES];
+        for (int i = 0; i < LINES; ++i) {
+            lowpass_[i] = taps[i] + damping_[i] * (lowpass_[i] - taps[i]);
+            mixed[i] = lowpass_[i];
+        }
+        left = lowpass_[0] + lowpass_[2] + lowpass_[4] + lowpass_[6];
+        right = lowpass_[1] + lowpass_[3] + lowpass_[5] + lowpass_[7];
+        hadamard8(mixed);
+        float* dst = buffer + (pos & mask_) * LINES;
+        for (int i = 0; i < LINES; ++i) {
+            dst[i] = input * INPUT_SIGN[i] + mixed[i] * feedback_[i];
+        }
+#endif
+        pos = (pos + 1) & mask_;
+
+        if (channels >= 2) {
+            frame[0] += left * output_scale;
+            frame[1] += right * output_scale;
+        } else {
+            frame[0] += (left + right) * 0.5f * output_scale;
+        }
+    }
+    write_pos_ = pos;
+
+#ifdef PSX5_AUDIO_SSE2
+    _mm_store_ps(lowpass_.data(), lowpass_lo);
+    _mm_store_ps(lowpass_.data() + 4, lowpass_hi);
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Feedback delay network reverb
+// Eight delay lines of mutually prime lengths feed back into each other
+// through a normalized 8x8 Hadamard matrix. Each line has a one-pole low
+// pass in its loop, so highs die away faster than lows, and a loop gain set
+// from the preset's RT60 for that line's length.
+//
+// All lines share one interleaved power-of-two buffer: the 8 values written
+// each frame are adjacent (two SSE2 stores) and wrapping is a mask.
+class AudioReverb {
+public:
+    enum Preset { ROOM = 0, HALL = 1, CATHEDRAL = 2, PRESET_COUNT };
+
+    static constexpr int LINES = 8;
+
+    // Reallocates only when the preset or rate needs longer lines than
+    // the buffer already holds; clears the tail whenever something changed
+    void configure(int preset, int sample_rate);
+    void reset();
+
+    // Adds the reverb of the block's channel average to the first two
+    // channels (to the only one for mono), scaled by `wet`
+    void process(float* samples, size_t frames, int channels, float wet);
+
+private:
+    int preset_ = -1;
+    int sample_rate_ = 0;
+
+    std::vector<float> buffer_;     // [frame][line]
+    size_t mask_ = 0;               // in frames
+    size_t write_pos_ = 0;
+    std::array<uint32_t, LINES> delays_{};
+    alignas(16) std::array<float, LINES> feedback_{};
+    alignas(16) std::array<float, LINES> damping_{};
+    alignas(16) std::array<float, LINES> lowpass_{};   // filter state
+};
@@ -0,0 +1,97 @@
+#include "audio_ring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+AudioRingBuffer::AudioRingBuffer(size_t capacity_frames, int channels)
+    : capacity_(round_up_pow2(std::max<size_t>(capacity_frames, 1)))
+    , mask_(capacity_ - 1)
+    , channels_(std::max(channels, 1))
+    , samples_(new float[capacity_ * channels_]()) {
+}
+
+AudioRingBuffer::Region AudioRingBuffer::region(uint64_t position, size_t frames) {
+    size_t start = static_cast<size_t>(position & mask_);
+    size_t first = std::min(frames, capacity_ - start);
+    return {samples_.get() + start * channels_, first, samples_.get(), frames - first};
+}
+
+AudioRingBuffer::Region AudioRingBuffer::prepare_write(size_t frames) {
+    uint64_t write = write_pos_.load(std::memory_order_relaxed);
+    if (capacity_ - (write - cached_read_pos_) < frames) {
+        cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    }
+    return region(write, std::min<size_t>(frames, capacity_ - (write - cached_read_pos_)));
+}
+
+void AudioRingBuffer::commit_write(size_t frames) {
+    write_pos_.store(write_pos_.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+    // Paired with wait_for_data: either the consumer sees the new signal
+    // before sleeping, or the producer sees it waiting
+    signal_.fetch_add(1, std::memory_order_seq_cst);
+    if (consumer_waiting_.load(std::memory_order_seq_cst)) {
+        signal_.notify_one();
+    }
+}
+
+size_t AudioRingBuffer::write(const float* samples, size_t frames) {
+    Region r = prepare_write(frames);
+    std::memcpy(r.first, samples, r.first_frames * channels_ * sizeof(float));
+    std::memcpy(r.second, samples + r.first_frames * channels_, r.second_frames * channels_ * sizeof(float));
+    commit_write(r.frames());
+    return r.frames();
+}
+
+AudioRingBuffer::Region AudioRingBuffer::prepare_read(size_t frames) {
+    uint64_t read = read_pos_.load(std::memory_order_relaxed);
+    if (cached_write_pos_ - read < frames) {
+        cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
+    }
+    return region(read, std::min<size_t>(frames, cached_write_pos_ - read));
+}
+
+void AudioRingBuffer::commit_read(size_t frames) {
+    read_pos_.store(read_pos_.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+}
+
+size_t AudioRingBuffer::read(float* samples, size_t frames) {
+    Region r = prepare_read(frames);
+    std::memcpy(samples, r.first, r.first_frames * channels_ * sizeof(float));
+    std::memcpy(samples + r.first_frames * channels_, r.second, r.second_frames * channels_ * sizeof(float));
+    commit_read(r.frames());
+    return r.frames();
+}
+
+size_t AudioRingBuffer::read_available() const {
+    // Read position first (acquire orders it before the write position load):
+    // it never passes the write position, so the difference cannot go
+    // negative, only overshoot while the consumer moves. Both are plain loads
+    // on x86 and ARM64.
+    uint64_t read = read_pos_.load(std::memory_order_acquire);
+    uint64_t write = write_pos_.load(std::memory_order_relaxed);
+    return static_cast<size_t>(std::min<uint64_t>(write - read, capacity_));
+}
+
+void AudioRingBuffer::wait_for_data(uint32_t seen) {
+    consumer_waiting_.store(true, std::memory_order_seq_cst);
+    if (signal_.load(std::memory_order_seq_cst) == seen) {
+        signal_.wait(seen, std::memory_order_acquire);
+    }
+    consumer_waiting_.store(false, std::memory_order_relaxed);
+}
+
+void AudioRingBuffer::wake() {
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_all();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Single-producer/single-consumer ring of interleaved float frames
+// The producer (emulation thread) reserves space and writes straight into
+// the ring; the consumer (audio thread) reads regions in place and hands
+// them to the device. Positions are frame counters that only grow, so
+// full/empty never alias. Each side keeps a cached copy of the other's
+// position and only reloads it when the cache says there is no room, which
+// keeps the shared cache lines quiet in the steady state.
+class AudioRingBuffer {
+public:
+    // A reserved run of frames; `second` is non-empty when it wraps
+    struct Region {
+        float* first;
+        size_t first_frames;
+        float* second;
+        size_t second_frames;
+        size_t frames() const { return first_frames + second_frames; }
+    };
+
+    // Capacity is rounded up to a power of two
+    AudioRingBuffer(size_t capacity_frames, int channels);
+
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    int channels() const { return channels_; }
+
+    // Producer side: reserve up to `frames`, fill, then commit what was written
+    Region prepare_write(size_t frames);
+    void commit_write(size_t frames);
+    // Copies in as many frames as fit; returns the count
+    size_t write(const float* samples, size_t frames);
+
+    // Consumer side: borrow up to `frames`, use, then release them
+    Region prepare_read(size_t frames);
+    void commit_read(size_t frames);
+    size_t read(float* samples, size_t frames);
+
+    // Safe from any thread; the values may be stale by the time they return
+    size_t read_available() const;
+    size_t write_available() const { return capacity_ - read_available(); }
+
+    // Blocks the consumer until something is committed or wake() is called
+    void wait_for_data(uint32_t seen);
+    uint32_t data_signal() const { return signal_.load(std::memory_order_acquire); }
+    void wake();
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    Region region(uint64_t position, size_t frames);
+
+    const size_t capacity_;
+    const size_t mask_;
+    const int channels_;
+    std::unique_ptr<float[]> samples_;
+
+    // Written by the producer
+    alignas(CACHE_LINE) std::atomic<uint64_t> write_pos_{0};
+    uint64_t cached_read_pos_ = 0;
+    std::atomic<uint32_t> signal_{0};
+
+    // Written by the consumer
+    alignas(CACHE_LINE) std::atomic<uint64_t> read_pos_{0};
+    uint64_t cached_write_pos_ = 0;
+    std::atomic<bool> consumer_waiting_{false};   // commits skip the futex wake otherwise
+};
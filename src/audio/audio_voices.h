@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Per-source state carried between blocks, matched to sources by id
+// Voices stay in the order their sources first appeared, so a source's
+// index in the caller's list is almost always its slot and the scan for a
+// moved one is rare. A block runs begin_block(), get() for every source
+// and end_block(), which forgets the sources that were removed.
+template <typename Voice>
+class AudioVoiceTable {
+public:
+    // Marks every voice unused until get() asks for it again
+    void begin_block() {
+        for (auto& entry : entries_) entry.used = false;
+    }
+
+    // Drops the voices get() did not ask for since begin_block()
+    void end_block() {
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& e) { return !e.used; }),
+                       entries_.end());
+    }
+
+    // The voice for source `id`, marked used; `index` is a hint to its
+    // slot. A new source starts from make()'s voice.
+    template <typename Make>
+    Voice& get(size_t index, int id, Make&& make) {
+        Entry* entry = nullptr;
+        if (index < entries_.size() && entries_[index].id == id) {
+            entry = &entries_[index];
+        } else {
+            for (auto& candidate : entries_) {
+                if (candidate.id == id) {
+                    entry = &candidate;
+                    break;
+                }
+            }
+        }
+        if (!entry) {
+            entries_.push_back(Entry{id, true, make()});
+            return entries_.back().voice;
+        }
+        entry->used = true;
+        return entry->voice;
+    }
+
+    void clear() { entries_.clear(); }
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        int id;
+        bool used;
+        Voice voice;
+    };
+
+    std::vector<Entry> entries_;
+};
@@ -97,7 +97,7 @@ bool VirtualMemoryManager::translate_address(uint64_t virtual_addr, uint64_t& ph
         // Check permissions
         if ((static_cast<uint32_t>(tlb_entry->protection) & static_cast<uint32_t>(required_protection)) == static_cast<uint32_t>(required_protection)) {
             physical_addr = tlb_entry->physical_page * PAGE_SIZE + offset;
-            tlb_entry->last_access = cache_access_counter++;
+            tlb_entry->last_access = tlb_access_counter++;
             return true;
         }
     }
@@ -132,6 +132,11 @@ bool VirtualMemoryManager::translate_address(uint64_t virtual_addr, uint64_t& ph
     return false;
 }
 
+bool VirtualMemoryManager::is_mapped(uint64_t virtual_addr) const {
+    auto it = page_table.find(virtual_addr / PAGE_SIZE);
+    return it != page_table.end() && it->second.present;
+}
+
 uint64_t VirtualMemoryManager::allocate_virtual_memory(size_t size, MemoryProtection protection, MemoryType type) {
     std::lock_guard<std::mutex> lock(memory_mutex);
     
@@ -175,7 +180,7 @@ void VirtualMemoryManager::update_tlb(uint64_t virtual_page, uint64_t physical_p
     entry.protection = protection;
     entry.valid = true;
     entry.asid = 0; // Simplified - single address space
-    entry.last_access = cache_access_counter++;
+    entry.last_access = tlb_access_counter++;
     
     tlb_index = (tlb_index + 1) % tlb_cache.size();
 }
@@ -189,6 +194,78 @@ TLBEntry* VirtualMemoryManager::find_tlb_entry(uint64_t virtual_page) {
     return nullptr;
 }
 
+void VirtualMemoryManager::invalidate_tlb_entry(uint64_t virtual_page) {
+    for (auto& entry : tlb_cache) {
+        if (entry.valid && entry.virtual_page == virtual_page) {
+            entry.valid = false;
+        }
+    }
+}
+
+bool VirtualMemoryManager::protect_memory(uint64_t virtual_addr, size_t size, MemoryProtection protection) {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    
+    uint64_t aligned_vaddr = virtual_addr & ~(PAGE_SIZE - 1);
+    size_t aligned_size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    
+    // Every page must be mapped before any of them changes
+    for (uint64_t offset = 0; offset < aligned_size; offset += PAGE_SIZE) {
+        if (page_table.find((aligned_vaddr + offset) / PAGE_SIZE) == page_table.end()) {
+            return false;
+        }
+    }
+    
+    for (uint64_t offset = 0; offset < aligned_size; offset += PAGE_SIZE) {
+        uint64_t vpage = (aligned_vaddr + offset) / PAGE_SIZE;
+        PageTableEntry& pte = page_table[vpage];
+        pte.writable = (static_cast<uint32_t>(protection) & static_cast<uint32_t>(MemoryProtection::WRITE)) ? 1 : 0;
+        pte.no_execute = (static_cast<uint32_t>(protection) & static_cast<uint32_t>(MemoryProtection::EXECUTE)) ? 0 : 1;
+        invalidate_tlb_entry(vpage);
+    }
+    
+    // Regions wholly inside the range take the new protection
+    for (auto& [addr, region] : memory_regions) {
+        if (region.virtual_addr >= aligned_vaddr && region.virtual_addr + region.size <= aligned_vaddr + aligned_size) {
+            region.protection = protection;
+        }
+    }
+    return true;
+}
+
+std::vector<MemoryRegion> VirtualMemoryManager::get_memory_map() const {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    
+    std::vector<MemoryRegion> regions;
+    regions.reserve(memory_regions.size());
+    for (const auto& [addr, region] : memory_regions) {
+        regions.push_back(region);
+    }
+    std::sort(regions.begin(), regions.end(), [](const MemoryRegion& a, const MemoryRegion& b) {
+        return a.virtual_addr < b.virtual_addr;
+    });
+    return regions;
+}
+
+size_t VirtualMemoryManager::get_total_allocated() const {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    
+    size_t total = 0;
+    for (const auto& [addr, size] : allocated_blocks) {
+        total += size;
+    }
+    return total;
+}
+
+size_t VirtualMemoryManager::get_total_free() const {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    
+    size_t total = 0;
+    for (const auto& block : free_blocks) {
+        total += block.second;
+    }
+    return total;
+}
+
 Memory::Memory(size_t size) : bytes(size, 0), vm_manager(std::make_unique<VirtualMemoryManager>()) {
     // Initialize cache
     for (auto& set : l1_cache) {
@@ -398,6 +475,49 @@ void Memory::invalidate_cache_line(uint64_t addr) {
     }
 }
 
+void Memory::invalidate_cache_range(uint64_t addr, size_t size) {
+    // Walks the cache rather than the range, which may be far larger
+    for (auto& set : l1_cache) {
+        for (auto& way : set) {
+            uint64_t line_addr = (way.tag * CACHE_SETS + (&set - &l1_cache[0])) * CACHE_LINE_SIZE;
+            if (way.valid && line_addr + CACHE_LINE_SIZE > addr && line_addr < addr + size) {
+                way.valid = false;
+            }
+        }
+    }
+}
+
+uint8_t* Memory::host_span(uint64_t addr, size_t size, MemoryProtection required_protection) {
+    if (size == 0) return nullptr;
+    
+    // Unmapped addresses are physical, as in read8()/write8(); a mapped page
+    // without the protection fails rather than aliasing physical memory
+    auto physical = [&](uint64_t virtual_addr, uint64_t& physical_addr) {
+        if (vm_manager->translate_address(virtual_addr, physical_addr, required_protection)) return true;
+        physical_addr = virtual_addr;
+        return !vm_manager->is_mapped(virtual_addr);
+    };
+    uint64_t base;
+    if (!physical(addr, base)) return nullptr;
+    if (base > bytes.size() || size > bytes.size() - base) return nullptr;
+    
+    for (uint64_t page = (addr / PAGE_SIZE + 1) * PAGE_SIZE; page < addr + size; page += PAGE_SIZE) {
+        uint64_t physical_page;
+        if (!physical(page, physical_page) || physical_page != base + (page - addr)) return nullptr;
+    }
+    return bytes.data() + base;
+}
+
+void Memory::span_written(uint64_t addr, size_t size) {
+    if (write_observer) write_observer(addr, size);
+    uint64_t physical_addr;
+    if (vm_manager->translate_address(addr, physical_addr, MemoryProtection::WRITE)) {
+        addr = physical_addr;
+    }
+    invalidate_cache_range(addr, size);
+    write_count++;
+}
+
 Memory::MemoryStats Memory::get_statistics() const {
     MemoryStats stats = {};
     stats.total_reads = read_count.load();
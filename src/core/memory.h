@@ -74,7 +74,8 @@ private:
     std::unordered_map<uint64_t, PageTableEntry> page_table;
     std::unordered_map<uint64_t, MemoryRegion> memory_regions;
     std::vector<TLBEntry> tlb_cache;
-    std::mutex memory_mutex;
+    std::atomic<uint64_t> tlb_access_counter{0};
+    mutable std::mutex memory_mutex;
     std::atomic<uint64_t> next_physical_page;
     
     // Memory allocation tracking
@@ -101,6 +102,8 @@ public:
     bool free_virtual_memory(uint64_t virtual_addr);
     
     bool translate_address(uint64_t virtual_addr, uint64_t& physical_addr, MemoryProtection required_protection = MemoryProtection::READ);
+    // Whether the page holding virtual_addr has a present page-table entry
+    bool is_mapped(uint64_t virtual_addr) const;
     MemoryRegion* find_region(uint64_t virtual_addr);
     
     void set_page_fault_handler(std::function<bool(uint64_t, MemoryProtection)> handler);
@@ -149,6 +152,7 @@ private:
     
     bool access_cache(uint64_t addr, uint8_t* data, size_t len, bool is_write);
     void invalidate_cache_line(uint64_t addr);
+    void invalidate_cache_range(uint64_t addr, size_t size);
 
 public:
     explicit Memory(size_t size);
@@ -203,5 +207,14 @@ public:
     
     size_t size() const { return bytes.size(); }
     uint8_t* data() { return bytes.data(); }
+    
+    // Host pointer to `size` guest bytes at virtual `addr`, translated page by
+    // page; nullptr when a mapped page lacks the protection, the range leaves
+    // RAM or it is not physically contiguous. Pages that were never mapped
+    // are taken as physical, as in read8()/write8(). Devices that fill a span
+    // directly (DMA, SSD decompression) call span_written() once they are done.
+    uint8_t* host_span(uint64_t addr, size_t size, MemoryProtection required_protection);
+    // Reports a direct write to the write observer and the cache model
+    void span_written(uint64_t addr, size_t size);
     VirtualMemoryManager* get_vm_manager() { return vm_manager.get(); }
 };
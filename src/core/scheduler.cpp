@@ -1,6 +1,7 @@
 #include "scheduler.h"
 #include <algorithm>
 #include <iostream>
+#include <memory>
 
 Scheduler::Scheduler() : start_time_(std::chrono::steady_clock::now()) {}
 
@@ -123,6 +124,50 @@ uint64_t Scheduler::schedule_repeating_task(std::function<void()> task, std::chr
     return task_id;
 }
 
+void Scheduler::parallel_for(size_t count, const std::function<void(size_t)>& fn, int priority) {
+    if (count == 0) return;
+    
+    size_t helpers = std::min(count - 1, threads_.size());
+    if (!running_.load() || helpers == 0) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    
+    struct Shared {
+        const std::function<void(size_t)>* fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->fn = &fn;
+    shared->count = count;
+    
+    // Helpers and the caller pull iterations from the same counter; a helper
+    // that starts after the work ran out touches only the shared block.
+    auto drain = [](Shared& s) {
+        size_t i;
+        while ((i = s.next.fetch_add(1)) < s.count) {
+            (*s.fn)(i);
+            if (s.done.fetch_add(1) + 1 == s.count) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.cv.notify_all();
+            }
+        }
+    };
+    
+    for (size_t h = 0; h < helpers; ++h) {
+        schedule_task([shared, drain] { drain(*shared); }, priority);
+    }
+    
+    drain(*shared);
+    
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->cv.wait(lock, [&] { return shared->done.load() == count; });
+}
+
 void Scheduler::worker_thread(uint64_t thread_id) {
     while (running_.load()) {
         Task task;
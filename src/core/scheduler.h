@@ -51,6 +51,11 @@ public:
     uint64_t schedule_repeating_task(std::function<void()> task, std::chrono::milliseconds interval, int priority = 0);
     bool cancel_task(uint64_t task_id);
     
+    // Runs fn(i) for every i in [0, count) across the worker pool and blocks
+    // until all iterations finish. The calling thread helps drain the work, so
+    // this is safe to call from inside a task. Runs serially when not initialized.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn, int priority = 0);
+    
     // Thread management
     void set_thread_affinity(uint64_t thread_id, int cpu_core);
     void pause_thread(uint64_t thread_id);
@@ -62,6 +67,8 @@ public:
     // Statistics
     size_t get_pending_tasks() const;
     size_t get_active_threads() const;
+    size_t get_worker_count() const { return threads_.size(); }
+    bool is_running() const { return running_.load(); }
     double get_cpu_usage() const;
 
 private:
@@ -70,7 +77,7 @@ private:
     
     std::vector<std::unique_ptr<Thread>> threads_;
     std::priority_queue<Task> task_queue_;
-    std::mutex queue_mutex_;
+    mutable std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
     std::condition_variable scheduler_cv_;
     
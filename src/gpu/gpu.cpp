@@ -4,14 +4,19 @@
 #endif
 #ifdef PSX5_ENABLE_VULKAN
 #include "gpu/vulkan_swapchain.h"
+#include "gpu/vulkan_translator.h"
+#include "gpu/vulkan_upload_manager.h"
 #endif
 #include "graphics_pipeline.h"
+#include "../core/memory.h"
+#include "../core/scheduler.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
 #include <thread>
 #include <cmath>
 #include <random>
+#include <chrono>
 
 GPU::GPU() {
     gpu_memory = std::make_unique<uint8_t[]>(GPU_MEMORY_SIZE);
@@ -34,6 +39,14 @@ GPU::GPU() {
         vulkan_backend = nullptr;
     } else {
         std::cout << "GPU: Vulkan backend initialized successfully" << std::endl;
+        vulkan_translator = new VulkanTranslator(this, vulkan_backend);
+        if (!vulkan_translator->init()) {
+            std::cerr << "GPU: Vulkan translation unavailable, draws use software rendering" << std::endl;
+            delete vulkan_translator;
+            vulkan_translator = nullptr;
+        } else {
+            vulkan_translator->set_scheduler(scheduler);
+        }
     }
 #else
     vulkan_backend = nullptr;
@@ -63,10 +76,18 @@ GPU::GPU() {
               << ", Tile-Based Rendering=" << (advanced_features.tile_based_rendering_enabled ? "ON" : "OFF")
               << ", Hierarchical Z=" << (advanced_features.hierarchical_z_enabled ? "ON" : "OFF")
               << std::endl;
+    
+    presenter.start();
 }
 
 GPU::~GPU() {
+    close_window();
+    presenter.stop();
+    dma_engine.wait_idle();
+    
 #ifdef PSX5_ENABLE_VULKAN
+    delete vulkan_translator;
+    vulkan_translator = nullptr;
     if (vulkan_backend) {
         vulkan_backend->shutdown();
         delete vulkan_backend;
@@ -113,9 +134,17 @@ void GPU::initialize_shader_engines() {
 }
 
 void GPU::submit(const std::vector<Command>& commands) {
-    std::cout << "GPU: Processing " << commands.size() << " RDNA2 commands" << std::endl;
+    event_log.record(GPULogLevel::Debug, GPUEvent::Submit, commands.size());
+    
+    if (!capture && !capture_path.empty() && capture_frames_ahead == 0) {
+        begin_capture();
+    }
     
     for (const auto& cmd : commands) {
+        if (capture) {
+            capture_command(cmd);
+        }
+        
         switch (cmd.opcode) {
             case DRAW_INDEX_AUTO:
             case DRAW_INDEX_2:
@@ -128,6 +157,7 @@ void GPU::submit(const std::vector<Command>& commands) {
             case DISPATCH_DIRECT:
             case DISPATCH_INDIRECT:
             case DISPATCH_COMPUTE:
+            case SET_COMPUTE_SHADER:
                 if (compute_pipeline) {
                     execute_compute_command(cmd);
                 }
@@ -137,36 +167,317 @@ void GPU::submit(const std::vector<Command>& commands) {
             case SET_CONFIG_REG:
             case SET_SH_REG:
                 // Handle register writes
-                std::cout << "GPU: Setting register 0x" << std::hex << cmd.arg0 
-                         << " = 0x" << std::hex << cmd.arg1 << std::dec << std::endl;
+                event_log.record(GPULogLevel::Trace, GPUEvent::SetRegister, cmd.arg0, cmd.arg1);
                 break;
                 
             case DMA_DATA:
             case COPY_DATA:
-                // Handle memory operations
-                std::cout << "GPU: Memory operation from 0x" << std::hex << cmd.arg0 
-                         << " to 0x" << std::hex << cmd.arg1 << " size " << std::dec << cmd.arg2 << std::endl;
+            case WRITE_DATA:
+                execute_memory_command(cmd);
+                break;
+                
+            case WAIT_REG_MEM:
+                execute_wait_reg_mem(cmd);
                 break;
                 
             case EVENT_WRITE:
-            case EVENT_WRITE_EOP:
                 // Handle synchronization events
-                std::cout << "GPU: Event write " << cmd.arg0 << std::endl;
+                event_log.record(GPULogLevel::Trace, GPUEvent::EventWrite, cmd.arg0);
+                break;
+                
+            case EVENT_WRITE_EOP: {
+                // End of pipe: all prior work, including async DMA, has retired.
+                // arg1 = GPU address to release arg2 to (0 = no release)
+                dma_engine.wait_idle();
+                retire_guest_writes();
+                sync_with_vulkan();
+                if (cmd.arg1 != 0) {
+                    uint8_t* dst = get_gpu_memory_ptr(cmd.arg1);
+                    if (dst && cmd.arg1 + sizeof(uint64_t) <= GPU_MEMORY_SIZE) {
+                        std::memcpy(dst, &cmd.arg2, sizeof(uint64_t));
+                        dirty_tracker.mark(cmd.arg1, sizeof(uint64_t));
+                    }
+                }
                 break;
+            }
                 
             default:
-                std::cout << "GPU: Unknown command opcode 0x" << std::hex << cmd.opcode << std::dec << std::endl;
+                event_log.record(GPULogLevel::Warn, GPUEvent::UnknownOpcode, cmd.opcode);
                 break;
         }
     }
     
+    retire_guest_writes();
+    
     // Update performance counters
     perf_counters.compute_dispatches += commands.size();
 }
 
+void GPU::present() {
+    const auto& target = render_backends[0].color_targets[0];
+    if (!(frame_state.active_render_targets & 1) || target.width == 0 || target.height == 0) {
+        return;
+    }
+    size_t size = static_cast<size_t>(target.pitch) * target.height;
+    if (target.base_address + size > GPU_MEMORY_SIZE) {
+        return;
+    }
+    
+#ifdef PSX5_ENABLE_VULKAN
+    // Translated draws reach GPU memory when their readbacks retire
+    if (vulkan_translator && vulkan_translator->has_pending_work()) {
+        sync_with_vulkan();
+    }
+#endif
+    
+    GPUPresentFrame frame;
+    frame.pixels = gpu_memory.get() + target.base_address;
+    frame.address = target.base_address;
+    frame.width = target.width;
+    frame.height = target.height;
+    frame.pitch = target.pitch;
+    frame.format = target.format;
+    frame.frame_number = frame_state.frame_number++;
+    presenter.queue_frame(frame);
+    
+    if (capture) {
+        finish_capture();
+    } else if (!capture_path.empty() && capture_frames_ahead > 0) {
+        capture_frames_ahead--;
+    }
+}
+
+bool GPU::open_window(int width, int height) {
+#if defined(PSX5_ENABLE_VULKAN) && defined(PSX5_ENABLE_GLFW)
+    if (window_swapchain) {
+        return true;
+    }
+    if (!glfwInit()) {
+        std::cerr << "GPU: GLFW initialization failed, frames are not displayed" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    window = glfwCreateWindow(width, height, "PSX5", nullptr, nullptr);
+    auto swapchain = std::make_unique<VulkanSwapchain>();
+    if (!window || !swapchain->init(window)) {
+        std::cerr << "GPU: No Vulkan surface to present to, frames are not displayed" << std::endl;
+        swapchain.reset();
+        if (window) {
+            glfwDestroyWindow(window);
+            window = nullptr;
+        }
+        glfwTerminate();
+        return false;
+    }
+    window_swapchain = swapchain.release();
+    presenter.set_sink(window_swapchain);
+    return true;
+#else
+    (void)width;
+    (void)height;
+    return false;
+#endif
+}
+
+void GPU::close_window() {
+#if defined(PSX5_ENABLE_VULKAN) && defined(PSX5_ENABLE_GLFW)
+    if (!window_swapchain) {
+        return;
+    }
+    // Returns once the presenter thread is done with the swapchain
+    presenter.set_sink(nullptr);
+    delete window_swapchain;
+    window_swapchain = nullptr;
+    glfwDestroyWindow(window);
+    window = nullptr;
+    glfwTerminate();
+#endif
+}
+
+void GPU::SetRenderTarget(uint32_t index, uint64_t address, uint32_t width, uint32_t height, uint32_t format) {
+    if (index >= render_backends[0].color_targets.size()) {
+        return;
+    }
+    
+    // A previous frame in this buffer may still be on screen
+    presenter.wait_released(address, static_cast<size_t>(width) * height * 4);
+    
+    for (auto& render_backend : render_backends) {
+        auto& target = render_backend.color_targets[index];
+        target.base_address = address;
+        target.width = width;
+        target.height = height;
+        target.format = format;
+        target.pitch = width * 4;
+        target.compression_enabled = false;
+    }
+    frame_state.active_render_targets |= 1u << index;
+}
+
+void GPU::set_scheduler(Scheduler* sched) {
+    scheduler = sched;
+    dma_engine.set_scheduler(sched);
+#ifdef PSX5_ENABLE_VULKAN
+    if (vulkan_translator) {
+        vulkan_translator->set_scheduler(sched);
+    }
+#endif
+}
+
+uint8_t* GPU::get_gpu_memory_ptr(uint64_t address) {
+    if (address >= GPU_MEMORY_SIZE) {
+        return nullptr;
+    }
+    return gpu_memory.get() + address;
+}
+
+uint8_t* GPU::resolve_dma_address(uint64_t address, size_t size, uint32_t space, bool write) {
+    if (space == DMA_SPACE_GUEST) {
+        if (!guest_memory) {
+            return nullptr;
+        }
+        return guest_memory->host_span(address, size, write ? MemoryProtection::WRITE : MemoryProtection::READ);
+    }
+    
+    if (address > GPU_MEMORY_SIZE || size > GPU_MEMORY_SIZE - address) {
+        return nullptr;
+    }
+    return gpu_memory.get() + address;
+}
+
+void GPU::execute_memory_command(const Command& cmd) {
+    uint32_t control = static_cast<uint32_t>(cmd.arg3);
+    uint32_t src_sel = control & DMA_SRC_SEL_MASK;
+    uint32_t dst_sel = (control >> DMA_DST_SEL_SHIFT) & DMA_SRC_SEL_MASK;
+    bool async = (control & DMA_ASYNC) != 0;
+    
+    switch (cmd.opcode) {
+        case DMA_DATA:
+        case COPY_DATA: {
+            // arg0 = source address (or fill pattern), arg1 = destination, arg2 = byte count
+            size_t size = static_cast<size_t>(cmd.arg2);
+            uint64_t fence = 0;
+            uint8_t* dst = resolve_dma_address(cmd.arg1, size, dst_sel, true);
+            if (!dst) {
+                event_log.record(GPULogLevel::Error, GPUEvent::DMARangeError, cmd.arg1, 1);
+                return;
+            }
+            if (dst_sel == DMA_SPACE_GPU) {
+                dirty_tracker.mark(cmd.arg1, size);
+            }
+            
+            if (cmd.opcode == DMA_DATA && src_sel == DMA_SRC_DATA) {
+                uint32_t pattern = static_cast<uint32_t>(cmd.arg0);
+                if (async) {
+                    fence = dma_engine.fill_async(dst, pattern, size);
+                } else {
+                    dma_engine.fill(dst, pattern, size);
+                }
+            } else {
+                const uint8_t* src = resolve_dma_address(cmd.arg0, size, src_sel, false);
+                if (!src) {
+                    event_log.record(GPULogLevel::Error, GPUEvent::DMARangeError, cmd.arg0, 0);
+                    return;
+                }
+                // COPY_DATA is a small register/memory move; it always completes inline
+                if (async && cmd.opcode == DMA_DATA) {
+                    fence = dma_engine.copy_async(dst, src, size);
+                } else {
+                    dma_engine.copy(dst, src, size);
+                }
+            }
+            // Guest writes reach the JIT and cache model; async ones once done
+            if (dst_sel == DMA_SPACE_GUEST) {
+                if (fence) {
+                    pending_guest_writes.push_back({fence, cmd.arg1, size});
+                } else {
+                    guest_memory->span_written(cmd.arg1, size);
+                }
+            }
+            perf_counters.memory_bandwidth_used += size;
+            break;
+        }
+        
+        case WRITE_DATA: {
+            // arg0 = destination, arg1 = immediate data, arg2 = byte count (1-8)
+            size_t size = std::min<size_t>(static_cast<size_t>(cmd.arg2), sizeof(uint64_t));
+            if (size == 0) size = sizeof(uint32_t);
+            uint8_t* dst = resolve_dma_address(cmd.arg0, size, dst_sel, true);
+            if (dst) {
+                std::memcpy(dst, &cmd.arg1, size);
+                if (dst_sel == DMA_SPACE_GPU) {
+                    dirty_tracker.mark(cmd.arg0, size);
+                } else {
+                    guest_memory->span_written(cmd.arg0, size);
+                }
+                perf_counters.memory_bandwidth_used += size;
+            }
+            break;
+        }
+    }
+}
+
+void GPU::retire_guest_writes() {
+    if (pending_guest_writes.empty()) {
+        return;
+    }
+    uint64_t completed = dma_engine.completed_fence();
+    auto done = std::partition(pending_guest_writes.begin(), pending_guest_writes.end(),
+                               [&](const PendingGuestWrite& write) { return write.fence > completed; });
+    for (auto it = done; it != pending_guest_writes.end(); ++it) {
+        guest_memory->span_written(it->address, it->size);
+    }
+    pending_guest_writes.erase(done, pending_guest_writes.end());
+}
+
+void GPU::execute_wait_reg_mem(const Command& cmd) {
+    // arg0 = address, arg1 = reference, arg2 = mask, arg3 = function | memory space
+    uint32_t function = static_cast<uint32_t>(cmd.arg3) & 0x7;
+    uint32_t space = (cmd.arg3 & WAIT_MEM_SPACE_GUEST) ? DMA_SPACE_GUEST : DMA_SPACE_GPU;
+    uint32_t reference = static_cast<uint32_t>(cmd.arg1);
+    uint32_t mask = cmd.arg2 ? static_cast<uint32_t>(cmd.arg2) : 0xFFFFFFFFu;
+    
+    const uint8_t* ptr = resolve_dma_address(cmd.arg0, sizeof(uint32_t), space, false);
+    if (!ptr) {
+        return;
+    }
+    
+    auto condition_met = [&]() {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        value &= mask;
+        switch (function) {
+            case WAIT_ALWAYS:        return true;
+            case WAIT_LESS:          return value < reference;
+            case WAIT_LESS_EQUAL:    return value <= reference;
+            case WAIT_EQUAL:         return value == reference;
+            case WAIT_NOT_EQUAL:     return value != reference;
+            case WAIT_GREATER_EQUAL: return value >= reference;
+            case WAIT_GREATER:       return value > reference;
+            default:                 return true;
+        }
+    };
+    
+    // The value being polled is usually produced by an earlier DMA; let the
+    // engine retire outstanding transfers before sampling memory.
+    if (dma_engine.completed_fence() < dma_engine.submitted_fence()) {
+        dma_engine.wait_idle();
+    }
+    retire_guest_writes();
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(WAIT_REG_MEM_TIMEOUT_US);
+    while (!condition_met()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            event_log.record(GPULogLevel::Warn, GPUEvent::WaitTimeout, cmd.arg0, cmd.arg1, cmd.arg2);
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
 void GPU::execute_graphics_command(const Command& cmd) {
     if (!frame_state.in_frame) {
-        std::cout << "GPU: Warning - Graphics command outside of frame" << std::endl;
+        event_log.record(GPULogLevel::Warn, GPUEvent::CommandOutsideFrame);
         BeginFrame();
     }
     
@@ -231,6 +542,23 @@ void GPU::execute_compute_command(const Command& cmd) {
             break;
         }
         
+        case DISPATCH_INDIRECT: {
+            // arg0 = GPU address of {group_x, group_y, group_z}
+            uint64_t args_address = cmd.arg0;
+            
+            if (compute_pipeline) {
+                compute_pipeline->DispatchIndirect(args_address);
+            } else {
+                uint8_t* args = get_gpu_memory_ptr(args_address);
+                if (args && args_address + 3 * sizeof(uint32_t) <= GPU_MEMORY_SIZE) {
+                    uint32_t groups[3];
+                    std::memcpy(groups, args, sizeof(groups));
+                    dispatch_compute_shader(groups[0], groups[1], groups[2]);
+                }
+            }
+            break;
+        }
+        
         case SET_COMPUTE_SHADER: {
             compute_state.compute_shader_id = static_cast<uint32_t>(cmd.arg0);
             compute_state.thread_group_size[0] = static_cast<uint32_t>(cmd.arg1 & 0xFFFF);
@@ -242,8 +570,7 @@ void GPU::execute_compute_command(const Command& cmd) {
 }
 
 void GPU::process_draw_call(uint32_t vertex_count, uint32_t instance_count) {
-    std::cout << "GPU: Processing production-quality draw call - " << vertex_count << " vertices, " 
-              << instance_count << " instances" << std::endl;
+    event_log.record(GPULogLevel::Debug, GPUEvent::DrawBegin, vertex_count, instance_count);
     
     // Process vertex data through vertex shader pipeline
     std::vector<ProcessedVertex> processed_vertices;
@@ -297,8 +624,7 @@ void GPU::process_draw_call(uint32_t vertex_count, uint32_t instance_count) {
     
     perf_counters.triangles_rendered += visible_primitives.size();
     
-    std::cout << "GPU: Production draw call complete - " << visible_primitives.size() << " visible primitives, "
-              << perf_counters.tiles_processed << " tiles processed" << std::endl;
+    event_log.record(GPULogLevel::Debug, GPUEvent::DrawEnd, visible_primitives.size(), perf_counters.tiles_processed);
 }
 
 GPU::ProcessedVertex GPU::execute_vertex_shader(uint32_t vertex_index) {
@@ -648,8 +974,7 @@ void GPU::bin_primitives_to_tiles_production(const std::vector<AssembledPrimitiv
     
     perf_counters.tiles_processed += tiles_x * tiles_y;
     
-    std::cout << "GPU: Production binned " << primitives.size() << " primitives to " 
-              << tiles_x << "x" << tiles_y << " tiles" << std::endl;
+    event_log.record(GPULogLevel::Trace, GPUEvent::TilesBinned, primitives.size(), tiles_x, tiles_y);
 }
 
 bool GPU::triangle_intersects_tile(float vertices[3][2], float tile_min_x, float tile_max_x, 
@@ -1111,38 +1436,6 @@ void GPU::update_hierarchical_z_production(uint32_t tile_x, uint32_t tile_y, flo
     }
 }
 
-void GPU::dispatch_compute_shader(uint32_t group_x, uint32_t group_y, uint32_t group_z) {
-    std::cout << "GPU: Dispatching compute shader - groups(" << group_x << ", " 
-              << group_y << ", " << group_z << ")" << std::endl;
-    
-    if (compute_state.compute_shader_id == 0) {
-        std::cout << "GPU: No compute shader set" << std::endl;
-        return;
-    }
-    
-    auto* compute_shader = get_compiled_shader(compute_state.compute_shader_id);
-    if (!compute_shader) {
-        std::cout << "GPU: Compute shader not found" << std::endl;
-        return;
-    }
-    
-    uint32_t total_groups = group_x * group_y * group_z;
-    uint32_t groups_per_cu = std::max(1u, total_groups / (SHADER_ENGINE_COUNT * RDNA2ShaderEngine::CUS_PER_SE));
-    
-    // Distribute compute work across all CUs
-    for (auto& se : shader_engines) {
-        for (auto& cu : se.compute_units) {
-            if (!cu.busy) {
-                cu.busy = true;
-                execute_shader_on_cu(cu, *compute_shader);
-                cu.busy = false;
-            }
-        }
-    }
-    
-    perf_counters.compute_dispatches++;
-}
-
 void GPU::execute_shader_on_cu(RDNA2ComputeUnit& cu, const CompiledShader& shader) {
     
     // Find available wavefront slot
@@ -1593,52 +1886,84 @@ CompiledShader GPU::compile_shader_advanced(uint32_t shader_id, const std::vecto
 
 void GPU::sync_with_vulkan() {
 #ifdef PSX5_ENABLE_VULKAN
+    if (vulkan_translator) {
+        vulkan_translator->flush();
+    }
     if (vulkan_backend && vulkan_backend->is_initialized()) {
-        // Wait for all GPU operations to complete
-        VkDevice device = vulkan_backend->get_device();
-        if (device != VK_NULL_HANDLE) {
-            vkDeviceWaitIdle(device);
-        }
+        // Submit anything still recorded and wait on the frame fences
+        vulkan_backend->wait_frames();
     }
 #endif
 }
 
-uint32_t GPU::create_buffer(size_t size, uint32_t usage_flags) {
+void GPU::set_software_rendering(bool enable) {
+    if (enable && !software_rendering) {
+        sync_with_vulkan();
+    }
+    software_rendering = enable;
+}
+
+uint32_t GPU::compile_shader(const std::vector<uint8_t>& shader_source, uint32_t shader_type) {
+    CompiledShader compiled{};
+    compiled.shader_type = shader_type;
+    
+    std::vector<uint32_t> words((shader_source.size() + 3) / 4);
+    if (!words.empty()) {
+        std::memcpy(words.data(), shader_source.data(), shader_source.size());
+    }
+    
+    // SPIR-V modules are kept for the Vulkan translator; anything else is
+    // treated as native ISA for the software path
+    if (words.size() >= 5 && words[0] == 0x07230203) {
+        compiled.spirv = std::move(words);
+    } else {
+        compiled.bytecode = std::move(words);
+    }
+    
+    uint32_t shader_id = next_shader_id++;
+    shader_cache[shader_id] = std::move(compiled);
 #ifdef PSX5_ENABLE_VULKAN
-    if (vulkan_backend && vulkan_backend->is_initialized()) {
-        VkBufferUsageFlags vk_usage = 0;
-        if (usage_flags & 0x1) vk_usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        if (usage_flags & 0x2) vk_usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-        if (usage_flags & 0x4) vk_usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        if (usage_flags & 0x8) vk_usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-        
-        uint32_t vk_buffer_id = vulkan_backend->create_buffer(size, vk_usage, VMA_MEMORY_USAGE_GPU_ONLY);
-        if (vk_buffer_id != 0) {
-            GPUResource resource;
-            resource.address = reinterpret_cast<uint64_t>(vulkan_backend);
-            resource.size = size;
-            resource.format = 0;
-            resource.width = 0;
-            resource.height = 0;
-            resource.depth = 0;
-            resource.mip_levels = 0;
-            resource.resource_type = 0; // buffer
-            resource.compressed = false;
-            
-            uint32_t resource_id = next_resource_id++;
-            gpu_resources[resource_id] = resource;
-            
-            // Store Vulkan buffer ID in a mapping
-            vulkan_buffer_mapping_[resource_id] = vk_buffer_id;
-            
-            return resource_id;
-        }
+    if (vulkan_translator && !shader_cache[shader_id].spirv.empty()) {
+        vulkan_translator->on_shader_compiled(shader_id);
     }
 #endif
+    return shader_id;
+}
+
+GPU::CompiledShader* GPU::get_compiled_shader(uint32_t shader_id) {
+    auto it = shader_cache.find(shader_id);
+    return it != shader_cache.end() ? &it->second : nullptr;
+}
+
+uint64_t GPU::allocate_resource_memory(size_t size) {
+    // Page alignment (which also satisfies storage buffer offsets) keeps
+    // resources from sharing dirty-tracker pages, so mirroring one never
+    // leaves a neighbour's boundary page dirty
+    const uint64_t align = GPUDirtyTracker::PAGE_SIZE;
+    uint64_t address = (next_resource_address + align - 1) & ~(align - 1);
+    if (address + size > GPU_MEMORY_SIZE) {
+        return 0;
+    }
+    next_resource_address = address + size;
+    memory_allocations[address] = size;
+    return address;
+}
+
+GPU::GPUResource* GPU::get_resource(uint32_t resource_id) {
+    auto it = gpu_resources.find(resource_id);
+    return it != gpu_resources.end() ? &it->second : nullptr;
+}
+
+uint32_t GPU::create_buffer(size_t size, uint32_t usage_flags) {
+    // Buffers live in GPU memory; the Vulkan translator mirrors the pages a
+    // draw or dispatch actually touches, so no device buffer is created here
+    uint64_t address = allocate_resource_memory(size);
+    if (address == 0) {
+        return 0;
+    }
     
-    // Fallback to software implementation
     GPUResource resource;
-    resource.address = reinterpret_cast<uint64_t>(gpu_memory.get()) + memory_allocations.size() * 1024;
+    resource.address = address;
     resource.size = size;
     resource.format = 0;
     resource.width = 0;
@@ -1650,28 +1975,38 @@ uint32_t GPU::create_buffer(size_t size, uint32_t usage_flags) {
     
     uint32_t resource_id = next_resource_id++;
     gpu_resources[resource_id] = resource;
-    memory_allocations[resource.address] = size;
     
     return resource_id;
 }
 
+#ifdef PSX5_ENABLE_VULKAN
+static VkFormat texture_vk_format(uint32_t format) {
+    switch (format) {
+        case 2: return VK_FORMAT_B8G8R8A8_UNORM;
+        case 3: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case 4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        default: return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+#endif
+
 uint32_t GPU::create_texture(uint32_t width, uint32_t height, uint32_t format, uint32_t mip_levels) {
 #ifdef PSX5_ENABLE_VULKAN
     if (vulkan_backend && vulkan_backend->is_initialized()) {
-        VkFormat vk_format = VK_FORMAT_R8G8B8A8_UNORM; // Default format
-        switch (format) {
-            case 1: vk_format = VK_FORMAT_R8G8B8A8_UNORM; break;
-            case 2: vk_format = VK_FORMAT_B8G8R8A8_UNORM; break;
-            case 3: vk_format = VK_FORMAT_R16G16B16A16_SFLOAT; break;
-            case 4: vk_format = VK_FORMAT_R32G32B32A32_SFLOAT; break;
-        }
+        VkFormat vk_format = texture_vk_format(format);
         
         VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         
         uint32_t vk_image_id = vulkan_backend->create_image(width, height, vk_format, usage, VMA_MEMORY_USAGE_GPU_ONLY);
         if (vk_image_id != 0) {
+            uint64_t address = allocate_resource_memory(static_cast<size_t>(width) * height * 4);
+            if (address == 0) {
+                vulkan_backend->destroy_image(vk_image_id);
+                return 0;
+            }
+            
             GPUResource resource;
-            resource.address = reinterpret_cast<uint64_t>(vulkan_backend);
+            resource.address = address;
             resource.size = width * height * 4; // Approximate size
             resource.format = format;
             resource.width = width;
@@ -1694,9 +2029,13 @@ uint32_t GPU::create_texture(uint32_t width, uint32_t height, uint32_t format, u
     
     // Fallback to software implementation
     size_t texture_size = width * height * 4 * mip_levels; // Approximate
+    uint64_t address = allocate_resource_memory(texture_size);
+    if (address == 0) {
+        return 0;
+    }
     
     GPUResource resource;
-    resource.address = reinterpret_cast<uint64_t>(gpu_memory.get()) + memory_allocations.size() * 1024;
+    resource.address = address;
     resource.size = texture_size;
     resource.format = format;
     resource.width = width;
@@ -1708,24 +2047,69 @@ uint32_t GPU::create_texture(uint32_t width, uint32_t height, uint32_t format, u
     
     uint32_t resource_id = next_resource_id++;
     gpu_resources[resource_id] = resource;
-    memory_allocations[resource.address] = texture_size;
     
     return resource_id;
 }
 
+bool GPU::update_texture(uint32_t resource_id, const void* data, size_t size) {
+    GPUResource* resource = get_resource(resource_id);
+    if (!resource || resource->resource_type == 0 || !data) {
+        return false;
+    }
+    size = std::min(size, resource->size);
+    
+    uint8_t* dst = get_gpu_memory_ptr(resource->address);
+    if (!dst) {
+        return false;
+    }
+    std::memcpy(dst, data, size);
+    mark_gpu_memory_dirty(resource->address, size);
+    
+#ifdef PSX5_ENABLE_VULKAN
+    VulkanUploadManager* uploads = vulkan_backend && vulkan_backend->is_initialized()
+        ? vulkan_backend->get_upload_manager() : nullptr;
+    auto image_it = vulkan_image_mapping_.find(resource_id);
+    if (uploads && image_it != vulkan_image_mapping_.end()) {
+        // The current image may still be sampled by frames in flight, so the
+        // data streams into a fresh one that replaces it once it has arrived
+        uint32_t new_image = vulkan_backend->create_image(resource->width, resource->height,
+                                                          texture_vk_format(resource->format),
+                                                          VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                                          VMA_MEMORY_USAGE_GPU_ONLY);
+        if (new_image == 0) {
+            return false;
+        }
+        
+        VulkanBackend* backend = vulkan_backend;
+        bool queued = uploads->upload_image(vulkan_backend->get_image(new_image), VK_IMAGE_ASPECT_COLOR_BIT,
+                                            resource->width, resource->height, data, size,
+                                            [this, backend, resource_id, new_image]() {
+            auto it = vulkan_image_mapping_.find(resource_id);
+            if (it == vulkan_image_mapping_.end()) {
+                // Resource destroyed while the upload was in flight
+                backend->destroy_image(new_image);
+                return;
+            }
+            uint32_t old_image = it->second;
+            it->second = new_image;
+            backend->defer_until_retired([backend, old_image]() { backend->destroy_image(old_image); });
+        });
+        if (!queued) {
+            vulkan_backend->destroy_image(new_image);
+            return false;
+        }
+    }
+#endif
+    
+    return true;
+}
+
 void GPU::destroy_resource(uint32_t resource_id) {
     auto it = gpu_resources.find(resource_id);
     if (it == gpu_resources.end()) return;
     
 #ifdef PSX5_ENABLE_VULKAN
     if (vulkan_backend && vulkan_backend->is_initialized()) {
-        // Check if it's a Vulkan buffer
-        auto buffer_it = vulkan_buffer_mapping_.find(resource_id);
-        if (buffer_it != vulkan_buffer_mapping_.end()) {
-            vulkan_backend->destroy_buffer(buffer_it->second);
-            vulkan_buffer_mapping_.erase(buffer_it);
-        }
-        
         // Check if it's a Vulkan image
         auto image_it = vulkan_image_mapping_.find(resource_id);
         if (image_it != vulkan_image_mapping_.end()) {
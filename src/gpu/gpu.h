@@ -4,6 +4,11 @@
 #include <memory>
 #include <unordered_map>
 #include <array>
+#include "gpu_dma.h"
+#include "gpu_event_log.h"
+#include "gpu_dirty_tracker.h"
+#include "gpu_presenter.h"
+#include "gpu_capture.h"
 
 // RDNA2 GPU Architecture Emulation for PS5
 // Implements AMD RDNA2 compute units, graphics pipeline, and command processing
@@ -85,6 +90,8 @@ struct RDNA2RenderBackend {
 // Forward declaration for graphics pipeline integration
 class GraphicsPipeline;
 class ComputePipeline;
+class Memory;
+class Scheduler;
 
 class GPU {
 public:
@@ -132,6 +139,28 @@ public:
         UPDATE_CONSTANTS = 0x95,
     };
     
+    // Memory packet encodings (Command::arg3 for DMA_DATA / COPY_DATA / WRITE_DATA)
+    enum DMAControl : uint32_t {
+        DMA_SPACE_GPU = 0,          // address is an offset into GPU memory
+        DMA_SPACE_GUEST = 1,        // address is a guest virtual address
+        DMA_SRC_DATA = 2,           // DMA_DATA only: fill with the low 32 bits of arg0
+        DMA_SRC_SEL_MASK = 0x3,     // bits 0-1: source space
+        DMA_DST_SEL_SHIFT = 2,      // bits 2-3: destination space
+        DMA_ASYNC = 1u << 4,        // complete on a fence instead of inline
+    };
+    
+    // WAIT_REG_MEM compare functions (Command::arg3 bits 0-2), PM4 encoding
+    enum WaitFunction : uint32_t {
+        WAIT_ALWAYS = 0,
+        WAIT_LESS = 1,
+        WAIT_LESS_EQUAL = 2,
+        WAIT_EQUAL = 3,
+        WAIT_NOT_EQUAL = 4,
+        WAIT_GREATER_EQUAL = 5,
+        WAIT_GREATER = 6,
+    };
+    static constexpr uint32_t WAIT_MEM_SPACE_GUEST = 1u << 4; // arg3 bit 4
+    
     GPU();
     ~GPU();
     
@@ -150,6 +179,41 @@ public:
     void allocate_gpu_memory(uint64_t address, size_t size);
     void free_gpu_memory(uint64_t address);
     uint8_t* get_gpu_memory_ptr(uint64_t address);
+    // Like get_gpu_memory_ptr() but nullptr unless all `size` bytes fit
+    uint8_t* get_gpu_memory_span(uint64_t address, size_t size) {
+        return resolve_dma_address(address, size, DMA_SPACE_GPU, true);
+    }
+    
+    // Host integration for the DMA engine
+    void set_guest_memory(Memory* memory) { guest_memory = memory; }
+    void set_scheduler(Scheduler* sched);
+    GPUDMAEngine& get_dma_engine() { return dma_engine; }
+
+    // Command, draw and dispatch events; silent below Warn unless tracing
+    GPUEventLog& get_event_log() { return event_log; }
+    
+    // present() hands the bound color target to the presenter thread without
+    // copying it; attach a sink (swapchain, GUI view) to display frames
+    GPUPresenter& get_presenter() { return presenter; }
+    // Opens a window and makes its Vulkan swapchain the presenter's sink.
+    // False when Vulkan and GLFW are not compiled in or there is no surface
+    // to present to. Call from the main thread; the GPU closes it on
+    // destruction.
+    bool open_window(int width = 1280, int height = 720);
+    void close_window();
+    
+    // Frame capture. The frame `frames_ahead` presents from now is recorded
+    // from its first submit() up to present() and written to `path`.
+    void request_capture(const std::string& path, uint32_t frames_ahead = 0);
+    bool is_capture_pending() const { return !capture_path.empty(); }
+    // Puts the GPU back at a capture's starting point; submit its commands to
+    // replay the frame. Guest ranges need set_guest_memory() to cover them.
+    bool restore_capture(const GPUCapture& capture);
+
+    // Anything writing GPU memory through get_gpu_memory_ptr() must report
+    // the range so mirrored copies (Vulkan buffers, render targets) refresh
+    void mark_gpu_memory_dirty(uint64_t address, size_t size) { dirty_tracker.mark(address, size); }
+    GPUDirtyTracker& get_dirty_tracker() { return dirty_tracker; }
     
     struct GPUResource {
         uint64_t address;
@@ -163,9 +227,20 @@ public:
     
     uint32_t create_buffer(size_t size, uint32_t usage_flags);
     uint32_t create_texture(uint32_t width, uint32_t height, uint32_t format, uint32_t mip_levels);
+    // Replaces a texture's contents. Under Vulkan the data streams through the
+    // transfer queue and the texture switches over once it has arrived.
+    bool update_texture(uint32_t resource_id, const void* data, size_t size);
     void destroy_resource(uint32_t resource_id);
     GPUResource* get_resource(uint32_t resource_id);
     
+    // Vulkan translation. Draws and dispatches go to the translator when it
+    // can express them; otherwise (or when forced) the software path runs.
+    class VulkanTranslator* get_vulkan_translator() { return software_rendering ? nullptr : vulkan_translator; }
+    void set_software_rendering(bool enable);
+    // Submits pending translated work and waits for the device; results are
+    // written back to GPU memory
+    void sync_with_vulkan();
+    
     struct DescriptorSet {
         uint32_t set_id;
         std::unordered_map<uint32_t, uint32_t> texture_bindings; // binding -> resource_id
@@ -187,6 +262,7 @@ public:
         std::vector<uint32_t> sampler_bindings;
         std::vector<uint32_t> buffer_bindings;
         uint32_t constant_buffer_size;
+        std::vector<uint32_t> spirv; // original module, used by the Vulkan translator
     };
     
     uint32_t compile_shader(const std::vector<uint8_t>& shader_source, uint32_t shader_type);
@@ -202,6 +278,9 @@ public:
         uint64_t tiles_processed;
         uint64_t primitives_culled;
         uint64_t hierarchical_z_rejects;
+        uint64_t compute_workgroups;
+        uint64_t compute_waves;
+        uint64_t compute_instructions;
     } perf_counters;
     
     // Graphics pipeline interface methods
@@ -243,9 +322,15 @@ private:
     // GPU Memory (16GB GDDR6 in PS5)
     static constexpr size_t GPU_MEMORY_SIZE = 16ULL * 1024 * 1024 * 1024;
     std::unique_ptr<uint8_t[]> gpu_memory;
+    GPUDirtyTracker dirty_tracker{GPU_MEMORY_SIZE};
     std::unordered_map<uint64_t, size_t> memory_allocations;
     
     std::unordered_map<uint32_t, GPUResource> gpu_resources;
+    // Resources are carved from the upper half of GPU memory so every buffer
+    // and texture has a GPU address the translator can mirror
+    static constexpr uint64_t RESOURCE_HEAP_BASE = GPU_MEMORY_SIZE / 2;
+    uint64_t next_resource_address = RESOURCE_HEAP_BASE;
+    uint64_t allocate_resource_memory(size_t size);
     std::unordered_map<uint32_t, DescriptorSet> descriptor_sets;
     uint32_t next_resource_id = 1;
     uint32_t next_descriptor_set_id = 1;
@@ -303,6 +388,52 @@ private:
         uint32_t hierarchical_z_levels;
     } advanced_features;
     
+    GPUEventLog event_log;
+    GPUPresenter presenter;
+    
+    std::string capture_path;
+    uint32_t capture_frames_ahead = 0;
+    std::unique_ptr<GPUCapture> capture;     // frame being recorded
+    void begin_capture();
+    void capture_command(const Command& cmd);
+    void finish_capture();
+    std::vector<uint8_t> save_capture_state() const;
+    bool restore_capture_state(const std::vector<uint8_t>& state);
+
+    // Memory and synchronization packets
+    GPUDMAEngine dma_engine;
+    Memory* guest_memory = nullptr;
+    Scheduler* scheduler = nullptr;
+    static constexpr uint64_t WAIT_REG_MEM_TIMEOUT_US = 100000;
+    
+    // Guest ranges written by async transfers, reported to guest memory on
+    // the command thread once their fence completes
+    struct PendingGuestWrite {
+        uint64_t fence;
+        uint64_t address;
+        size_t size;
+    };
+    std::vector<PendingGuestWrite> pending_guest_writes;
+    
+    void execute_memory_command(const Command& cmd);
+    void execute_wait_reg_mem(const Command& cmd);
+    // Guest addresses go through Memory::host_span(), so they are translated
+    // and must carry read (or, for `write`, write) permission
+    uint8_t* resolve_dma_address(uint64_t address, size_t size, uint32_t space, bool write);
+    void retire_guest_writes();
+    
+    // Compute dispatch. Workgroups run as 64-lane waves with a private LDS
+    // allocation; waves of one group are interleaved at S_BARRIER.
+    static constexpr uint32_t WAVE_SIZE = 64;
+    static constexpr uint32_t MAX_WORKGROUP_SIZE = 1024;
+    static constexpr uint32_t COMPUTE_VGPR_COUNT = 256;
+    static constexpr uint32_t COMPUTE_SGPR_COUNT = 128;
+    static constexpr size_t COMPUTE_LDS_SIZE = 65536;
+    static constexpr uint32_t COMPUTE_MAX_INSTRUCTIONS = 1u << 20; // per wave, guards runaway shaders
+    struct ComputeWorkgroupContext;
+    uint64_t execute_workgroup(const CompiledShader& shader, const uint32_t group_id[3],
+                               const uint32_t group_size[3], ComputeWorkgroupContext& ctx);
+    
     // Internal processing functions
     void process_command_queue();
     void execute_shader_on_cu(RDNA2ComputeUnit& cu, const CompiledShader& shader);
@@ -317,10 +448,12 @@ private:
     
     // Vulkan backend integration
     class VulkanBackend* vulkan_backend;
-    void sync_with_vulkan();
+    class VulkanTranslator* vulkan_translator = nullptr;
+    class VulkanSwapchain* window_swapchain = nullptr;
+    struct GLFWwindow* window = nullptr;
+    bool software_rendering = false;
     
 #ifdef PSX5_ENABLE_VULKAN
-    std::unordered_map<uint32_t, uint32_t> vulkan_buffer_mapping_;  // resource_id -> vulkan_buffer_id
     std::unordered_map<uint32_t, uint32_t> vulkan_image_mapping_;   // resource_id -> vulkan_image_id
 #endif
 };
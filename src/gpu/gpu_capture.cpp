@@ -0,0 +1,466 @@
+#include "gpu_capture.h"
+#include "gpu.h"
+#include "../core/memory.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "vulkan_translator.h"
+#endif
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+
+namespace {
+
+// Upper bounds that reject corrupt files before allocating. Zero pages are
+// not stored, so a range can be larger than the rest of the file; all of
+// them together still have to fit in GPU and user memory.
+constexpr uint64_t MAX_RANGE_SIZE = 4ULL * 1024 * 1024 * 1024;
+constexpr uint64_t MAX_TOTAL_RANGE_SIZE = PS5_GPU_MEMORY_SIZE + PS5_USER_MEMORY_SIZE;
+constexpr uint32_t MAX_VECTOR_WORDS = 64 * 1024 * 1024;
+// Smallest on-disk record of each kind, to bound counts by the bytes left
+constexpr uint64_t MIN_SHADER_BYTES = 4 * sizeof(uint32_t) + 5 * sizeof(uint32_t);
+constexpr uint64_t RANGE_HEADER_BYTES = sizeof(uint32_t) + 2 * sizeof(uint64_t) + sizeof(uint32_t);
+constexpr uint64_t COMMAND_BYTES = sizeof(uint32_t) + 4 * sizeof(uint64_t);
+
+template <typename T>
+void write_pod(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& file, T& value) {
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return static_cast<bool>(file);
+}
+
+void write_words(std::ofstream& file, const std::vector<uint32_t>& words) {
+    write_pod(file, static_cast<uint32_t>(words.size()));
+    file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+}
+
+// Bytes between the read position and the end of the file
+uint64_t bytes_left(std::ifstream& file, uint64_t file_size) {
+    std::streamoff pos = file.tellg();
+    return pos < 0 || static_cast<uint64_t>(pos) > file_size ? 0 : file_size - static_cast<uint64_t>(pos);
+}
+
+// Reads a record count, rejecting one the rest of the file cannot hold
+bool read_count(std::ifstream& file, uint64_t file_size, uint64_t record_bytes, uint32_t& count) {
+    return read_pod(file, count) && count <= MAX_VECTOR_WORDS &&
+           count <= bytes_left(file, file_size) / record_bytes;
+}
+
+bool read_words(std::ifstream& file, uint64_t file_size, std::vector<uint32_t>& words) {
+    uint32_t count = 0;
+    if (!read_count(file, file_size, sizeof(uint32_t), count)) return false;
+    words.resize(count);
+    file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(count * sizeof(uint32_t)));
+    return static_cast<bool>(file);
+}
+
+bool page_is_zero(const uint8_t* data, size_t size) {
+    return std::all_of(data, data + size, [](uint8_t b) { return b == 0; });
+}
+
+// GPU state block: trivially copyable structs are stored as-is, maps as a
+// count followed by key/value pairs
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename Map>
+void put_map(std::vector<uint8_t>& out, const Map& map) {
+    put(out, static_cast<uint32_t>(map.size()));
+    for (const auto& [key, value] : map) {
+        put(out, key);
+        put(out, value);
+    }
+}
+
+struct StateReader {
+    const std::vector<uint8_t>& data;
+    size_t offset = 0;
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.size() - offset < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    template <typename Map>
+    bool get_map(Map& map) {
+        uint32_t count = 0;
+        if (!get(count)) return false;
+        map.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            typename Map::key_type key{};
+            typename Map::mapped_type value{};
+            if (!get(key) || !get(value)) return false;
+            map[key] = value;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool GPUCapture::covers(uint32_t space, uint64_t address, uint64_t size) const {
+    for (const auto& range : memory) {
+        if (range.space == space && address >= range.address &&
+            address + size <= range.address + range.data.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GPUCapture::save(const std::string& path) const {
+    std::string temp_path = path + ".tmp";
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "GPUCapture: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    file.write(MAGIC, sizeof(MAGIC));
+    write_pod(file, VERSION);
+    write_pod(file, frame_number);
+
+    write_pod(file, static_cast<uint32_t>(state.size()));
+    file.write(reinterpret_cast<const char*>(state.data()), static_cast<std::streamsize>(state.size()));
+
+    write_pod(file, static_cast<uint32_t>(shaders.size()));
+    for (const auto& shader : shaders) {
+        write_pod(file, shader.id);
+        write_pod(file, shader.shader_type);
+        write_pod(file, shader.resource_usage);
+        write_pod(file, shader.constant_buffer_size);
+        write_words(file, shader.bytecode);
+        write_words(file, shader.spirv);
+        write_words(file, shader.texture_bindings);
+        write_words(file, shader.sampler_bindings);
+        write_words(file, shader.buffer_bindings);
+    }
+
+    // Ranges: header, then (page index, page) for each non-zero page
+    write_pod(file, static_cast<uint32_t>(memory.size()));
+    for (const auto& range : memory) {
+        uint64_t size = range.data.size();
+        uint32_t page_count = static_cast<uint32_t>((size + PAGE_SIZE - 1) / PAGE_SIZE);
+        uint32_t stored = 0;
+        for (uint32_t page = 0; page < page_count; ++page) {
+            size_t offset = static_cast<size_t>(page) * PAGE_SIZE;
+            if (!page_is_zero(range.data.data() + offset, std::min<size_t>(PAGE_SIZE, size - offset))) {
+                stored++;
+            }
+        }
+        write_pod(file, range.space);
+        write_pod(file, range.address);
+        write_pod(file, size);
+        write_pod(file, stored);
+        for (uint32_t page = 0; page < page_count; ++page) {
+            size_t offset = static_cast<size_t>(page) * PAGE_SIZE;
+            size_t length = std::min<size_t>(PAGE_SIZE, size - offset);
+            if (page_is_zero(range.data.data() + offset, length)) continue;
+            write_pod(file, page);
+            file.write(reinterpret_cast<const char*>(range.data.data() + offset), static_cast<std::streamsize>(length));
+        }
+    }
+
+    write_pod(file, static_cast<uint32_t>(commands.size()));
+    for (const auto& cmd : commands) {
+        write_pod(file, cmd.opcode);
+        write_pod(file, cmd.arg0);
+        write_pod(file, cmd.arg1);
+        write_pod(file, cmd.arg2);
+        write_pod(file, cmd.arg3);
+    }
+
+    file.close();
+    if (!file) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    return !ec;
+}
+
+bool GPUCapture::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "GPUCapture: Cannot open " << path << std::endl;
+        return false;
+    }
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    char magic[8];
+    uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    if (!read_pod(file, version) || std::memcmp(magic, MAGIC, sizeof(magic)) != 0 || version != VERSION) {
+        std::cerr << "GPUCapture: " << path << " is not a version " << VERSION << " capture" << std::endl;
+        return false;
+    }
+
+    uint32_t count = 0;
+    if (!read_pod(file, frame_number) || !read_count(file, file_size, 1, count)) return false;
+    state.resize(count);
+    file.read(reinterpret_cast<char*>(state.data()), count);
+
+    if (!read_count(file, file_size, MIN_SHADER_BYTES, count)) return false;
+    shaders.assign(count, Shader{});
+    for (auto& shader : shaders) {
+        if (!read_pod(file, shader.id) || !read_pod(file, shader.shader_type) ||
+            !read_pod(file, shader.resource_usage) || !read_pod(file, shader.constant_buffer_size) ||
+            !read_words(file, file_size, shader.bytecode) || !read_words(file, file_size, shader.spirv) ||
+            !read_words(file, file_size, shader.texture_bindings) ||
+            !read_words(file, file_size, shader.sampler_bindings) ||
+            !read_words(file, file_size, shader.buffer_bindings)) {
+            return false;
+        }
+    }
+
+    if (!read_count(file, file_size, RANGE_HEADER_BYTES, count)) return false;
+    memory.assign(count, MemoryRange{});
+    uint64_t total_size = 0;
+    for (auto& range : memory) {
+        uint64_t size = 0;
+        uint32_t stored = 0;
+        if (!read_pod(file, range.space) || !read_pod(file, range.address) ||
+            !read_pod(file, size) || size > MAX_RANGE_SIZE || size > MAX_TOTAL_RANGE_SIZE - total_size) {
+            return false;
+        }
+        // Every stored page is an index plus up to a page of data
+        if (!read_count(file, file_size, sizeof(uint32_t) + 1, stored) ||
+            stored > (size + PAGE_SIZE - 1) / PAGE_SIZE) {
+            return false;
+        }
+        total_size += size;
+        range.data.assign(static_cast<size_t>(size), 0);
+        for (uint32_t i = 0; i < stored; ++i) {
+            uint32_t page = 0;
+            size_t offset = 0;
+            if (!read_pod(file, page) || (offset = static_cast<size_t>(page) * PAGE_SIZE) >= size) return false;
+            file.read(reinterpret_cast<char*>(range.data.data() + offset),
+                      static_cast<std::streamsize>(std::min<size_t>(PAGE_SIZE, size - offset)));
+        }
+    }
+
+    if (!read_count(file, file_size, COMMAND_BYTES, count)) return false;
+    commands.assign(count, Command{});
+    for (auto& cmd : commands) {
+        if (!read_pod(file, cmd.opcode) || !read_pod(file, cmd.arg0) || !read_pod(file, cmd.arg1) ||
+            !read_pod(file, cmd.arg2) || !read_pod(file, cmd.arg3)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GPU::request_capture(const std::string& path, uint32_t frames_ahead) {
+    capture_path = path;
+    capture_frames_ahead = frames_ahead;
+}
+
+void GPU::begin_capture() {
+    // Async copies from the previous frame must land before memory is read
+    dma_engine.wait_idle();
+    sync_with_vulkan();
+
+    capture = std::make_unique<GPUCapture>();
+    capture->frame_number = frame_state.frame_number;
+    capture->state = save_capture_state();
+
+    for (const auto& [id, compiled] : shader_cache) {
+        capture->shaders.push_back({id, compiled.shader_type, compiled.resource_usage, compiled.constant_buffer_size,
+                                    compiled.bytecode, compiled.spirv, compiled.texture_bindings,
+                                    compiled.sampler_bindings, compiled.buffer_bindings});
+    }
+
+    auto add_range = [this](uint64_t address, uint64_t size) {
+        const uint8_t* src = resolve_dma_address(address, size, DMA_SPACE_GPU, false);
+        if (size == 0 || !src || capture->covers(GPUCapture::SPACE_GPU, address, size)) {
+            return;
+        }
+        capture->memory.push_back({GPUCapture::SPACE_GPU, address, std::vector<uint8_t>(src, src + size)});
+    };
+    for (const auto& [address, size] : memory_allocations) {
+        add_range(address, size);
+    }
+    for (const auto& backend : render_backends) {
+        for (uint32_t i = 0; i < backend.color_targets.size(); ++i) {
+            const auto& target = backend.color_targets[i];
+            if (frame_state.active_render_targets & (1u << i)) {
+                add_range(target.base_address, static_cast<uint64_t>(target.pitch) * target.height);
+            }
+        }
+        if (frame_state.depth_target_bound) {
+            const auto& depth = backend.depth_target;
+            uint64_t pitch = depth.pitch ? depth.pitch : static_cast<uint64_t>(depth.width) * 4;
+            add_range(depth.base_address, pitch * depth.height);
+        }
+    }
+}
+
+void GPU::capture_command(const Command& cmd) {
+    capture->commands.push_back({cmd.opcode, cmd.arg0, cmd.arg1, cmd.arg2, cmd.arg3});
+
+    // Memory the frame reads is taken the first time it is touched, before
+    // the command runs; guest memory only exists in the capture this way
+    uint64_t address = 0;
+    uint64_t size = 0;
+    uint32_t space = DMA_SPACE_GPU;
+    if (cmd.opcode == DMA_DATA || cmd.opcode == COPY_DATA) {
+        space = static_cast<uint32_t>(cmd.arg3) & DMA_SRC_SEL_MASK;
+        if (space == DMA_SRC_DATA) {
+            return;
+        }
+        address = cmd.arg0;
+        size = cmd.arg2;
+    } else if (cmd.opcode == WAIT_REG_MEM) {
+        space = (cmd.arg3 & WAIT_MEM_SPACE_GUEST) ? DMA_SPACE_GUEST : DMA_SPACE_GPU;
+        address = cmd.arg0;
+        size = sizeof(uint32_t);
+    } else {
+        return;
+    }
+
+    uint32_t capture_space = space == DMA_SPACE_GUEST ? GPUCapture::SPACE_GUEST : GPUCapture::SPACE_GPU;
+    if (size == 0 || capture->covers(capture_space, address, size)) {
+        return;
+    }
+    // The source of an async copy may still be written by an earlier one
+    dma_engine.wait_idle();
+    const uint8_t* src = resolve_dma_address(address, size, space, false);
+    if (src) {
+        capture->memory.push_back({capture_space, address, std::vector<uint8_t>(src, src + size)});
+    }
+}
+
+void GPU::finish_capture() {
+    std::sort(capture->memory.begin(), capture->memory.end(),
+              [](const auto& a, const auto& b) { return std::tie(a.space, a.address) < std::tie(b.space, b.address); });
+    if (capture->save(capture_path)) {
+        std::cout << "GPU: Captured frame " << capture->frame_number << " (" << capture->commands.size()
+                  << " commands, " << capture->memory.size() << " memory ranges) to " << capture_path << std::endl;
+    } else {
+        std::cerr << "GPU: Failed to write capture " << capture_path << std::endl;
+    }
+    capture.reset();
+    capture_path.clear();
+}
+
+bool GPU::restore_capture(const GPUCapture& source) {
+    dma_engine.wait_idle();
+    sync_with_vulkan();
+
+    if (!restore_capture_state(source.state)) {
+        std::cerr << "GPU: Capture state block does not match this build" << std::endl;
+        return false;
+    }
+
+    for (const auto& shader : source.shaders) {
+        CompiledShader compiled{};
+        compiled.shader_type = shader.shader_type;
+        compiled.resource_usage = shader.resource_usage;
+        compiled.constant_buffer_size = shader.constant_buffer_size;
+        compiled.bytecode = shader.bytecode;
+        compiled.spirv = shader.spirv;
+        compiled.texture_bindings = shader.texture_bindings;
+        compiled.sampler_bindings = shader.sampler_bindings;
+        compiled.buffer_bindings = shader.buffer_bindings;
+        bool is_new = shader_cache.find(shader.id) == shader_cache.end();
+        shader_cache[shader.id] = std::move(compiled);
+        next_shader_id = std::max(next_shader_id, shader.id + 1);
+#ifdef PSX5_ENABLE_VULKAN
+        if (is_new && vulkan_translator && !shader.spirv.empty()) {
+            vulkan_translator->on_shader_compiled(shader.id);
+        }
+#else
+        (void)is_new;
+#endif
+    }
+
+    for (const auto& range : source.memory) {
+        uint32_t space = range.space == GPUCapture::SPACE_GUEST ? DMA_SPACE_GUEST : DMA_SPACE_GPU;
+        uint8_t* dst = resolve_dma_address(range.address, range.data.size(), space, true);
+        if (!dst) {
+            std::cerr << "GPU: Capture range 0x" << std::hex << range.address << std::dec
+                      << " (" << range.data.size() << " bytes) is outside "
+                      << (space == DMA_SPACE_GUEST ? "guest" : "GPU") << " memory" << std::endl;
+            return false;
+        }
+        std::memcpy(dst, range.data.data(), range.data.size());
+        if (space == DMA_SPACE_GPU) {
+            memory_allocations.emplace(range.address, range.data.size());
+            dirty_tracker.mark(range.address, range.data.size());
+        } else {
+            guest_memory->span_written(range.address, range.data.size());
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> GPU::save_capture_state() const {
+    std::vector<uint8_t> out;
+    put(out, graphics_state);
+    put(out, compute_state);
+    for (const auto& backend : render_backends) {
+        put(out, backend.color_targets);
+        put(out, backend.depth_target);
+    }
+    put(out, frame_state.active_render_targets);
+    put(out, frame_state.depth_target_bound);
+    put_map(out, gpu_resources);
+
+    put(out, static_cast<uint32_t>(descriptor_sets.size()));
+    for (const auto& [id, set] : descriptor_sets) {
+        put(out, id);
+        put(out, set.set_id);
+        put_map(out, set.texture_bindings);
+        put_map(out, set.sampler_bindings);
+        put_map(out, set.buffer_bindings);
+        put_map(out, set.constant_data);
+    }
+    return out;
+}
+
+bool GPU::restore_capture_state(const std::vector<uint8_t>& state) {
+    StateReader in{state};
+    GraphicsState graphics{};
+    ComputeState compute{};
+    if (!in.get(graphics) || !in.get(compute)) return false;
+    for (auto& backend : render_backends) {
+        if (!in.get(backend.color_targets) || !in.get(backend.depth_target)) return false;
+    }
+    if (!in.get(frame_state.active_render_targets) || !in.get(frame_state.depth_target_bound) ||
+        !in.get_map(gpu_resources)) {
+        return false;
+    }
+
+    uint32_t set_count = 0;
+    if (!in.get(set_count)) return false;
+    descriptor_sets.clear();
+    for (uint32_t i = 0; i < set_count; ++i) {
+        uint32_t id = 0;
+        DescriptorSet set{};
+        if (!in.get(id) || !in.get(set.set_id) || !in.get_map(set.texture_bindings) ||
+            !in.get_map(set.sampler_bindings) || !in.get_map(set.buffer_bindings) ||
+            !in.get_map(set.constant_data)) {
+            return false;
+        }
+        descriptor_sets[id] = std::move(set);
+    }
+
+    graphics_state = graphics;
+    compute_state = compute;
+    return in.offset == state.size();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPU frame capture
+// One frame's command stream plus everything it starts from: the GPU's
+// fixed-function state, the shaders it has compiled, the contents of every
+// GPU allocation and bound render target, and the guest memory read by the
+// frame's DMA packets. Replaying restores all of it and resubmits the
+// commands, so the frame runs the same way every time without the game.
+//
+// On disk, memory ranges are stored as 4 KiB pages and all-zero pages are
+// left out; most of a frame's allocations are untouched or cleared.
+struct GPUCapture {
+    static constexpr char MAGIC[8] = {'P', 'S', 'X', '5', 'G', 'C', 'A', 'P'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    struct Command {
+        uint32_t opcode;
+        uint64_t arg0;
+        uint64_t arg1;
+        uint64_t arg2;
+        uint64_t arg3;
+    };
+
+    struct Shader {
+        uint32_t id;
+        uint32_t shader_type;
+        uint32_t resource_usage;
+        uint32_t constant_buffer_size;
+        std::vector<uint32_t> bytecode;
+        std::vector<uint32_t> spirv;
+        std::vector<uint32_t> texture_bindings;
+        std::vector<uint32_t> sampler_bindings;
+        std::vector<uint32_t> buffer_bindings;
+    };
+
+    enum MemorySpace : uint32_t { SPACE_GPU = 0, SPACE_GUEST = 1 };
+
+    struct MemoryRange {
+        uint32_t space;
+        uint64_t address;
+        std::vector<uint8_t> data;
+    };
+
+    uint64_t frame_number = 0;
+    std::vector<uint8_t> state;          // GPU state block, layout owned by GPU
+    std::vector<Shader> shaders;
+    std::vector<MemoryRange> memory;     // contents at the start of the frame
+    std::vector<Command> commands;
+
+    // True if [address, address + size) in `space` is already captured
+    bool covers(uint32_t space, uint64_t address, uint64_t size) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
@@ -0,0 +1,338 @@
+#include "gpu.h"
+#include "../core/scheduler.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "vulkan_translator.h"
+#endif
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+// Compute dispatch
+// Every workgroup of a dispatch is executed. Workgroups are split into
+// batches that run on the scheduler workers; inside a workgroup the threads
+// are packed into 64-lane waves which share one LDS allocation and are
+// interleaved cooperatively at S_BARRIER.
+//
+// Compute ISA (same field layout as execute_shader_on_cu):
+//   [31:26] opcode  [23:16] dst  [15:8] src1  [7:0] src0
+//   0x01 V_ADD_F32           v[dst] = v[src0] + v[src1]
+//   0x02 V_MUL_F32           v[dst] = v[src0] * v[src1]
+//   0x03 V_MAD_F32           v[dst] = v[src0] * v[src1] + v[dst]
+//   0x05 V_MOV_B32           v[dst] = v[src0]
+//   0x06 V_ADD_U32           v[dst] = v[src0] + v[src1]
+//   0x07 V_LSHLREV_B32       v[dst] = v[src1] << src0
+//   0x08 V_MOV_B32_SGPR      v[dst] = s[src0]
+//   0x10 S_LOAD_DWORD        s[dst] = mem[s[src0+1]:s[src0] + s[src1]]
+//   0x11 BUFFER_LOAD_DWORD   v[dst] = mem[s[src1+1]:s[src1] + v[src0]]
+//   0x12 BUFFER_STORE_DWORD  mem[s[src1+1]:s[src1] + v[src0]] = v[dst]
+//   0x18 DS_READ_B32         v[dst] = lds[v[src0]]
+//   0x19 DS_WRITE_B32        lds[v[src0]] = v[dst]
+//   0x1A S_BARRIER
+//   0x3F S_ENDPGM
+//
+// Initial state: v0-v2 = local id xyz, v3 = local linear id,
+// s0-s2 = workgroup id xyz, s4:s5 = constant buffer address.
+
+struct GPU::ComputeWorkgroupContext {
+    struct Wave {
+        uint32_t pc;
+        uint64_t exec_mask;
+        bool done;
+        bool at_barrier;
+        uint64_t executed;
+        std::vector<uint32_t> vgprs; // COMPUTE_VGPR_COUNT * WAVE_SIZE, register-major
+        std::array<uint32_t, COMPUTE_SGPR_COUNT> sgprs;
+    };
+
+    std::vector<Wave> waves;
+    std::vector<uint8_t> lds;
+};
+
+namespace {
+
+inline float as_float(uint32_t v) { float f; std::memcpy(&f, &v, 4); return f; }
+inline uint32_t as_uint(float f) { uint32_t v; std::memcpy(&v, &f, 4); return v; }
+
+} // namespace
+
+void GPU::dispatch_compute_shader(uint32_t group_x, uint32_t group_y, uint32_t group_z) {
+    event_log.record(GPULogLevel::Debug, GPUEvent::Dispatch, group_x, group_y, group_z);
+
+    if (compute_state.compute_shader_id == 0) {
+        event_log.record(GPULogLevel::Warn, GPUEvent::DispatchError, 0);
+        return;
+    }
+
+    const CompiledShader* compute_shader = get_compiled_shader(compute_state.compute_shader_id);
+    if (!compute_shader) {
+        event_log.record(GPULogLevel::Warn, GPUEvent::DispatchError, 1, compute_state.compute_shader_id);
+        return;
+    }
+
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = get_vulkan_translator()) {
+        if (translator->dispatch(compute_state.compute_shader_id, group_x, group_y, group_z)) {
+            perf_counters.compute_dispatches++;
+            return;
+        }
+        // The software path works on GPU memory directly; retire translated work first
+        if (translator->has_pending_work()) {
+            translator->flush();
+        }
+    }
+#endif
+
+    uint32_t group_size[3] = {
+        std::max(1u, compute_state.thread_group_size[0]),
+        std::max(1u, compute_state.thread_group_size[1]),
+        std::max(1u, compute_state.thread_group_size[2]),
+    };
+    uint64_t threads_per_group = static_cast<uint64_t>(group_size[0]) * group_size[1] * group_size[2];
+    if (threads_per_group > MAX_WORKGROUP_SIZE) {
+        event_log.record(GPULogLevel::Error, GPUEvent::DispatchError, 2, threads_per_group);
+        return;
+    }
+
+    uint64_t total_groups = static_cast<uint64_t>(group_x) * group_y * group_z;
+    if (total_groups == 0) {
+        return;
+    }
+
+    bool parallel = scheduler && scheduler->is_running() && total_groups > 1;
+    size_t lanes = parallel ? scheduler->get_worker_count() + 1 : 1;
+    // A few batches per worker keeps the tail short when groups are uneven
+    size_t batch_count = static_cast<size_t>(std::min<uint64_t>(total_groups, lanes * 4));
+
+    std::atomic<uint64_t> instructions{0};
+    uint64_t groups_xy = static_cast<uint64_t>(group_x) * group_y;
+
+    auto run_batch = [&](size_t batch) {
+        static thread_local ComputeWorkgroupContext ctx;
+        uint64_t begin = total_groups * batch / batch_count;
+        uint64_t end = total_groups * (batch + 1) / batch_count;
+        uint64_t executed = 0;
+
+        for (uint64_t linear = begin; linear < end; ++linear) {
+            uint32_t group_id[3] = {
+                static_cast<uint32_t>(linear % group_x),
+                static_cast<uint32_t>((linear / group_x) % group_y),
+                static_cast<uint32_t>(linear / groups_xy),
+            };
+            executed += execute_workgroup(*compute_shader, group_id, group_size, ctx);
+        }
+        instructions.fetch_add(executed, std::memory_order_relaxed);
+    };
+
+    if (parallel) {
+        scheduler->parallel_for(batch_count, run_batch);
+    } else {
+        for (size_t batch = 0; batch < batch_count; ++batch) {
+            run_batch(batch);
+        }
+    }
+
+    uint64_t waves_per_group = (threads_per_group + WAVE_SIZE - 1) / WAVE_SIZE;
+    perf_counters.compute_workgroups += total_groups;
+    perf_counters.compute_waves += total_groups * waves_per_group;
+    perf_counters.compute_instructions += instructions.load();
+    perf_counters.compute_dispatches++;
+}
+
+uint64_t GPU::execute_workgroup(const CompiledShader& shader, const uint32_t group_id[3],
+                                const uint32_t group_size[3], ComputeWorkgroupContext& ctx) {
+    uint32_t thread_count = group_size[0] * group_size[1] * group_size[2];
+    uint32_t wave_count = (thread_count + WAVE_SIZE - 1) / WAVE_SIZE;
+
+    if (ctx.waves.size() < wave_count) {
+        ctx.waves.resize(wave_count);
+    }
+    if (ctx.lds.size() != COMPUTE_LDS_SIZE) {
+        // LDS contents are undefined at workgroup launch, so it is not cleared between groups
+        ctx.lds.assign(COMPUTE_LDS_SIZE, 0);
+    }
+
+    for (uint32_t w = 0; w < wave_count; ++w) {
+        auto& wave = ctx.waves[w];
+        wave.pc = 0;
+        wave.done = false;
+        wave.at_barrier = false;
+        wave.executed = 0;
+        if (wave.vgprs.size() != static_cast<size_t>(COMPUTE_VGPR_COUNT) * WAVE_SIZE) {
+            wave.vgprs.assign(static_cast<size_t>(COMPUTE_VGPR_COUNT) * WAVE_SIZE, 0);
+        }
+        wave.sgprs.fill(0);
+
+        uint32_t first_thread = w * WAVE_SIZE;
+        uint32_t lanes = std::min(WAVE_SIZE, thread_count - first_thread);
+        wave.exec_mask = lanes == 64 ? ~0ULL : ((1ULL << lanes) - 1);
+
+        for (uint32_t lane = 0; lane < lanes; ++lane) {
+            uint32_t local = first_thread + lane;
+            wave.vgprs[0 * WAVE_SIZE + lane] = local % group_size[0];
+            wave.vgprs[1 * WAVE_SIZE + lane] = (local / group_size[0]) % group_size[1];
+            wave.vgprs[2 * WAVE_SIZE + lane] = local / (group_size[0] * group_size[1]);
+            wave.vgprs[3 * WAVE_SIZE + lane] = local;
+        }
+
+        wave.sgprs[0] = group_id[0];
+        wave.sgprs[1] = group_id[1];
+        wave.sgprs[2] = group_id[2];
+        wave.sgprs[4] = static_cast<uint32_t>(compute_state.constant_buffer_address);
+        wave.sgprs[5] = static_cast<uint32_t>(compute_state.constant_buffer_address >> 32);
+    }
+
+    const size_t code_size = shader.bytecode.size();
+    uint8_t* memory = gpu_memory.get();
+    uint8_t* lds = ctx.lds.data();
+
+    // Run every wave up to its next barrier, then release the barrier; repeat
+    // until all waves have ended.
+    uint32_t remaining = wave_count;
+    while (remaining > 0) {
+        for (uint32_t w = 0; w < wave_count; ++w) {
+            auto& wave = ctx.waves[w];
+            if (wave.done) continue;
+
+            uint32_t* v = wave.vgprs.data();
+            auto& s = wave.sgprs;
+            const uint64_t exec = wave.exec_mask;
+
+            while (!wave.at_barrier && !wave.done) {
+                if (wave.pc >= code_size || wave.executed >= COMPUTE_MAX_INSTRUCTIONS) {
+                    wave.done = true;
+                    break;
+                }
+
+                uint32_t instruction = shader.bytecode[wave.pc++];
+                wave.executed++;
+
+                uint32_t opcode = (instruction >> 26) & 0x3F;
+                uint32_t src0 = (instruction >> 0) & 0xFF;
+                uint32_t src1 = (instruction >> 8) & 0xFF;
+                uint32_t dst = (instruction >> 16) & 0xFF;
+
+                uint32_t* vd = v + dst * WAVE_SIZE;
+                const uint32_t* v0 = v + src0 * WAVE_SIZE;
+                const uint32_t* v1 = v + src1 * WAVE_SIZE;
+
+                switch (opcode) {
+                    case 0x01: // V_ADD_F32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) vd[lane] = as_uint(as_float(v0[lane]) + as_float(v1[lane]));
+                        }
+                        break;
+
+                    case 0x02: // V_MUL_F32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) vd[lane] = as_uint(as_float(v0[lane]) * as_float(v1[lane]));
+                        }
+                        break;
+
+                    case 0x03: // V_MAD_F32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) {
+                                vd[lane] = as_uint(as_float(v0[lane]) * as_float(v1[lane]) + as_float(vd[lane]));
+                            }
+                        }
+                        break;
+
+                    case 0x05: // V_MOV_B32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) vd[lane] = v0[lane];
+                        }
+                        break;
+
+                    case 0x06: // V_ADD_U32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) vd[lane] = v0[lane] + v1[lane];
+                        }
+                        break;
+
+                    case 0x07: // V_LSHLREV_B32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if (exec & (1ULL << lane)) vd[lane] = v1[lane] << (src0 & 31);
+                        }
+                        break;
+
+                    case 0x08: // V_MOV_B32_SGPR
+                        if (src0 < COMPUTE_SGPR_COUNT) {
+                            for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                                if (exec & (1ULL << lane)) vd[lane] = s[src0];
+                            }
+                        }
+                        break;
+
+                    case 0x10: // S_LOAD_DWORD
+                        if (src0 + 1 < COMPUTE_SGPR_COUNT && src1 < COMPUTE_SGPR_COUNT && dst < COMPUTE_SGPR_COUNT) {
+                            uint64_t address = ((static_cast<uint64_t>(s[src0 + 1]) << 32) | s[src0]) + s[src1];
+                            if (address + 4 <= GPU_MEMORY_SIZE) {
+                                std::memcpy(&s[dst], memory + address, 4);
+                            }
+                        }
+                        break;
+
+                    case 0x11: // BUFFER_LOAD_DWORD
+                    case 0x12: // BUFFER_STORE_DWORD
+                        if (src1 + 1 < COMPUTE_SGPR_COUNT) {
+                            uint64_t base = (static_cast<uint64_t>(s[src1 + 1]) << 32) | s[src1];
+                            for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                                if (!(exec & (1ULL << lane))) continue;
+                                uint64_t address = base + v0[lane];
+                                if (address + 4 > GPU_MEMORY_SIZE) continue;
+                                if (opcode == 0x11) {
+                                    std::memcpy(&vd[lane], memory + address, 4);
+                                } else {
+                                    std::memcpy(memory + address, &vd[lane], 4);
+                                    dirty_tracker.mark(address, 4);
+                                }
+                            }
+                        }
+                        break;
+
+                    case 0x18: // DS_READ_B32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if ((exec & (1ULL << lane)) && v0[lane] + 4ULL <= COMPUTE_LDS_SIZE) {
+                                std::memcpy(&vd[lane], lds + v0[lane], 4);
+                            }
+                        }
+                        break;
+
+                    case 0x19: // DS_WRITE_B32
+                        for (uint32_t lane = 0; lane < WAVE_SIZE; ++lane) {
+                            if ((exec & (1ULL << lane)) && v0[lane] + 4ULL <= COMPUTE_LDS_SIZE) {
+                                std::memcpy(lds + v0[lane], &vd[lane], 4);
+                            }
+                        }
+                        break;
+
+                    case 0x1A: // S_BARRIER
+                        wave.at_barrier = true;
+                        break;
+
+                    case 0x3F: // S_ENDPGM
+                        wave.done = true;
+                        break;
+
+                    default:
+                        // Unknown instruction - skip
+                        break;
+                }
+            }
+
+            if (wave.done) {
+                remaining--;
+            }
+        }
+
+        // Every live wave is parked at the barrier (or has ended): release it
+        for (uint32_t w = 0; w < wave_count; ++w) {
+            ctx.waves[w].at_barrier = false;
+        }
+    }
+
+    uint64_t executed = 0;
+    for (uint32_t w = 0; w < wave_count; ++w) {
+        executed += ctx.waves[w].executed;
+    }
+    return executed;
+}
@@ -0,0 +1,190 @@
+#include "gpu_dirty_tracker.h"
+#include <algorithm>
+
+namespace {
+
+// Bits [first, last] of a 64-bit word
+inline uint64_t bit_range(uint32_t first, uint32_t last) {
+    uint64_t high = last == 63 ? ~0ULL : ((1ULL << (last + 1)) - 1);
+    return high & ~((1ULL << first) - 1);
+}
+
+} // namespace
+
+GPUDirtyTracker::GPUDirtyTracker(uint64_t memory_size)
+    : memory_size_(memory_size) {
+    uint64_t pages = (memory_size + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    word_count_ = static_cast<size_t>((pages + 63) / 64);
+    words_.reset(new std::atomic<uint64_t>[word_count_]);
+    for (size_t i = 0; i < word_count_; ++i) {
+        words_[i].store(0, std::memory_order_relaxed);
+    }
+    page_generations_.reset(new std::atomic<uint64_t>[word_count_ * 64]);
+    for (size_t i = 0; i < word_count_ * 64; ++i) {
+        page_generations_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool GPUDirtyTracker::clip(uint64_t& address, uint64_t& size) const {
+    if (size == 0 || address >= memory_size_) {
+        return false;
+    }
+    size = std::min(size, memory_size_ - address);
+    return true;
+}
+
+void GPUDirtyTracker::mark(uint64_t address, uint64_t size) {
+    if (!clip(address, size)) return;
+
+    uint64_t first_page = address >> PAGE_SHIFT;
+    uint64_t last_page = (address + size - 1) >> PAGE_SHIFT;
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+
+    for (uint64_t word = first_page / 64; word <= last_page / 64; ++word) {
+        uint32_t lo = word == first_page / 64 ? static_cast<uint32_t>(first_page % 64) : 0;
+        uint32_t hi = word == last_page / 64 ? static_cast<uint32_t>(last_page % 64) : 63;
+        uint64_t mask = bit_range(lo, hi);
+        for (uint64_t page = word * 64 + lo; page <= word * 64 + hi; ++page) {
+            if (page_generations_[page].load(std::memory_order_relaxed) != generation) {
+                page_generations_[page].store(generation, std::memory_order_release);
+            }
+        }
+        // Skip the RMW when the pages are already dirty; repeated small writes
+        // to the same page are the common case
+        if ((words_[word].load(std::memory_order_relaxed) & mask) != mask) {
+            words_[word].fetch_or(mask, std::memory_order_release);
+        }
+    }
+}
+
+void GPUDirtyTracker::mark_all() {
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < word_count_ * 64; ++i) {
+        page_generations_[i].store(generation, std::memory_order_release);
+    }
+    for (size_t i = 0; i < word_count_; ++i) {
+        words_[i].store(~0ULL, std::memory_order_release);
+    }
+}
+
+bool GPUDirtyTracker::is_dirty(uint64_t address, uint64_t size) const {
+    if (!clip(address, size)) return false;
+
+    uint64_t first_page = address >> PAGE_SHIFT;
+    uint64_t last_page = (address + size - 1) >> PAGE_SHIFT;
+
+    for (uint64_t word = first_page / 64; word <= last_page / 64; ++word) {
+        uint32_t lo = word == first_page / 64 ? static_cast<uint32_t>(first_page % 64) : 0;
+        uint32_t hi = word == last_page / 64 ? static_cast<uint32_t>(last_page % 64) : 63;
+        if (words_[word].load(std::memory_order_acquire) & bit_range(lo, hi)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t GPUDirtyTracker::collect_and_clear(uint64_t address, uint64_t size, std::vector<Range>& out) {
+    if (!clip(address, size)) return 0;
+
+    const uint64_t end = address + size;
+    uint64_t first_page = address >> PAGE_SHIFT;
+    uint64_t last_page = (end - 1) >> PAGE_SHIFT;
+    uint64_t collected = 0;
+
+    // Pages the range only partly covers are reported but stay dirty: the
+    // rest of such a page may belong to another consumer that has not seen
+    // the write yet
+    uint64_t page_end = std::min((last_page + 1) << PAGE_SHIFT, memory_size_);
+    uint64_t clear_first = first_page + ((address & (PAGE_SIZE - 1)) != 0);
+    uint64_t clear_last = last_page - (page_end > end);   // may wrap below clear_first
+
+    bool in_run = false;
+    uint64_t run_start = 0;
+
+    auto close_run = [&](uint64_t run_end_page) {
+        uint64_t begin = std::max(run_start << PAGE_SHIFT, address);
+        uint64_t finish = std::min(run_end_page << PAGE_SHIFT, end);
+        out.push_back({begin, finish - begin});
+        collected += finish - begin;
+        in_run = false;
+    };
+
+    for (uint64_t word = first_page / 64; word <= last_page / 64; ++word) {
+        uint32_t lo = word == first_page / 64 ? static_cast<uint32_t>(first_page % 64) : 0;
+        uint32_t hi = word == last_page / 64 ? static_cast<uint32_t>(last_page % 64) : 63;
+        uint64_t mask = bit_range(lo, hi);
+
+        uint64_t clear_mask = 0;
+        uint64_t word_first = word * 64 + lo;
+        uint64_t word_last = word * 64 + hi;
+        if (clear_last != ~0ULL && clear_first <= clear_last &&
+            clear_first <= word_last && word_first <= clear_last) {
+            clear_mask = bit_range(static_cast<uint32_t>(std::max(clear_first, word_first) - word * 64),
+                                   static_cast<uint32_t>(std::min(clear_last, word_last) - word * 64));
+        }
+
+        uint64_t bits = words_[word].load(std::memory_order_acquire) & mask;
+        if (bits & clear_mask) {
+            bits = words_[word].fetch_and(~clear_mask, std::memory_order_acq_rel) & mask;
+        }
+
+        if (bits == 0) {
+            if (in_run) close_run(word * 64 + lo);
+            continue;
+        }
+
+        for (uint32_t bit = lo; bit <= hi; ++bit) {
+            uint64_t page = word * 64 + bit;
+            bool dirty = (bits >> bit) & 1;
+            if (dirty && !in_run) {
+                in_run = true;
+                run_start = page;
+            } else if (!dirty && in_run) {
+                close_run(page);
+            }
+        }
+    }
+
+    if (in_run) {
+        close_run(last_page + 1);
+    }
+    return collected;
+}
+
+uint64_t GPUDirtyTracker::next_generation() {
+    return generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool GPUDirtyTracker::written_since(uint64_t address, uint64_t size, uint64_t generation) const {
+    if (!clip(address, size)) return false;
+
+    uint64_t last_page = (address + size - 1) >> PAGE_SHIFT;
+    for (uint64_t page = address >> PAGE_SHIFT; page <= last_page; ++page) {
+        if (page_generations_[page].load(std::memory_order_acquire) > generation) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GPUDirtyTracker::collect_written_since(uint64_t address, uint64_t size, uint64_t generation,
+                                            std::vector<Range>& out) const {
+    if (!clip(address, size)) return;
+
+    const uint64_t end = address + size;
+    uint64_t last_page = (end - 1) >> PAGE_SHIFT;
+    bool in_run = false;
+    uint64_t run_start = 0;
+    for (uint64_t page = address >> PAGE_SHIFT; page <= last_page + 1; ++page) {
+        bool written = page <= last_page && page_generations_[page].load(std::memory_order_acquire) > generation;
+        if (written && !in_run) {
+            in_run = true;
+            run_start = page;
+        } else if (!written && in_run) {
+            uint64_t begin = std::max(run_start << PAGE_SHIFT, address);
+            uint64_t finish = std::min(page << PAGE_SHIFT, end);
+            out.push_back({begin, finish - begin});
+            in_run = false;
+        }
+    }
+}
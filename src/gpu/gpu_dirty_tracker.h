@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Page-granular dirty tracking for GPU memory
+// Writers (DMA, WRITE_DATA, software compute stores, host uploads) mark the
+// pages they touch. Consumers that mirror GPU memory elsewhere (the Vulkan
+// translator) collect and clear the dirty runs of the range they are about
+// to use, so only modified pages are re-uploaded.
+//
+// Each page also records the generation of its last write (8 bytes per
+// page). A consumer that keeps a copy of a range not aligned to pages cannot
+// clear the pages it shares with a neighbour, so it remembers the generation
+// it copied at and asks whether anything was written since. Results written
+// back from a copy skip the pages written after it was taken.
+class GPUDirtyTracker {
+public:
+    static constexpr uint32_t PAGE_SHIFT = 12;
+    static constexpr uint64_t PAGE_SIZE = 1ULL << PAGE_SHIFT;
+
+    struct Range {
+        uint64_t address;
+        uint64_t size;
+    };
+
+    explicit GPUDirtyTracker(uint64_t memory_size);
+
+    void mark(uint64_t address, uint64_t size);
+    void mark_all();
+    bool is_dirty(uint64_t address, uint64_t size) const;
+
+    // Appends the dirty page runs inside [address, address + size) to `out`
+    // and clears them. Runs are clipped to the requested range, and a page
+    // the range covers only in part is reported but left dirty, since the
+    // rest of it may back another consumer. Returns the number of dirty
+    // bytes collected.
+    uint64_t collect_and_clear(uint64_t address, uint64_t size, std::vector<Range>& out);
+
+    // Starts a new generation and returns the previous one: writes marked
+    // before the call are at or below it, later writes above it
+    uint64_t next_generation();
+    // True if a page overlapping the range was marked after `generation`
+    bool written_since(uint64_t address, uint64_t size, uint64_t generation) const;
+    // Appends the page runs inside [address, address + size) marked after
+    // `generation` to `out`, clipped to the range
+    void collect_written_since(uint64_t address, uint64_t size, uint64_t generation,
+                               std::vector<Range>& out) const;
+
+    uint64_t get_memory_size() const { return memory_size_; }
+
+private:
+    bool clip(uint64_t& address, uint64_t& size) const;
+
+    uint64_t memory_size_;
+    size_t word_count_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    std::unique_ptr<std::atomic<uint64_t>[]> page_generations_;
+    std::atomic<uint64_t> generation_{1};
+};
@@ -0,0 +1,215 @@
+#include "gpu_dma.h"
+#include "../core/scheduler.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PSX5_DMA_SSE2 1
+#endif
+
+namespace {
+
+#ifdef PSX5_DMA_SSE2
+// Streaming copy: 64 bytes per iteration with unaligned loads and aligned
+// non-temporal stores. Caller guarantees dst is 16-byte aligned.
+void stream_copy_aligned(uint8_t* dst, const uint8_t* src, size_t size) {
+    size_t blocks = size / 64;
+    for (size_t i = 0; i < blocks; ++i) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 0), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+        src += 64;
+        dst += 64;
+    }
+    size_t tail = size % 64;
+    if (tail) {
+        std::memcpy(dst, src, tail);
+    }
+}
+
+void stream_fill_aligned(uint8_t* dst, __m128i pattern, size_t size) {
+    size_t blocks = size / 64;
+    for (size_t i = 0; i < blocks; ++i) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 0), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), pattern);
+        dst += 64;
+    }
+    size_t tail = size % 64;
+    if (tail) {
+        alignas(16) uint8_t bytes[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(bytes), pattern);
+        for (size_t i = 0; i < tail; ++i) {
+            dst[i] = bytes[i % 16];
+        }
+    }
+}
+#endif
+
+// Fill with a 32-bit pattern, keeping the pattern phase relative to `phase`
+void scalar_fill(uint8_t* dst, uint32_t value, size_t size, size_t phase) {
+    uint8_t bytes[4];
+    std::memcpy(bytes, &value, 4);
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = bytes[(phase + i) & 3];
+    }
+}
+
+} // namespace
+
+GPUDMAEngine::GPUDMAEngine() = default;
+
+GPUDMAEngine::~GPUDMAEngine() {
+    wait_idle();
+}
+
+void GPUDMAEngine::copy_range(uint8_t* dst, const uint8_t* src, size_t size) {
+#ifdef PSX5_DMA_SSE2
+    if (size >= NON_TEMPORAL_THRESHOLD) {
+        size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+        std::memcpy(dst, src, head);
+        stream_copy_aligned(dst + head, src + head, size - head);
+        _mm_sfence();
+        return;
+    }
+#endif
+    std::memmove(dst, src, size);
+}
+
+void GPUDMAEngine::fill_range(uint8_t* dst, uint32_t value, size_t size) {
+#ifdef PSX5_DMA_SSE2
+    if (size >= NON_TEMPORAL_THRESHOLD) {
+        size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+        scalar_fill(dst, value, head, 0);
+        // Rotate the pattern so the streamed part continues at the right byte
+        uint32_t shift = static_cast<uint32_t>(head & 3) * 8;
+        uint32_t rotated = shift ? (value >> shift) | (value << (32 - shift)) : value;
+        stream_fill_aligned(dst + head, _mm_set1_epi32(static_cast<int>(rotated)), size - head);
+        _mm_sfence();
+        return;
+    }
+#endif
+    scalar_fill(dst, value, size, 0);
+}
+
+void GPUDMAEngine::copy(uint8_t* dst, const uint8_t* src, size_t size) {
+    if (!dst || !src || size == 0) return;
+
+    bool overlapping = dst < src + size && src < dst + size;
+    if (!overlapping && size >= PARALLEL_THRESHOLD && scheduler_ && scheduler_->is_running()) {
+        size_t chunks = (size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+        scheduler_->parallel_for(chunks, [&](size_t chunk) {
+            size_t offset = chunk * PARALLEL_CHUNK_SIZE;
+            size_t len = std::min(PARALLEL_CHUNK_SIZE, size - offset);
+            copy_range(dst + offset, src + offset, len);
+        });
+        parallel_transfers_.fetch_add(1, std::memory_order_relaxed);
+    } else if (overlapping) {
+        std::memmove(dst, src, size);
+    } else {
+        copy_range(dst, src, size);
+    }
+
+    bytes_copied_.fetch_add(size, std::memory_order_relaxed);
+    transfers_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GPUDMAEngine::fill(uint8_t* dst, uint32_t value, size_t size) {
+    if (!dst || size == 0) return;
+
+    if (size >= PARALLEL_THRESHOLD && scheduler_ && scheduler_->is_running()) {
+        // Chunk size is a multiple of 4 so every chunk starts on pattern phase 0
+        size_t chunks = (size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+        scheduler_->parallel_for(chunks, [&](size_t chunk) {
+            size_t offset = chunk * PARALLEL_CHUNK_SIZE;
+            size_t len = std::min(PARALLEL_CHUNK_SIZE, size - offset);
+            fill_range(dst + offset, value, len);
+        });
+        parallel_transfers_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        fill_range(dst, value, size);
+    }
+
+    bytes_filled_.fetch_add(size, std::memory_order_relaxed);
+    transfers_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t GPUDMAEngine::copy_async(uint8_t* dst, const uint8_t* src, size_t size) {
+    uint64_t fence = begin_fence();
+    if (scheduler_ && scheduler_->is_running()) {
+        scheduler_->schedule_task([this, dst, src, size, fence] {
+            copy(dst, src, size);
+            end_fence(fence);
+        });
+    } else {
+        copy(dst, src, size);
+        end_fence(fence);
+    }
+    return fence;
+}
+
+uint64_t GPUDMAEngine::fill_async(uint8_t* dst, uint32_t value, size_t size) {
+    uint64_t fence = begin_fence();
+    if (scheduler_ && scheduler_->is_running()) {
+        scheduler_->schedule_task([this, dst, value, size, fence] {
+            fill(dst, value, size);
+            end_fence(fence);
+        });
+    } else {
+        fill(dst, value, size);
+        end_fence(fence);
+    }
+    return fence;
+}
+
+uint64_t GPUDMAEngine::begin_fence() {
+    std::lock_guard<std::mutex> lock(fence_mutex_);
+    uint64_t fence = submitted_fence_.load() + 1;
+    submitted_fence_.store(fence);
+    in_flight_.insert(fence);
+    return fence;
+}
+
+void GPUDMAEngine::end_fence(uint64_t fence) {
+    // Notify under the lock: a waiter in the destructor may free the
+    // condition variable as soon as it sees the fence retire
+    std::lock_guard<std::mutex> lock(fence_mutex_);
+    in_flight_.erase(fence);
+    fence_cv_.notify_all();
+}
+
+uint64_t GPUDMAEngine::completed_fence() const {
+    std::lock_guard<std::mutex> lock(fence_mutex_);
+    if (in_flight_.empty()) {
+        return submitted_fence_.load();
+    }
+    return *in_flight_.begin() - 1;
+}
+
+void GPUDMAEngine::wait_fence(uint64_t fence) {
+    std::unique_lock<std::mutex> lock(fence_mutex_);
+    fence_cv_.wait(lock, [&] {
+        return in_flight_.empty() || *in_flight_.begin() > fence;
+    });
+}
+
+void GPUDMAEngine::wait_idle() {
+    std::unique_lock<std::mutex> lock(fence_mutex_);
+    fence_cv_.wait(lock, [&] { return in_flight_.empty(); });
+}
+
+GPUDMAEngine::Stats GPUDMAEngine::get_stats() const {
+    Stats stats;
+    stats.bytes_copied = bytes_copied_.load(std::memory_order_relaxed);
+    stats.bytes_filled = bytes_filled_.load(std::memory_order_relaxed);
+    stats.transfers = transfers_.load(std::memory_order_relaxed);
+    stats.parallel_transfers = parallel_transfers_.load(std::memory_order_relaxed);
+    return stats;
+}
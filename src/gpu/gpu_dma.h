@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+
+class Scheduler;
+
+// GPU DMA engine
+// Services DMA_DATA / COPY_DATA / WRITE_DATA packets. Large transfers use
+// non-temporal SIMD stores so streamed assets do not evict the working set
+// from the host caches, and are split across scheduler workers.
+class GPUDMAEngine {
+public:
+    // Transfers at or above this size bypass the cache with streaming stores
+    static constexpr size_t NON_TEMPORAL_THRESHOLD = 256 * 1024;
+    // Transfers at or above this size are split across scheduler workers
+    static constexpr size_t PARALLEL_THRESHOLD = 8 * 1024 * 1024;
+    static constexpr size_t PARALLEL_CHUNK_SIZE = 2 * 1024 * 1024;
+
+    struct Stats {
+        uint64_t bytes_copied;
+        uint64_t bytes_filled;
+        uint64_t transfers;
+        uint64_t parallel_transfers;
+    };
+
+    GPUDMAEngine();
+    ~GPUDMAEngine();
+
+    void set_scheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
+
+    // Synchronous transfers; return once the data is visible
+    void copy(uint8_t* dst, const uint8_t* src, size_t size);
+    void fill(uint8_t* dst, uint32_t value, size_t size);
+
+    // Asynchronous transfers; return a fence value that signals on completion
+    uint64_t copy_async(uint8_t* dst, const uint8_t* src, size_t size);
+    uint64_t fill_async(uint8_t* dst, uint32_t value, size_t size);
+
+    // Fence tracking. Fences complete in submission order from the point of
+    // view of completed_fence(), even if the transfers finish out of order.
+    uint64_t submitted_fence() const { return submitted_fence_.load(); }
+    uint64_t completed_fence() const;
+    bool is_fence_complete(uint64_t fence) const { return completed_fence() >= fence; }
+    void wait_fence(uint64_t fence);
+    void wait_idle();
+
+    Stats get_stats() const;
+
+private:
+    void copy_range(uint8_t* dst, const uint8_t* src, size_t size);
+    void fill_range(uint8_t* dst, uint32_t value, size_t size);
+    uint64_t begin_fence();
+    void end_fence(uint64_t fence);
+
+    Scheduler* scheduler_ = nullptr;
+
+    std::atomic<uint64_t> submitted_fence_{0};
+    mutable std::mutex fence_mutex_;
+    std::condition_variable fence_cv_;
+    std::set<uint64_t> in_flight_;
+
+    std::atomic<uint64_t> bytes_copied_{0};
+    std::atomic<uint64_t> bytes_filled_{0};
+    std::atomic<uint64_t> transfers_{0};
+    std::atomic<uint64_t> parallel_transfers_{0};
+};
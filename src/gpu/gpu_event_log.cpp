@@ -0,0 +1,319 @@
+#include "gpu_event_log.h"
+#include "../core/logger.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+constexpr uint64_t RATE_WINDOW_NS = 1000000000ULL;
+
+const char* event_name(uint16_t event) {
+    switch (static_cast<GPUEvent>(event)) {
+        case GPUEvent::Submit: return "Submit";
+        case GPUEvent::SetRegister: return "SetRegister";
+        case GPUEvent::EventWrite: return "EventWrite";
+        case GPUEvent::UnknownOpcode: return "UnknownOpcode";
+        case GPUEvent::DMARangeError: return "DMARangeError";
+        case GPUEvent::WaitTimeout: return "WaitTimeout";
+        case GPUEvent::CommandOutsideFrame: return "CommandOutsideFrame";
+        case GPUEvent::DrawBegin: return "DrawBegin";
+        case GPUEvent::DrawEnd: return "DrawEnd";
+        case GPUEvent::TilesBinned: return "TilesBinned";
+        case GPUEvent::Dispatch: return "Dispatch";
+        case GPUEvent::DispatchError: return "DispatchError";
+        case GPUEvent::Suppressed: return "Suppressed";
+        default: return "Unknown";
+    }
+}
+
+} // namespace
+
+GPUEventLog::GPUEventLog() {
+    pending_.reserve(QUEUE_CAPACITY);
+    writer_ = std::thread(&GPUEventLog::writer_loop, this);
+}
+
+GPUEventLog::~GPUEventLog() {
+    queue_pending_summaries(now_ns(), true);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stop_ = true;
+    }
+    queue_cv_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    if (trace_file_) {
+        std::fclose(trace_file_);
+        trace_file_ = nullptr;
+    }
+}
+
+bool GPUEventLog::parse_level(const std::string& name, GPULogLevel& level) {
+    if (name == "trace") level = GPULogLevel::Trace;
+    else if (name == "debug") level = GPULogLevel::Debug;
+    else if (name == "info") level = GPULogLevel::Info;
+    else if (name == "warn") level = GPULogLevel::Warn;
+    else if (name == "error") level = GPULogLevel::Error;
+    else if (name == "off") level = GPULogLevel::Off;
+    else return false;
+    return true;
+}
+
+bool GPUEventLog::start_trace(const std::string& path) {
+    stop_trace();
+
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    trace_file_ = std::fopen(path.c_str(), "wb");
+    if (!trace_file_) {
+        return false;
+    }
+
+    GPUTraceHeader header{};
+    std::memcpy(header.magic, "PSX5GEVT", 8);
+    header.version = TRACE_VERSION;
+    header.record_size = sizeof(GPUEventRecord);
+    std::fwrite(&header, sizeof(header), 1, trace_file_);
+
+    tracing_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void GPUEventLog::stop_trace() {
+    if (!tracing_.exchange(false)) {
+        return;
+    }
+    // Write out whatever was captured before closing the file
+    flush();
+
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    if (trace_file_) {
+        std::fclose(trace_file_);
+        trace_file_ = nullptr;
+    }
+}
+
+void GPUEventLog::record_slow(GPULogLevel level, GPUEvent event, uint64_t arg0, uint64_t arg1, uint64_t arg2) {
+    uint64_t now = now_ns();
+    bool to_text = static_cast<uint8_t>(level) >= level_.load(std::memory_order_relaxed) &&
+                   rate_allow(event, now);
+    if (!to_text && !tracing_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    GPUEventRecord rec{};
+    rec.timestamp_ns = now;
+    rec.event = static_cast<uint16_t>(event);
+    rec.level = static_cast<uint8_t>(level);
+    rec.to_text = to_text ? 1 : 0;
+    rec.args[0] = arg0;
+    rec.args[1] = arg1;
+    rec.args[2] = arg2;
+    enqueue(rec);
+}
+
+bool GPUEventLog::rate_allow(GPUEvent event, uint64_t now) {
+    RateWindow& window = rate_[static_cast<size_t>(event)];
+
+    uint64_t start = window.window_start.load(std::memory_order_relaxed);
+    if (now - start >= RATE_WINDOW_NS &&
+        window.window_start.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        window.count.store(0, std::memory_order_relaxed);
+        queue_suppressed(event, now);
+    }
+
+    if (window.count.fetch_add(1, std::memory_order_relaxed) < RATE_LIMIT_PER_SECOND) {
+        return true;
+    }
+    window.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void GPUEventLog::queue_suppressed(GPUEvent event, uint64_t now) {
+    uint32_t suppressed = rate_[static_cast<size_t>(event)].suppressed.exchange(0, std::memory_order_relaxed);
+    if (!suppressed) {
+        return;
+    }
+    GPUEventRecord rec{};
+    rec.timestamp_ns = now;
+    rec.event = static_cast<uint16_t>(GPUEvent::Suppressed);
+    rec.level = static_cast<uint8_t>(GPULogLevel::Warn);
+    rec.to_text = 1;
+    rec.args[0] = static_cast<uint64_t>(event);
+    rec.args[1] = suppressed;
+    enqueue(rec);
+}
+
+void GPUEventLog::queue_pending_summaries(uint64_t now, bool all) {
+    for (size_t i = 0; i < static_cast<size_t>(GPUEvent::Count); ++i) {
+        const RateWindow& window = rate_[i];
+        if (window.suppressed.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        // The window stays open; the next event of the type restarts it and
+        // reports only what was suppressed after this
+        if (all || now - window.window_start.load(std::memory_order_relaxed) >= RATE_WINDOW_NS) {
+            queue_suppressed(static_cast<GPUEvent>(i), now);
+        }
+    }
+}
+
+void GPUEventLog::enqueue(const GPUEventRecord& rec) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (pending_.size() >= QUEUE_CAPACITY) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending_.push_back(rec);
+        enqueued_++;
+        // The writer wakes on its own timer; only nudge it when the queue is filling up
+        wake = pending_.size() == QUEUE_CAPACITY / 2;
+    }
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+    if (wake) {
+        queue_cv_.notify_one();
+    }
+}
+
+void GPUEventLog::flush() {
+    queue_pending_summaries(now_ns(), true);
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    uint64_t target = enqueued_;
+    if (written_ >= target) {
+        return;
+    }
+    flush_requested_ = true;
+    queue_cv_.notify_one();
+    flushed_cv_.wait(lock, [&] { return written_ >= target || stop_; });
+}
+
+void GPUEventLog::writer_loop() {
+    std::vector<GPUEventRecord> batch;
+    batch.reserve(QUEUE_CAPACITY);
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        queue_cv_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [&] {
+            return stop_ || flush_requested_ || pending_.size() >= QUEUE_CAPACITY / 2;
+        });
+
+        // Bursts whose window ended with no later event to report them
+        lock.unlock();
+        queue_pending_summaries(now_ns(), false);
+        lock.lock();
+
+        batch.swap(pending_);
+        uint64_t target = enqueued_;
+        flush_requested_ = false;
+        bool stopping = stop_;
+        lock.unlock();
+
+        if (!batch.empty()) {
+            write_batch(batch);
+            batch.clear();
+        }
+
+        lock.lock();
+        written_ = target;
+        flushed_cv_.notify_all();
+        if (stopping && pending_.empty()) {
+            break;
+        }
+    }
+}
+
+void GPUEventLog::write_batch(const std::vector<GPUEventRecord>& batch) {
+    for (const auto& rec : batch) {
+        if (rec.to_text) {
+            format_text(rec);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    if (trace_file_) {
+        std::fwrite(batch.data(), sizeof(GPUEventRecord), batch.size(), trace_file_);
+        traced_.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+}
+
+void GPUEventLog::format_text(const GPUEventRecord& rec) {
+    char line[192];
+    const unsigned long long a0 = rec.args[0];
+    const unsigned long long a1 = rec.args[1];
+    const unsigned long long a2 = rec.args[2];
+
+    switch (static_cast<GPUEvent>(rec.event)) {
+        case GPUEvent::Submit:
+            std::snprintf(line, sizeof(line), "GPU: Processing %llu RDNA2 commands", a0);
+            break;
+        case GPUEvent::SetRegister:
+            std::snprintf(line, sizeof(line), "GPU: Setting register 0x%llx = 0x%llx", a0, a1);
+            break;
+        case GPUEvent::EventWrite:
+            std::snprintf(line, sizeof(line), "GPU: Event write %llu", a0);
+            break;
+        case GPUEvent::UnknownOpcode:
+            std::snprintf(line, sizeof(line), "GPU: Unknown command opcode 0x%llx", a0);
+            break;
+        case GPUEvent::DMARangeError:
+            std::snprintf(line, sizeof(line), "GPU: DMA %s out of range 0x%llx", a1 ? "destination" : "source", a0);
+            break;
+        case GPUEvent::WaitTimeout:
+            std::snprintf(line, sizeof(line), "GPU: WAIT_REG_MEM timed out on 0x%llx (ref 0x%llx, mask 0x%llx)", a0, a1, a2);
+            break;
+        case GPUEvent::CommandOutsideFrame:
+            std::snprintf(line, sizeof(line), "GPU: Graphics command outside of frame");
+            break;
+        case GPUEvent::DrawBegin:
+            std::snprintf(line, sizeof(line), "GPU: Draw call - %llu vertices, %llu instances", a0, a1);
+            break;
+        case GPUEvent::DrawEnd:
+            std::snprintf(line, sizeof(line), "GPU: Draw call complete - %llu visible primitives, %llu tiles processed", a0, a1);
+            break;
+        case GPUEvent::TilesBinned:
+            std::snprintf(line, sizeof(line), "GPU: Binned %llu primitives to %llux%llu tiles", a0, a1, a2);
+            break;
+        case GPUEvent::Dispatch:
+            std::snprintf(line, sizeof(line), "GPU: Dispatching compute shader - groups(%llu, %llu, %llu)", a0, a1, a2);
+            break;
+        case GPUEvent::DispatchError:
+            if (a0 == 0) std::snprintf(line, sizeof(line), "GPU: No compute shader set");
+            else if (a0 == 1) std::snprintf(line, sizeof(line), "GPU: Compute shader %llu not found", a1);
+            else std::snprintf(line, sizeof(line), "GPU: Workgroup size %llu exceeds limit", a1);
+            break;
+        case GPUEvent::Suppressed:
+            std::snprintf(line, sizeof(line), "GPU: %llu %s events suppressed by rate limit",
+                          a1, event_name(static_cast<uint16_t>(a0)));
+            break;
+        default:
+            std::snprintf(line, sizeof(line), "GPU: event %u", static_cast<unsigned>(rec.event));
+            break;
+    }
+
+    switch (static_cast<GPULogLevel>(rec.level)) {
+        case GPULogLevel::Trace: log::trace(line); break;
+        case GPULogLevel::Debug: log::debug(line); break;
+        case GPULogLevel::Info: log::info(line); break;
+        case GPULogLevel::Warn: log::warn(line); break;
+        default: log::error(line); break;
+    }
+}
+
+GPUEventLog::Stats GPUEventLog::get_stats() const {
+    Stats stats;
+    stats.recorded = recorded_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.suppressed = suppressed_.load(std::memory_order_relaxed);
+    stats.traced = traced_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <string>
+
+// GPU event log
+// Hot paths record fixed-size events instead of formatting text. Events are
+// filtered by level with a single relaxed load, rate-limited per event type,
+// and formatted on a background thread. A binary trace of every event can be
+// written for offline analysis. Default level is Warn, so command/draw/
+// dispatch events cost one branch when nothing is listening.
+
+enum class GPULogLevel : uint8_t {
+    Trace, Debug, Info, Warn, Error, Off
+};
+
+enum class GPUEvent : uint16_t {
+    Submit,            // arg0 = command count
+    SetRegister,       // arg0 = register, arg1 = value
+    EventWrite,        // arg0 = event type
+    UnknownOpcode,     // arg0 = opcode
+    DMARangeError,     // arg0 = address, arg1 = 0 source / 1 destination
+    WaitTimeout,       // arg0 = address, arg1 = reference, arg2 = mask
+    CommandOutsideFrame,
+    DrawBegin,         // arg0 = vertex count, arg1 = instance count
+    DrawEnd,           // arg0 = visible primitives, arg1 = tiles processed
+    TilesBinned,       // arg0 = primitives, arg1 = tiles x, arg2 = tiles y
+    Dispatch,          // arg0..arg2 = group counts
+    DispatchError,     // arg0 = 0 no shader / 1 shader missing / 2 group too large, arg1 = detail
+    Suppressed,        // arg0 = event type, arg1 = events dropped by the rate limit
+    Count
+};
+
+// Binary trace layout: GPUTraceHeader followed by GPUEventRecord entries
+struct GPUTraceHeader {
+    char magic[8];            // "PSX5GEVT"
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct GPUEventRecord {
+    uint64_t timestamp_ns;    // steady clock
+    uint16_t event;
+    uint8_t level;
+    uint8_t to_text;          // passed the level filter and rate limit
+    uint32_t reserved;
+    uint64_t args[3];
+};
+static_assert(sizeof(GPUEventRecord) == 40, "GPU trace record layout changed");
+
+class GPUEventLog {
+public:
+    static constexpr uint32_t TRACE_VERSION = 1;
+    // Events waiting for the writer beyond this are dropped and counted
+    static constexpr size_t QUEUE_CAPACITY = 16384;
+    // Text lines per event type per second; the rest are summarised
+    static constexpr uint32_t RATE_LIMIT_PER_SECOND = 20;
+    static constexpr uint32_t FLUSH_INTERVAL_MS = 50;
+
+    struct Stats {
+        uint64_t recorded;
+        uint64_t dropped;
+        uint64_t suppressed;
+        uint64_t traced;
+    };
+
+    GPUEventLog();
+    ~GPUEventLog();
+
+    GPUEventLog(const GPUEventLog&) = delete;
+    GPUEventLog& operator=(const GPUEventLog&) = delete;
+
+    void set_level(GPULogLevel level) { level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    GPULogLevel get_level() const { return static_cast<GPULogLevel>(level_.load(std::memory_order_relaxed)); }
+
+    // Parses "trace", "debug", "info", "warn", "error" or "off"
+    static bool parse_level(const std::string& name, GPULogLevel& level);
+
+    bool start_trace(const std::string& path);
+    void stop_trace();
+    bool is_tracing() const { return tracing_.load(std::memory_order_relaxed); }
+
+    bool enabled(GPULogLevel level) const {
+        return static_cast<uint8_t>(level) >= level_.load(std::memory_order_relaxed) ||
+               tracing_.load(std::memory_order_relaxed);
+    }
+
+    void record(GPULogLevel level, GPUEvent event, uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0) {
+        if (enabled(level)) {
+            record_slow(level, event, arg0, arg1, arg2);
+        }
+    }
+
+    // Blocks until every event recorded so far has been written, along with
+    // the count of any still being suppressed
+    void flush();
+
+    Stats get_stats() const;
+
+private:
+    struct RateWindow {
+        std::atomic<uint64_t> window_start{0};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> suppressed{0};
+    };
+
+    void record_slow(GPULogLevel level, GPUEvent event, uint64_t arg0, uint64_t arg1, uint64_t arg2);
+    bool rate_allow(GPUEvent event, uint64_t now_ns);
+    void queue_suppressed(GPUEvent event, uint64_t now_ns);
+    // Reports the suppressed counts of windows that have ended, or of every
+    // window when `all`, so a type's last burst is not lost
+    void queue_pending_summaries(uint64_t now_ns, bool all);
+    void enqueue(const GPUEventRecord& rec);
+    void writer_loop();
+    void write_batch(const std::vector<GPUEventRecord>& batch);
+    static void format_text(const GPUEventRecord& rec);
+
+    std::atomic<uint8_t> level_{static_cast<uint8_t>(GPULogLevel::Warn)};
+    std::atomic<bool> tracing_{false};
+
+    RateWindow rate_[static_cast<size_t>(GPUEvent::Count)];
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable flushed_cv_;
+    std::vector<GPUEventRecord> pending_;
+    uint64_t enqueued_ = 0;   // guarded by queue_mutex_
+    uint64_t written_ = 0;    // guarded by queue_mutex_
+    bool flush_requested_ = false;
+    bool stop_ = false;
+
+    std::mutex trace_mutex_;
+    FILE* trace_file_ = nullptr;
+
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> traced_{0};
+
+    std::thread writer_;
+};
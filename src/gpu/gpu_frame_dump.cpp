@@ -0,0 +1,238 @@
+#include "gpu_frame_dump.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+uint64_t now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void put_u32_be(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// QOI opcodes (https://qoiformat.org/qoi-specification.pdf)
+constexpr uint8_t QOI_OP_INDEX = 0x00;
+constexpr uint8_t QOI_OP_DIFF = 0x40;
+constexpr uint8_t QOI_OP_LUMA = 0x80;
+constexpr uint8_t QOI_OP_RUN = 0xc0;
+constexpr uint8_t QOI_OP_RGB = 0xfe;
+constexpr uint8_t QOI_OP_RGBA = 0xff;
+constexpr uint32_t QOI_MAX_RUN = 62;
+
+struct QOIPixel {
+    uint8_t r, g, b, a;
+    bool operator==(const QOIPixel& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+
+} // namespace
+
+GPUFrameDumper::GPUFrameDumper(const Config& config) : config_(config) {
+    if (config_.interval == 0) {
+        config_.interval = 1;
+    }
+}
+
+GPUFrameDumper::~GPUFrameDumper() {
+    close();
+}
+
+bool GPUFrameDumper::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!config_.directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(config_.directory, ec);
+        if (ec) {
+            std::cerr << "GPUFrameDumper: Cannot create " << config_.directory << ": " << ec.message() << std::endl;
+            return false;
+        }
+    }
+    if (!config_.timing_path.empty()) {
+        timing_file_ = std::fopen(config_.timing_path.c_str(), "w");
+        if (!timing_file_) {
+            std::cerr << "GPUFrameDumper: Cannot open " << config_.timing_path << std::endl;
+            return false;
+        }
+        std::fprintf(timing_file_, "frame,timestamp_us,frame_time_us,dump_time_us,dumped\n");
+    }
+    return true;
+}
+
+void GPUFrameDumper::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timing_file_) {
+        std::fclose(timing_file_);
+        timing_file_ = nullptr;
+    }
+    if (raw_file_) {
+        std::fclose(raw_file_);
+        raw_file_ = nullptr;
+    }
+}
+
+bool GPUFrameDumper::parse_format(const std::string& name, Format& format) {
+    if (name == "qoi") {
+        format = Format::QOI;
+    } else if (name == "raw") {
+        format = Format::Raw;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool GPUFrameDumper::present(const GPUPresentFrame& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t start = now_us();
+    uint64_t frame_time = last_frame_us_ ? start - last_frame_us_ : 0;
+    last_frame_us_ = start;
+
+    bool dump = !config_.directory.empty() && frame.frame_number % config_.interval == 0;
+    bool ok = true;
+    if (dump) {
+        ok = config_.format == Format::QOI ? write_qoi(frame) : write_raw(frame);
+    }
+    uint64_t dump_time = dump ? now_us() - start : 0;
+
+    stats_.frames++;
+    stats_.total_frame_time_us += frame_time;
+    stats_.max_frame_time_us = std::max(stats_.max_frame_time_us, frame_time);
+    stats_.total_dump_time_us += dump_time;
+    if (dump && ok) {
+        stats_.dumped++;
+    }
+
+    if (timing_file_) {
+        std::fprintf(timing_file_, "%llu,%llu,%llu,%llu,%d\n",
+                     static_cast<unsigned long long>(frame.frame_number),
+                     static_cast<unsigned long long>(start),
+                     static_cast<unsigned long long>(frame_time),
+                     static_cast<unsigned long long>(dump_time),
+                     dump && ok ? 1 : 0);
+    }
+    return ok;
+}
+
+GPUFrameDumper::Stats GPUFrameDumper::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool GPUFrameDumper::write_qoi(const GPUPresentFrame& frame) {
+    encode_qoi(frame.pixels, frame.width, frame.height, frame.pitch, encode_buffer_);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "frame_%06llu.qoi", static_cast<unsigned long long>(frame.frame_number));
+    std::string path = (std::filesystem::path(config_.directory) / name).string();
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "GPUFrameDumper: Cannot write " << path << std::endl;
+        return false;
+    }
+    size_t written = std::fwrite(encode_buffer_.data(), 1, encode_buffer_.size(), file);
+    std::fclose(file);
+    stats_.bytes_written += written;
+    return written == encode_buffer_.size();
+}
+
+bool GPUFrameDumper::write_raw(const GPUPresentFrame& frame) {
+    if (!raw_file_ || raw_width_ != frame.width || raw_height_ != frame.height) {
+        if (raw_file_) {
+            std::fclose(raw_file_);
+        }
+        char name[96];
+        std::snprintf(name, sizeof(name), "frames_%06llu_%ux%u.rgba",
+                      static_cast<unsigned long long>(frame.frame_number), frame.width, frame.height);
+        std::string path = (std::filesystem::path(config_.directory) / name).string();
+        raw_file_ = std::fopen(path.c_str(), "wb");
+        if (!raw_file_) {
+            std::cerr << "GPUFrameDumper: Cannot write " << path << std::endl;
+            return false;
+        }
+        raw_width_ = frame.width;
+        raw_height_ = frame.height;
+    }
+
+    size_t row_bytes = static_cast<size_t>(frame.width) * 4;
+    for (uint32_t y = 0; y < frame.height; ++y) {
+        if (std::fwrite(frame.pixels + static_cast<size_t>(y) * frame.pitch, 1, row_bytes, raw_file_) != row_bytes) {
+            return false;
+        }
+    }
+    stats_.bytes_written += row_bytes * frame.height;
+    return true;
+}
+
+void GPUFrameDumper::encode_qoi(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t pitch,
+                                std::vector<uint8_t>& out) {
+    out.clear();
+    // Worst case is QOI_OP_RGBA for every pixel
+    out.reserve(14 + static_cast<size_t>(width) * height * 5 + 8);
+
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    put_u32_be(out, width);
+    put_u32_be(out, height);
+    out.push_back(4);   // RGBA
+    out.push_back(0);   // sRGB with linear alpha
+
+    QOIPixel index[64] = {};
+    QOIPixel prev{0, 0, 0, 255};
+    uint32_t run = 0;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * pitch;
+        for (uint32_t x = 0; x < width; ++x) {
+            QOIPixel px{row[x * 4 + 0], row[x * 4 + 1], row[x * 4 + 2], row[x * 4 + 3]};
+
+            if (px == prev) {
+                if (++run == QOI_MAX_RUN) {
+                    out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            uint32_t hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+            if (index[hash] == px) {
+                out.push_back(static_cast<uint8_t>(QOI_OP_INDEX | hash));
+            } else {
+                index[hash] = px;
+                if (px.a == prev.a) {
+                    int8_t dr = static_cast<int8_t>(px.r - prev.r);
+                    int8_t dg = static_cast<int8_t>(px.g - prev.g);
+                    int8_t db = static_cast<int8_t>(px.b - prev.b);
+                    int dr_dg = dr - dg;
+                    int db_dg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out.push_back(static_cast<uint8_t>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    } else if (dr_dg >= -8 && dr_dg <= 7 && dg >= -32 && dg <= 31 && db_dg >= -8 && db_dg <= 7) {
+                        out.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (dg + 32)));
+                        out.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+                    } else {
+                        out.insert(out.end(), {QOI_OP_RGB, px.r, px.g, px.b});
+                    }
+                } else {
+                    out.insert(out.end(), {QOI_OP_RGBA, px.r, px.g, px.b, px.a});
+                }
+            }
+            prev = px;
+        }
+    }
+    if (run > 0) {
+        out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+    }
+
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "gpu_presenter.h"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Headless frame sink
+// Stands in for a window when running without a display (CI, build farms).
+// Every frame is timed; frames whose frame_number is a multiple of
+// `interval` are written either as a QOI image (lossless, compressed, one
+// file per frame) or appended to a raw RGBA8 video stream. The raw stream
+// starts a new file whenever the resolution changes, named so it can be fed
+// to `ffmpeg -f rawvideo -pix_fmt rgba -s WxH`.
+class GPUFrameDumper : public GPUPresentSink {
+public:
+    enum class Format { QOI, Raw };
+
+    struct Config {
+        std::string directory;     // empty = time frames only
+        Format format = Format::QOI;
+        uint32_t interval = 1;     // dump frames numbered 0, N, 2N, ...
+        std::string timing_path;   // per-frame CSV, empty = none
+    };
+
+    struct Stats {
+        uint64_t frames;
+        uint64_t dumped;
+        uint64_t bytes_written;
+        uint64_t total_frame_time_us;  // between consecutive frames
+        uint64_t max_frame_time_us;
+        uint64_t total_dump_time_us;
+    };
+
+    explicit GPUFrameDumper(const Config& config);
+    ~GPUFrameDumper() override;
+
+    GPUFrameDumper(const GPUFrameDumper&) = delete;
+    GPUFrameDumper& operator=(const GPUFrameDumper&) = delete;
+
+    // Creates the output directory and timing file
+    bool open();
+    void close();
+
+    bool present(const GPUPresentFrame& frame) override;
+
+    Stats get_stats() const;
+
+    // Parses "qoi" or "raw"
+    static bool parse_format(const std::string& name, Format& format);
+    // Encodes RGBA8 rows `pitch` bytes apart into `out`, replacing its contents
+    static void encode_qoi(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t pitch,
+                           std::vector<uint8_t>& out);
+
+private:
+    bool write_qoi(const GPUPresentFrame& frame);
+    bool write_raw(const GPUPresentFrame& frame);
+
+    Config config_;
+    mutable std::mutex mutex_;
+    FILE* timing_file_ = nullptr;
+    FILE* raw_file_ = nullptr;
+    uint32_t raw_width_ = 0;
+    uint32_t raw_height_ = 0;
+    uint64_t last_frame_us_ = 0;
+    std::vector<uint8_t> encode_buffer_;
+    Stats stats_{};
+};
@@ -0,0 +1,177 @@
+#include "gpu_presenter.h"
+#include <chrono>
+
+namespace {
+
+bool overlaps(const GPUPresentFrame& frame, uint64_t address, size_t size) {
+    uint64_t frame_end = frame.address + static_cast<uint64_t>(frame.pitch) * frame.height;
+    return address < frame_end && frame.address < address + size;
+}
+
+} // namespace
+
+GPUPresenter::GPUPresenter() = default;
+
+GPUPresenter::~GPUPresenter() {
+    stop();
+}
+
+void GPUPresenter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    stopping_ = false;
+    thread_ = std::thread(&GPUPresenter::present_loop, this);
+}
+
+void GPUPresenter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        stopping_ = true;
+    }
+    queued_cv_.notify_all();
+    thread_.join();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+    if (has_queued_) {
+        has_queued_ = false;
+        stats_.dropped++;
+    }
+    released_cv_.notify_all();
+    released_cv_.wait(lock, [this] { return !releasing_; });
+    if (held_) {
+        release_held(lock);
+    }
+}
+
+void GPUPresenter::set_sink(GPUPresentSink* sink) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        released_cv_.wait(lock, [this] { return !presenting_ && !releasing_; });
+        if (!held_) break;
+        release_held(lock);
+    }
+    sink_ = sink;
+}
+
+void GPUPresenter::set_mode(Mode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = mode;
+}
+
+void GPUPresenter::queue_frame(const GPUPresentFrame& frame) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stats_.queued++;
+        if (mode_ == Mode::FIFO) {
+            released_cv_.wait(lock, [this] { return !has_queued_ || !running_ || stopping_; });
+        }
+        if (!running_ || stopping_ || !sink_) {
+            stats_.dropped++;
+            return;
+        }
+        if (has_queued_) {
+            stats_.dropped++;
+        }
+        queued_ = frame;
+        has_queued_ = true;
+    }
+    queued_cv_.notify_one();
+}
+
+bool GPUPresenter::on_screen(uint64_t address, size_t size) const {
+    return (presenting_ || releasing_) && overlaps(on_screen_, address, size);
+}
+
+void GPUPresenter::release_held(std::unique_lock<std::mutex>& lock) {
+    GPUPresentFrame frame = on_screen_;
+    GPUPresentSink* sink = sink_;
+    releasing_ = true;
+    lock.unlock();
+    if (sink) {
+        sink->release(frame);
+    }
+    lock.lock();
+    releasing_ = false;
+    held_ = false;
+    released_cv_.notify_all();
+}
+
+void GPUPresenter::wait_released(uint64_t address, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto queued_here = [&] { return has_queued_ && overlaps(queued_, address, size); };
+    // In mailbox mode a queued frame about to be drawn over is stale; a newer
+    // one will follow. FIFO shows it first.
+    if (mode_ == Mode::Mailbox && queued_here()) {
+        has_queued_ = false;
+        stats_.dropped++;
+        released_cv_.notify_all();
+    }
+    bool waited = false;
+    while (true) {
+        // Drawing into the buffer on screen: take it back from the sink
+        if (held_ && !presenting_ && !releasing_ && overlaps(on_screen_, address, size)) {
+            release_held(lock);
+            continue;
+        }
+        if (!on_screen(address, size) && !queued_here()) break;
+        if (!waited) {
+            stats_.render_waits++;
+            waited = true;
+        }
+        released_cv_.wait(lock);
+    }
+}
+
+void GPUPresenter::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_cv_.wait(lock, [this] { return (!has_queued_ || !running_) && !presenting_; });
+}
+
+GPUPresenter::Stats GPUPresenter::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void GPUPresenter::present_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queued_cv_.wait(lock, [this] { return stopping_ || has_queued_; });
+        if (stopping_) break;
+        // The next frame replaces the one on screen
+        if (held_) {
+            if (releasing_) {
+                released_cv_.wait(lock);
+            } else {
+                release_held(lock);
+            }
+            continue;
+        }
+
+        on_screen_ = queued_;
+        has_queued_ = false;
+        presenting_ = true;
+        GPUPresentSink* sink = sink_;
+        lock.unlock();
+        // A FIFO producer may be waiting for the slot
+        released_cv_.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = sink && sink->present(on_screen_);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        presenting_ = false;
+        held_ = sink != nullptr;
+        if (ok) {
+            stats_.presented++;
+            stats_.present_time_us += static_cast<uint64_t>(elapsed);
+        } else {
+            stats_.failed++;
+        }
+        released_cv_.notify_all();
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// A color target queued for display. `pixels` points straight into GPU
+// memory; nothing is copied or converted on the way to the sink.
+struct GPUPresentFrame {
+    const uint8_t* pixels;
+    uint64_t address;          // GPU address of the first pixel
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;            // bytes per row
+    uint32_t format;           // always RGBA8 for the software rasterizer
+    uint64_t frame_number;
+};
+
+// Displays frames for the presenter. present() runs on the presenter thread.
+// The frame stays on screen afterwards, so a sink may keep reading
+// `frame.pixels` (to repaint it) until release() is called for it, which
+// happens when the next frame replaces it, the renderer takes the buffer
+// back or the sink is detached. release() may run on any thread and must
+// not return while a read is in progress.
+class GPUPresentSink {
+public:
+    virtual ~GPUPresentSink() = default;
+    virtual bool present(const GPUPresentFrame& frame) = 0;
+    virtual void release(const GPUPresentFrame& frame) { (void)frame; }
+};
+
+// GPU frame presenter
+// Triple buffered: one buffer on screen, one queued, one being rendered.
+// The buffer on screen stays with the sink until the next frame replaces
+// it; a renderer that draws into it first (single buffering) takes it back.
+// In mailbox mode queue_frame() never blocks; a frame that is still queued
+// when the next one arrives is dropped. FIFO mode shows every frame instead:
+// queue_frame() waits for the queued slot to empty, which headless runs use
+// so what reaches the sink does not depend on timing. The renderer calls
+// wait_released() before drawing into a buffer so it never overwrites the
+// frame being shown.
+class GPUPresenter {
+public:
+    enum class Mode { Mailbox, FIFO };
+
+    struct Stats {
+        uint64_t queued;
+        uint64_t presented;
+        uint64_t dropped;          // replaced before they were shown
+        uint64_t failed;           // rejected by the sink
+        uint64_t render_waits;     // renderer waited for a buffer to leave the screen
+        uint64_t present_time_us;
+    };
+
+    GPUPresenter();
+    ~GPUPresenter();
+
+    void start();
+    void stop();
+    bool is_running() const { return running_; }
+
+    // Swaps the sink; returns once the previous sink is no longer in use.
+    // nullptr detaches (frames are then dropped).
+    void set_sink(GPUPresentSink* sink);
+    void set_mode(Mode mode);
+
+    void queue_frame(const GPUPresentFrame& frame);
+    // Blocks while the frame being presented overlaps [address, address + size);
+    // in FIFO mode also while a queued frame does. A frame already shown
+    // there is released from the sink first.
+    void wait_released(uint64_t address, size_t size);
+    // Blocks until every queued frame has been presented or dropped
+    void wait_idle();
+
+    Stats get_stats() const;
+
+private:
+    void present_loop();
+    bool on_screen(uint64_t address, size_t size) const;
+    // Hands the frame on screen back from the sink; called with the lock held
+    void release_held(std::unique_lock<std::mutex>& lock);
+
+    mutable std::mutex mutex_;
+    std::condition_variable queued_cv_;
+    std::condition_variable released_cv_;
+    std::thread thread_;
+    bool running_ = false;
+    bool stopping_ = false;
+
+    GPUPresentSink* sink_ = nullptr;
+    Mode mode_ = Mode::Mailbox;
+    bool has_queued_ = false;
+    bool presenting_ = false;
+    bool held_ = false;            // on_screen_ was presented and the sink may still read it
+    bool releasing_ = false;       // a release() call is in progress
+    GPUPresentFrame queued_{};
+    GPUPresentFrame on_screen_{};
+
+    Stats stats_{};
+};
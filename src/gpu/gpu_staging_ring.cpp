@@ -0,0 +1,36 @@
+#include "gpu_staging_ring.h"
+
+bool GPUStagingRing::allocate(uint64_t size, uint64_t value, uint64_t& offset) {
+    uint64_t begin;
+    if (spans_.empty()) {
+        if (size > size_) return false;
+        begin = 0;
+    } else {
+        const uint64_t tail = spans_.front().begin;
+        const uint64_t head = (spans_.back().end + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        // The newest span starting below the oldest one means the live part
+        // wraps: free space is [head, tail). Otherwise it is [head, end of
+        // ring) followed by [0, tail).
+        const bool wrapped = spans_.back().begin < tail;
+        if (wrapped) {
+            if (head > tail || tail - head < size) return false;
+            begin = head;
+        } else if (head <= size_ && size_ - head >= size) {
+            begin = head;
+        } else if (size <= tail) {
+            begin = 0;
+        } else {
+            return false;
+        }
+    }
+
+    offset = begin;
+    spans_.push_back({begin, begin + size, value});
+    return true;
+}
+
+void GPUStagingRing::release(uint64_t completed) {
+    while (!spans_.empty() && spans_.front().value <= completed) {
+        spans_.pop_front();
+    }
+}
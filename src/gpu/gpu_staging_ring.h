@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+// Staging ring bookkeeping for streaming uploads
+// Hands out aligned byte spans of a fixed-size ring, each tagged with the
+// timeline value whose completion frees it. Spans are freed in the order
+// they were handed out, so the live part of the ring runs from the oldest
+// span to the newest one, wrapping past the end at most once. Only offsets
+// are tracked; the caller owns the memory.
+class GPUStagingRing {
+public:
+    static constexpr uint64_t ALIGNMENT = 16;
+
+    explicit GPUStagingRing(uint64_t size) : size_(size) {}
+
+    // Places `size` (> 0) bytes freed at `value`; false when no free run is
+    // large enough until older spans are released
+    bool allocate(uint64_t size, uint64_t value, uint64_t& offset);
+    // Frees the spans whose value has been reached
+    void release(uint64_t completed);
+    void clear() { spans_.clear(); }
+
+    bool empty() const { return spans_.empty(); }
+    // Value freeing the oldest span; only when not empty
+    uint64_t oldest_value() const { return spans_.front().value; }
+    uint64_t size() const { return size_; }
+
+private:
+    struct Span {
+        uint64_t begin;
+        uint64_t end;
+        uint64_t value;
+    };
+
+    const uint64_t size_;
+    std::deque<Span> spans_;   // oldest first
+};
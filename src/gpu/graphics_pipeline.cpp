@@ -1,7 +1,11 @@
 #include "graphics_pipeline.h"
 #include "../core/logger.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "vulkan_translator.h"
+#endif
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace PS5Emu {
 
@@ -69,6 +73,16 @@ void GraphicsPipeline::BeginRenderPass(uint32_t render_pass_id, uint32_t framebu
     const RenderPass& render_pass = rp_it->second;
     const Framebuffer& framebuffer = fb_it->second;
     
+#ifdef PSX5_ENABLE_VULKAN
+    // The translator clears on the device and writes attachments back at the
+    // end of the pass
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->begin_render_pass(render_pass, framebuffer, {}, 1.0f);
+        Logger::Debug("Began render pass: {}, framebuffer: {}", render_pass_id, framebuffer_id);
+        return;
+    }
+#endif
+    
     // Clear attachments based on load operations
     for (size_t i = 0; i < render_pass.attachments.size(); ++i) {
         const auto& attachment = render_pass.attachments[i];
@@ -79,6 +93,7 @@ void GraphicsPipeline::BeginRenderPass(uint32_t render_pass_id, uint32_t framebu
             if (attachment_ptr) {
                 size_t attachment_size = framebuffer.width * framebuffer.height * 4; // Assume 4 bytes per pixel
                 memset(attachment_ptr, 0, attachment_size);
+                gpu->mark_gpu_memory_dirty(attachment_addr, attachment_size);
             }
         }
     }
@@ -86,6 +101,34 @@ void GraphicsPipeline::BeginRenderPass(uint32_t render_pass_id, uint32_t framebu
     Logger::Debug("Began render pass: {}, framebuffer: {}", render_pass_id, framebuffer_id);
 }
 
+void GraphicsPipeline::NextSubpass() {
+    auto rp_it = render_passes.find(current_render_pass);
+    if (rp_it == render_passes.end() || current_subpass + 1 >= rp_it->second.subpasses.size()) {
+        Logger::Error("No subpass to advance to");
+        return;
+    }
+    current_subpass++;
+    
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->next_subpass();
+    }
+#endif
+}
+
+void GraphicsPipeline::EndRenderPass() {
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->end_render_pass();
+    }
+#endif
+    
+    Logger::Debug("Ended render pass: {}", current_render_pass);
+    current_render_pass = 0;
+    current_framebuffer = 0;
+    current_subpass = 0;
+}
+
 void GraphicsPipeline::Draw(uint32_t vertex_count, uint32_t instance_count, 
                            uint32_t first_vertex, uint32_t first_instance) {
     if (current_pipeline == 0) {
@@ -98,6 +141,17 @@ void GraphicsPipeline::Draw(uint32_t vertex_count, uint32_t instance_count,
     Logger::Debug("Draw: vertices={}, instances={}, first_vertex={}, first_instance={}", 
                   vertex_count, instance_count, first_vertex, first_instance);
     
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        if (translator->draw(pipeline, vertex_count, instance_count, first_vertex, first_instance)) {
+            gpu->perf_counters.triangles_rendered += vertex_count / 3;
+            return;
+        }
+        // Software stages read GPU memory; bring translated results back first
+        translator->flush();
+    }
+#endif
+    
     // Execute graphics pipeline stages
     ExecuteVertexStage(pipeline, vertex_count);
     
@@ -128,6 +182,17 @@ void GraphicsPipeline::DrawIndexed(uint32_t index_count, uint32_t instance_count
     
     // Similar to Draw but with index buffer processing
     const PipelineState& pipeline = pipelines[current_pipeline];
+    
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        if (translator->draw_indexed(pipeline, index_count, instance_count, first_index, vertex_offset, first_instance)) {
+            gpu->perf_counters.triangles_rendered += index_count / 3;
+            return;
+        }
+        translator->flush();
+    }
+#endif
+    
     ExecuteVertexStage(pipeline, index_count);
     ExecuteRasterizationStage(pipeline);
     ExecuteFragmentStage(pipeline);
@@ -135,6 +200,79 @@ void GraphicsPipeline::DrawIndexed(uint32_t index_count, uint32_t instance_count
     gpu->perf_counters.triangles_rendered += index_count / 3;
 }
 
+void GraphicsPipeline::DrawIndirect(uint64_t buffer_address, uint32_t draw_count, uint32_t stride) {
+    // Arguments are {vertex_count, instance_count, first_vertex, first_instance}.
+    // They are read on the CPU, so anything producing them on the device must
+    // have been synchronised (EVENT_WRITE_EOP) beforehand.
+    stride = std::max<uint32_t>(stride, 4 * sizeof(uint32_t));
+    for (uint32_t i = 0; i < draw_count; ++i) {
+        uint64_t address = buffer_address + static_cast<uint64_t>(i) * stride;
+        const uint8_t* args = gpu->get_gpu_memory_ptr(address);
+        if (!args || !gpu->get_gpu_memory_ptr(address + 4 * sizeof(uint32_t) - 1)) {
+            Logger::Error("Invalid indirect draw buffer: 0x{:x}", address);
+            return;
+        }
+        uint32_t params[4];
+        std::memcpy(params, args, sizeof(params));
+        Draw(params[0], params[1], params[2], params[3]);
+    }
+}
+
+void GraphicsPipeline::BindVertexBuffers(uint32_t first_binding, const std::vector<uint64_t>& buffer_addresses,
+                                         const std::vector<uint64_t>& offsets) {
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        for (size_t i = 0; i < buffer_addresses.size(); ++i) {
+            uint64_t offset = i < offsets.size() ? offsets[i] : 0;
+            translator->bind_vertex_buffer(first_binding + static_cast<uint32_t>(i), buffer_addresses[i], offset);
+        }
+    }
+#endif
+    resource_binding_state.vertex_buffers_dirty = true;
+}
+
+void GraphicsPipeline::BindIndexBuffer(uint64_t buffer_address, uint64_t offset, uint32_t index_type) {
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->bind_index_buffer(buffer_address, offset, index_type);
+    }
+#endif
+    resource_binding_state.index_buffer_dirty = true;
+}
+
+void GraphicsPipeline::BindDescriptorSets(uint32_t first_set, const std::vector<uint32_t>& descriptor_sets) {
+    // Each entry is a buffer resource bound whole to storage slot first_set + i
+    for (size_t i = 0; i < descriptor_sets.size(); ++i) {
+        uint32_t slot = first_set + static_cast<uint32_t>(i);
+        if (slot < resource_binding_state.bound_descriptor_sets.size()) {
+            resource_binding_state.bound_descriptor_sets[slot] = descriptor_sets[i];
+        }
+#ifdef PSX5_ENABLE_VULKAN
+        if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+            const GPU::GPUResource* resource = gpu->get_resource(descriptor_sets[i]);
+            translator->bind_buffer(slot, resource ? resource->address : 0, resource ? resource->size : 0);
+        }
+#endif
+    }
+    resource_binding_state.descriptor_sets_dirty = true;
+}
+
+void GraphicsPipeline::SetViewport(float x, float y, float width, float height, float min_depth, float max_depth) {
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->set_viewport(x, y, width, height, min_depth, max_depth);
+    }
+#endif
+}
+
+void GraphicsPipeline::SetScissor(int32_t x, int32_t y, uint32_t width, uint32_t height) {
+#ifdef PSX5_ENABLE_VULKAN
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        translator->set_scissor(x, y, width, height);
+    }
+#endif
+}
+
 void GraphicsPipeline::ExecuteVertexStage(const PipelineState& pipeline, uint32_t vertex_count) {
     // Simulate vertex shader execution on compute units
     // TODO: Implement proper vertex fetching no simulation
@@ -312,7 +450,31 @@ void ComputePipeline::Dispatch(uint32_t group_count_x, uint32_t group_count_y, u
                   total_threads);
     
     gpu->dispatch_compute_shader(group_count_x, group_count_y, group_count_z);
-    gpu->perf_counters.compute_dispatches++;
+}
+
+void ComputePipeline::DispatchIndirect(uint64_t buffer_address) {
+    const uint8_t* args = gpu->get_gpu_memory_ptr(buffer_address);
+    if (!args || !gpu->get_gpu_memory_ptr(buffer_address + 3 * sizeof(uint32_t) - 1)) {
+        Logger::Error("Invalid indirect dispatch buffer: 0x{:x}", buffer_address);
+        return;
+    }
+
+    uint32_t groups[3];
+    std::memcpy(groups, args, sizeof(groups));
+    Dispatch(groups[0], groups[1], groups[2]);
+}
+
+void ComputePipeline::BindComputeDescriptorSets(uint32_t first_set, const std::vector<uint32_t>& descriptor_sets) {
+#ifdef PSX5_ENABLE_VULKAN
+    // Same slot model as GraphicsPipeline::BindDescriptorSets
+    if (VulkanTranslator* translator = gpu->get_vulkan_translator()) {
+        for (size_t i = 0; i < descriptor_sets.size(); ++i) {
+            const GPU::GPUResource* resource = gpu->get_resource(descriptor_sets[i]);
+            translator->bind_buffer(first_set + static_cast<uint32_t>(i),
+                                    resource ? resource->address : 0, resource ? resource->size : 0);
+        }
+    }
+#endif
 }
 
 } // namespace PS5Emu
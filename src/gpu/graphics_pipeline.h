@@ -116,7 +116,7 @@ public:
         std::vector<uint32_t> color_attachments;
         uint32_t depth_attachment;
         bool independent_blend_enable;
-        std::vector<ColorBlendAttachment> per_target_blend;
+        std::vector<ColorBlendState::ColorBlendAttachment> per_target_blend;
     };
     
     // Pipeline State Object
@@ -327,7 +327,7 @@ private:
     void TileRasterization(const std::vector<Tile>& tiles);
     void ProcessTile(const Tile& tile);
     void ProcessAdvancedTile(const AdvancedTile& tile);
-    void ExecuteSubpassDependencies(const std::vector<SubpassDependency>& dependencies, uint32_t current_subpass);
+    void ExecuteSubpassDependencies(const std::vector<RenderPass::SubpassDependency>& dependencies, uint32_t current_subpass);
     void ResolveMultisampleAttachments(const std::vector<uint32_t>& resolve_targets);
     
     // Resource binding state
@@ -1,5 +1,6 @@
 #include "vulkan_backend.h"
 #ifdef PSX5_ENABLE_VULKAN
+#include "vulkan_upload_manager.h"
 #include <vulkan/vulkan.h>
 #include <iostream>
 #include <vector>
@@ -29,6 +30,13 @@ bool VulkanBackend::init() {
     if (!create_command_pool()) return false;
     if (!create_descriptor_pool()) return false;
     if (!create_memory_allocator()) return false;
+    if (!create_frame_resources()) return false;
+    
+    // Streaming is optional: without it texture updates stay in GPU memory only
+    upload_manager_ = std::make_unique<VulkanUploadManager>(this);
+    if (!upload_manager_->init()) {
+        upload_manager_.reset();
+    }
     
     initialized_ = true;
     std::cout << "VulkanBackend: Vulkan backend initialized successfully" << std::endl;
@@ -39,13 +47,10 @@ void VulkanBackend::shutdown() {
     if (!initialized_) return;
     
     if (device_ != VK_NULL_HANDLE) {
+        wait_frames();
+        upload_manager_.reset();
         vkDeviceWaitIdle(device_);
-        
-        // Cleanup memory allocator
-        if (memory_allocator_) {
-            vmaDestroyAllocator(memory_allocator_);
-            memory_allocator_ = VK_NULL_HANDLE;
-        }
+        destroy_frame_resources();
         
         // Cleanup descriptor pool
         if (descriptor_pool_ != VK_NULL_HANDLE) {
@@ -77,6 +82,12 @@ void VulkanBackend::shutdown() {
         }
         images_.clear();
         
+        // Cleanup memory allocator, after every allocation made from it
+        if (memory_allocator_) {
+            vmaDestroyAllocator(memory_allocator_);
+            memory_allocator_ = VK_NULL_HANDLE;
+        }
+        
         vkDestroyDevice(device_, nullptr);
         device_ = VK_NULL_HANDLE;
     }
@@ -200,27 +211,30 @@ VulkanBackend::QueueFamilyIndices VulkanBackend::find_queue_families(VkPhysicalD
     std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
     
-    int i = 0;
+    uint32_t i = 0;
     for (const auto& queue_family : queue_families) {
-        if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        if ((queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphics_family.has_value()) {
             indices.graphics_family = i;
         }
         
-        if (queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) {
+        if ((queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !indices.compute_family.has_value()) {
             indices.compute_family = i;
         }
         
-        if (queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT) {
+        // Prefer a transfer-only family (the DMA engines) so streaming runs beside rendering
+        bool transfer_only = !(queue_family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+        if ((queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT) && transfer_only) {
             indices.transfer_family = i;
         }
         
-        if (indices.is_complete()) {
-            break;
-        }
-        
         i++;
     }
     
+    // Graphics and compute queues always support transfers
+    if (!indices.transfer_family.has_value()) {
+        indices.transfer_family = indices.graphics_family;
+    }
+    
     return indices;
 }
 
@@ -259,8 +273,14 @@ bool VulkanBackend::create_logical_device() {
         VK_KHR_MAINTENANCE3_EXTENSION_NAME
     };
     
+    // Core in Vulkan 1.2; the upload manager hands work to the graphics queue with it
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{};
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timeline_features.timelineSemaphore = VK_TRUE;
+    
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    create_info.pNext = &timeline_features;
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.pEnabledFeatures = &device_features;
@@ -294,6 +314,51 @@ bool VulkanBackend::create_command_pool() {
     return true;
 }
 
+bool VulkanBackend::create_frame_resources() {
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family_indices_.graphics_family.value();
+    
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    
+    for (auto& frame : frames_) {
+        if (vkCreateCommandPool(device_, &pool_info, nullptr, &frame.command_pool) != VK_SUCCESS ||
+            vkCreateFence(device_, &fence_info, nullptr, &frame.fence) != VK_SUCCESS ||
+            vkCreateSemaphore(device_, &semaphore_info, nullptr, &frame.image_available) != VK_SUCCESS ||
+            vkCreateSemaphore(device_, &semaphore_info, nullptr, &frame.render_finished) != VK_SUCCESS) {
+            std::cerr << "VulkanBackend: Failed to create frame resources" << std::endl;
+            return false;
+        }
+    }
+    
+    // Rings are created on first use so a backend that never stages pays nothing
+    frame_index_ = 0;
+    frame_number_ = 0;
+    return true;
+}
+
+void VulkanBackend::destroy_frame_resources() {
+    for (auto& frame : frames_) {
+        for (FrameRing* ring : {&frame.staging, &frame.readback}) {
+            if (ring->buffer_id) {
+                unmap_buffer(ring->buffer_id);
+                destroy_buffer(ring->buffer_id);
+            }
+            *ring = FrameRing{};
+        }
+        if (frame.render_finished != VK_NULL_HANDLE) vkDestroySemaphore(device_, frame.render_finished, nullptr);
+        if (frame.image_available != VK_NULL_HANDLE) vkDestroySemaphore(device_, frame.image_available, nullptr);
+        if (frame.fence != VK_NULL_HANDLE) vkDestroyFence(device_, frame.fence, nullptr);
+        if (frame.command_pool != VK_NULL_HANDLE) vkDestroyCommandPool(device_, frame.command_pool, nullptr);
+        frame = FrameContext{};
+    }
+}
+
 bool VulkanBackend::create_descriptor_pool() {
     std::array<VkDescriptorPoolSize, 4> pool_sizes{};
     pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -394,7 +459,19 @@ uint32_t VulkanBackend::create_image(uint32_t width, uint32_t height, VkFormat f
     view_info.image = vulkan_image.image;
     view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
     view_info.format = format;
-    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_D32_SFLOAT:
+            view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            break;
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            break;
+        default:
+            view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            break;
+    }
     view_info.subresourceRange.baseMipLevel = 0;
     view_info.subresourceRange.levelCount = 1;
     view_info.subresourceRange.baseArrayLayer = 0;
@@ -436,6 +513,21 @@ void VulkanBackend::destroy_image(uint32_t image_id) {
     }
 }
 
+VkBuffer VulkanBackend::get_buffer(uint32_t buffer_id) const {
+    auto it = buffers_.find(buffer_id);
+    return it != buffers_.end() ? it->second.buffer : VK_NULL_HANDLE;
+}
+
+VkImage VulkanBackend::get_image(uint32_t image_id) const {
+    auto it = images_.find(image_id);
+    return it != images_.end() ? it->second.image : VK_NULL_HANDLE;
+}
+
+VkImageView VulkanBackend::get_image_view(uint32_t image_id) const {
+    auto it = images_.find(image_id);
+    return it != images_.end() ? it->second.image_view : VK_NULL_HANDLE;
+}
+
 void* VulkanBackend::map_buffer(uint32_t buffer_id) {
     auto it = buffers_.find(buffer_id);
     if (it == buffers_.end()) return nullptr;
@@ -455,37 +547,235 @@ void VulkanBackend::unmap_buffer(uint32_t buffer_id) {
     }
 }
 
-VkCommandBuffer VulkanBackend::begin_single_time_commands() {
-    VkCommandBufferAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = command_pool_;
-    alloc_info.commandBufferCount = 1;
+VulkanBackend::FrameContext& VulkanBackend::begin_frame_recording() {
+    FrameContext& frame = frames_[frame_index_];
+    if (frame.recording) {
+        return frame;
+    }
     
-    VkCommandBuffer command_buffer;
-    vkAllocateCommandBuffers(device_, &alloc_info, &command_buffer);
+    if (frame.command_buffers.empty()) {
+        frame.command_buffers.resize(1);
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool = frame.command_pool;
+        alloc_info.commandBufferCount = 1;
+        vkAllocateCommandBuffers(device_, &alloc_info, frame.command_buffers.data());
+    }
     
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.command_buffers[0], &begin_info);
     
-    vkBeginCommandBuffer(command_buffer, &begin_info);
+    frame.command_buffers_used = 1;
+    frame.recording = true;
+    return frame;
+}
+
+VkCommandBuffer VulkanBackend::get_frame_command_buffer() {
+    return begin_frame_recording().command_buffers[0];
+}
+
+VkCommandBuffer VulkanBackend::allocate_frame_command_buffer() {
+    FrameContext& frame = begin_frame_recording();
+    
+    // Command buffers are kept with the pool and reused every time the frame comes around
+    if (frame.command_buffers_used == frame.command_buffers.size()) {
+        VkCommandBuffer command_buffer;
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool = frame.command_pool;
+        alloc_info.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device_, &alloc_info, &command_buffer) != VK_SUCCESS) {
+            std::cerr << "VulkanBackend: Failed to allocate frame command buffer" << std::endl;
+            return VK_NULL_HANDLE;
+        }
+        frame.command_buffers.push_back(command_buffer);
+    }
     
+    VkCommandBuffer command_buffer = frame.command_buffers[frame.command_buffers_used++];
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(command_buffer, &begin_info);
     return command_buffer;
 }
 
-void VulkanBackend::end_single_time_commands(VkCommandBuffer command_buffer) {
-    vkEndCommandBuffer(command_buffer);
+bool VulkanBackend::allocate_from_ring(FrameRing& ring, VkDeviceSize ring_size, VkDeviceSize size,
+                                       VkBufferUsageFlags usage, VmaMemoryUsage memory_usage,
+                                       StagingAllocation& allocation) {
+    if (!ring.buffer_id && size <= ring_size) {
+        ring.buffer_id = create_buffer(ring_size, usage, memory_usage);
+        ring.mapped = ring.buffer_id ? static_cast<uint8_t*>(map_buffer(ring.buffer_id)) : nullptr;
+        if (!ring.mapped) {
+            if (ring.buffer_id) destroy_buffer(ring.buffer_id);
+            ring = FrameRing{};
+            return false;
+        }
+        ring.buffer = get_buffer(ring.buffer_id);
+        ring.size = ring_size;
+        ring.used = 0;
+    }
+    
+    VkDeviceSize offset = (ring.used + 15) & ~VkDeviceSize(15);
+    if (ring.buffer_id && offset + size <= ring.size) {
+        ring.used = offset + size;
+        allocation = {ring.buffer, offset, ring.mapped + offset};
+        return true;
+    }
+    
+    // The ring is full for this frame: fall back to a dedicated buffer freed on retire
+    uint32_t buffer_id = create_buffer(size, usage, memory_usage);
+    void* mapped = buffer_id ? map_buffer(buffer_id) : nullptr;
+    if (!mapped) {
+        if (buffer_id) destroy_buffer(buffer_id);
+        return false;
+    }
+    frames_[frame_index_].overflow_buffers.push_back(buffer_id);
+    allocation = {get_buffer(buffer_id), 0, static_cast<uint8_t*>(mapped)};
+    return true;
+}
+
+bool VulkanBackend::allocate_staging(VkDeviceSize size, StagingAllocation& allocation) {
+    return allocate_from_ring(frames_[frame_index_].staging, FRAME_STAGING_SIZE, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VMA_MEMORY_USAGE_CPU_TO_GPU, allocation);
+}
+
+bool VulkanBackend::allocate_readback(VkDeviceSize size, StagingAllocation& allocation) {
+    return allocate_from_ring(frames_[frame_index_].readback, FRAME_READBACK_SIZE, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VMA_MEMORY_USAGE_GPU_TO_CPU, allocation);
+}
+
+void VulkanBackend::defer_until_retired(std::function<void()> callback) {
+    frames_[frame_index_].retire_callbacks.push_back(std::move(callback));
+}
+
+void VulkanBackend::add_frame_wait(VkSemaphore timeline, uint64_t value, VkPipelineStageFlags stage) {
+    FrameContext& frame = frames_[frame_index_];
+    for (size_t i = 0; i < frame.wait_semaphores.size(); ++i) {
+        if (frame.wait_semaphores[i] == timeline) {
+            frame.wait_values[i] = std::max(frame.wait_values[i], value);
+            frame.wait_stages[i] |= stage;
+            return;
+        }
+    }
+    frame.wait_semaphores.push_back(timeline);
+    frame.wait_values.push_back(value);
+    frame.wait_stages.push_back(stage);
+}
+
+bool VulkanBackend::end_frame(VkSemaphore wait_semaphore, VkPipelineStageFlags wait_stage,
+                              VkSemaphore signal_semaphore) {
+    // Uploads staged this frame go out on the transfer queue; finished ones
+    // are handed to this frame
+    if (upload_manager_) {
+        upload_manager_->submit();
+        upload_manager_->acquire_completed();
+    }
+    
+    FrameContext& frame = frames_[frame_index_];
+    bool has_work = frame.recording || !frame.retire_callbacks.empty() || !frame.overflow_buffers.empty() ||
+                    frame.staging.used || frame.readback.used || !frame.wait_semaphores.empty();
+    if (!has_work && wait_semaphore == VK_NULL_HANDLE && signal_semaphore == VK_NULL_HANDLE) {
+        return true;
+    }
+    
+    for (uint32_t i = 0; i < frame.command_buffers_used; ++i) {
+        vkEndCommandBuffer(frame.command_buffers[i]);
+    }
     
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
+    submit_info.commandBufferCount = frame.command_buffers_used;
+    submit_info.pCommandBuffers = frame.command_buffers.data();
+    // Timeline values are ignored for the binary semaphores
+    if (wait_semaphore != VK_NULL_HANDLE) {
+        frame.wait_semaphores.push_back(wait_semaphore);
+        frame.wait_values.push_back(0);
+        frame.wait_stages.push_back(wait_stage);
+    }
+    uint64_t signal_value = 0;
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(frame.wait_values.size());
+    timeline_info.pWaitSemaphoreValues = frame.wait_values.data();
+    timeline_info.signalSemaphoreValueCount = signal_semaphore != VK_NULL_HANDLE ? 1 : 0;
+    timeline_info.pSignalSemaphoreValues = &signal_value;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = static_cast<uint32_t>(frame.wait_semaphores.size());
+    submit_info.pWaitSemaphores = frame.wait_semaphores.data();
+    submit_info.pWaitDstStageMask = frame.wait_stages.data();
+    if (signal_semaphore != VK_NULL_HANDLE) {
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &signal_semaphore;
+    }
     
-    vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphics_queue_);
+    bool submitted = vkQueueSubmit(graphics_queue_, 1, &submit_info, frame.fence) == VK_SUCCESS;
+    if (!submitted) {
+        std::cerr << "VulkanBackend: Frame " << frame_number_ << " submit failed" << std::endl;
+    }
+    frame.wait_semaphores.clear();
+    frame.wait_values.clear();
+    frame.wait_stages.clear();
+    frame.recording = false;
+    frame.submitted = submitted;
+    if (!submitted) {
+        // Nothing will signal the fence; release the frame now
+        retire_frame(frame);
+    }
     
-    vkFreeCommandBuffers(device_, command_pool_, 1, &command_buffer);
+    frame_index_ = (frame_index_ + 1) % FRAMES_IN_FLIGHT;
+    frame_number_++;
+    
+    // Reusing the next frame's pool and rings requires its last submission to have finished
+    retire_frame(frames_[frame_index_]);
+    return submitted;
+}
+
+void VulkanBackend::retire_frame(FrameContext& frame) {
+    if (frame.submitted) {
+        vkWaitForFences(device_, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device_, 1, &frame.fence);
+        frame.submitted = false;
+    }
+    
+    // Callbacks may read the frame's rings, so they run before the rings are reset
+    std::vector<std::function<void()>> callbacks;
+    callbacks.swap(frame.retire_callbacks);
+    for (auto& callback : callbacks) {
+        callback();
+    }
+    
+    for (uint32_t id : frame.overflow_buffers) {
+        unmap_buffer(id);
+        destroy_buffer(id);
+    }
+    frame.overflow_buffers.clear();
+    frame.staging.used = 0;
+    frame.readback.used = 0;
+    
+    vkResetCommandPool(device_, frame.command_pool, 0);
+    frame.command_buffers_used = 0;
+}
+
+void VulkanBackend::wait_frames() {
+    if (device_ == VK_NULL_HANDLE) return;
+    
+    end_frame();
+    // Oldest first, so retire callbacks run in submission order
+    for (uint32_t i = 1; i <= FRAMES_IN_FLIGHT; ++i) {
+        FrameContext& frame = frames_[(frame_index_ + i) % FRAMES_IN_FLIGHT];
+        if (frame.submitted) {
+            retire_frame(frame);
+        }
+    }
+}
+
+VulkanBackend::FrameSemaphores VulkanBackend::get_frame_semaphores() const {
+    const FrameContext& frame = frames_[frame_index_];
+    return {frame.image_available, frame.render_finished};
 }
 
 void VulkanBackend::copy_buffer(uint32_t src_buffer_id, uint32_t dst_buffer_id, VkDeviceSize size) {
@@ -497,13 +787,9 @@ void VulkanBackend::copy_buffer(uint32_t src_buffer_id, uint32_t dst_buffer_id,
         return;
     }
     
-    VkCommandBuffer command_buffer = begin_single_time_commands();
-    
     VkBufferCopy copy_region{};
     copy_region.size = size;
-    vkCmdCopyBuffer(command_buffer, src_it->second.buffer, dst_it->second.buffer, 1, &copy_region);
-    
-    end_single_time_commands(command_buffer);
+    vkCmdCopyBuffer(get_frame_command_buffer(), src_it->second.buffer, dst_it->second.buffer, 1, &copy_region);
 }
 
 void VulkanBackend::transition_image_layout(uint32_t image_id, VkImageLayout old_layout, VkImageLayout new_layout) {
@@ -513,7 +799,7 @@ void VulkanBackend::transition_image_layout(uint32_t image_id, VkImageLayout old
         return;
     }
     
-    VkCommandBuffer command_buffer = begin_single_time_commands();
+    VkCommandBuffer command_buffer = get_frame_command_buffer();
     
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -549,8 +835,6 @@ void VulkanBackend::transition_image_layout(uint32_t image_id, VkImageLayout old
     }
     
     vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-    
-    end_single_time_commands(command_buffer);
 }
 
 #endif
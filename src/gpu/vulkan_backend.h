@@ -4,9 +4,37 @@
 #include <vk_mem_alloc.h>
 #include <unordered_map>
 #include <optional>
+#include <array>
+#include <functional>
+#include <vector>
+#include <memory>
 
+class VulkanUploadManager;
+
+// Work is recorded into the current frame and submitted with a single
+// vkQueueSubmit by end_frame(). Each of the FRAMES_IN_FLIGHT frames owns a
+// command pool, a fence, presentation semaphores and host-visible staging
+// and readback rings; a frame's resources are only reused after its fence
+// signals, so the CPU waits on the GPU only when it gets FRAMES_IN_FLIGHT
+// submissions ahead (or at an explicit wait_frames()).
 class VulkanBackend {
 public:
+    static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+    static constexpr VkDeviceSize FRAME_STAGING_SIZE = 64 * 1024 * 1024;
+    static constexpr VkDeviceSize FRAME_READBACK_SIZE = 16 * 1024 * 1024;
+    
+    // Host-visible memory in the current frame, valid until the frame retires
+    struct StagingAllocation {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        uint8_t* mapped;
+    };
+    
+    struct FrameSemaphores {
+        VkSemaphore image_available;
+        VkSemaphore render_finished;
+    };
+    
     VulkanBackend();
     ~VulkanBackend();
     
@@ -24,11 +52,28 @@ public:
     void* map_buffer(uint32_t buffer_id);
     void unmap_buffer(uint32_t buffer_id);
     
-    // Command buffer utilities
-    VkCommandBuffer begin_single_time_commands();
-    void end_single_time_commands(VkCommandBuffer command_buffer);
-    
-    // Buffer operations
+    // Frames in flight
+    // The frame's first command buffer; backend operations record here
+    VkCommandBuffer get_frame_command_buffer();
+    // A further command buffer, already begun, submitted after those allocated before it
+    VkCommandBuffer allocate_frame_command_buffer();
+    bool allocate_staging(VkDeviceSize size, StagingAllocation& allocation);
+    bool allocate_readback(VkDeviceSize size, StagingAllocation& allocation);
+    // Runs once the GPU has finished the current frame, in submission order
+    void defer_until_retired(std::function<void()> callback);
+    // Makes the current frame's submission wait for a timeline semaphore value
+    void add_frame_wait(VkSemaphore timeline, uint64_t value, VkPipelineStageFlags stage);
+    // Submits the current frame and moves to the next, waiting only if that
+    // frame's previous submission is still executing
+    bool end_frame(VkSemaphore wait_semaphore = VK_NULL_HANDLE, VkPipelineStageFlags wait_stage = 0,
+                   VkSemaphore signal_semaphore = VK_NULL_HANDLE);
+    // Submits pending work and retires every frame in flight
+    void wait_frames();
+    uint32_t get_frame_index() const { return frame_index_; }
+    uint64_t get_frame_number() const { return frame_number_; }
+    FrameSemaphores get_frame_semaphores() const;
+    
+    // Buffer operations (recorded into the current frame)
     void copy_buffer(uint32_t src_buffer_id, uint32_t dst_buffer_id, VkDeviceSize size);
     void transition_image_layout(uint32_t image_id, VkImageLayout old_layout, VkImageLayout new_layout);
     
@@ -38,9 +83,19 @@ public:
     VkInstance get_instance() const { return instance_; }
     VkQueue get_graphics_queue() const { return graphics_queue_; }
     VkQueue get_compute_queue() const { return compute_queue_; }
+    VkQueue get_transfer_queue() const { return transfer_queue_; }
     VkCommandPool get_command_pool() const { return command_pool_; }
     VkDescriptorPool get_descriptor_pool() const { return descriptor_pool_; }
     VmaAllocator get_memory_allocator() const { return memory_allocator_; }
+    uint32_t get_graphics_queue_family() const { return queue_family_indices_.graphics_family.value_or(0); }
+    uint32_t get_transfer_queue_family() const { return queue_family_indices_.transfer_family.value_or(0); }
+    // Streaming uploads on the transfer queue (nullptr if unavailable)
+    VulkanUploadManager* get_upload_manager() const { return upload_manager_.get(); }
+    
+    // Resource handle lookup (VK_NULL_HANDLE for unknown ids)
+    VkBuffer get_buffer(uint32_t buffer_id) const;
+    VkImage get_image(uint32_t image_id) const;
+    VkImageView get_image_view(uint32_t image_id) const;
     
     bool is_initialized() const { return initialized_; }
     
@@ -64,6 +119,32 @@ private:
         VkBufferUsageFlags usage = 0;
     };
     
+    struct FrameRing {
+        uint32_t buffer_id = 0;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;
+        VkDeviceSize size = 0;
+        VkDeviceSize used = 0;
+    };
+    
+    struct FrameContext {
+        VkCommandPool command_pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> command_buffers;   // [0] is the frame command buffer
+        uint32_t command_buffers_used = 0;
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore image_available = VK_NULL_HANDLE;
+        VkSemaphore render_finished = VK_NULL_HANDLE;
+        FrameRing staging;
+        FrameRing readback;
+        std::vector<uint32_t> overflow_buffers;         // ring overflow, freed on retire
+        std::vector<std::function<void()>> retire_callbacks;
+        std::vector<VkSemaphore> wait_semaphores;       // timeline waits for the next submit
+        std::vector<uint64_t> wait_values;
+        std::vector<VkPipelineStageFlags> wait_stages;
+        bool recording = false;
+        bool submitted = false;
+    };
+    
     struct VulkanImage {
         VkImage image = VK_NULL_HANDLE;
         VkImageView image_view = VK_NULL_HANDLE;
@@ -96,6 +177,12 @@ private:
     std::unordered_map<uint32_t, VulkanImage> images_;
     uint32_t next_resource_id_ = 1;
     
+    // Frames in flight
+    std::array<FrameContext, FRAMES_IN_FLIGHT> frames_;
+    uint32_t frame_index_ = 0;
+    uint64_t frame_number_ = 0;
+    std::unique_ptr<VulkanUploadManager> upload_manager_;
+    
     bool initialized_;
     
     // Initialization helpers
@@ -105,6 +192,14 @@ private:
     bool create_command_pool();
     bool create_descriptor_pool();
     bool create_memory_allocator();
+    bool create_frame_resources();
+    void destroy_frame_resources();
+    
+    // Frame helpers
+    FrameContext& begin_frame_recording();
+    void retire_frame(FrameContext& frame);
+    bool allocate_from_ring(FrameRing& ring, VkDeviceSize ring_size, VkDeviceSize size, VkBufferUsageFlags usage,
+                            VmaMemoryUsage memory_usage, StagingAllocation& allocation);
     
     // Device selection
     int rate_device_suitability(VkPhysicalDevice device);
@@ -0,0 +1,473 @@
+#include "vulkan_pipeline_cache.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "../core/scheduler.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+using GP = PS5Emu::GraphicsPipeline;
+
+constexpr char RECORDED_MAGIC[8] = {'P', 'S', 'X', '5', 'P', 'S', 'O', '\0'};
+constexpr uint32_t RECORDED_VERSION = 1;
+constexpr const char* RECORDED_FILE = "pipelines.bin";
+constexpr const char* VK_CACHE_FILE = "pipeline_cache.bin";
+
+uint64_t fnv1a(const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Field-by-field serialization. Structs are never copied wholesale, so
+// padding bytes cannot leak into hashes or files.
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void operator()(const uint32_t& v) { put(&v, sizeof(v)); }
+    void operator()(const int32_t& v) { put(&v, sizeof(v)); }
+    void operator()(const uint64_t& v) { put(&v, sizeof(v)); }
+    void operator()(const float& v) { put(&v, sizeof(v)); }
+    void operator()(const bool& v) { uint8_t b = v ? 1 : 0; put(&b, 1); }
+
+    template <typename T, typename Fn>
+    void vec(const std::vector<T>& v, Fn&& fn) {
+        (*this)(static_cast<uint32_t>(v.size()));
+        for (const T& item : v) fn(const_cast<T&>(item));
+    }
+
+    bool ok() const { return true; }
+
+private:
+    void put(const void* p, size_t n) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(p);
+        out_.insert(out_.end(), bytes, bytes + n);
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    void operator()(uint32_t& v) { get(&v, sizeof(v)); }
+    void operator()(int32_t& v) { get(&v, sizeof(v)); }
+    void operator()(uint64_t& v) { get(&v, sizeof(v)); }
+    void operator()(float& v) { get(&v, sizeof(v)); }
+    void operator()(bool& v) { uint8_t b = 0; get(&b, 1); v = b != 0; }
+
+    template <typename T, typename Fn>
+    void vec(std::vector<T>& v, Fn&& fn) {
+        uint32_t count = 0;
+        (*this)(count);
+        // Every element is at least one byte; reject counts the data cannot hold
+        if (!ok_ || count > size_ - pos_) {
+            ok_ = false;
+            return;
+        }
+        v.assign(count, T{});
+        for (T& item : v) fn(item);
+    }
+
+    bool ok() const { return ok_ && pos_ == size_; }
+
+private:
+    void get(void* p, size_t n) {
+        if (!ok_ || n > size_ - pos_) {
+            ok_ = false;
+            std::memset(p, 0, n);
+            return;
+        }
+        std::memcpy(p, data_ + pos_, n);
+        pos_ += n;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+template <typename Ar>
+void serialize_u32_vec(Ar& ar, std::vector<uint32_t>& v) {
+    ar.vec(v, [&](uint32_t& x) { ar(x); });
+}
+
+template <typename Ar>
+void serialize_blend(Ar& ar, GP::ColorBlendState::ColorBlendAttachment& a) {
+    ar(a.blend_enable); ar(a.src_color_blend_factor); ar(a.dst_color_blend_factor); ar(a.color_blend_op);
+    ar(a.src_alpha_blend_factor); ar(a.dst_alpha_blend_factor); ar(a.alpha_blend_op); ar(a.color_write_mask);
+}
+
+template <typename Ar>
+void serialize_stencil(Ar& ar, GP::DepthStencilState::StencilOpState& s) {
+    ar(s.fail_op); ar(s.pass_op); ar(s.depth_fail_op); ar(s.compare_op);
+    ar(s.compare_mask); ar(s.write_mask); ar(s.reference);
+}
+
+// Session ids (pipeline_id, shader ids, render_pass, subpass) are skipped
+template <typename Ar>
+void serialize_state(Ar& ar, GP::PipelineState& s) {
+    ar.vec(s.vertex_input.bindings, [&](GP::VertexInputState::VertexBinding& b) {
+        ar(b.binding); ar(b.stride); ar(b.per_instance);
+    });
+    ar.vec(s.vertex_input.attributes, [&](GP::VertexInputState::VertexAttribute& a) {
+        ar(a.location); ar(a.binding); ar(a.format); ar(a.offset);
+    });
+
+    ar(s.tessellation.enabled); ar(s.tessellation.patch_control_points);
+    for (float& level : s.tessellation.tessellation_levels) ar(level);
+
+    ar(s.geometry.enabled); ar(s.geometry.input_primitive);
+    ar(s.geometry.output_primitive); ar(s.geometry.max_output_vertices);
+
+    auto& r = s.rasterization;
+    ar(r.depth_clamp_enable); ar(r.rasterizer_discard_enable); ar(r.polygon_mode); ar(r.cull_mode);
+    ar(r.front_face); ar(r.depth_bias_enable); ar(r.depth_bias_constant); ar(r.depth_bias_clamp);
+    ar(r.depth_bias_slope); ar(r.line_width);
+
+    auto& m = s.multisample;
+    ar(m.sample_count); ar(m.sample_shading_enable); ar(m.min_sample_shading); ar(m.sample_mask);
+    ar(m.alpha_to_coverage_enable); ar(m.alpha_to_one_enable);
+
+    auto& d = s.depth_stencil;
+    ar(d.depth_test_enable); ar(d.depth_write_enable); ar(d.depth_compare_op);
+    ar(d.depth_bounds_test_enable); ar(d.stencil_test_enable);
+    serialize_stencil(ar, d.front_stencil);
+    serialize_stencil(ar, d.back_stencil);
+    ar(d.min_depth_bounds); ar(d.max_depth_bounds);
+
+    ar(s.color_blend.logic_op_enable); ar(s.color_blend.logic_op);
+    ar.vec(s.color_blend.attachments, [&](GP::ColorBlendState::ColorBlendAttachment& a) { serialize_blend(ar, a); });
+    for (float& c : s.color_blend.blend_constants) ar(c);
+
+    auto& mrt = s.multi_render_target;
+    serialize_u32_vec(ar, mrt.color_attachments);
+    ar(mrt.depth_attachment); ar(mrt.independent_blend_enable);
+    ar.vec(mrt.per_target_blend, [&](GP::ColorBlendState::ColorBlendAttachment& a) { serialize_blend(ar, a); });
+}
+
+// render_pass_id is skipped
+template <typename Ar>
+void serialize_render_pass(Ar& ar, GP::RenderPass& rp) {
+    ar.vec(rp.attachments, [&](GP::RenderPass::Attachment& a) {
+        ar(a.format); ar(a.samples); ar(a.load_op); ar(a.store_op);
+        ar(a.stencil_load_op); ar(a.stencil_store_op); ar(a.initial_layout); ar(a.final_layout);
+    });
+    ar.vec(rp.subpasses, [&](GP::RenderPass::SubpassDescription& s) {
+        serialize_u32_vec(ar, s.input_attachments);
+        serialize_u32_vec(ar, s.color_attachments);
+        serialize_u32_vec(ar, s.resolve_attachments);
+        ar(s.depth_stencil_attachment);
+        serialize_u32_vec(ar, s.preserve_attachments);
+        ar(s.variable_rate_shading_enabled); ar(s.shading_rate);
+    });
+    ar.vec(rp.dependencies, [&](GP::RenderPass::SubpassDependency& d) {
+        ar(d.src_subpass); ar(d.dst_subpass); ar(d.src_stage_mask); ar(d.dst_stage_mask);
+        ar(d.src_access_mask); ar(d.dst_access_mask); ar(d.memory_barrier); ar(d.buffer_barrier); ar(d.image_barrier);
+    });
+    ar(rp.tile_based_optimization); ar(rp.early_z_optimization); ar(rp.conservative_rasterization);
+}
+
+template <typename Ar>
+void serialize_desc(Ar& ar, GraphicsPipelineDesc& desc) {
+    serialize_state(ar, desc.state);
+    serialize_render_pass(ar, desc.render_pass);
+    ar(desc.subpass);
+    ar(desc.topology);
+    for (uint64_t& hash : desc.shader_hashes) ar(hash);
+}
+
+std::vector<uint8_t> encode_desc(const GraphicsPipelineDesc& desc) {
+    std::vector<uint8_t> bytes;
+    StateWriter writer(bytes);
+    serialize_desc(writer, const_cast<GraphicsPipelineDesc&>(desc));
+    return bytes;
+}
+
+} // namespace
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    shutdown();
+}
+
+uint64_t VulkanPipelineCache::hash_desc(const GraphicsPipelineDesc& desc) {
+    std::vector<uint8_t> bytes = encode_desc(desc);
+    return fnv1a(bytes.data(), bytes.size());
+}
+
+uint64_t VulkanPipelineCache::hash_render_pass(const PS5Emu::GraphicsPipeline::RenderPass& render_pass) {
+    std::vector<uint8_t> bytes;
+    StateWriter writer(bytes);
+    serialize_render_pass(writer, const_cast<PS5Emu::GraphicsPipeline::RenderPass&>(render_pass));
+    return fnv1a(bytes.data(), bytes.size());
+}
+
+uint64_t VulkanPipelineCache::hash_spirv(const std::vector<uint32_t>& spirv) {
+    return fnv1a(reinterpret_cast<const uint8_t*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+}
+
+bool VulkanPipelineCache::init(VkDevice device, const VkPhysicalDeviceProperties& properties,
+                               const std::string& directory) {
+    device_ = device;
+    directory_ = directory;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+
+    std::vector<uint8_t> initial_data;
+    if (!load_vk_cache(directory_ + "/" + VK_CACHE_FILE, properties, initial_data)) {
+        initial_data.clear();
+    }
+
+    VkPipelineCacheCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = initial_data.size();
+    create_info.pInitialData = initial_data.empty() ? nullptr : initial_data.data();
+    if (vkCreatePipelineCache(device_, &create_info, nullptr, &vk_cache_) != VK_SUCCESS) {
+        // Stale or corrupt data must not stop us from starting with an empty cache
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = nullptr;
+        if (vkCreatePipelineCache(device_, &create_info, nullptr, &vk_cache_) != VK_SUCCESS) {
+            std::cerr << "VulkanPipelineCache: Failed to create pipeline cache" << std::endl;
+            return false;
+        }
+    }
+
+    load_recorded(directory_ + "/" + RECORDED_FILE);
+    std::cout << "VulkanPipelineCache: " << initial_data.size() << " bytes of driver cache, "
+              << recorded_.size() << " recorded pipelines" << std::endl;
+    return true;
+}
+
+void VulkanPipelineCache::shutdown() {
+    if (device_ == VK_NULL_HANDLE) return;
+
+    wait_idle();
+    if (vk_cache_ != VK_NULL_HANDLE) {
+        save_vk_cache(directory_ + "/" + VK_CACHE_FILE);
+    }
+    save_recorded(directory_ + "/" + RECORDED_FILE);
+
+    for (auto& [key, entry] : entries_) {
+        if (entry.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device_, entry.pipeline, nullptr);
+        }
+    }
+    entries_.clear();
+    if (vk_cache_ != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(device_, vk_cache_, nullptr);
+        vk_cache_ = VK_NULL_HANDLE;
+    }
+    device_ = VK_NULL_HANDLE;
+}
+
+VulkanPipelineCache::Status VulkanPipelineCache::request(uint64_t key, const GraphicsPipelineDesc& desc,
+                                                         BuildFn build, VkPipeline& pipeline) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.requests++;
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            pipeline = it->second.pipeline;
+            return it->second.status;
+        }
+        entries_[key] = {Status::Compiling, VK_NULL_HANDLE};
+        if (recorded_.size() < MAX_RECORDED_PIPELINES || recorded_.count(key)) {
+            recorded_[key] = desc;
+        }
+        in_flight_++;
+    }
+
+    if (scheduler_ && scheduler_->is_running()) {
+        scheduler_->schedule_task([this, key, build = std::move(build)] { compile(key, build); });
+        pipeline = VK_NULL_HANDLE;
+        return Status::Compiling;
+    }
+
+    // No workers: compile on the calling thread
+    compile(key, build);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry& entry = entries_[key];
+    pipeline = entry.pipeline;
+    return entry.status;
+}
+
+void VulkanPipelineCache::compile(uint64_t key, const BuildFn& build) {
+    auto start = std::chrono::steady_clock::now();
+    VkPipeline pipeline = build(vk_cache_);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[key];
+    entry.pipeline = pipeline;
+    entry.status = pipeline != VK_NULL_HANDLE ? Status::Ready : Status::Failed;
+    if (pipeline != VK_NULL_HANDLE) {
+        stats_.compiled++;
+    } else {
+        stats_.failed++;
+        recorded_.erase(key);
+    }
+    stats_.compile_time_us += static_cast<uint64_t>(elapsed.count());
+    if (--in_flight_ == 0) {
+        idle_cv_.notify_all();
+    }
+}
+
+std::vector<GraphicsPipelineDesc> VulkanPipelineCache::take_prewarm(const std::unordered_set<uint64_t>& shader_hashes) {
+    std::vector<GraphicsPipelineDesc> ready;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = prewarm_pending_.begin();
+    while (it != prewarm_pending_.end()) {
+        auto recorded = recorded_.find(*it);
+        if (recorded == recorded_.end() || entries_.count(*it)) {
+            it = prewarm_pending_.erase(it);
+            continue;
+        }
+        bool available = true;
+        for (uint64_t hash : recorded->second.shader_hashes) {
+            if (hash != 0 && !shader_hashes.count(hash)) {
+                available = false;
+                break;
+            }
+        }
+        if (available) {
+            ready.push_back(recorded->second);
+            it = prewarm_pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return ready;
+}
+
+void VulkanPipelineCache::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+VulkanPipelineCache::Stats VulkanPipelineCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Persistence
+
+bool VulkanPipelineCache::load_recorded(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, RECORDED_MAGIC, sizeof(magic)) != 0 || version != RECORDED_VERSION) {
+        std::cerr << "VulkanPipelineCache: Ignoring incompatible " << path << std::endl;
+        return false;
+    }
+
+    count = std::min(count, MAX_RECORDED_PIPELINES);
+    std::vector<uint8_t> bytes;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t size = 0;
+        file.read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (!file || size > (1u << 20)) break;
+        bytes.resize(size);
+        file.read(reinterpret_cast<char*>(bytes.data()), size);
+        if (!file) break;
+
+        GraphicsPipelineDesc desc{};
+        StateReader reader(bytes.data(), bytes.size());
+        serialize_desc(reader, desc);
+        if (!reader.ok()) continue;
+
+        uint64_t key = fnv1a(bytes.data(), bytes.size());
+        if (recorded_.emplace(key, std::move(desc)).second) {
+            prewarm_pending_.push_back(key);
+        }
+    }
+    return true;
+}
+
+bool VulkanPipelineCache::save_recorded(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Write to a temporary file so a crash mid-save keeps the old list
+    std::string temp_path = path + ".tmp";
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    uint32_t count = static_cast<uint32_t>(recorded_.size());
+    file.write(RECORDED_MAGIC, sizeof(RECORDED_MAGIC));
+    file.write(reinterpret_cast<const char*>(&RECORDED_VERSION), sizeof(RECORDED_VERSION));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& [key, desc] : recorded_) {
+        std::vector<uint8_t> bytes = encode_desc(desc);
+        uint32_t size = static_cast<uint32_t>(bytes.size());
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(reinterpret_cast<const char*>(bytes.data()), size);
+    }
+    file.close();
+    if (!file) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    return !ec;
+}
+
+bool VulkanPipelineCache::load_vk_cache(const std::string& path, const VkPhysicalDeviceProperties& properties,
+                                        std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamsize size = file.tellg();
+    // Version one header: length, version, vendor id, device id, cache UUID
+    constexpr size_t HEADER_SIZE = 16 + VK_UUID_SIZE;
+    if (size < static_cast<std::streamsize>(HEADER_SIZE)) return false;
+
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), size);
+    if (!file) return false;
+
+    uint32_t header[4];
+    std::memcpy(header, data.data(), sizeof(header));
+    if (header[2] != properties.vendorID || header[3] != properties.deviceID ||
+        std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        std::cout << "VulkanPipelineCache: Driver or device changed, discarding " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VulkanPipelineCache::save_vk_cache(const std::string& path) {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, vk_cache_, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return false;
+    }
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device_, vk_cache_, &size, data.data()) != VK_SUCCESS) {
+        return false;
+    }
+
+    std::string temp_path = path + ".tmp";
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(size));
+    file.close();
+    if (!file) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    return !ec;
+}
+#endif
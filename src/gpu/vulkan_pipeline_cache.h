@@ -0,0 +1,105 @@
+#pragma once
+#ifdef PSX5_ENABLE_VULKAN
+#include <vulkan/vulkan.h>
+#include "graphics_pipeline.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Scheduler;
+
+// Everything a graphics VkPipeline depends on, with session-specific ids
+// (pipeline, render pass and shader ids) replaced by content hashes so the
+// same state maps to the same key in every session.
+struct GraphicsPipelineDesc {
+    PS5Emu::GraphicsPipeline::PipelineState state;
+    PS5Emu::GraphicsPipeline::RenderPass render_pass;
+    uint32_t subpass;
+    uint32_t topology;
+    std::array<uint64_t, 5> shader_hashes; // VS, TCS, TES, GS, FS; 0 = stage unused
+};
+
+// Graphics pipeline cache
+// Pipelines are keyed by a hash of their GraphicsPipelineDesc and compiled
+// on scheduler workers; request() reports Compiling until the pipeline is
+// ready. Driver-side results go through a VkPipelineCache that is saved to
+// disk, and every desc requested is recorded so the next session can
+// pre-warm those pipelines as soon as their shaders are loaded.
+class VulkanPipelineCache {
+public:
+    enum class Status { Ready, Compiling, Failed };
+    using BuildFn = std::function<VkPipeline(VkPipelineCache cache)>;
+
+    static constexpr uint32_t MAX_RECORDED_PIPELINES = 8192;
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t compiled;
+        uint64_t failed;
+        uint64_t prewarmed;
+        uint64_t compile_time_us;
+    };
+
+    VulkanPipelineCache() = default;
+    ~VulkanPipelineCache();
+
+    // Loads the driver cache (if it matches this device) and the recorded
+    // pipeline list from `directory`
+    bool init(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::string& directory);
+    // Waits for in-flight compiles, saves both files and destroys all pipelines
+    void shutdown();
+
+    void set_scheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
+    VkPipelineCache get_vk_cache() const { return vk_cache_; }
+
+    static uint64_t hash_desc(const GraphicsPipelineDesc& desc);
+    static uint64_t hash_render_pass(const PS5Emu::GraphicsPipeline::RenderPass& render_pass);
+    static uint64_t hash_spirv(const std::vector<uint32_t>& spirv);
+
+    // Returns Ready with `pipeline` set, or starts (or continues) compiling.
+    // `build` runs on a worker thread and must only touch immutable state.
+    Status request(uint64_t key, const GraphicsPipelineDesc& desc, BuildFn build, VkPipeline& pipeline);
+
+    // Removes and returns recorded descs whose shaders are all available
+    std::vector<GraphicsPipelineDesc> take_prewarm(const std::unordered_set<uint64_t>& shader_hashes);
+    void note_prewarmed(uint64_t count) { stats_.prewarmed += count; }
+
+    void wait_idle();
+    Stats get_stats() const;
+
+private:
+    struct Entry {
+        Status status;
+        VkPipeline pipeline;
+    };
+
+    void compile(uint64_t key, const BuildFn& build);
+    bool load_recorded(const std::string& path);
+    bool save_recorded(const std::string& path);
+    bool load_vk_cache(const std::string& path, const VkPhysicalDeviceProperties& properties,
+                       std::vector<uint8_t>& data);
+    bool save_vk_cache(const std::string& path);
+
+    VkDevice device_ = VK_NULL_HANDLE;
+    VkPipelineCache vk_cache_ = VK_NULL_HANDLE;
+    Scheduler* scheduler_ = nullptr;
+    std::string directory_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    uint32_t in_flight_ = 0;
+
+    // Descs seen this session plus those recorded earlier, written back on shutdown
+    std::unordered_map<uint64_t, GraphicsPipelineDesc> recorded_;
+    std::vector<uint64_t> prewarm_pending_;
+
+    Stats stats_{};
+};
+#endif
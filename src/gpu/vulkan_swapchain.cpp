@@ -6,6 +6,7 @@
 #include <vector>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 
 static std::vector<char> read_file(const std::string& path){
     std::ifstream f(path, std::ios::binary|std::ios::ate);
@@ -17,7 +18,7 @@ static std::vector<char> read_file(const std::string& path){
 VulkanSwapchain::~VulkanSwapchain(){ shutdown(); }
 
 bool VulkanSwapchain::create_instance(GLFWwindow* window){
-    VkApplicationInfo app{}; app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO; app.pApplicationName = "psx5"; app.apiVersion = VK_API_VERSION_1_0;
+    VkApplicationInfo app{}; app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO; app.pApplicationName = "psx5"; app.apiVersion = VK_API_VERSION_1_1;
     VkInstanceCreateInfo ici{}; ici.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO; ici.pApplicationInfo = &app;
     if(vkCreateInstance(&ici, nullptr, &instance_) != VK_SUCCESS){ std::cerr<<"vkCreateInstance failed\n"; return false; }
     if(glfwCreateWindowSurface(instance_, window, nullptr, &surface_) != VK_SUCCESS){ std::cerr<<"glfwCreateWindowSurface failed\n"; return false; }
@@ -26,11 +27,32 @@ bool VulkanSwapchain::create_instance(GLFWwindow* window){
 
 bool VulkanSwapchain::pick_physical_device(){ uint32_t count=0; vkEnumeratePhysicalDevices(instance_, &count, nullptr); if(count==0) return false; std::vector<VkPhysicalDevice> devs(count); vkEnumeratePhysicalDevices(instance_, &count, devs.data()); physical_ = devs[0]; return true; }
 
-bool VulkanSwapchain::create_device_and_queues(){ float pr=1.0f; VkDeviceQueueCreateInfo qci{}; qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO; qci.queueFamilyIndex=0; qci.queueCount=1; qci.pQueuePriorities=&pr; VkDeviceCreateInfo dci{}; dci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO; dci.queueCreateInfoCount=1; dci.pQueueCreateInfos=&qci; if(vkCreateDevice(physical_, &dci, nullptr, &device_)!=VK_SUCCESS){ std::cerr<<"vkCreateDevice failed\n"; return false;} vkGetDeviceQueue(device_,0,0,&graphicsQueue_); vkGetDeviceQueue(device_,0,0,&presentQueue_); return true; }
+bool VulkanSwapchain::create_device_and_queues(){
+    uint32_t extCount=0; vkEnumerateDeviceExtensionProperties(physical_, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> exts(extCount); vkEnumerateDeviceExtensionProperties(physical_, nullptr, &extCount, exts.data());
+    for(const auto& e: exts) if(std::strcmp(e.extensionName, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)==0) hostImportSupported_ = true;
+    std::vector<const char*> enabled = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    if(hostImportSupported_){
+        enabled.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps{}; hostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 props{}; props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2; props.pNext = &hostProps;
+        vkGetPhysicalDeviceProperties2(physical_, &props);
+        hostImportAlignment_ = std::max<VkDeviceSize>(hostProps.minImportedHostPointerAlignment, 1);
+    }
+    float pr=1.0f; VkDeviceQueueCreateInfo qci{}; qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO; qci.queueFamilyIndex=0; qci.queueCount=1; qci.pQueuePriorities=&pr;
+    VkDeviceCreateInfo dci{}; dci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO; dci.queueCreateInfoCount=1; dci.pQueueCreateInfos=&qci; dci.enabledExtensionCount=(uint32_t)enabled.size(); dci.ppEnabledExtensionNames=enabled.data();
+    if(vkCreateDevice(physical_, &dci, nullptr, &device_)!=VK_SUCCESS){ std::cerr<<"vkCreateDevice failed\n"; return false;}
+    vkGetDeviceQueue(device_,0,0,&graphicsQueue_); vkGetDeviceQueue(device_,0,0,&presentQueue_);
+    if(hostImportSupported_){
+        getHostPointerProperties_ = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(vkGetDeviceProcAddr(device_, "vkGetMemoryHostPointerPropertiesEXT"));
+        hostImportSupported_ = getHostPointerProperties_ != nullptr;
+    }
+    return true;
+}
 
 bool VulkanSwapchain::create_swapchain(GLFWwindow* window){
     VkSurfaceCapabilitiesKHR caps; vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_, surface_, &caps);
-    VkSwapchainCreateInfoKHR sci{}; sci.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR; sci.surface = surface_; sci.minImageCount = caps.minImageCount+1; sci.imageFormat = VK_FORMAT_B8G8R8A8_UNORM; sci.imageColorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR; sci.imageExtent = caps.currentExtent; sci.imageArrayLayers = 1; sci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT; sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; sci.preTransform = caps.currentTransform; sci.presentMode = VK_PRESENT_MODE_FIFO_KHR; sci.clipped = VK_TRUE; if(vkCreateSwapchainKHR(device_, &sci, nullptr, &swapchain_)!=VK_SUCCESS){ std::cerr<<"vkCreateSwapchainKHR failed\n"; return false;} uint32_t count=0; vkGetSwapchainImagesKHR(device_, swapchain_, &count, nullptr); swapImages_.resize(count); vkGetSwapchainImagesKHR(device_, swapchain_, &count, swapImages_.data()); swapViews_.resize(count); for(uint32_t i=0;i<count;++i){ VkImageViewCreateInfo ivci{}; ivci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; ivci.image = swapImages_[i]; ivci.viewType = VK_IMAGE_VIEW_TYPE_2D; ivci.format = VK_FORMAT_B8G8R8A8_UNORM; ivci.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; ivci.subresourceRange.levelCount = 1; ivci.subresourceRange.layerCount = 1; if(vkCreateImageView(device_, &ivci, nullptr, &swapViews_[i])!=VK_SUCCESS){ std::cerr<<"vkCreateImageView failed\n"; return false; } }
+    VkSwapchainCreateInfoKHR sci{}; sci.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR; sci.surface = surface_; sci.minImageCount = caps.minImageCount+1; sci.imageFormat = VK_FORMAT_B8G8R8A8_UNORM; sci.imageColorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR; sci.imageExtent = caps.currentExtent; extent_ = caps.currentExtent; sci.imageArrayLayers = 1; sci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT; sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; sci.preTransform = caps.currentTransform; sci.presentMode = VK_PRESENT_MODE_FIFO_KHR; sci.clipped = VK_TRUE; if(vkCreateSwapchainKHR(device_, &sci, nullptr, &swapchain_)!=VK_SUCCESS){ std::cerr<<"vkCreateSwapchainKHR failed\n"; return false;} uint32_t count=0; vkGetSwapchainImagesKHR(device_, swapchain_, &count, nullptr); swapImages_.resize(count); vkGetSwapchainImagesKHR(device_, swapchain_, &count, swapImages_.data()); swapViews_.resize(count); for(uint32_t i=0;i<count;++i){ VkImageViewCreateInfo ivci{}; ivci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; ivci.image = swapImages_[i]; ivci.viewType = VK_IMAGE_VIEW_TYPE_2D; ivci.format = VK_FORMAT_B8G8R8A8_UNORM; ivci.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; ivci.subresourceRange.levelCount = 1; ivci.subresourceRange.layerCount = 1; if(vkCreateImageView(device_, &ivci, nullptr, &swapViews_[i])!=VK_SUCCESS){ std::cerr<<"vkCreateImageView failed\n"; return false; } }
     return true;
 }
 
@@ -38,7 +60,9 @@ bool VulkanSwapchain::create_render_pass(){
     VkAttachmentDescription att{}; att.format = VK_FORMAT_B8G8R8A8_UNORM; att.samples = VK_SAMPLE_COUNT_1_BIT; att.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; att.storeOp = VK_ATTACHMENT_STORE_OP_STORE; att.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; att.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     VkAttachmentReference colorRef{}; colorRef.attachment = 0; colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     VkSubpassDescription sub{}; sub.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS; sub.colorAttachmentCount = 1; sub.pColorAttachments = &colorRef;
-    VkRenderPassCreateInfo rpci{}; rpci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO; rpci.attachmentCount = 1; rpci.pAttachments = &att; rpci.subpassCount = 1; rpci.pSubpasses = &sub;
+    // The layout transition waits for the acquire semaphore, which is waited at colour output
+    VkSubpassDependency dep{}; dep.srcSubpass = VK_SUBPASS_EXTERNAL; dep.dstSubpass = 0; dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    VkRenderPassCreateInfo rpci{}; rpci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO; rpci.attachmentCount = 1; rpci.pAttachments = &att; rpci.subpassCount = 1; rpci.pSubpasses = &sub; rpci.dependencyCount = 1; rpci.pDependencies = &dep;
     if(vkCreateRenderPass(device_, &rpci, nullptr, &renderPass_)!=VK_SUCCESS){ std::cerr<<"vkCreateRenderPass failed\n"; return false; }
     return true;
 }
@@ -71,18 +95,34 @@ bool VulkanSwapchain::create_pipeline(const std::string& vert_spv_path, const st
     return true;
 }
 
+bool VulkanSwapchain::create_framebuffers(){
+    framebuffers_.resize(swapViews_.size(), VK_NULL_HANDLE);
+    for(size_t i=0;i<swapViews_.size();++i){
+        framebuffers_[i] = create_framebuffer_for_view(device_, renderPass_, swapViews_[i], extent_);
+        if(framebuffers_[i]==VK_NULL_HANDLE){ std::cerr<<"vkCreateFramebuffer failed\n"; return false; }
+    }
+    return true;
+}
+
 bool VulkanSwapchain::create_command_buffers(){
     VkCommandPoolCreateInfo pc{}; pc.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO; pc.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; pc.queueFamilyIndex = 0;
     if(vkCreateCommandPool(device_, &pc, nullptr, &cmdPool_)!=VK_SUCCESS) return false;
-    cmdBuffers_.resize(swapViews_.size());
+    cmdBuffers_.resize(MAX_FRAMES_IN_FLIGHT);
     VkCommandBufferAllocateInfo ai{}; ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO; ai.commandPool = cmdPool_; ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; ai.commandBufferCount = (uint32_t)cmdBuffers_.size();
     if(vkAllocateCommandBuffers(device_, &ai, cmdBuffers_.data())!=VK_SUCCESS) return false;
-    // Create framebuffers
-    VkExtent2D extent = {800,600};
-    for(size_t i=0;i<swapViews_.size();++i){
-        VkFramebuffer fb = create_framebuffer_for_view(device_, renderPass_, swapViews_[i], extent);
-        // store as a temporary in cmdBuffers_ mapping; we avoid storing framebuffers array for brevity
-        (void)fb;
+    return true;
+}
+
+bool VulkanSwapchain::create_sync_objects(){
+    imageAvailable_.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE); renderFinished_.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE); inFlight_.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    imagesInFlight_.assign(swapImages_.size(), VK_NULL_HANDLE);
+    VkSemaphoreCreateInfo sci{}; sci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    // Fences start signalled so the first wait on each frame returns immediately
+    VkFenceCreateInfo fci{}; fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO; fci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    for(size_t i=0;i<MAX_FRAMES_IN_FLIGHT;++i){
+        if(vkCreateSemaphore(device_, &sci, nullptr, &imageAvailable_[i])!=VK_SUCCESS ||
+           vkCreateSemaphore(device_, &sci, nullptr, &renderFinished_[i])!=VK_SUCCESS ||
+           vkCreateFence(device_, &fci, nullptr, &inFlight_[i])!=VK_SUCCESS){ std::cerr<<"sync object creation failed\n"; return false; }
     }
     return true;
 }
@@ -95,12 +135,19 @@ bool VulkanSwapchain::init(GLFWwindow* window){
     if(!create_render_pass()) return false;
     std::string vert = std::string("build/shaders/quad.vert.spv"); std::string frag = std::string("build/shaders/quad.frag.spv");
     if(!create_pipeline(vert, frag)) { std::cerr<<"create_pipeline failed\n"; /* continue to allow shader replacement */ }
+    if(!create_framebuffers()) return false;
     if(!create_command_buffers()) return false;
+    if(!create_sync_objects()) return false;
     initialized_ = true; return true;
 }
 
 void VulkanSwapchain::shutdown(){
     if(device_) vkDeviceWaitIdle(device_);
+    destroy_present_resources();
+    for(auto f: inFlight_) if(f) vkDestroyFence(device_, f, nullptr); inFlight_.clear(); imagesInFlight_.clear();
+    for(auto sem: imageAvailable_) if(sem) vkDestroySemaphore(device_, sem, nullptr); imageAvailable_.clear();
+    for(auto sem: renderFinished_) if(sem) vkDestroySemaphore(device_, sem, nullptr); renderFinished_.clear();
+    for(auto fb: framebuffers_) if(fb) vkDestroyFramebuffer(device_, fb, nullptr); framebuffers_.clear();
     if(cmdPool_){ vkDestroyCommandPool(device_, cmdPool_, nullptr); cmdPool_ = VK_NULL_HANDLE; }
     if(pipeline_){ vkDestroyPipeline(device_, pipeline_, nullptr); pipeline_ = VK_NULL_HANDLE; }
     if(pipelineLayout_){ vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr); pipelineLayout_ = VK_NULL_HANDLE; }
@@ -115,23 +162,179 @@ void VulkanSwapchain::shutdown(){
 
 void VulkanSwapchain::draw_frame(){
     if(!initialized_) return;
+    // Wait only for the frame that last used this slot, MAX_FRAMES_IN_FLIGHT frames ago
+    vkWaitForFences(device_, 1, &inFlight_[currentFrame_], VK_TRUE, UINT64_MAX);
     uint32_t imageIndex = 0;
-    VkResult res = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, VK_NULL_HANDLE, VK_NULL_HANDLE, &imageIndex);
-    if(res != VK_SUCCESS){ std::cerr<<"AcquireNextImageKHR failed\n"; return; }
-    VkCommandBuffer cb = cmdBuffers_[imageIndex];
-    VkCommandBufferBeginInfo bi{}; bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VkResult res = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, imageAvailable_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
+    if(res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR){ std::cerr<<"AcquireNextImageKHR failed\n"; return; }
+    // The image may still be in use by an older frame when images outnumber frames in flight
+    if(imagesInFlight_[imageIndex] != VK_NULL_HANDLE) vkWaitForFences(device_, 1, &imagesInFlight_[imageIndex], VK_TRUE, UINT64_MAX);
+    imagesInFlight_[imageIndex] = inFlight_[currentFrame_];
+    vkResetFences(device_, 1, &inFlight_[currentFrame_]);
+
+    VkCommandBuffer cb = cmdBuffers_[currentFrame_];
+    vkResetCommandBuffer(cb, 0);
+    VkCommandBufferBeginInfo bi{}; bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(cb, &bi);
     VkClearValue clearColor{}; clearColor.color = {{0.1f,0.2f,0.3f,1.0f}};
-    VkRenderPassBeginInfo rpbi{}; rpbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rpbi.renderPass = renderPass_; rpbi.renderArea.offset = {0,0}; rpbi.renderArea.extent = {800,600}; rpbi.clearValueCount = 1; rpbi.pClearValues = &clearColor;
-    // We don't have per-swapchain framebuffers stored; for a full implementation, create and track them.
-    // For now, just end command buffer after clear and submit to present a cleared image.
-    // TODO: Implement actual framebuffer creation and management
-    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+    VkRenderPassBeginInfo rpbi{}; rpbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rpbi.renderPass = renderPass_; rpbi.framebuffer = framebuffers_[imageIndex]; rpbi.renderArea.offset = {0,0}; rpbi.renderArea.extent = extent_; rpbi.clearValueCount = 1; rpbi.pClearValues = &clearColor;
+    vkCmdBeginRenderPass(cb, &rpbi, VK_SUBPASS_CONTENTS_INLINE);
+    // The quad pipeline has no vertex input yet, so the pass only clears
+    vkCmdEndRenderPass(cb);
     vkEndCommandBuffer(cb);
-    VkSubmitInfo si{}; si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; si.commandBufferCount = 1; si.pCommandBuffers = &cb;
-    vkQueueSubmit(graphicsQueue_, 1, &si, VK_NULL_HANDLE); vkQueueWaitIdle(graphicsQueue_);
-    VkPresentInfoKHR pi{}; pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR; pi.swapchainCount = 1; pi.pSwapchains = &swapchain_; pi.pImageIndices = &imageIndex; vkQueuePresentKHR(presentQueue_, &pi);
-    std::cout<<"VulkanSwapchain::draw_frame() - presented\n";
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo si{}; si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.waitSemaphoreCount = 1; si.pWaitSemaphores = &imageAvailable_[currentFrame_]; si.pWaitDstStageMask = &waitStage;
+    si.commandBufferCount = 1; si.pCommandBuffers = &cb;
+    si.signalSemaphoreCount = 1; si.pSignalSemaphores = &renderFinished_[currentFrame_];
+    if(vkQueueSubmit(graphicsQueue_, 1, &si, inFlight_[currentFrame_]) != VK_SUCCESS){ std::cerr<<"vkQueueSubmit failed\n"; return; }
+    VkPresentInfoKHR pi{}; pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR; pi.waitSemaphoreCount = 1; pi.pWaitSemaphores = &renderFinished_[currentFrame_]; pi.swapchainCount = 1; pi.pSwapchains = &swapchain_; pi.pImageIndices = &imageIndex; vkQueuePresentKHR(presentQueue_, &pi);
+    currentFrame_ = (currentFrame_ + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+uint32_t VulkanSwapchain::find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties){
+    VkPhysicalDeviceMemoryProperties mp{}; vkGetPhysicalDeviceMemoryProperties(physical_, &mp);
+    for(uint32_t i=0;i<mp.memoryTypeCount;++i) if((type_bits & (1u<<i)) && (mp.memoryTypes[i].propertyFlags & properties)==properties) return i;
+    return UINT32_MAX;
+}
+
+bool VulkanSwapchain::import_host_range(const uint8_t* pixels, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset){
+    // Imports must start and end on the device's alignment; GPU memory is one
+    // large allocation, so the rounded range stays inside it
+    uintptr_t addr = reinterpret_cast<uintptr_t>(pixels);
+    uintptr_t base = addr & ~static_cast<uintptr_t>(hostImportAlignment_-1);
+    VkDeviceSize span = (addr + size - base + hostImportAlignment_ - 1) & ~(hostImportAlignment_-1);
+    for(auto& imp: hostImports_){
+        if(base >= imp.base && base + span <= imp.base + imp.size){ imp.lastUsed = presentCount_; buffer = imp.buffer; offset = addr - imp.base; return true; }
+    }
+    // present() waits for its copy, so no import is in use by the GPU here
+    if(hostImports_.size() >= MAX_HOST_IMPORTS){
+        auto lru = std::min_element(hostImports_.begin(), hostImports_.end(), [](const HostImport& a, const HostImport& b){ return a.lastUsed < b.lastUsed; });
+        vkDestroyBuffer(device_, lru->buffer, nullptr); vkFreeMemory(device_, lru->memory, nullptr); hostImports_.erase(lru);
+    }
+    VkMemoryHostPointerPropertiesEXT hp{}; hp.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+    if(getHostPointerProperties_(device_, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, reinterpret_cast<void*>(base), &hp)!=VK_SUCCESS) return false;
+    VkExternalMemoryBufferCreateInfo ebci{}; ebci.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO; ebci.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    VkBufferCreateInfo bci{}; bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO; bci.pNext = &ebci; bci.size = span; bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT; bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    HostImport imp{}; imp.base = base; imp.size = span; imp.lastUsed = presentCount_;
+    if(vkCreateBuffer(device_, &bci, nullptr, &imp.buffer)!=VK_SUCCESS) return false;
+    VkMemoryRequirements req{}; vkGetBufferMemoryRequirements(device_, imp.buffer, &req);
+    uint32_t type = find_memory_type(req.memoryTypeBits & hp.memoryTypeBits, 0);
+    VkImportMemoryHostPointerInfoEXT ii{}; ii.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT; ii.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT; ii.pHostPointer = reinterpret_cast<void*>(base);
+    VkMemoryAllocateInfo mai{}; mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO; mai.pNext = &ii; mai.allocationSize = span; mai.memoryTypeIndex = type;
+    if(type==UINT32_MAX || vkAllocateMemory(device_, &mai, nullptr, &imp.memory)!=VK_SUCCESS || vkBindBufferMemory(device_, imp.buffer, imp.memory, 0)!=VK_SUCCESS){
+        if(imp.memory) vkFreeMemory(device_, imp.memory, nullptr);
+        vkDestroyBuffer(device_, imp.buffer, nullptr); return false;
+    }
+    hostImports_.push_back(imp);
+    buffer = imp.buffer; offset = addr - base; return true;
+}
+
+bool VulkanSwapchain::ensure_staging(VkDeviceSize size){
+    if(size <= stagingSize_) return true;
+    if(stagingBuffer_){ vkDestroyBuffer(device_, stagingBuffer_, nullptr); stagingBuffer_ = VK_NULL_HANDLE; }
+    if(stagingMemory_){ vkFreeMemory(device_, stagingMemory_, nullptr); stagingMemory_ = VK_NULL_HANDLE; }
+    stagingMapped_ = nullptr; stagingSize_ = 0;
+    VkBufferCreateInfo bci{}; bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO; bci.size = size; bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT; bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if(vkCreateBuffer(device_, &bci, nullptr, &stagingBuffer_)!=VK_SUCCESS) return false;
+    VkMemoryRequirements req{}; vkGetBufferMemoryRequirements(device_, stagingBuffer_, &req);
+    VkMemoryAllocateInfo mai{}; mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO; mai.allocationSize = req.size;
+    mai.memoryTypeIndex = find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if(mai.memoryTypeIndex==UINT32_MAX || vkAllocateMemory(device_, &mai, nullptr, &stagingMemory_)!=VK_SUCCESS) return false;
+    vkBindBufferMemory(device_, stagingBuffer_, stagingMemory_, 0);
+    // Mapped once for the lifetime of the buffer
+    if(vkMapMemory(device_, stagingMemory_, 0, VK_WHOLE_SIZE, 0, &stagingMapped_)!=VK_SUCCESS) return false;
+    stagingSize_ = size; return true;
+}
+
+bool VulkanSwapchain::ensure_frame_image(uint32_t width, uint32_t height){
+    if(frameImage_ && frameExtent_.width==width && frameExtent_.height==height) return true;
+    if(frameImage_){ vkDestroyImage(device_, frameImage_, nullptr); frameImage_ = VK_NULL_HANDLE; }
+    if(frameImageMemory_){ vkFreeMemory(device_, frameImageMemory_, nullptr); frameImageMemory_ = VK_NULL_HANDLE; }
+    frameExtent_ = {};
+    VkImageCreateInfo ici{}; ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO; ici.imageType = VK_IMAGE_TYPE_2D; ici.format = VK_FORMAT_R8G8B8A8_UNORM; ici.extent = {width, height, 1}; ici.mipLevels = 1; ici.arrayLayers = 1; ici.samples = VK_SAMPLE_COUNT_1_BIT; ici.tiling = VK_IMAGE_TILING_OPTIMAL; ici.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE; ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if(vkCreateImage(device_, &ici, nullptr, &frameImage_)!=VK_SUCCESS) return false;
+    VkMemoryRequirements req{}; vkGetImageMemoryRequirements(device_, frameImage_, &req);
+    VkMemoryAllocateInfo mai{}; mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO; mai.allocationSize = req.size; mai.memoryTypeIndex = find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if(mai.memoryTypeIndex==UINT32_MAX || vkAllocateMemory(device_, &mai, nullptr, &frameImageMemory_)!=VK_SUCCESS) return false;
+    vkBindImageMemory(device_, frameImage_, frameImageMemory_, 0);
+    frameExtent_ = {width, height}; return true;
+}
+
+void VulkanSwapchain::destroy_present_resources(){
+    for(auto& imp: hostImports_){ vkDestroyBuffer(device_, imp.buffer, nullptr); vkFreeMemory(device_, imp.memory, nullptr); } hostImports_.clear();
+    if(stagingBuffer_){ vkDestroyBuffer(device_, stagingBuffer_, nullptr); stagingBuffer_ = VK_NULL_HANDLE; }
+    if(stagingMemory_){ vkFreeMemory(device_, stagingMemory_, nullptr); stagingMemory_ = VK_NULL_HANDLE; }
+    stagingMapped_ = nullptr; stagingSize_ = 0;
+    if(frameImage_){ vkDestroyImage(device_, frameImage_, nullptr); frameImage_ = VK_NULL_HANDLE; }
+    if(frameImageMemory_){ vkFreeMemory(device_, frameImageMemory_, nullptr); frameImageMemory_ = VK_NULL_HANDLE; }
+    frameExtent_ = {};
+}
+
+static void image_barrier(VkCommandBuffer cb, VkImage image, VkImageLayout from, VkImageLayout to, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage){
+    VkImageMemoryBarrier b{}; b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER; b.oldLayout = from; b.newLayout = to; b.srcAccessMask = srcAccess; b.dstAccessMask = dstAccess;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; b.subresourceRange.levelCount = 1; b.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(cb, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+bool VulkanSwapchain::present(const GPUPresentFrame& frame){
+    if(!initialized_ || !frame.pixels || frame.width==0 || frame.height==0) return false;
+    VkDeviceSize size = static_cast<VkDeviceSize>(frame.pitch) * frame.height;
+    if(!ensure_frame_image(frame.width, frame.height)) return false;
+
+    vkWaitForFences(device_, 1, &inFlight_[currentFrame_], VK_TRUE, UINT64_MAX);
+    VkBuffer src = VK_NULL_HANDLE; VkDeviceSize srcOffset = 0;
+    presentCount_++;
+    if(!(hostImportSupported_ && import_host_range(frame.pixels, size, src, srcOffset))){
+        // No import: one copy into persistently mapped memory, no conversion
+        if(!ensure_staging(size)) return false;
+        std::memcpy(stagingMapped_, frame.pixels, size);
+        src = stagingBuffer_; srcOffset = 0;
+    }
+
+    uint32_t imageIndex = 0;
+    VkResult res = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, imageAvailable_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
+    if(res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR){ std::cerr<<"AcquireNextImageKHR failed\n"; return false; }
+    if(imagesInFlight_[imageIndex] != VK_NULL_HANDLE) vkWaitForFences(device_, 1, &imagesInFlight_[imageIndex], VK_TRUE, UINT64_MAX);
+    imagesInFlight_[imageIndex] = inFlight_[currentFrame_];
+    vkResetFences(device_, 1, &inFlight_[currentFrame_]);
+
+    VkCommandBuffer cb = cmdBuffers_[currentFrame_];
+    VkImage frameImage = frameImage_;
+    VkImage swapImage = swapImages_[imageIndex];
+    vkResetCommandBuffer(cb, 0);
+    VkCommandBufferBeginInfo bi{}; bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cb, &bi);
+    image_barrier(cb, frameImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkBufferImageCopy region{}; region.bufferOffset = srcOffset; region.bufferRowLength = frame.pitch / 4; region.bufferImageHeight = frame.height;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; region.imageSubresource.layerCount = 1; region.imageExtent = {frame.width, frame.height, 1};
+    vkCmdCopyBufferToImage(cb, src, frameImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    image_barrier(cb, frameImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    image_barrier(cb, swapImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    // The blit converts RGBA to the swapchain's BGRA and scales to the window
+    VkImageBlit blit{};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1] = {static_cast<int32_t>(frame.width), static_cast<int32_t>(frame.height), 1};
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; blit.dstSubresource.layerCount = 1;
+    blit.dstOffsets[1] = {static_cast<int32_t>(extent_.width), static_cast<int32_t>(extent_.height), 1};
+    vkCmdBlitImage(cb, frameImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, swapImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+    image_barrier(cb, swapImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    vkEndCommandBuffer(cb);
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkSubmitInfo si{}; si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.waitSemaphoreCount = 1; si.pWaitSemaphores = &imageAvailable_[currentFrame_]; si.pWaitDstStageMask = &waitStage;
+    si.commandBufferCount = 1; si.pCommandBuffers = &cb;
+    si.signalSemaphoreCount = 1; si.pSignalSemaphores = &renderFinished_[currentFrame_];
+    VkFence fence = inFlight_[currentFrame_];
+    if(vkQueueSubmit(graphicsQueue_, 1, &si, fence) != VK_SUCCESS){ std::cerr<<"vkQueueSubmit failed\n"; return false; }
+    VkPresentInfoKHR pi{}; pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR; pi.waitSemaphoreCount = 1; pi.pWaitSemaphores = &renderFinished_[currentFrame_]; pi.swapchainCount = 1; pi.pSwapchains = &swapchain_; pi.pImageIndices = &imageIndex; vkQueuePresentKHR(presentQueue_, &pi);
+    currentFrame_ = (currentFrame_ + 1) % MAX_FRAMES_IN_FLIGHT;
+    // The caller may reuse the pixels once the copy has run
+    vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX);
+    return true;
 }
 
 #endif
@@ -2,16 +2,23 @@
 #ifdef PSX5_ENABLE_VULKAN
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
+#include "gpu_presenter.h"
 #include <string>
 #include <vector>
 
-class VulkanSwapchain {
+class VulkanSwapchain : public GPUPresentSink {
 public:
     VulkanSwapchain() = default;
     ~VulkanSwapchain();
     bool init(GLFWwindow* window);
     void shutdown();
     void draw_frame();
+    // Shows an RGBA8 frame from GPU memory. With VK_EXT_external_memory_host
+    // the pages are imported and read in place by the GPU; otherwise they are
+    // staged through a persistently mapped buffer. The GPU copies into an
+    // RGBA8 image and blits (scaling and converting) to the swap image.
+    // Returns once the frame has been read.
+    bool present(const GPUPresentFrame& frame) override;
     bool valid() const { return initialized_; }
 private:
     bool initialized_{false};
@@ -24,21 +31,52 @@ private:
     VkSwapchainKHR swapchain_{VK_NULL_HANDLE};
     std::vector<VkImage> swapImages_;
     std::vector<VkImageView> swapViews_;
+    std::vector<VkFramebuffer> framebuffers_;
+    VkExtent2D extent_{};
     VkRenderPass renderPass_{VK_NULL_HANDLE};
     VkPipeline pipeline_{VK_NULL_HANDLE};
     VkPipelineLayout pipelineLayout_{VK_NULL_HANDLE};
-    // for simplicity single command buffer
-    // TODO: Implement command buffer recording
+    // One command buffer and set of sync objects per frame in flight; the CPU
+    // only waits when it is MAX_FRAMES_IN_FLIGHT frames ahead of the GPU
+    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 2;
     VkCommandPool cmdPool_{VK_NULL_HANDLE};
     std::vector<VkCommandBuffer> cmdBuffers_;
+    std::vector<VkSemaphore> imageAvailable_;
+    std::vector<VkSemaphore> renderFinished_;
+    std::vector<VkFence> inFlight_;
+    std::vector<VkFence> imagesInFlight_;   // per swap image: fence of the frame last rendering to it
     size_t currentFrame_{0};
+    // Zero-copy presentation. Imports cover whole pages and are reused while
+    // the renderer cycles through its buffers.
+    struct HostImport { uintptr_t base; VkDeviceSize size; VkBuffer buffer; VkDeviceMemory memory; uint64_t lastUsed; };
+    static constexpr size_t MAX_HOST_IMPORTS = 6;
+    bool hostImportSupported_{false};
+    VkDeviceSize hostImportAlignment_{4096};
+    PFN_vkGetMemoryHostPointerPropertiesEXT getHostPointerProperties_{nullptr};
+    std::vector<HostImport> hostImports_;
+    uint64_t presentCount_{0};
+    // present() waits for its copy, so one staging buffer and blit source suffice
+    VkBuffer stagingBuffer_{VK_NULL_HANDLE};        // fallback without host imports
+    VkDeviceMemory stagingMemory_{VK_NULL_HANDLE};
+    void* stagingMapped_{nullptr};
+    VkDeviceSize stagingSize_{0};
+    VkImage frameImage_{VK_NULL_HANDLE};            // RGBA8 blit source
+    VkDeviceMemory frameImageMemory_{VK_NULL_HANDLE};
+    VkExtent2D frameExtent_{};
     bool create_instance(GLFWwindow* window);
     bool pick_physical_device();
     bool create_device_and_queues();
     bool create_swapchain(GLFWwindow* window);
     bool create_render_pass();
     bool create_pipeline(const std::string& vert_spv_path, const std::string& frag_spv_path);
+    bool create_framebuffers();
     bool create_command_buffers();
+    bool create_sync_objects();
+    uint32_t find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties);
+    bool import_host_range(const uint8_t* pixels, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+    bool ensure_staging(VkDeviceSize size);
+    bool ensure_frame_image(uint32_t width, uint32_t height);
+    void destroy_present_resources();
     VkShaderModule load_spv_module(const std::string& path);
 };
 #endif
@@ -0,0 +1,1416 @@
+#include "vulkan_translator.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "gpu.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t PAGE_SIZE = GPUDirtyTracker::PAGE_SIZE;
+
+VkFormat translate_surface_format(uint32_t format) {
+    switch (format) {
+        case 2: return VK_FORMAT_B8G8R8A8_UNORM;
+        case 3: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case 4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case 5: return VK_FORMAT_D32_SFLOAT;
+        case 6: return VK_FORMAT_D24_UNORM_S8_UINT;
+        case 1:
+        default: return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+bool is_depth_format(VkFormat format) {
+    return format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+}
+
+VkImageAspectFlags aspect_for(VkFormat format) {
+    if (format == VK_FORMAT_D24_UNORM_S8_UINT) return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    if (format == VK_FORMAT_D32_SFLOAT) return VK_IMAGE_ASPECT_DEPTH_BIT;
+    return VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+uint32_t surface_format_size(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default: return 4;
+    }
+}
+
+VkImageLayout resting_layout(bool depth) {
+    return depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+}
+
+VkFormat translate_vertex_format(uint32_t format) {
+    switch (format) {
+        case 0: return VK_FORMAT_R32_SFLOAT;
+        case 1: return VK_FORMAT_R32G32_SFLOAT;
+        case 2: return VK_FORMAT_R32G32B32_SFLOAT;
+        case 4: return VK_FORMAT_R8G8B8A8_UNORM;
+        case 5: return VK_FORMAT_R16G16_SFLOAT;
+        case 6: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case 7: return VK_FORMAT_R32_UINT;
+        case 3:
+        default: return VK_FORMAT_R32G32B32A32_SFLOAT;
+    }
+}
+
+VkAttachmentLoadOp translate_load_op(uint32_t op) {
+    switch (op) {
+        case 0: return VK_ATTACHMENT_LOAD_OP_LOAD;
+        case 2: return VK_ATTACHMENT_LOAD_OP_CLEAR;
+        default: return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    }
+}
+
+VkAttachmentStoreOp translate_store_op(uint32_t op) {
+    return op == 0 ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+VkSampleCountFlagBits translate_samples(uint32_t samples) {
+    switch (samples) {
+        case 2: return VK_SAMPLE_COUNT_2_BIT;
+        case 4: return VK_SAMPLE_COUNT_4_BIT;
+        case 8: return VK_SAMPLE_COUNT_8_BIT;
+        case 16: return VK_SAMPLE_COUNT_16_BIT;
+        default: return VK_SAMPLE_COUNT_1_BIT;
+    }
+}
+
+VkCompareOp translate_compare_op(uint32_t op) {
+    return op <= VK_COMPARE_OP_ALWAYS ? static_cast<VkCompareOp>(op) : VK_COMPARE_OP_ALWAYS;
+}
+
+VkStencilOp translate_stencil_op(uint32_t op) {
+    return op <= VK_STENCIL_OP_DECREMENT_AND_WRAP ? static_cast<VkStencilOp>(op) : VK_STENCIL_OP_KEEP;
+}
+
+VkBlendFactor translate_blend_factor(uint32_t factor) {
+    return factor <= VK_BLEND_FACTOR_ONE_MINUS_SRC1_ALPHA ? static_cast<VkBlendFactor>(factor) : VK_BLEND_FACTOR_ONE;
+}
+
+VkBlendOp translate_blend_op(uint32_t op) {
+    // Software path: 0 add, 1 subtract; anything else has no fixed-function equivalent
+    return op == 1 ? VK_BLEND_OP_SUBTRACT : VK_BLEND_OP_ADD;
+}
+
+VkStencilOpState translate_stencil(const PS5Emu::GraphicsPipeline::DepthStencilState::StencilOpState& s) {
+    VkStencilOpState state{};
+    state.failOp = translate_stencil_op(s.fail_op);
+    state.passOp = translate_stencil_op(s.pass_op);
+    state.depthFailOp = translate_stencil_op(s.depth_fail_op);
+    state.compareOp = translate_compare_op(s.compare_op);
+    state.compareMask = s.compare_mask;
+    state.writeMask = s.write_mask;
+    state.reference = s.reference;
+    return state;
+}
+
+void image_barrier(VkCommandBuffer cmd, VkImage image, VkImageAspectFlags aspect,
+                   VkImageLayout old_layout, VkImageLayout new_layout,
+                   VkAccessFlags src_access, VkAccessFlags dst_access,
+                   VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = aspect;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = src_access;
+    barrier.dstAccessMask = dst_access;
+    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+} // namespace
+
+VulkanTranslator::VulkanTranslator(GPU* gpu, VulkanBackend* backend)
+    : gpu_(gpu), backend_(backend) {
+}
+
+VulkanTranslator::~VulkanTranslator() {
+    shutdown();
+}
+
+bool VulkanTranslator::init() {
+    if (initialized_) return true;
+    if (!backend_ || !backend_->is_initialized()) return false;
+
+    device_ = backend_->get_device();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(backend_->get_physical_device(), &properties);
+    storage_alignment_ = std::max<VkDeviceSize>(properties.limits.minStorageBufferOffsetAlignment, 4);
+
+    // One layout for everything: MAX_BUFFER_SLOTS storage buffers visible to all stages
+    std::array<VkDescriptorSetLayoutBinding, MAX_BUFFER_SLOTS> bindings{};
+    for (uint32_t i = 0; i < MAX_BUFFER_SLOTS; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+    }
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = MAX_BUFFER_SLOTS;
+    layout_info.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device_, &layout_info, nullptr, &set_layout_) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create descriptor set layout" << std::endl;
+        return false;
+    }
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &set_layout_;
+    if (vkCreatePipelineLayout(device_, &pipeline_layout_info, nullptr, &pipeline_layout_) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create pipeline layout" << std::endl;
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size.descriptorCount = DESCRIPTOR_SETS_PER_BATCH * MAX_BUFFER_SLOTS;
+    VkDescriptorPoolCreateInfo descriptor_pool_info{};
+    descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptor_pool_info.maxSets = DESCRIPTOR_SETS_PER_BATCH;
+    descriptor_pool_info.poolSizeCount = 1;
+    descriptor_pool_info.pPoolSizes = &pool_size;
+    // One pool per frame in flight, reset when that frame's slot is recorded again
+    for (VkDescriptorPool& pool : descriptor_pools_) {
+        if (vkCreateDescriptorPool(device_, &descriptor_pool_info, nullptr, &pool) != VK_SUCCESS) {
+            std::cerr << "VulkanTranslator: Failed to create descriptor pool" << std::endl;
+            return false;
+        }
+    }
+
+    // Unbound slots point at a small dummy buffer so descriptor sets stay valid
+    dummy_buffer_id_ = backend_->create_buffer(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    dummy_buffer_ = backend_->get_buffer(dummy_buffer_id_);
+    if (dummy_buffer_ == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    if (!pipeline_cache_.init(device_, properties, PIPELINE_CACHE_DIR)) {
+        return false;
+    }
+
+    initialized_ = true;
+    std::cout << "VulkanTranslator: Draw/dispatch translation enabled" << std::endl;
+    return true;
+}
+
+void VulkanTranslator::shutdown() {
+    if (device_ == VK_NULL_HANDLE) return;
+
+    if (initialized_) {
+        if (in_render_pass_) {
+            end_vk_render_pass(true);
+        }
+        flush();
+    }
+    vkDeviceWaitIdle(device_);
+
+    // Graphics pipelines belong to the cache; it waits for in-flight compiles
+    // before anything they reference is destroyed
+    pipeline_cache_.shutdown();
+    for (auto& [key, pipeline] : compute_pipelines_) vkDestroyPipeline(device_, pipeline, nullptr);
+    for (auto& [key, module] : shader_modules_) vkDestroyShaderModule(device_, module, nullptr);
+    for (auto& [key, framebuffer] : framebuffers_) vkDestroyFramebuffer(device_, framebuffer, nullptr);
+    for (auto& [key, render_pass] : render_passes_) vkDestroyRenderPass(device_, render_pass, nullptr);
+    graphics_pipelines_.clear();
+    compute_pipelines_.clear();
+    shader_modules_.clear();
+    framebuffers_.clear();
+    render_passes_.clear();
+
+    for (auto& [address, target] : render_targets_) destroy_render_target(target);
+    render_targets_.clear();
+    for (auto& [address, buffer] : buffers_) backend_->destroy_buffer(buffer.buffer_id);
+    buffers_.clear();
+    if (dummy_buffer_id_) {
+        backend_->destroy_buffer(dummy_buffer_id_);
+        dummy_buffer_id_ = 0;
+    }
+    // Runs the deferred destruction queued above
+    backend_->wait_frames();
+
+    for (VkDescriptorPool& pool : descriptor_pools_) {
+        if (pool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device_, pool, nullptr);
+        pool = VK_NULL_HANDLE;
+    }
+    if (pipeline_layout_ != VK_NULL_HANDLE) vkDestroyPipelineLayout(device_, pipeline_layout_, nullptr);
+    if (set_layout_ != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device_, set_layout_, nullptr);
+    descriptor_pool_ = VK_NULL_HANDLE;
+    pipeline_layout_ = VK_NULL_HANDLE;
+    set_layout_ = VK_NULL_HANDLE;
+
+    initialized_ = false;
+    device_ = VK_NULL_HANDLE;
+}
+
+// Recording
+
+void VulkanTranslator::begin_recording() {
+    if (recording_) return;
+
+    // The backend only hands out a frame once its previous submission has
+    // retired, so that frame's descriptor pool is free again
+    descriptor_pool_ = descriptor_pools_[backend_->get_frame_index()];
+    vkResetDescriptorPool(device_, descriptor_pool_, 0);
+    descriptor_sets_used_ = 0;
+
+    upload_cmd_ = backend_->get_frame_command_buffer();
+    draw_cmd_ = backend_->allocate_frame_command_buffer();
+
+    // Earlier batches may still be reading or writing memory this batch uploads to
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(upload_cmd_, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    recording_ = true;
+}
+
+VkCommandBuffer VulkanTranslator::draw_commands() {
+    begin_recording();
+    return draw_cmd_;
+}
+
+VkCommandBuffer VulkanTranslator::upload_commands() {
+    begin_recording();
+    return upload_cmd_;
+}
+
+void VulkanTranslator::submit() {
+    if (!initialized_ || !recording_) return;
+
+    // A submit inside a render pass closes it, and the next batch reopens it
+    // with load ops
+    bool resume = in_render_pass_;
+    if (resume) {
+        end_vk_render_pass(true);
+    }
+
+    // Everything uploaded in this batch is visible to the draw command buffer
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                            VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(upload_cmd_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    // Results become visible to the rest of the emulator through GPU memory
+    // once the batch retires. Written-back ranges are not marked dirty: the
+    // device copies are the source. Pages DMA or the guest wrote after a
+    // readback was queued are newer than its copy and are left alone; that
+    // is page granular, so such a write also keeps the rest of its page.
+    batches_in_flight_++;
+    backend_->defer_until_retired([this, readbacks = std::move(readbacks_)] {
+        GPUDirtyTracker& tracker = gpu_->get_dirty_tracker();
+        std::vector<GPUDirtyTracker::Range> written;
+        for (const auto& readback : readbacks) {
+            uint8_t* dst = gpu_->get_gpu_memory_ptr(readback.address);
+            if (!dst) continue;
+            written.clear();
+            tracker.collect_written_since(readback.address, readback.size, readback.generation, written);
+            uint64_t offset = 0;
+            written.push_back({readback.address + readback.size, 0});
+            for (const auto& range : written) {
+                uint64_t gap = range.address - readback.address - offset;
+                std::memcpy(dst + offset, readback.source + offset, gap);
+                stats_.bytes_read_back += gap;
+                offset += gap + range.size;
+            }
+        }
+        batches_in_flight_--;
+    });
+    readbacks_.clear();
+    backend_->end_frame();
+
+    for (auto& [address, buffer] : buffers_) buffer.used_in_batch = false;
+    for (auto& [address, target] : render_targets_) target.used_in_batch = false;
+
+    recording_ = false;
+    upload_cmd_ = VK_NULL_HANDLE;
+    draw_cmd_ = VK_NULL_HANDLE;
+    epoch_++;
+    stats_.submits++;
+
+    if (resume) {
+        begin_vk_render_pass(true);
+    }
+}
+
+void VulkanTranslator::flush() {
+    if (!initialized_) return;
+
+    submit();
+    backend_->wait_frames();
+}
+
+// GPU memory mirroring
+
+void VulkanTranslator::upload(VkBuffer dst, VkDeviceSize dst_offset, uint64_t address, uint64_t size) {
+    const uint8_t* src = gpu_->get_gpu_memory_ptr(address);
+    if (!src || size == 0) return;
+
+    VulkanBackend::StagingAllocation staging;
+    if (!backend_->allocate_staging(size, staging)) return;
+    std::memcpy(staging.mapped, src, size);
+
+    VkBufferCopy region{};
+    region.srcOffset = staging.offset;
+    region.dstOffset = dst_offset;
+    region.size = size;
+    vkCmdCopyBuffer(upload_commands(), staging.buffer, dst, 1, &region);
+    stats_.bytes_uploaded += size;
+}
+
+bool VulkanTranslator::prepare_buffer(uint64_t address, uint64_t size, BufferRef& ref) {
+    GPUDirtyTracker& tracker = gpu_->get_dirty_tracker();
+    const uint64_t memory_size = tracker.get_memory_size();
+    if (address >= memory_size) return false;
+    size = std::min(std::max<uint64_t>(size, 4), memory_size - address);
+
+    uint64_t start = address & ~(PAGE_SIZE - 1);
+    uint64_t end = std::min((address + size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1), memory_size);
+
+    // Find cached buffers overlapping [start, end)
+    auto it = buffers_.upper_bound(start);
+    if (it != buffers_.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second.address + prev->second.size > start) {
+            it = prev;
+        }
+    }
+    auto first = it;
+    size_t overlaps = 0;
+    bool overlap_used = false;
+    uint64_t union_start = start;
+    uint64_t union_end = end;
+    for (; it != buffers_.end() && it->first < end; ++it) {
+        overlaps++;
+        overlap_used |= it->second.used_in_batch;
+        union_start = std::min(union_start, it->second.address);
+        union_end = std::max(union_end, it->second.address + it->second.size);
+    }
+
+    CachedBuffer* entry = nullptr;
+    if (overlaps == 1 && first->second.address <= start && first->second.address + first->second.size >= end) {
+        entry = &first->second;
+
+        if (tracker.is_dirty(start, end - start)) {
+            // Uploads execute before this batch's draws; if the old contents
+            // are still needed by recorded work, submit the batch first. The
+            // next batch's uploads are ordered after it on the queue.
+            if (entry->used_in_batch) {
+                submit();
+            }
+            dirty_scratch_.clear();
+            tracker.collect_and_clear(start, end - start, dirty_scratch_);
+            for (const auto& range : dirty_scratch_) {
+                upload(entry->buffer, range.address - entry->address, range.address, range.size);
+            }
+        }
+    } else {
+        // Grow: replace every overlapping buffer with one covering the union.
+        // The union is filled from GPU memory, which must first receive
+        // everything written to the old buffers.
+        if (overlaps && has_pending_work()) {
+            flush();
+        }
+        auto erase_it = buffers_.lower_bound(union_start);
+        while (erase_it != buffers_.end() && erase_it->first < union_end) {
+            uint32_t buffer_id = erase_it->second.buffer_id;
+            backend_->defer_until_retired([backend = backend_, buffer_id] { backend->destroy_buffer(buffer_id); });
+            erase_it = buffers_.erase(erase_it);
+            epoch_++;
+        }
+
+        CachedBuffer buffer{};
+        buffer.address = union_start;
+        buffer.size = union_end - union_start;
+        buffer.buffer_id = backend_->create_buffer(buffer.size,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+        buffer.buffer = backend_->get_buffer(buffer.buffer_id);
+        if (buffer.buffer == VK_NULL_HANDLE) {
+            return false;
+        }
+        stats_.buffers_created++;
+
+        entry = &buffers_.emplace(buffer.address, buffer).first->second;
+        dirty_scratch_.clear();
+        tracker.collect_and_clear(entry->address, entry->size, dirty_scratch_);
+        upload(entry->buffer, 0, entry->address, entry->size);
+    }
+
+    entry->used_in_batch = true;
+    ref.buffer = entry->buffer;
+    ref.offset = address - entry->address;
+    return true;
+}
+
+void VulkanTranslator::upload_render_target(RenderTarget& target, bool initialize) {
+    VkCommandBuffer cmd = upload_commands();
+    VkImageAspectFlags aspect = aspect_for(target.format);
+    VkImageLayout resting = resting_layout(target.depth);
+    VkImageLayout old_layout = initialize ? VK_IMAGE_LAYOUT_UNDEFINED : resting;
+
+    GPUDirtyTracker& tracker = gpu_->get_dirty_tracker();
+    uint64_t size = static_cast<uint64_t>(target.width) * target.height * surface_format_size(target.format);
+    const uint8_t* src = gpu_->get_gpu_memory_ptr(target.address);
+
+    if (target.depth || !src || target.address + size > tracker.get_memory_size()) {
+        // Depth contents live only on the device
+        image_barrier(cmd, target.image, aspect, old_layout, resting, 0,
+                      target.depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT);
+        return;
+    }
+
+    VulkanBackend::StagingAllocation staging;
+    if (!backend_->allocate_staging(size, staging)) return;
+    // Writes from here on land in a later generation and upload again
+    target.generation = tracker.next_generation();
+    std::memcpy(staging.mapped, src, size);
+    dirty_scratch_.clear();
+    tracker.collect_and_clear(target.address, size, dirty_scratch_);
+
+    image_barrier(cmd, target.image, aspect, old_layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  initialize ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging.offset;
+    region.imageSubresource.aspectMask = aspect;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {target.width, target.height, 1};
+    vkCmdCopyBufferToImage(cmd, staging.buffer, target.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    image_barrier(cmd, target.image, aspect, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, resting,
+                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    stats_.bytes_uploaded += size;
+}
+
+VulkanTranslator::RenderTarget* VulkanTranslator::acquire_render_target(uint64_t address, uint32_t width,
+                                                                        uint32_t height, VkFormat format) {
+    auto it = render_targets_.find(address);
+    if (it != render_targets_.end()) {
+        RenderTarget& existing = it->second;
+        if (existing.width == width && existing.height == height && existing.format == format) {
+            return &existing;
+        }
+        // Same memory reinterpreted with a new size or format; the new
+        // target is initialized from GPU memory, so the old one must be
+        // written back first
+        if (has_pending_work()) {
+            flush();
+        }
+        destroy_render_target(existing);
+        render_targets_.erase(it);
+    }
+
+    bool depth = is_depth_format(format);
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    usage |= depth ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+                   : (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    RenderTarget target{};
+    target.address = address;
+    target.width = width;
+    target.height = height;
+    target.format = format;
+    target.depth = depth;
+    target.image_id = backend_->create_image(width, height, format, usage, VMA_MEMORY_USAGE_GPU_ONLY);
+    target.image = backend_->get_image(target.image_id);
+    target.view = backend_->get_image_view(target.image_id);
+    if (target.image == VK_NULL_HANDLE) {
+        return nullptr;
+    }
+
+    RenderTarget& stored = render_targets_.emplace(address, target).first->second;
+    upload_render_target(stored, true);
+    return &stored;
+}
+
+void VulkanTranslator::destroy_render_target(RenderTarget& target) {
+    // Framebuffers hold views of the image, and batches in flight may still use both
+    std::vector<VkFramebuffer> framebuffers;
+    for (auto& [id, framebuffer] : framebuffers_) {
+        framebuffers.push_back(framebuffer);
+    }
+    framebuffers_.clear();
+    backend_->defer_until_retired([device = device_, backend = backend_, framebuffers = std::move(framebuffers),
+                                   image_id = target.image_id] {
+        for (VkFramebuffer framebuffer : framebuffers) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        backend->destroy_image(image_id);
+    });
+}
+
+void VulkanTranslator::queue_readback(VkBuffer src, VkDeviceSize src_offset, uint64_t address, uint64_t size) {
+    VulkanBackend::StagingAllocation readback;
+    if (!backend_->allocate_readback(size, readback)) return;
+
+    VkBufferCopy region{};
+    region.srcOffset = src_offset;
+    region.dstOffset = readback.offset;
+    region.size = size;
+    vkCmdCopyBuffer(draw_commands(), src, readback.buffer, 1, &region);
+    readbacks_.push_back({address, size, readback.mapped, gpu_->get_dirty_tracker().next_generation()});
+}
+
+void VulkanTranslator::queue_readback(RenderTarget& target) {
+    uint64_t size = static_cast<uint64_t>(target.width) * target.height * surface_format_size(target.format);
+    if (target.address + size > gpu_->get_dirty_tracker().get_memory_size()) return;
+
+    VulkanBackend::StagingAllocation readback;
+    if (!backend_->allocate_readback(size, readback)) return;
+
+    VkCommandBuffer cmd = draw_commands();
+    image_barrier(cmd, target.image, VK_IMAGE_ASPECT_COLOR_BIT,
+                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = readback.offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {target.width, target.height, 1};
+    vkCmdCopyImageToBuffer(cmd, target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+    image_barrier(cmd, target.image, VK_IMAGE_ASPECT_COLOR_BIT,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                  VK_ACCESS_TRANSFER_READ_BIT,
+                  VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    readbacks_.push_back({target.address, size, readback.mapped, gpu_->get_dirty_tracker().next_generation()});
+}
+
+// Object translation
+
+VkRenderPass VulkanTranslator::get_render_pass(const RenderPass& render_pass, bool resume) {
+    // Keyed by content so pipelines recorded in earlier sessions find a compatible pass
+    uint64_t key = (VulkanPipelineCache::hash_render_pass(render_pass) << 1) | (resume ? 1 : 0);
+    auto it = render_passes_.find(key);
+    if (it != render_passes_.end()) {
+        return it->second;
+    }
+
+    std::vector<VkAttachmentDescription> attachments;
+    for (const auto& attachment : render_pass.attachments) {
+        VkFormat format = translate_surface_format(attachment.format);
+        bool depth = is_depth_format(format);
+
+        VkAttachmentDescription desc{};
+        desc.format = format;
+        desc.samples = translate_samples(attachment.samples);
+        desc.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : translate_load_op(attachment.load_op);
+        desc.storeOp = translate_store_op(attachment.store_op);
+        desc.stencilLoadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : translate_load_op(attachment.stencil_load_op);
+        desc.stencilStoreOp = translate_store_op(attachment.stencil_store_op);
+        // Render targets rest in their attachment layout between passes
+        desc.initialLayout = resting_layout(depth);
+        desc.finalLayout = resting_layout(depth);
+        attachments.push_back(desc);
+    }
+
+    // References must outlive vkCreateRenderPass
+    std::vector<std::vector<VkAttachmentReference>> color_refs(render_pass.subpasses.size());
+    std::vector<std::vector<VkAttachmentReference>> input_refs(render_pass.subpasses.size());
+    std::vector<std::vector<VkAttachmentReference>> resolve_refs(render_pass.subpasses.size());
+    std::vector<VkAttachmentReference> depth_refs(render_pass.subpasses.size());
+    std::vector<VkSubpassDescription> subpasses;
+
+    for (size_t i = 0; i < render_pass.subpasses.size(); ++i) {
+        const auto& subpass = render_pass.subpasses[i];
+
+        for (uint32_t index : subpass.color_attachments) {
+            color_refs[i].push_back({index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        }
+        for (uint32_t index : subpass.input_attachments) {
+            input_refs[i].push_back({index, VK_IMAGE_LAYOUT_GENERAL});
+        }
+        if (subpass.resolve_attachments.size() == subpass.color_attachments.size()) {
+            for (uint32_t index : subpass.resolve_attachments) {
+                resolve_refs[i].push_back({index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+            }
+        }
+
+        VkSubpassDescription desc{};
+        desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        desc.colorAttachmentCount = static_cast<uint32_t>(color_refs[i].size());
+        desc.pColorAttachments = color_refs[i].data();
+        desc.inputAttachmentCount = static_cast<uint32_t>(input_refs[i].size());
+        desc.pInputAttachments = input_refs[i].data();
+        desc.pResolveAttachments = resolve_refs[i].empty() ? nullptr : resolve_refs[i].data();
+        desc.preserveAttachmentCount = static_cast<uint32_t>(subpass.preserve_attachments.size());
+        desc.pPreserveAttachments = subpass.preserve_attachments.data();
+
+        // The depth slot is only meaningful when it names a depth-format attachment
+        uint32_t depth_index = subpass.depth_stencil_attachment;
+        if (depth_index < attachments.size() && is_depth_format(attachments[depth_index].format)) {
+            depth_refs[i] = {depth_index, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+            desc.pDepthStencilAttachment = &depth_refs[i];
+        }
+        subpasses.push_back(desc);
+    }
+
+    std::vector<VkSubpassDependency> dependencies;
+    for (const auto& dep : render_pass.dependencies) {
+        VkSubpassDependency desc{};
+        desc.srcSubpass = dep.src_subpass;
+        desc.dstSubpass = dep.dst_subpass;
+        desc.srcStageMask = dep.src_stage_mask ? dep.src_stage_mask : VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+        desc.dstStageMask = dep.dst_stage_mask ? dep.dst_stage_mask : VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+        desc.srcAccessMask = dep.src_access_mask;
+        desc.dstAccessMask = dep.dst_access_mask;
+        desc.dependencyFlags = render_pass.tile_based_optimization ? VK_DEPENDENCY_BY_REGION_BIT : 0;
+        dependencies.push_back(desc);
+    }
+
+    VkRenderPassCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    create_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+    create_info.pAttachments = attachments.data();
+    create_info.subpassCount = static_cast<uint32_t>(subpasses.size());
+    create_info.pSubpasses = subpasses.data();
+    create_info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    create_info.pDependencies = dependencies.data();
+
+    VkRenderPass vk_render_pass = VK_NULL_HANDLE;
+    if (vkCreateRenderPass(device_, &create_info, nullptr, &vk_render_pass) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create render pass " << render_pass.render_pass_id << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    render_passes_[key] = vk_render_pass;
+    return vk_render_pass;
+}
+
+VkFramebuffer VulkanTranslator::get_framebuffer(const Framebuffer& framebuffer, VkRenderPass render_pass) {
+    auto it = framebuffers_.find(framebuffer.framebuffer_id);
+    if (it != framebuffers_.end()) {
+        return it->second;
+    }
+
+    std::vector<VkImageView> views;
+    for (uint64_t address : framebuffer.attachment_addresses) {
+        auto target = render_targets_.find(address);
+        if (target == render_targets_.end()) {
+            return VK_NULL_HANDLE;
+        }
+        views.push_back(target->second.view);
+    }
+
+    VkFramebufferCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    create_info.renderPass = render_pass;
+    create_info.attachmentCount = static_cast<uint32_t>(views.size());
+    create_info.pAttachments = views.data();
+    create_info.width = framebuffer.width;
+    create_info.height = framebuffer.height;
+    create_info.layers = std::max(1u, framebuffer.layers);
+
+    VkFramebuffer vk_framebuffer = VK_NULL_HANDLE;
+    if (vkCreateFramebuffer(device_, &create_info, nullptr, &vk_framebuffer) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create framebuffer " << framebuffer.framebuffer_id << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    framebuffers_[framebuffer.framebuffer_id] = vk_framebuffer;
+    return vk_framebuffer;
+}
+
+VkShaderModule VulkanTranslator::get_shader_module(uint32_t shader_id) {
+    auto it = shader_modules_.find(shader_id);
+    if (it != shader_modules_.end()) {
+        return it->second;
+    }
+
+    const GPU::CompiledShader* shader = gpu_->get_compiled_shader(shader_id);
+    if (!shader || shader->spirv.empty()) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkShaderModuleCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    create_info.codeSize = shader->spirv.size() * sizeof(uint32_t);
+    create_info.pCode = shader->spirv.data();
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(device_, &create_info, nullptr, &module) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create shader module " << shader_id << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    shader_modules_[shader_id] = module;
+
+    uint64_t hash = VulkanPipelineCache::hash_spirv(shader->spirv);
+    shader_hashes_[shader_id] = hash;
+    shader_ids_by_hash_[hash] = shader_id;
+    return module;
+}
+
+void VulkanTranslator::on_shader_compiled(uint32_t shader_id) {
+    if (!initialized_ || get_shader_module(shader_id) == VK_NULL_HANDLE) return;
+
+    // Recorded descs carry shader hashes; map them back to this session's ids
+    std::unordered_set<uint64_t> available;
+    for (const auto& [hash, id] : shader_ids_by_hash_) available.insert(hash);
+
+    uint64_t prewarmed = 0;
+    for (GraphicsPipelineDesc& desc : pipeline_cache_.take_prewarm(available)) {
+        PipelineState& state = desc.state;
+        uint32_t* const ids[5] = {&state.vertex_shader, &state.tessellation_control_shader,
+                                  &state.tessellation_evaluation_shader, &state.geometry_shader,
+                                  &state.fragment_shader};
+        for (size_t i = 0; i < desc.shader_hashes.size(); ++i) {
+            *ids[i] = desc.shader_hashes[i] ? shader_ids_by_hash_[desc.shader_hashes[i]] : 0;
+        }
+
+        PipelineJob job;
+        if (!prepare_pipeline_job(desc, job)) continue;
+        VkPipeline pipeline;
+        pipeline_cache_.request(VulkanPipelineCache::hash_desc(job.desc), job.desc,
+                                [this, job](VkPipelineCache cache) { return build_graphics_pipeline(job, cache); },
+                                pipeline);
+        prewarmed++;
+    }
+    pipeline_cache_.note_prewarmed(prewarmed);
+}
+
+void VulkanTranslator::set_scheduler(Scheduler* scheduler) {
+    pipeline_cache_.set_scheduler(scheduler);
+}
+
+VulkanPipelineCache::Status VulkanTranslator::get_graphics_pipeline(const PipelineState& state, VkPipeline& pipeline) {
+    // Fast path: this pipeline id was already resolved for this pass, subpass and topology
+    uint64_t local_key = current_render_pass_hash_ ^ (static_cast<uint64_t>(state.pipeline_id) * 0x9E3779B97F4A7C15ULL) ^
+                         (static_cast<uint64_t>(primitive_topology_) << 56) ^ (static_cast<uint64_t>(current_subpass_) << 48);
+    auto it = graphics_pipelines_.find(local_key);
+    if (it != graphics_pipelines_.end()) {
+        pipeline = it->second;
+        return VulkanPipelineCache::Status::Ready;
+    }
+
+    GraphicsPipelineDesc desc{};
+    desc.state = state;
+    desc.render_pass = current_render_pass_;
+    desc.subpass = current_subpass_;
+    desc.topology = primitive_topology_;
+
+    PipelineJob job;
+    if (!prepare_pipeline_job(desc, job)) {
+        return VulkanPipelineCache::Status::Failed;
+    }
+    uint64_t key = VulkanPipelineCache::hash_desc(job.desc);
+    auto status = pipeline_cache_.request(key, job.desc, [this, job](VkPipelineCache cache) {
+        return build_graphics_pipeline(job, cache);
+    }, pipeline);
+
+    if (status == VulkanPipelineCache::Status::Compiling && !async_compile_) {
+        pipeline_cache_.wait_idle();
+        status = pipeline_cache_.request(key, job.desc, nullptr, pipeline);
+    }
+    if (status == VulkanPipelineCache::Status::Ready) {
+        graphics_pipelines_[local_key] = pipeline;
+    }
+    return status;
+}
+
+bool VulkanTranslator::prepare_pipeline_job(const GraphicsPipelineDesc& desc, PipelineJob& job) {
+    // Shader modules and the render pass are created here, on the recording
+    // thread; the build itself only reads them
+    const PipelineState& state = desc.state;
+    job.desc = desc;
+    job.modules.fill(VK_NULL_HANDLE);
+    job.desc.shader_hashes.fill(0);
+
+    const uint32_t shader_ids[5] = {
+        state.vertex_shader,
+        state.tessellation.enabled ? state.tessellation_control_shader : 0,
+        state.tessellation.enabled ? state.tessellation_evaluation_shader : 0,
+        state.geometry.enabled ? state.geometry_shader : 0,
+        state.fragment_shader,
+    };
+    for (size_t i = 0; i < job.modules.size(); ++i) {
+        if (shader_ids[i] == 0) {
+            if (i == 0 || (i < 3 && state.tessellation.enabled) || (i == 3 && state.geometry.enabled)) {
+                return false;  // required stage missing
+            }
+            continue;
+        }
+        job.modules[i] = get_shader_module(shader_ids[i]);
+        if (job.modules[i] == VK_NULL_HANDLE) {
+            return false;
+        }
+        job.desc.shader_hashes[i] = shader_hashes_.at(shader_ids[i]);
+    }
+
+    job.render_pass = get_render_pass(desc.render_pass, false);
+    return job.render_pass != VK_NULL_HANDLE;
+}
+
+VkPipeline VulkanTranslator::build_graphics_pipeline(const PipelineJob& job, VkPipelineCache cache) const {
+    const PipelineState& state = job.desc.state;
+    const RenderPass& render_pass = job.desc.render_pass;
+
+    static constexpr VkShaderStageFlagBits STAGES[5] = {
+        VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+        VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, VK_SHADER_STAGE_GEOMETRY_BIT, VK_SHADER_STAGE_FRAGMENT_BIT,
+    };
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    for (size_t i = 0; i < job.modules.size(); ++i) {
+        if (job.modules[i] == VK_NULL_HANDLE) continue;
+        VkPipelineShaderStageCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        info.stage = STAGES[i];
+        info.module = job.modules[i];
+        info.pName = "main";
+        stages.push_back(info);
+    }
+    bool tessellation = job.modules[1] != VK_NULL_HANDLE;
+
+    // Vertex input
+    std::vector<VkVertexInputBindingDescription> bindings;
+    for (const auto& binding : state.vertex_input.bindings) {
+        bindings.push_back({binding.binding, binding.stride,
+                            binding.per_instance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX});
+    }
+    std::vector<VkVertexInputAttributeDescription> attributes;
+    for (const auto& attribute : state.vertex_input.attributes) {
+        attributes.push_back({attribute.location, attribute.binding,
+                              translate_vertex_format(attribute.format), attribute.offset});
+    }
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+    vertex_input.pVertexBindingDescriptions = bindings.data();
+    vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+    vertex_input.pVertexAttributeDescriptions = attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    if (tessellation) {
+        input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+    } else if (job.desc.topology == 1) {
+        input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    } else if (job.desc.topology == 2) {
+        input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+    } else {
+        input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+
+    VkPipelineTessellationStateCreateInfo tessellation_state{};
+    tessellation_state.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    tessellation_state.patchControlPoints = std::max(1u, state.tessellation.patch_control_points);
+
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    const auto& raster = state.rasterization;
+    VkPipelineRasterizationStateCreateInfo rasterization{};
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.depthClampEnable = VK_FALSE;
+    rasterization.rasterizerDiscardEnable = raster.rasterizer_discard_enable;
+    rasterization.polygonMode = raster.polygon_mode <= VK_POLYGON_MODE_POINT
+        ? static_cast<VkPolygonMode>(raster.polygon_mode) : VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = raster.cull_mode & VK_CULL_MODE_FRONT_AND_BACK;
+    rasterization.frontFace = raster.front_face ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterization.depthBiasEnable = raster.depth_bias_enable;
+    rasterization.depthBiasConstantFactor = raster.depth_bias_constant;
+    rasterization.depthBiasClamp = raster.depth_bias_clamp;
+    rasterization.depthBiasSlopeFactor = raster.depth_bias_slope;
+    rasterization.lineWidth = 1.0f;  // wideLines is not enabled on the device
+
+    // Sample count must match the subpass attachments
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    const RenderPass::SubpassDescription* subpass = job.desc.subpass < render_pass.subpasses.size()
+        ? &render_pass.subpasses[job.desc.subpass] : nullptr;
+    if (subpass && !subpass->color_attachments.empty() &&
+        subpass->color_attachments[0] < render_pass.attachments.size()) {
+        samples = translate_samples(render_pass.attachments[subpass->color_attachments[0]].samples);
+    }
+    VkPipelineMultisampleStateCreateInfo multisample{};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = samples;
+    multisample.sampleShadingEnable = VK_FALSE;
+    multisample.alphaToCoverageEnable = state.multisample.alpha_to_coverage_enable;
+    multisample.alphaToOneEnable = VK_FALSE;
+
+    const auto& ds = state.depth_stencil;
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = ds.depth_test_enable;
+    depth_stencil.depthWriteEnable = ds.depth_write_enable;
+    depth_stencil.depthCompareOp = translate_compare_op(ds.depth_compare_op);
+    depth_stencil.depthBoundsTestEnable = VK_FALSE;
+    depth_stencil.stencilTestEnable = ds.stencil_test_enable;
+    depth_stencil.front = translate_stencil(ds.front_stencil);
+    depth_stencil.back = translate_stencil(ds.back_stencil);
+    depth_stencil.minDepthBounds = ds.min_depth_bounds;
+    depth_stencil.maxDepthBounds = ds.max_depth_bounds;
+
+    // One blend state per colour attachment of the subpass
+    size_t color_count = subpass ? subpass->color_attachments.size() : 0;
+    std::vector<VkPipelineColorBlendAttachmentState> blend_attachments(color_count);
+    for (size_t i = 0; i < color_count; ++i) {
+        VkPipelineColorBlendAttachmentState& blend = blend_attachments[i];
+        if (i < state.color_blend.attachments.size()) {
+            const auto& src = state.color_blend.attachments[i];
+            blend.blendEnable = src.blend_enable;
+            blend.srcColorBlendFactor = translate_blend_factor(src.src_color_blend_factor);
+            blend.dstColorBlendFactor = translate_blend_factor(src.dst_color_blend_factor);
+            blend.colorBlendOp = translate_blend_op(src.color_blend_op);
+            blend.srcAlphaBlendFactor = translate_blend_factor(src.src_alpha_blend_factor);
+            blend.dstAlphaBlendFactor = translate_blend_factor(src.dst_alpha_blend_factor);
+            blend.alphaBlendOp = translate_blend_op(src.alpha_blend_op);
+            blend.colorWriteMask = src.color_write_mask & 0xF;
+        } else {
+            blend.blendEnable = VK_FALSE;
+            blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                   VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        }
+    }
+    VkPipelineColorBlendStateCreateInfo color_blend{};
+    color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blend.logicOpEnable = VK_FALSE;  // logicOp is not enabled on the device
+    color_blend.attachmentCount = static_cast<uint32_t>(blend_attachments.size());
+    color_blend.pAttachments = blend_attachments.data();
+    std::memcpy(color_blend.blendConstants, state.color_blend.blend_constants, sizeof(color_blend.blendConstants));
+
+    VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = 2;
+    dynamic_state.pDynamicStates = dynamic_states;
+
+    VkGraphicsPipelineCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    create_info.stageCount = static_cast<uint32_t>(stages.size());
+    create_info.pStages = stages.data();
+    create_info.pVertexInputState = &vertex_input;
+    create_info.pInputAssemblyState = &input_assembly;
+    create_info.pTessellationState = tessellation ? &tessellation_state : nullptr;
+    create_info.pViewportState = &viewport_state;
+    create_info.pRasterizationState = &rasterization;
+    create_info.pMultisampleState = &multisample;
+    create_info.pDepthStencilState = &depth_stencil;
+    create_info.pColorBlendState = &color_blend;
+    create_info.pDynamicState = &dynamic_state;
+    create_info.layout = pipeline_layout_;
+    create_info.renderPass = job.render_pass;
+    create_info.subpass = job.desc.subpass;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(device_, cache, 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create graphics pipeline " << state.pipeline_id << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    return pipeline;
+}
+
+VkPipeline VulkanTranslator::get_compute_pipeline(uint32_t shader_id) {
+    auto it = compute_pipelines_.find(shader_id);
+    if (it != compute_pipelines_.end()) {
+        return it->second;
+    }
+
+    VkShaderModule module = get_shader_module(shader_id);
+    if (module == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkComputePipelineCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    create_info.stage.module = module;
+    create_info.stage.pName = "main";
+    create_info.layout = pipeline_layout_;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device_, pipeline_cache_.get_vk_cache(), 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+        std::cerr << "VulkanTranslator: Failed to create compute pipeline for shader " << shader_id << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    compute_pipelines_[shader_id] = pipeline;
+    return pipeline;
+}
+
+VkDescriptorSet VulkanTranslator::write_descriptor_set(const std::array<BufferRef, MAX_BUFFER_SLOTS>& refs) {
+    // Sets come from the pool of the batch being recorded
+    begin_recording();
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = descriptor_pool_;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &set_layout_;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    if (vkAllocateDescriptorSets(device_, &alloc_info, &set) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    descriptor_sets_used_++;
+
+    std::array<VkDescriptorBufferInfo, MAX_BUFFER_SLOTS> infos{};
+    std::array<VkWriteDescriptorSet, MAX_BUFFER_SLOTS> writes{};
+    for (uint32_t i = 0; i < MAX_BUFFER_SLOTS; ++i) {
+        if (slots_[i].size && refs[i].buffer != VK_NULL_HANDLE) {
+            infos[i] = {refs[i].buffer, refs[i].offset, slots_[i].size};
+        } else {
+            infos[i] = {dummy_buffer_, 0, VK_WHOLE_SIZE};
+        }
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &infos[i];
+    }
+    vkUpdateDescriptorSets(device_, MAX_BUFFER_SLOTS, writes.data(), 0, nullptr);
+    return set;
+}
+
+// Render passes
+
+void VulkanTranslator::begin_render_pass(const RenderPass& render_pass, const Framebuffer& framebuffer,
+                                         const std::vector<float>& clear_colors, float clear_depth) {
+    if (!initialized_) return;
+    if (in_render_pass_) {
+        end_render_pass();
+    }
+
+    // Render targets first: acquiring one may flush the batch
+    GPUDirtyTracker& tracker = gpu_->get_dirty_tracker();
+    size_t count = std::min(render_pass.attachments.size(), framebuffer.attachment_addresses.size());
+    clear_values_.assign(count, VkClearValue{});
+    size_t color_index = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& attachment = render_pass.attachments[i];
+        VkFormat format = translate_surface_format(attachment.format);
+        uint64_t address = framebuffer.attachment_addresses[i];
+
+        bool existed = render_targets_.count(address) != 0;
+        RenderTarget* target = acquire_render_target(address, framebuffer.width, framebuffer.height, format);
+        if (!target) return;
+
+        // Pages the target shares with its neighbours stay dirty after an
+        // upload, so ask whether memory changed since then instead
+        uint64_t size = static_cast<uint64_t>(target->width) * target->height * surface_format_size(format);
+        if (existed && !target->depth && translate_load_op(attachment.load_op) == VK_ATTACHMENT_LOAD_OP_LOAD &&
+            tracker.written_since(address, size, target->generation)) {
+            if (target->used_in_batch) {
+                submit();
+            }
+            upload_render_target(*target, false);
+        }
+        target->used_in_batch = true;
+
+        if (target->depth) {
+            clear_values_[i].depthStencil = {clear_depth, 0};
+        } else {
+            for (int c = 0; c < 4; ++c) {
+                size_t index = color_index * 4 + c;
+                clear_values_[i].color.float32[c] = index < clear_colors.size() ? clear_colors[index] : 0.0f;
+            }
+            color_index++;
+        }
+    }
+
+    current_render_pass_ = render_pass;
+    current_render_pass_hash_ = VulkanPipelineCache::hash_render_pass(render_pass);
+    current_framebuffer_ = framebuffer;
+    viewport_set_ = false;
+    scissor_set_ = false;
+    begin_vk_render_pass(false);
+}
+
+void VulkanTranslator::begin_vk_render_pass(bool resume) {
+    VkRenderPass render_pass = get_render_pass(current_render_pass_, resume);
+    // Framebuffers are created against the non-resume pass; both are compatible
+    VkFramebuffer framebuffer = get_framebuffer(current_framebuffer_, get_render_pass(current_render_pass_, false));
+    if (render_pass == VK_NULL_HANDLE || framebuffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (resume) {
+        for (uint64_t address : current_framebuffer_.attachment_addresses) {
+            auto it = render_targets_.find(address);
+            if (it != render_targets_.end()) it->second.used_in_batch = true;
+        }
+    }
+
+    VkRenderPassBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    begin_info.renderPass = render_pass;
+    begin_info.framebuffer = framebuffer;
+    begin_info.renderArea.extent = {current_framebuffer_.width, current_framebuffer_.height};
+    begin_info.clearValueCount = static_cast<uint32_t>(clear_values_.size());
+    begin_info.pClearValues = clear_values_.data();
+
+    VkCommandBuffer cmd = draw_commands();
+    vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    if (resume) {
+        for (uint32_t s = 0; s < current_subpass_; ++s) {
+            vkCmdNextSubpass(cmd, VK_SUBPASS_CONTENTS_INLINE);
+        }
+    } else {
+        current_subpass_ = 0;
+    }
+    in_render_pass_ = true;
+}
+
+void VulkanTranslator::next_subpass() {
+    if (!in_render_pass_) return;
+    if (current_subpass_ + 1 >= current_render_pass_.subpasses.size()) return;
+    vkCmdNextSubpass(draw_commands(), VK_SUBPASS_CONTENTS_INLINE);
+    current_subpass_++;
+}
+
+void VulkanTranslator::end_vk_render_pass(bool write_back) {
+    VkCommandBuffer cmd = draw_commands();
+    // Vulkan requires every subpass to be stepped through
+    for (uint32_t s = current_subpass_ + 1; s < current_render_pass_.subpasses.size(); ++s) {
+        vkCmdNextSubpass(cmd, VK_SUBPASS_CONTENTS_INLINE);
+    }
+    vkCmdEndRenderPass(cmd);
+    in_render_pass_ = false;
+
+    if (!write_back) return;
+    size_t count = std::min(current_render_pass_.attachments.size(), current_framebuffer_.attachment_addresses.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (translate_store_op(current_render_pass_.attachments[i].store_op) != VK_ATTACHMENT_STORE_OP_STORE) {
+            continue;
+        }
+        auto it = render_targets_.find(current_framebuffer_.attachment_addresses[i]);
+        if (it != render_targets_.end() && !it->second.depth) {
+            queue_readback(it->second);
+        }
+    }
+}
+
+void VulkanTranslator::end_render_pass() {
+    if (!in_render_pass_) return;
+    end_vk_render_pass(true);
+}
+
+// Bindings and dynamic state
+
+void VulkanTranslator::set_viewport(float x, float y, float width, float height, float min_depth, float max_depth) {
+    viewport_ = {x, y, width, height, min_depth, max_depth};
+    viewport_set_ = true;
+}
+
+void VulkanTranslator::set_scissor(int32_t x, int32_t y, uint32_t width, uint32_t height) {
+    scissor_.offset = {x, y};
+    scissor_.extent = {width, height};
+    scissor_set_ = true;
+}
+
+void VulkanTranslator::bind_vertex_buffer(uint32_t binding, uint64_t address, uint64_t offset) {
+    if (binding < MAX_VERTEX_BINDINGS) {
+        vertex_bindings_[binding] = {address, offset, true};
+    }
+}
+
+void VulkanTranslator::bind_index_buffer(uint64_t address, uint64_t offset, uint32_t index_type) {
+    index_address_ = address;
+    index_offset_ = offset;
+    index_type_ = index_type;
+}
+
+void VulkanTranslator::bind_buffer(uint32_t slot, uint64_t address, uint64_t size) {
+    if (slot < MAX_BUFFER_SLOTS) {
+        slots_[slot] = {address, size};
+    }
+}
+
+// Draws and dispatches
+
+VulkanTranslator::DrawSetup VulkanTranslator::bind_draw_state(const PipelineState& state, uint64_t vertex_end,
+                                                              uint64_t instance_end, uint64_t index_bytes) {
+    if (!initialized_ || !in_render_pass_) return DrawSetup::Unsupported;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    switch (get_graphics_pipeline(state, pipeline)) {
+        case VulkanPipelineCache::Status::Ready: break;
+        case VulkanPipelineCache::Status::Compiling: return DrawSetup::Skipped;
+        case VulkanPipelineCache::Status::Failed: return DrawSetup::Unsupported;
+    }
+
+    if (descriptor_sets_used_ >= DESCRIPTOR_SETS_PER_BATCH) {
+        submit();
+    }
+
+    // Resolve every GPU range this draw reads. Preparing one range can retire
+    // a buffer another range already resolved to, so repeat until stable.
+    std::array<BufferRef, MAX_VERTEX_BINDINGS> vertex_refs{};
+    std::array<BufferRef, MAX_BUFFER_SLOTS> slot_refs{};
+    BufferRef index_ref{};
+    uint64_t epoch;
+    do {
+        epoch = epoch_;
+        for (const auto& binding : state.vertex_input.bindings) {
+            if (binding.binding >= MAX_VERTEX_BINDINGS) return DrawSetup::Unsupported;
+            const VertexBinding& bound = vertex_bindings_[binding.binding];
+            if (!bound.bound) return DrawSetup::Unsupported;
+            uint64_t count = binding.per_instance ? instance_end : vertex_end;
+            uint64_t size = std::max<uint64_t>(count * binding.stride, 16);
+            if (!prepare_buffer(bound.address + bound.offset, size, vertex_refs[binding.binding])) return DrawSetup::Unsupported;
+        }
+        if (index_bytes && !prepare_buffer(index_address_ + index_offset_, index_bytes, index_ref)) {
+            return DrawSetup::Unsupported;
+        }
+        for (uint32_t i = 0; i < MAX_BUFFER_SLOTS; ++i) {
+            if (!slots_[i].size) continue;
+            if (!prepare_buffer(slots_[i].address, slots_[i].size, slot_refs[i])) return DrawSetup::Unsupported;
+            if (slot_refs[i].offset % storage_alignment_) return DrawSetup::Unsupported;
+        }
+    } while (epoch != epoch_);
+
+    VkDescriptorSet set = write_descriptor_set(slot_refs);
+    if (set == VK_NULL_HANDLE) return DrawSetup::Unsupported;
+
+    VkCommandBuffer cmd = draw_commands();
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, 0, 1, &set, 0, nullptr);
+
+    VkViewport viewport = viewport_set_ ? viewport_
+        : VkViewport{0.0f, 0.0f, static_cast<float>(current_framebuffer_.width),
+                     static_cast<float>(current_framebuffer_.height), 0.0f, 1.0f};
+    VkRect2D scissor = scissor_set_ ? scissor_
+        : VkRect2D{{0, 0}, {current_framebuffer_.width, current_framebuffer_.height}};
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    for (const auto& binding : state.vertex_input.bindings) {
+        const BufferRef& ref = vertex_refs[binding.binding];
+        vkCmdBindVertexBuffers(cmd, binding.binding, 1, &ref.buffer, &ref.offset);
+    }
+    if (index_bytes) {
+        vkCmdBindIndexBuffer(cmd, index_ref.buffer, index_ref.offset,
+                             index_type_ ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16);
+    }
+    return DrawSetup::Recorded;
+}
+
+bool VulkanTranslator::draw(const PipelineState& pipeline, uint32_t vertex_count, uint32_t instance_count,
+                            uint32_t first_vertex, uint32_t first_instance) {
+    DrawSetup setup = bind_draw_state(pipeline, static_cast<uint64_t>(first_vertex) + vertex_count,
+                                      static_cast<uint64_t>(first_instance) + instance_count, 0);
+    if (setup == DrawSetup::Unsupported) return false;
+    if (setup == DrawSetup::Skipped) {
+        stats_.draws_skipped++;
+        return true;
+    }
+    vkCmdDraw(draw_cmd_, vertex_count, instance_count, first_vertex, first_instance);
+    stats_.draws++;
+    return true;
+}
+
+bool VulkanTranslator::draw_indexed(const PipelineState& pipeline, uint32_t index_count, uint32_t instance_count,
+                                    uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) {
+    // The vertex range an indexed draw touches is only known from the indices
+    uint32_t index_size = index_type_ ? 4 : 2;
+    uint64_t index_base = index_address_ + index_offset_;
+    uint64_t index_bytes = (static_cast<uint64_t>(first_index) + index_count) * index_size;
+    if (index_base + index_bytes > gpu_->get_dirty_tracker().get_memory_size()) return false;
+
+    const uint8_t* indices = gpu_->get_gpu_memory_ptr(index_base + static_cast<uint64_t>(first_index) * index_size);
+    if (!indices) return false;
+    int64_t max_index = 0;
+    for (uint32_t i = 0; i < index_count; ++i) {
+        uint32_t index;
+        if (index_size == 4) {
+            std::memcpy(&index, indices + i * 4, 4);
+        } else {
+            uint16_t index16;
+            std::memcpy(&index16, indices + i * 2, 2);
+            index = index16;
+        }
+        max_index = std::max<int64_t>(max_index, index);
+    }
+    int64_t vertex_end = std::max<int64_t>(max_index + vertex_offset + 1, 1);
+
+    DrawSetup setup = bind_draw_state(pipeline, static_cast<uint64_t>(vertex_end),
+                                      static_cast<uint64_t>(first_instance) + instance_count, index_bytes);
+    if (setup == DrawSetup::Unsupported) return false;
+    if (setup == DrawSetup::Skipped) {
+        stats_.draws_skipped++;
+        return true;
+    }
+    vkCmdDrawIndexed(draw_cmd_, index_count, instance_count, first_index, vertex_offset, first_instance);
+    stats_.draws++;
+    return true;
+}
+
+bool VulkanTranslator::dispatch(uint32_t shader_id, uint32_t group_x, uint32_t group_y, uint32_t group_z) {
+    // Dispatches cannot be recorded inside a render pass
+    if (!initialized_ || in_render_pass_) return false;
+
+    VkPipeline pipeline = get_compute_pipeline(shader_id);
+    if (pipeline == VK_NULL_HANDLE) return false;
+
+    if (descriptor_sets_used_ >= DESCRIPTOR_SETS_PER_BATCH) {
+        submit();
+    }
+
+    std::array<BufferRef, MAX_BUFFER_SLOTS> slot_refs{};
+    uint64_t epoch;
+    do {
+        epoch = epoch_;
+        for (uint32_t i = 0; i < MAX_BUFFER_SLOTS; ++i) {
+            if (!slots_[i].size) continue;
+            if (!prepare_buffer(slots_[i].address, slots_[i].size, slot_refs[i])) return false;
+            if (slot_refs[i].offset % storage_alignment_) return false;
+        }
+    } while (epoch != epoch_);
+
+    VkDescriptorSet set = write_descriptor_set(slot_refs);
+    if (set == VK_NULL_HANDLE) return false;
+
+    VkCommandBuffer cmd = draw_commands();
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout_, 0, 1, &set, 0, nullptr);
+    vkCmdDispatch(cmd, group_x, group_y, group_z);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    // Storage buffers may have been written: copy them back to GPU memory on flush
+    for (uint32_t i = 0; i < MAX_BUFFER_SLOTS; ++i) {
+        if (slots_[i].size) {
+            queue_readback(slot_refs[i].buffer, slot_refs[i].offset, slots_[i].address, slots_[i].size);
+        }
+    }
+
+    stats_.dispatches++;
+    return true;
+}
+#endif
@@ -0,0 +1,251 @@
+#pragma once
+#ifdef PSX5_ENABLE_VULKAN
+#include <vulkan/vulkan.h>
+#include "vulkan_backend.h"
+#include "graphics_pipeline.h"
+#include "vulkan_pipeline_cache.h"
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <array>
+
+// Vulkan translation backend
+// Maps GraphicsPipeline state (pipelines, render passes, framebuffers,
+// vertex/index/descriptor bindings) and draw/dispatch commands onto Vulkan
+// pipelines and command buffers. GPU memory is mirrored into device buffers
+// on first use; afterwards only pages marked in the GPU dirty tracker are
+// re-uploaded. Render targets live in device images and colour attachments
+// are written back to GPU memory when the batch retires.
+//
+// Each batch is recorded into one of the backend's frames in flight and
+// submitted without waiting; flush() is the only point where the CPU waits
+// for the GPU.
+//
+// Graphics pipelines come from a VulkanPipelineCache. With a scheduler set
+// they compile on worker threads and draws needing a pipeline that is still
+// compiling are skipped (counted in draws_skipped) rather than stalling the
+// frame; set_async_compile(false) waits instead, for deterministic output.
+//
+// Guest enums follow the software rasterizer's numbering:
+//   surface formats  1 RGBA8, 2 BGRA8, 3 RGBA16F, 4 RGBA32F, 5 D32F, 6 D24S8
+//   vertex formats   0 R32F, 1 RG32F, 2 RGB32F, 3 RGBA32F, 4 RGBA8 unorm,
+//                    5 RG16F, 6 RGBA16F, 7 R32 uint
+//   load ops         0 load, 1 don't care, 2 clear; store ops 0 store, 1 don't care
+//   topology         0 triangle list, 1 strip, 2 fan (patch list with tessellation)
+// Compare, stencil, blend factor, polygon mode, cull mode and front face
+// values are numbered like their Vulkan counterparts.
+class VulkanTranslator {
+public:
+    using PipelineState = PS5Emu::GraphicsPipeline::PipelineState;
+    using RenderPass = PS5Emu::GraphicsPipeline::RenderPass;
+    using Framebuffer = PS5Emu::GraphicsPipeline::Framebuffer;
+
+    static constexpr uint32_t MAX_VERTEX_BINDINGS = 16;
+    // Storage buffers visible to every stage as set 0, bindings 0..N-1
+    static constexpr uint32_t MAX_BUFFER_SLOTS = 8;
+    static constexpr uint32_t DESCRIPTOR_SETS_PER_BATCH = 4096;
+    static constexpr const char* PIPELINE_CACHE_DIR = "cache/vulkan";
+
+    struct Stats {
+        uint64_t draws;
+        uint64_t draws_skipped;     // pipeline still compiling
+        uint64_t dispatches;
+        uint64_t submits;
+        uint64_t buffers_created;
+        uint64_t bytes_uploaded;
+        uint64_t bytes_read_back;
+    };
+
+    VulkanTranslator(GPU* gpu, VulkanBackend* backend);
+    ~VulkanTranslator();
+
+    bool init();
+    void shutdown();
+
+    // Pipeline compilation
+    void set_scheduler(Scheduler* scheduler);
+    void set_async_compile(bool async_compile) { async_compile_ = async_compile; }
+    // Registers a newly compiled shader and pre-warms recorded pipelines
+    // whose shaders are now all available
+    void on_shader_compiled(uint32_t shader_id);
+
+    // Render passes
+    void begin_render_pass(const RenderPass& render_pass, const Framebuffer& framebuffer,
+                           const std::vector<float>& clear_colors, float clear_depth);
+    void next_subpass();
+    void end_render_pass();
+    bool in_render_pass() const { return in_render_pass_; }
+
+    // Bindings and dynamic state
+    void set_primitive_topology(uint32_t topology) { primitive_topology_ = topology; }
+    void set_viewport(float x, float y, float width, float height, float min_depth, float max_depth);
+    void set_scissor(int32_t x, int32_t y, uint32_t width, uint32_t height);
+    void bind_vertex_buffer(uint32_t binding, uint64_t address, uint64_t offset);
+    void bind_index_buffer(uint64_t address, uint64_t offset, uint32_t index_type);
+    void bind_buffer(uint32_t slot, uint64_t address, uint64_t size);
+
+    // Draws and dispatches. Return false when the state cannot be expressed
+    // in Vulkan (no SPIR-V for a stage, no render pass), so the caller falls
+    // back to the software path. A draw skipped while its pipeline compiles
+    // returns true.
+    bool draw(const PipelineState& pipeline, uint32_t vertex_count, uint32_t instance_count,
+              uint32_t first_vertex, uint32_t first_instance);
+    bool draw_indexed(const PipelineState& pipeline, uint32_t index_count, uint32_t instance_count,
+                      uint32_t first_index, int32_t vertex_offset, uint32_t first_instance);
+    bool dispatch(uint32_t shader_id, uint32_t group_x, uint32_t group_y, uint32_t group_z);
+
+    // Submits recorded work; results reach GPU memory when the batch retires
+    void submit();
+    // Submits recorded work and waits for every batch in flight, so all
+    // results are in GPU memory
+    void flush();
+    bool has_pending_work() const { return recording_ || batches_in_flight_ > 0; }
+
+    Stats get_stats() const { return stats_; }
+    VulkanPipelineCache::Stats get_pipeline_cache_stats() const { return pipeline_cache_.get_stats(); }
+
+private:
+    struct CachedBuffer {
+        uint64_t address;
+        uint64_t size;
+        uint32_t buffer_id;
+        VkBuffer buffer;
+        bool used_in_batch;
+    };
+
+    struct RenderTarget {
+        uint64_t address;
+        uint32_t width;
+        uint32_t height;
+        VkFormat format;
+        bool depth;
+        uint32_t image_id;
+        VkImage image;
+        VkImageView view;
+        bool used_in_batch;
+        uint64_t generation;   // dirty tracker generation of the last upload
+    };
+
+    struct Readback {
+        uint64_t address;
+        uint64_t size;
+        const uint8_t* source;
+        uint64_t generation;   // pages written after this keep their contents
+    };
+
+    struct BufferRef {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+    };
+
+    // Everything a worker needs to build a graphics pipeline; the modules and
+    // render pass are created up front and outlive the cache's pipelines
+    struct PipelineJob {
+        GraphicsPipelineDesc desc;
+        std::array<VkShaderModule, 5> modules;
+        VkRenderPass render_pass;
+    };
+
+    enum class DrawSetup { Recorded, Skipped, Unsupported };
+
+    // Recording
+    void begin_recording();
+    VkCommandBuffer draw_commands();
+    VkCommandBuffer upload_commands();
+
+    // GPU memory mirroring
+    bool prepare_buffer(uint64_t address, uint64_t size, BufferRef& ref);
+    void upload(VkBuffer dst, VkDeviceSize dst_offset, uint64_t address, uint64_t size);
+    void upload_render_target(RenderTarget& target, bool initialize);
+    RenderTarget* acquire_render_target(uint64_t address, uint32_t width, uint32_t height, VkFormat format);
+    void queue_readback(VkBuffer src, VkDeviceSize src_offset, uint64_t address, uint64_t size);
+    void queue_readback(RenderTarget& target);
+    void destroy_render_target(RenderTarget& target);
+
+    // Object translation
+    VkRenderPass get_render_pass(const RenderPass& render_pass, bool resume);
+    VkFramebuffer get_framebuffer(const Framebuffer& framebuffer, VkRenderPass render_pass);
+    VulkanPipelineCache::Status get_graphics_pipeline(const PipelineState& state, VkPipeline& pipeline);
+    bool prepare_pipeline_job(const GraphicsPipelineDesc& desc, PipelineJob& job);
+    VkPipeline build_graphics_pipeline(const PipelineJob& job, VkPipelineCache cache) const;
+    VkPipeline get_compute_pipeline(uint32_t shader_id);
+    VkShaderModule get_shader_module(uint32_t shader_id);
+    VkDescriptorSet write_descriptor_set(const std::array<BufferRef, MAX_BUFFER_SLOTS>& refs);
+
+    DrawSetup bind_draw_state(const PipelineState& pipeline, uint64_t vertex_end, uint64_t instance_end,
+                              uint64_t index_bytes);
+    void begin_vk_render_pass(bool resume);
+    void end_vk_render_pass(bool write_back);
+
+    GPU* gpu_;
+    VulkanBackend* backend_;
+    VkDevice device_ = VK_NULL_HANDLE;
+    bool initialized_ = false;
+
+    // Both belong to the backend's current frame while recording
+    VkCommandBuffer upload_cmd_ = VK_NULL_HANDLE;   // transfers; executes before draw_cmd_
+    VkCommandBuffer draw_cmd_ = VK_NULL_HANDLE;
+    bool recording_ = false;
+    uint32_t batches_in_flight_ = 0;                // submitted, readbacks not yet applied
+
+    VkDescriptorSetLayout set_layout_ = VK_NULL_HANDLE;
+    VkPipelineLayout pipeline_layout_ = VK_NULL_HANDLE;
+    std::array<VkDescriptorPool, VulkanBackend::FRAMES_IN_FLIGHT> descriptor_pools_{};
+    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;  // the recording batch's pool
+    uint32_t descriptor_sets_used_ = 0;
+    VkDeviceSize storage_alignment_ = 256;
+    // Bumped whenever a batch is submitted or a cached buffer is retired; buffer
+    // references taken before a bump may be stale
+    uint64_t epoch_ = 0;
+    uint32_t dummy_buffer_id_ = 0;
+    VkBuffer dummy_buffer_ = VK_NULL_HANDLE;
+
+    std::map<uint64_t, CachedBuffer> buffers_;       // non-overlapping, page aligned, keyed by address
+    std::map<uint64_t, RenderTarget> render_targets_;
+    std::vector<Readback> readbacks_;
+    std::vector<GPUDirtyTracker::Range> dirty_scratch_;
+
+    VulkanPipelineCache pipeline_cache_;
+    bool async_compile_ = true;
+
+    std::unordered_map<uint64_t, VkRenderPass> render_passes_;     // content hash << 1 | resume
+    std::unordered_map<uint32_t, VkFramebuffer> framebuffers_;     // framebuffer_id
+    std::unordered_map<uint64_t, VkPipeline> graphics_pipelines_;  // pipeline_id, pass, subpass, topology; owned by pipeline_cache_
+    std::unordered_map<uint32_t, VkPipeline> compute_pipelines_;   // shader id
+    std::unordered_map<uint32_t, VkShaderModule> shader_modules_;
+    std::unordered_map<uint32_t, uint64_t> shader_hashes_;         // shader id -> SPIR-V hash
+    std::unordered_map<uint64_t, uint32_t> shader_ids_by_hash_;
+
+    // Current state
+    bool in_render_pass_ = false;
+    RenderPass current_render_pass_{};
+    uint64_t current_render_pass_hash_ = 0;
+    Framebuffer current_framebuffer_{};
+    std::vector<VkClearValue> clear_values_;
+    uint32_t current_subpass_ = 0;
+    uint32_t primitive_topology_ = 0;
+    VkViewport viewport_{};
+    VkRect2D scissor_{};
+    bool viewport_set_ = false;
+    bool scissor_set_ = false;
+
+    struct VertexBinding {
+        uint64_t address;
+        uint64_t offset;
+        bool bound;
+    };
+    std::array<VertexBinding, MAX_VERTEX_BINDINGS> vertex_bindings_{};
+    uint64_t index_address_ = 0;
+    uint64_t index_offset_ = 0;
+    uint32_t index_type_ = 0;                        // 0 = 16-bit, 1 = 32-bit
+
+    struct BufferSlot {
+        uint64_t address;
+        uint64_t size;
+    };
+    std::array<BufferSlot, MAX_BUFFER_SLOTS> slots_{};
+
+    Stats stats_{};
+};
+#endif
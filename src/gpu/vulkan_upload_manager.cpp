@@ -0,0 +1,405 @@
+#include "vulkan_upload_manager.h"
+#ifdef PSX5_ENABLE_VULKAN
+#include "vulkan_backend.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+VulkanUploadManager::VulkanUploadManager(VulkanBackend* backend) : backend_(backend) {}
+
+VulkanUploadManager::~VulkanUploadManager() {
+    shutdown();
+}
+
+bool VulkanUploadManager::init() {
+    if (initialized_) return true;
+
+    device_ = backend_->get_device();
+    queue_ = backend_->get_transfer_queue();
+    transfer_family_ = backend_->get_transfer_queue_family();
+    graphics_family_ = backend_->get_graphics_queue_family();
+
+    VkSemaphoreTypeCreateInfo type_info{};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+    if (vkCreateSemaphore(device_, &semaphore_info, nullptr, &timeline_) != VK_SUCCESS) {
+        std::cerr << "VulkanUploadManager: Failed to create timeline semaphore" << std::endl;
+        return false;
+    }
+
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = transfer_family_;
+    if (vkCreateCommandPool(device_, &pool_info, nullptr, &command_pool_) != VK_SUCCESS) {
+        std::cerr << "VulkanUploadManager: Failed to create command pool" << std::endl;
+        return false;
+    }
+
+    ring_buffer_id_ = backend_->create_buffer(RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    ring_buffer_ = backend_->get_buffer(ring_buffer_id_);
+    ring_mapped_ = ring_buffer_id_ ? static_cast<uint8_t*>(backend_->map_buffer(ring_buffer_id_)) : nullptr;
+    if (!ring_mapped_) {
+        std::cerr << "VulkanUploadManager: Failed to create staging ring" << std::endl;
+        return false;
+    }
+
+    initialized_ = true;
+    std::cout << "VulkanUploadManager: Streaming uploads on queue family " << transfer_family_
+              << (transfer_family_ != graphics_family_ ? " (dedicated)" : " (shared with graphics)") << std::endl;
+    return true;
+}
+
+void VulkanUploadManager::shutdown() {
+    if (device_ == VK_NULL_HANDLE) return;
+
+    if (initialized_) {
+        wait_idle();
+    }
+    // Anything still waiting for acquisition is dropped with its destination
+    pending_.clear();
+
+    for (const auto& staging : dedicated_) {
+        backend_->unmap_buffer(staging.buffer_id);
+        backend_->destroy_buffer(staging.buffer_id);
+    }
+    dedicated_.clear();
+    if (ring_buffer_id_) {
+        backend_->unmap_buffer(ring_buffer_id_);
+        backend_->destroy_buffer(ring_buffer_id_);
+        ring_buffer_id_ = 0;
+    }
+    ring_.clear();
+
+    if (command_pool_ != VK_NULL_HANDLE) vkDestroyCommandPool(device_, command_pool_, nullptr);
+    if (timeline_ != VK_NULL_HANDLE) vkDestroySemaphore(device_, timeline_, nullptr);
+    command_pool_ = VK_NULL_HANDLE;
+    timeline_ = VK_NULL_HANDLE;
+    batches_.clear();
+    recording_ = nullptr;
+
+    initialized_ = false;
+    device_ = VK_NULL_HANDLE;
+}
+
+// Staging
+
+uint64_t VulkanUploadManager::get_completed_value() const {
+    uint64_t value = 0;
+    if (timeline_ != VK_NULL_HANDLE) {
+        vkGetSemaphoreCounterValue(device_, timeline_, &value);
+    }
+    return value;
+}
+
+void VulkanUploadManager::wait_value(uint64_t value) {
+    VkSemaphoreWaitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline_;
+    wait_info.pValues = &value;
+    vkWaitSemaphores(device_, &wait_info, UINT64_MAX);
+}
+
+void VulkanUploadManager::reclaim() {
+    uint64_t completed = get_completed_value();
+
+    ring_.release(completed);
+
+    auto done = std::remove_if(dedicated_.begin(), dedicated_.end(), [&](const DedicatedStaging& staging) {
+        if (staging.value > completed) return false;
+        backend_->unmap_buffer(staging.buffer_id);
+        backend_->destroy_buffer(staging.buffer_id);
+        return true;
+    });
+    dedicated_.erase(done, dedicated_.end());
+
+    for (auto& batch : batches_) {
+        if (batch.value != 0 && batch.value <= completed && &batch != recording_) {
+            batch.value = 0;
+        }
+    }
+}
+
+bool VulkanUploadManager::allocate_ring(VkDeviceSize size, VkDeviceSize& offset) {
+    for (;;) {
+        reclaim();
+        if (ring_.allocate(size, next_value_, offset)) {
+            return true;
+        }
+        if (ring_.empty()) {
+            return false;
+        }
+
+        // Out of space: the oldest span may belong to the batch still being recorded
+        stats_.ring_stalls++;
+        uint64_t oldest = ring_.oldest_value();
+        if (oldest == next_value_) {
+            submit();
+        }
+        wait_value(oldest);
+    }
+}
+
+bool VulkanUploadManager::stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset) {
+    if (size <= RING_SIZE) {
+        if (!allocate_ring(size, offset)) return false;
+        std::memcpy(ring_mapped_ + offset, data, size);
+        buffer = ring_buffer_;
+        return true;
+    }
+
+    uint32_t buffer_id = backend_->create_buffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    void* mapped = buffer_id ? backend_->map_buffer(buffer_id) : nullptr;
+    if (!mapped) {
+        if (buffer_id) backend_->destroy_buffer(buffer_id);
+        return false;
+    }
+    std::memcpy(mapped, data, size);
+    dedicated_.push_back({buffer_id, next_value_});
+    buffer = backend_->get_buffer(buffer_id);
+    offset = 0;
+    stats_.dedicated_uploads++;
+    return true;
+}
+
+VkCommandBuffer VulkanUploadManager::batch_commands() {
+    if (recording_) {
+        return recording_->command_buffer;
+    }
+
+    reclaim();
+    auto free_batch = std::find_if(batches_.begin(), batches_.end(), [](const Batch& batch) { return batch.value == 0; });
+    if (free_batch == batches_.end()) {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool_;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        VkCommandBuffer command_buffer;
+        if (vkAllocateCommandBuffers(device_, &alloc_info, &command_buffer) != VK_SUCCESS) {
+            return VK_NULL_HANDLE;
+        }
+        batches_.push_back({command_buffer, 0});
+        free_batch = std::prev(batches_.end());
+    }
+
+    recording_ = &*free_batch;
+    recording_->value = next_value_;
+    vkResetCommandBuffer(recording_->command_buffer, 0);
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(recording_->command_buffer, &begin_info);
+    return recording_->command_buffer;
+}
+
+// Uploads
+
+bool VulkanUploadManager::upload_buffer(VkBuffer dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size,
+                                        std::function<void()> on_ready) {
+    if (!initialized_ || size == 0) return false;
+
+    VkBuffer src;
+    VkDeviceSize src_offset;
+    if (!stage(data, size, src, src_offset)) return false;
+    VkCommandBuffer cmd = batch_commands();
+    if (cmd == VK_NULL_HANDLE) return false;
+
+    VkBufferCopy region{};
+    region.srcOffset = src_offset;
+    region.dstOffset = dst_offset;
+    region.size = size;
+    vkCmdCopyBuffer(cmd, src, dst, 1, &region);
+
+    PendingAcquire acquire{};
+    acquire.value = next_value_;
+    acquire.is_image = false;
+    acquire.on_ready = std::move(on_ready);
+
+    VkBufferMemoryBarrier& barrier = acquire.buffer_barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = dst;
+    barrier.offset = dst_offset;
+    barrier.size = size;
+
+    if (transfer_family_ != graphics_family_) {
+        // Release; the matching acquire is recorded on the graphics queue
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family_;
+        barrier.dstQueueFamilyIndex = graphics_family_;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+        barrier.srcAccessMask = 0;
+    } else {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    pending_.push_back(std::move(acquire));
+
+    stats_.uploads++;
+    stats_.bytes += size;
+    return true;
+}
+
+bool VulkanUploadManager::upload_image(VkImage image, VkImageAspectFlags aspect, uint32_t width, uint32_t height,
+                                       const void* data, VkDeviceSize size, std::function<void()> on_ready) {
+    if (!initialized_ || size == 0) return false;
+
+    VkBuffer src;
+    VkDeviceSize src_offset;
+    if (!stage(data, size, src, src_offset)) return false;
+    VkCommandBuffer cmd = batch_commands();
+    if (cmd == VK_NULL_HANDLE) return false;
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = aspect;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+
+    // The previous contents are discarded, so no ownership has to be taken first
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = src_offset;
+    region.imageSubresource.aspectMask = aspect;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyBufferToImage(cmd, src, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    PendingAcquire acquire{};
+    acquire.value = next_value_;
+    acquire.is_image = true;
+    acquire.on_ready = std::move(on_ready);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    if (transfer_family_ != graphics_family_) {
+        // Release with the layout change; the acquire repeats it on the graphics queue
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family_;
+        barrier.dstQueueFamilyIndex = graphics_family_;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        acquire.image_barrier = barrier;
+        acquire.image_barrier.srcAccessMask = 0;
+        acquire.image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    } else {
+        // Same family: transition here, the semaphore wait makes the writes visible
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        acquire.image_barrier = barrier;
+        acquire.image_barrier.image = VK_NULL_HANDLE;  // nothing left to record
+    }
+    pending_.push_back(std::move(acquire));
+
+    stats_.uploads++;
+    stats_.bytes += size;
+    return true;
+}
+
+// Submission
+
+uint64_t VulkanUploadManager::submit() {
+    if (!recording_) {
+        return next_value_ - 1;
+    }
+
+    vkEndCommandBuffer(recording_->command_buffer);
+
+    uint64_t signal_value = next_value_;
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &signal_value;
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = &timeline_info;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &recording_->command_buffer;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &timeline_;
+
+    if (vkQueueSubmit(queue_, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+        // Nothing will signal this value; signal it from the host so nothing waits forever
+        std::cerr << "VulkanUploadManager: Transfer submit failed" << std::endl;
+        VkSemaphoreSignalInfo signal_info{};
+        signal_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+        signal_info.semaphore = timeline_;
+        signal_info.value = signal_value;
+        vkSignalSemaphore(device_, &signal_info);
+    }
+
+    recording_ = nullptr;
+    next_value_++;
+    stats_.batches++;
+    return signal_value;
+}
+
+void VulkanUploadManager::acquire_completed() {
+    if (pending_.empty()) return;
+
+    uint64_t completed = get_completed_value();
+    if (pending_.front().value > completed) return;
+
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+    std::vector<VkImageMemoryBarrier> image_barriers;
+    std::vector<std::function<void()>> ready;
+    uint64_t acquired_value = 0;
+
+    // Batches complete in order, so completed uploads are a prefix
+    auto it = pending_.begin();
+    for (; it != pending_.end() && it->value <= completed; ++it) {
+        if (it->is_image) {
+            if (it->image_barrier.image != VK_NULL_HANDLE) image_barriers.push_back(it->image_barrier);
+        } else if (transfer_family_ != graphics_family_) {
+            buffer_barriers.push_back(it->buffer_barrier);
+        }
+        if (it->on_ready) ready.push_back(std::move(it->on_ready));
+        acquired_value = it->value;
+    }
+    pending_.erase(pending_.begin(), it);
+
+    // The value has been reached, so this wait never holds the frame back; it
+    // orders the releases before the acquires
+    backend_->add_frame_wait(timeline_, acquired_value, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    if (!buffer_barriers.empty() || !image_barriers.empty()) {
+        vkCmdPipelineBarrier(backend_->get_frame_command_buffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+                             static_cast<uint32_t>(buffer_barriers.size()), buffer_barriers.data(),
+                             static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+    }
+
+    for (auto& callback : ready) {
+        callback();
+    }
+}
+
+void VulkanUploadManager::wait_idle() {
+    uint64_t last = submit();
+    if (last != 0) {
+        wait_value(last);
+    }
+    reclaim();
+}
+#endif
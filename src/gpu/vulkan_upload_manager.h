@@ -0,0 +1,109 @@
+#pragma once
+#ifdef PSX5_ENABLE_VULKAN
+#include <vulkan/vulkan.h>
+#include "gpu_staging_ring.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class VulkanBackend;
+
+// Streaming uploads on the transfer queue
+// Data is copied into a persistently mapped staging ring and the copies are
+// batched into one transfer submission per frame (or sooner when the ring
+// fills). Each batch signals a timeline semaphore value; once the value is
+// reached the graphics queue acquires ownership of the destinations at the
+// start of the next frame. Uploads that have not completed yet are simply
+// acquired a frame later, so rendering never waits for a transfer.
+//
+// Destinations must not be in use by submitted graphics work: stream into a
+// fresh buffer or image and switch to it from the on_ready callback.
+class VulkanUploadManager {
+public:
+    static constexpr VkDeviceSize RING_SIZE = 64 * 1024 * 1024;
+
+    struct Stats {
+        uint64_t uploads;
+        uint64_t bytes;
+        uint64_t batches;
+        uint64_t ring_stalls;      // uploads that waited for ring space
+        uint64_t dedicated_uploads; // larger than the ring
+    };
+
+    explicit VulkanUploadManager(VulkanBackend* backend);
+    ~VulkanUploadManager();
+
+    bool init();
+    void shutdown();
+
+    // Queue a copy into `dst`; `on_ready` runs on the recording thread once the
+    // graphics queue owns the result. Return false if no staging memory could be had.
+    bool upload_buffer(VkBuffer dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size,
+                       std::function<void()> on_ready = nullptr);
+    // Replaces the whole of mip 0, leaving it in SHADER_READ_ONLY_OPTIMAL
+    bool upload_image(VkImage image, VkImageAspectFlags aspect, uint32_t width, uint32_t height,
+                      const void* data, VkDeviceSize size, std::function<void()> on_ready = nullptr);
+
+    // Submits the batch being recorded; returns the timeline value it signals
+    uint64_t submit();
+    // Records graphics-queue acquires for every completed upload into the
+    // backend's current frame. Called by the backend before each frame submit.
+    void acquire_completed();
+    void wait_idle();
+
+    VkSemaphore get_timeline() const { return timeline_; }
+    uint64_t get_completed_value() const;
+    bool has_pending() const { return !pending_.empty(); }
+    Stats get_stats() const { return stats_; }
+
+private:
+    struct Batch {
+        VkCommandBuffer command_buffer;
+        uint64_t value;            // signalled on completion, 0 when free
+    };
+
+    struct DedicatedStaging {
+        uint32_t buffer_id;
+        uint64_t value;
+    };
+
+    // Graphics-side half of an ownership transfer
+    struct PendingAcquire {
+        uint64_t value;
+        bool is_image;
+        VkBufferMemoryBarrier buffer_barrier;
+        VkImageMemoryBarrier image_barrier;
+        std::function<void()> on_ready;
+    };
+
+    bool stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+    bool allocate_ring(VkDeviceSize size, VkDeviceSize& offset);
+    VkCommandBuffer batch_commands();
+    void reclaim();
+    void wait_value(uint64_t value);
+
+    VulkanBackend* backend_;
+    VkDevice device_ = VK_NULL_HANDLE;
+    VkQueue queue_ = VK_NULL_HANDLE;
+    uint32_t transfer_family_ = 0;
+    uint32_t graphics_family_ = 0;
+    bool initialized_ = false;
+
+    VkSemaphore timeline_ = VK_NULL_HANDLE;
+    uint64_t next_value_ = 1;      // signalled by the batch being recorded
+
+    VkCommandPool command_pool_ = VK_NULL_HANDLE;
+    std::vector<Batch> batches_;
+    Batch* recording_ = nullptr;
+
+    uint32_t ring_buffer_id_ = 0;
+    VkBuffer ring_buffer_ = VK_NULL_HANDLE;
+    uint8_t* ring_mapped_ = nullptr;
+    GPUStagingRing ring_{RING_SIZE};
+    std::vector<DedicatedStaging> dedicated_;
+
+    std::vector<PendingAcquire> pending_;      // in submission order
+
+    Stats stats_{};
+};
+#endif
@@ -0,0 +1,81 @@
+#include "frame_view.h"
+#include <QPainter>
+#include <QImage>
+#include <QMetaObject>
+#include <QDeadlineTimer>
+
+FrameView::FrameView(QWidget *parent)
+    : QWidget(parent)
+    , m_frame{}
+    , m_hasFrame(false)
+    , m_newFrame(false)
+    , m_detached(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(320, 180);
+}
+
+FrameView::~FrameView()
+{
+    detach();
+}
+
+bool FrameView::present(const GPUPresentFrame &frame)
+{
+    QMutexLocker locker(&m_frameMutex);
+    if (m_detached) {
+        return false;
+    }
+    m_frame = frame;
+    m_hasFrame = true;
+    m_newFrame = true;
+    QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+
+    QDeadlineTimer deadline(PAINT_TIMEOUT_MS);
+    while (m_newFrame && !m_detached && m_painted.wait(&m_frameMutex, deadline)) {
+    }
+    bool painted = !m_newFrame && !m_detached;
+    m_newFrame = false;
+    return painted;
+}
+
+void FrameView::release(const GPUPresentFrame &)
+{
+    // Paints hold the mutex while they read the pixels
+    QMutexLocker locker(&m_frameMutex);
+    m_hasFrame = false;
+    m_newFrame = false;
+}
+
+void FrameView::detach()
+{
+    QMutexLocker locker(&m_frameMutex);
+    m_detached = true;
+    m_hasFrame = false;
+    m_newFrame = false;
+    m_painted.wakeAll();
+}
+
+void FrameView::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    QMutexLocker locker(&m_frameMutex);
+    if (!m_hasFrame) {
+        return;
+    }
+    // No copy: the image shares the frame's memory, which the presenter keeps
+    // on screen until release()
+    QImage image(m_frame.pixels, static_cast<int>(m_frame.width), static_cast<int>(m_frame.height),
+                 static_cast<qsizetype>(m_frame.pitch), QImage::Format_RGBA8888);
+    QSize size = image.size().scaled(this->size(), Qt::KeepAspectRatio);
+    QRect target(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(target, image);
+
+    if (m_newFrame) {
+        m_newFrame = false;
+        m_painted.wakeAll();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QWidget>
+#include <QMutex>
+#include <QWaitCondition>
+#include "gpu/gpu_presenter.h"
+
+// Displays frames from the GPU presenter. Paints draw straight from GPU
+// memory: the presenter keeps the buffer on screen until release(), so
+// paints it did not ask for (expose, resize, restore) redraw the same pixels.
+class FrameView : public QWidget, public GPUPresentSink
+{
+    Q_OBJECT
+
+public:
+    explicit FrameView(QWidget *parent = nullptr);
+    ~FrameView();
+
+    // Called on the presenter thread
+    bool present(const GPUPresentFrame &frame) override;
+    // Called when the presenter takes the buffer back; waits out a paint
+    void release(const GPUPresentFrame &frame) override;
+
+    // Stops waiting for paints; call before detaching from the presenter
+    void detach();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // A hidden or minimized window gets no paint events
+    static constexpr unsigned long PAINT_TIMEOUT_MS = 100;
+
+    QMutex m_frameMutex;
+    QWaitCondition m_painted;
+    GPUPresentFrame m_frame;
+    bool m_hasFrame;            // m_frame is on screen and may be painted
+    bool m_newFrame;            // m_frame waits for its first paint
+    bool m_detached;
+};
@@ -4,6 +4,7 @@
 #include "settings_dialog.h"
 #include "psn_manager.h"
 #include "trophy_window.h"
+#include "frame_view.h"
 #include "emulator_thread.h"
 #include "runtime/emulator.h"
 
@@ -25,6 +26,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_centralLayout(nullptr)
     , m_gameListView(nullptr)
     , m_gameListModel(nullptr)
+    , m_frameView(nullptr)
     , m_logDock(nullptr)
     , m_logWidget(nullptr)
     , m_settingsDialog(nullptr)
@@ -85,6 +87,8 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     saveSettings();
+    m_frameView->detach();
+    m_emulator->gpu().get_presenter().set_sink(nullptr);
     delete m_emulatorThread;
 }
 
@@ -206,6 +210,12 @@ void MainWindow::setupGameList()
             this, &MainWindow::onGameDoubleClicked);
     
     m_centralLayout->addWidget(m_gameListView);
+    
+    // Takes the game list's place while a game is running
+    m_frameView = new FrameView;
+    m_frameView->setVisible(false);
+    m_centralLayout->addWidget(m_frameView);
+    m_emulator->gpu().get_presenter().set_sink(m_frameView);
 }
 
 void MainWindow::setupLogDock()
@@ -386,7 +396,9 @@ void MainWindow::showSettings()
     if (!m_settingsDialog) {
         m_settingsDialog = new SettingsDialog(this);
     }
-    m_settingsDialog->exec();
+    if (m_settingsDialog->exec() == QDialog::Accepted) {
+        applyAudioSettings();
+    }
 }
 
 void MainWindow::showTrophies()
@@ -459,6 +471,8 @@ void MainWindow::updateStatus()
 void MainWindow::onEmulationStarted()
 {
     m_emulationRunning = true;
+    m_gameListView->setVisible(false);
+    m_frameView->setVisible(true);
     m_gameStatusLabel->setText(QString("Running: %1").arg(QFileInfo(m_currentGamePath).baseName()));
 }
 
@@ -470,6 +484,8 @@ void MainWindow::onEmulationPaused()
 void MainWindow::onEmulationStopped()
 {
     m_emulationRunning = false;
+    m_frameView->setVisible(false);
+    m_gameListView->setVisible(true);
     m_gameStatusLabel->setText(QString("Stopped: %1").arg(QFileInfo(m_currentGamePath).baseName()));
 }
 
@@ -482,7 +498,16 @@ void MainWindow::onEmulationError(const QString &error)
 
 void MainWindow::onFpsUpdated(int fps)
 {
-    m_fpsLabel->setText(QString("FPS: %1").arg(fps));
+    QString text = QString("FPS: %1").arg(fps);
+    // Audio health alongside: CPU or GPU stalls show up as underruns and
+    // as pacing that stretches away from 1
+    Audio& audio = m_emulator->audio();
+    if (audio.is_running()) {
+        Audio::Stats stats = audio.get_stats();
+        text += QString(" | Audio %1 ms, %2 underruns, x%3")
+            .arg(stats.latency_ms, 0, 'f', 0).arg(stats.underruns).arg(stats.stretch, 0, 'f', 4);
+    }
+    m_fpsLabel->setText(text);
 }
 
 void MainWindow::onStatusUpdated(const QString &status)
@@ -497,6 +522,41 @@ void MainWindow::loadSettings()
     
     m_psnUsername = m_settings->value("psn/username").toString();
     updatePSNStatus();
+    applyAudioSettings();
+}
+
+// (Re)opens the audio output with the saved backend, rate and buffer size
+void MainWindow::applyAudioSettings()
+{
+    QString backendName = m_settings->value("audio/backend").toString();
+    AudioBackend backend = AudioBackend::Default;
+    if (backendName == "SDL2") {
+        backend = AudioBackend::SDL2;
+    } else if (backendName == "ALSA" || backendName == "PulseAudio") {
+        // PulseAudio and PipeWire are reached through ALSA's default device
+        backend = AudioBackend::ALSA;
+    } else if (backendName.startsWith("Null")) {
+        backend = AudioBackend::Null;
+    }
+    
+    // The guest always renders 48 kHz; the setting is the device rate
+    AudioFormat format;
+    format.sample_rate = 48000;
+    format.output_sample_rate = m_settings->value("audio/sampleRate", "48000 Hz").toString().left(5).toInt();
+    format.channels = 2;
+    format.bits_per_sample = 32;
+    format.is_float = true;
+    format.period_frames = m_settings->value("audio/bufferSize", "1024").toString().toInt();
+    
+    Audio& audio = m_emulator->audio();
+    audio.shutdown();
+    if (audio.initialize(format, backend)) {
+        m_logWidget->addMessage(QString("Audio output: %1 Hz, %2 frame periods, %3 ms latency")
+            .arg(audio.get_output_sample_rate()).arg(format.period_frames)
+            .arg(audio.get_output_latency() * 1000.0, 0, 'f', 1));
+    } else {
+        m_logWidget->addMessage(QString("Audio output unavailable (%1)").arg(backendName));
+    }
 }
 
 void MainWindow::saveSettings()
@@ -22,6 +22,7 @@ class LogWidget;
 class SettingsDialog;
 class PSNManager;
 class TrophyWindow;
+class FrameView;
 
 class MainWindow : public QMainWindow
 {
@@ -61,6 +62,7 @@ private:
     void setupLogDock();
     void loadSettings();
     void saveSettings();
+    void applyAudioSettings();
     void updatePSNStatus();
     void closeEvent(QCloseEvent *event) override;
 
@@ -73,6 +75,7 @@ private:
     QVBoxLayout *m_centralLayout;
     QTableView *m_gameListView;
     GameListModel *m_gameListModel;
+    FrameView *m_frameView;
     
     // Docks
     QDockWidget *m_logDock;
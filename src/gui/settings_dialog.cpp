@@ -185,6 +185,7 @@ QWidget* SettingsDialog::createAudioTab()
 #else
     m_audioBackend->addItems({"ALSA", "PulseAudio", "SDL2"});
 #endif
+    m_audioBackend->addItem("Null (no output)");
     backendLayout->addRow("Audio Backend:", m_audioBackend);
     
     m_audioDevice = new QComboBox;
@@ -215,7 +216,7 @@ QWidget* SettingsDialog::createAudioTab()
     settingsLayout->addRow("Sample Rate:", m_sampleRate);
     
     m_bufferSize = new QComboBox;
-    m_bufferSize->addItems({"512", "1024", "2048", "4096"});
+    m_bufferSize->addItems({"128", "256", "512", "1024", "2048", "4096"});
     settingsLayout->addRow("Buffer Size:", m_bufferSize);
     
     layout->addWidget(settingsGroup);
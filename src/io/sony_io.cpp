@@ -1,8 +1,11 @@
 #include "sony_io.h"
 #include "../core/logger.h"
+#include "../core/memory.h"
+#include "../gpu/gpu.h"
 #include <cstring>
 #include <algorithm>
 #include <random>
+#include <thread>
 #include <vector>
 #include <cmath>
 
@@ -16,12 +19,22 @@ SonyIOComplex::SonyIOComplex() {
     memset(&audio_engine, 0, sizeof(audio_engine));
     audio_engine.hrtf_enabled = true;
     audio_engine.output_channels = 2; // Stereo default
+    room_reverb.configure(AudioReverb::ROOM, TEMPEST_SAMPLE_RATE);
+    
+    // HRTF engine on the built-in spherical-head responses until a measured
+    // set is loaded
+    hrir_set.make_spherical_head(TEMPEST_SAMPLE_RATE);
+    hrtf = std::make_unique<AudioHRTFEngine>(hrir_set, HRTF_BLOCK_FRAMES);
+    hrtf_input.assign(HRTF_BLOCK_FRAMES, 0.0f);
+    hrtf_left.assign(HRTF_BLOCK_FRAMES, 0.0f);
+    hrtf_right.assign(HRTF_BLOCK_FRAMES, 0.0f);
     
     // Initialize SSD controller
     ssd_controller.total_capacity = 825ULL * 1024 * 1024 * 1024; // 825GB
     ssd_controller.queue_depth = 32;
     ssd_controller.compression_enabled = true;
     ssd_controller.decompression_unit_active = true;
+    ssd_reader.set_cache(&ssd_cache, SSD_READ_AHEAD_BLOCKS);
     
     // Register standard PS5 I/O devices
     RegisterDevice({0x1000, 0x10000000, 0x1000, "DualSense Controller", false});
@@ -34,6 +47,9 @@ SonyIOComplex::SonyIOComplex() {
 }
 
 SonyIOComplex::~SonyIOComplex() {
+    // Members go in reverse order, so the reader would be gone before the
+    // queue; finish every request while its callbacks still have a reader
+    ssd_queue.close();
     Logger::Info("Sony I/O Complex shutdown");
 }
 
@@ -144,160 +160,206 @@ void SonyIOComplex::ProcessAudio(float* samples, size_t sample_count) {
         return;
     }
     
-    for (size_t i = 0; i < sample_count; i += 2) {
-        float left_output = 0.0f;
-        float right_output = 0.0f;
+    // Stereo sources share the incoming mix, so they pass straight through
+    // both channels at their combined volume
+    float stereo_volume = 0.0f;
+    for (const auto& source : audio_engine.sources) {
+        if (!source.is_3d) stereo_volume += source.volume;
+    }
+    
+    // 3D sources go through the HRTF engine a block at a time, so their
+    // output trails the input by one block
+    const size_t block = hrtf->block_frames();
+    for (size_t i = 0; i + 1 < sample_count; i += 2) {
+        hrtf_input[hrtf_fill] = samples[i];
+        float left_output = samples[i] * stereo_volume + hrtf_left[hrtf_fill];
+        float right_output = samples[i + 1] * stereo_volume + hrtf_right[hrtf_fill];
+        samples[i] = left_output;
+        samples[i + 1] = right_output;
+        if (++hrtf_fill == block) {
+            render_hrtf_block();
+            hrtf_fill = 0;
+        }
+    }
+    
+    // Room acoustics over the whole mixed block
+    room_reverb.process(samples, sample_count / 2, 2, ROOM_REVERB_WET);
+}
+
+void SonyIOComplex::Add3DAudioSource(uint32_t source_id, const Tempest3D::AudioSource& source) {
+    Tempest3D::AudioSource entry = source;
+    entry.id = source_id;
+    for (auto& existing : audio_engine.sources) {
+        if (existing.id == source_id) {
+            existing = entry;
+            return;
+        }
+    }
+    audio_engine.sources.push_back(entry);
+}
+
+void SonyIOComplex::Remove3DAudioSource(uint32_t source_id) {
+    auto& sources = audio_engine.sources;
+    sources.erase(std::remove_if(sources.begin(), sources.end(),
+                                 [source_id](const Tempest3D::AudioSource& s) { return s.id == source_id; }),
+                  sources.end());
+}
+
+void SonyIOComplex::SetListenerTransform(const float position[3], const float orientation[4]) {
+    std::copy(position, position + 3, audio_engine.listener_position);
+    std::copy(orientation, orientation + 4, audio_engine.listener_orientation);
+}
+
+bool SonyIOComplex::LoadHRIRSet(const std::string& path) {
+    AudioHRIRSet set;
+    if (!set.load(path) || set.sample_rate() != TEMPEST_SAMPLE_RATE) {
+        Logger::Error("Failed to load HRIR set {}", path);
+        return false;
+    }
+    hrir_set = std::move(set);
+    hrtf = std::make_unique<AudioHRTFEngine>(hrir_set, HRTF_BLOCK_FRAMES);
+    return true;
+}
+
+// Per source, once per block: direction in the listener's frame, distance
+// and air losses, Doppler pitch
+void SonyIOComplex::render_hrtf_block() {
+    const float* q = audio_engine.listener_orientation;   // x, y, z, w
+    float q_norm = q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3];
+    
+    doppler.push(hrtf_input.data());
+    hrtf_sources.clear();
+    for (const auto& source : audio_engine.sources) {
+        if (!source.is_3d) continue;
         
-        for (const auto& source : audio_engine.sources) {
-            if (!source.is_3d) {
-                // Stereo source - simple mixing
-                // TODO: Implement proper stereo mixing
-                left_output += samples[i] * source.volume;
-                right_output += samples[i + 1] * source.volume;
-                continue;
-            }
-            
-            // Calculate 3D position relative to listener
-            float dx = source.position[0] - audio_engine.listener_position[0];
-            float dy = source.position[1] - audio_engine.listener_position[1];
-            float dz = source.position[2] - audio_engine.listener_position[2];
-            
-            float distance = std::sqrt(dx*dx + dy*dy + dz*dz);
-            if (distance < 0.001f) distance = 0.001f;
-            
-            // Calculate spherical coordinates for HRTF lookup
-            float azimuth = std::atan2(dx, dz);
-            float elevation = std::atan2(dy, std::sqrt(dx*dx + dz*dz));
-            
-            // Distance attenuation with realistic falloff
-            float attenuation = 1.0f / (1.0f + distance * distance * 0.01f);
-            
-            // Air absorption (high frequencies attenuate more with distance)
-            float air_absorption = std::exp(-distance * 0.001f);
-            
-            // Apply HRTF (Head-Related Transfer Function)
-            float hrtf_left, hrtf_right;
-            apply_hrtf(azimuth, elevation, &hrtf_left, &hrtf_right);
-            
-            float doppler_factor = calculate_doppler_shift(source, dx, dy, dz, distance);
-            
-            float source_sample = samples[i] * source.volume * attenuation * air_absorption * doppler_factor;
-            
-            left_output += source_sample * hrtf_left;
-            right_output += source_sample * hrtf_right;
+        // Calculate 3D position relative to listener
+        float dx = source.position[0] - audio_engine.listener_position[0];
+        float dy = source.position[1] - audio_engine.listener_position[1];
+        float dz = source.position[2] - audio_engine.listener_position[2];
+        
+        float distance = std::sqrt(dx*dx + dy*dy + dz*dz);
+        if (distance < 0.001f) distance = 0.001f;
+        
+        // Rotate into the listener's frame (inverse of the orientation);
+        // an unset orientation leaves the world axes
+        float lx = dx, ly = dy, lz = dz;
+        if (q_norm > 1e-6f) {
+            float ux = -q[0], uy = -q[1], uz = -q[2], w = q[3];
+            float dot = ux*dx + uy*dy + uz*dz;
+            float cx = uy*dz - uz*dy, cy = uz*dx - ux*dz, cz = ux*dy - uy*dx;
+            float scale = (w*w - (ux*ux + uy*uy + uz*uz)) / q_norm;
+            lx = (2.0f * dot * ux + 2.0f * w * cx) / q_norm + scale * dx;
+            ly = (2.0f * dot * uy + 2.0f * w * cy) / q_norm + scale * dy;
+            lz = (2.0f * dot * uz + 2.0f * w * cz) / q_norm + scale * dz;
         }
         
-        apply_room_acoustics(&left_output, &right_output, i);
+        // Calculate spherical coordinates for HRTF lookup
+        float azimuth = std::atan2(lx, lz);
+        float elevation = std::atan2(ly, std::sqrt(lx*lx + lz*lz));
         
-        samples[i] = left_output;
-        samples[i + 1] = right_output;
+        // Distance attenuation with realistic falloff
+        float attenuation = 1.0f / (1.0f + distance * distance * 0.01f);
+        
+        // Air absorption (high frequencies attenuate more with distance)
+        float air_absorption = std::exp(-distance * 0.001f);
+        
+        // Doppler as pitch: each source reads the block through its own delay
+        float doppler_factor = calculate_doppler_shift(source, dx, dy, dz, distance);
+        const float* input = doppler.render(hrtf_sources.size(), static_cast<int>(source.id), distance, doppler_factor);
+        
+        float gain = source.volume * attenuation * air_absorption;
+        hrtf_sources.push_back({static_cast<int>(source.id), azimuth, elevation, gain, input});
     }
+    hrtf->process(hrtf_sources, hrtf_left.data(), hrtf_right.data());
+}
+
+bool SonyIOComplex::MountSSD(const std::string& image_path) {
+    SSDQueue::Config config;
+    config.queue_depth = ssd_controller.queue_depth;
+    if (!ssd_queue.open(image_path, config)) {
+        Logger::Error("Failed to open SSD image {}", image_path);
+        return false;
+    }
+    Logger::Info("Mounted SSD image {} ({}, queue depth {})", image_path,
+                 ssd_queue.backend() == SSDQueue::Backend::IoUring ? "io_uring" : "thread pool",
+                 ssd_queue.queue_depth());
+    return true;
 }
 
 void SonyIOComplex::QueueSSDRead(uint64_t lba, uint32_t sectors, void* buffer, std::function<void(bool)> callback) {
-    SSDController::IORequest request;
-    request.lba = lba;
-    request.sector_count = sectors;
-    request.buffer = buffer;
-    request.is_write = false;
-    request.callback = callback;
-    
-    ssd_controller.pending_requests.push_back(request);
+    if (!ssd_queue.is_open()) {
+        Logger::Error("SSD read with no image mounted: LBA={}", lba);
+        if (callback) callback(false);
+        return;
+    }
+    // A full queue stalls the guest until earlier requests complete, as the
+    // hardware would
+    while (!ssd_queue.submit_read(lba, sectors, buffer, callback)) {
+        if (ssd_queue.poll() == 0) std::this_thread::yield();
+    }
     Logger::Debug("Queued SSD read: LBA={}, sectors={}", lba, sectors);
 }
 
-void SonyIOComplex::ProcessSSDQueue() {
-    // Process pending SSD requests
-    for (auto& request : ssd_controller.pending_requests) {
-        if (request.is_write) {
-            // Write operation with compression
-            Logger::Debug("Processing SSD write: LBA={}, sectors={}", request.lba, request.sector_count);
-            
-            if (ssd_controller.compression_enabled) {
-                // Apply Kraken compression (PS5's custom compression)
-                size_t original_size = request.sector_count * 512;
-                std::vector<uint8_t> compressed_data;
-                
-                bool compression_success = compress_kraken(
-                    static_cast<const uint8_t*>(request.buffer),
-                    original_size,
-                    compressed_data
-                );
-                
-                if (compression_success) {
-                    Logger::Debug("Compressed {} bytes to {} bytes (ratio: {:.2f})",
-                                original_size, compressed_data.size(),
-                                (float)compressed_data.size() / original_size);
-                    
-                    store_compressed_block(request.lba, compressed_data);
-                } else {
-                    store_uncompressed_block(request.lba, 
-                                           static_cast<const uint8_t*>(request.buffer),
-                                           original_size);
-                }
-            } else {
-                store_uncompressed_block(request.lba,
-                                       static_cast<const uint8_t*>(request.buffer),
-                                       request.sector_count * 512);
-            }
-        } else {
-            Logger::Debug("Processing SSD read: LBA={}, sectors={}", request.lba, request.sector_count);
-            
-            if (ssd_controller.decompression_unit_active) {
-                std::vector<uint8_t> stored_data;
-                bool is_compressed = load_block(request.lba, stored_data);
-                
-                if (is_compressed) {
-                    std::vector<uint8_t> decompressed_data;
-                    bool decompression_success = decompress_kraken(stored_data, decompressed_data);
-                    
-                    if (decompression_success) {
-                        size_t copy_size = std::min(decompressed_data.size(), 
-                                                  request.sector_count * 512);
-                        std::memcpy(request.buffer, decompressed_data.data(), copy_size);
-                        
-                        Logger::Debug("Decompressed {} bytes to {} bytes",
-                                    stored_data.size(), decompressed_data.size());
-                    } else {
-                        Logger::Error("Decompression failed for LBA {}", request.lba);
-                        std::memset(request.buffer, 0, request.sector_count * 512);
-                    }
-                } else {
-                    // Direct read of uncompressed data
-                    std::vector<uint8_t> stored_data;
-                    load_block(request.lba, stored_data);
-                    
-                    size_t copy_size = std::min(stored_data.size(), request.sector_count * 512);
-                    std::memcpy(request.buffer, stored_data.data(), copy_size);
-                    
-                    // Zero-fill remaining space
-                    if (copy_size < request.sector_count * 512) {
-                        std::memset(static_cast<uint8_t*>(request.buffer) + copy_size, 0,
-                                  request.sector_count * 512 - copy_size);
-                    }
-                }
-            } else {
-                // Simple read without decompression
-                // TODO implement proper decompression
-                std::vector<uint8_t> stored_data;
-                load_block(request.lba, stored_data);
-                
-                size_t copy_size = std::min(stored_data.size(), request.sector_count * 512);
-                std::memcpy(request.buffer, stored_data.data(), copy_size);
-                
-                if (copy_size < request.sector_count * 512) {
-                    std::memset(static_cast<uint8_t*>(request.buffer) + copy_size, 0,
-                              request.sector_count * 512 - copy_size);
-                }
-            }
-        }
-        
-        if (request.callback) {
-            request.callback(true);
+void SonyIOComplex::QueueSSDWrite(uint64_t lba, uint32_t sectors, const void* buffer,
+                                  std::function<void(bool)> callback) {
+    if (!ssd_queue.is_open()) {
+        Logger::Error("SSD write with no image mounted: LBA={}", lba);
+        if (callback) callback(false);
+        return;
+    }
+    // Through the reader, so cached blocks over these sectors are dropped
+    while (!ssd_reader.submit_write(lba, sectors, buffer, callback)) {
+        if (ssd_queue.poll() == 0) std::this_thread::yield();
+    }
+    Logger::Debug("Queued SSD write: LBA={}, sectors={}", lba, sectors);
+}
+
+void SonyIOComplex::QueueSSDCompressedRead(uint64_t lba, uint32_t compressed_size, void* output, size_t output_size,
+                                           std::function<void(bool)> callback) {
+    submit_compressed_read(lba, compressed_size, static_cast<uint8_t*>(output), output_size, std::move(callback));
+}
+
+void SonyIOComplex::QueueSSDCompressedRead(uint64_t lba, uint32_t compressed_size, SSDMemorySpace space,
+                                           uint64_t address, size_t output_size, std::function<void(bool)> callback) {
+    uint8_t* output = nullptr;
+    if (space == SSDMemorySpace::Guest && guest_memory) {
+        output = guest_memory->host_span(address, output_size, MemoryProtection::WRITE);
+    } else if (space == SSDMemorySpace::GPU && gpu) {
+        output = gpu->get_gpu_memory_span(address, output_size);
+    }
+    if (!output) {
+        Logger::Error("SSD read destination not writable: {} 0x{:x}+{}",
+                      space == SSDMemorySpace::Guest ? "guest" : "GPU", address, output_size);
+        if (callback) callback(false);
+        return;
+    }
+    submit_compressed_read(lba, compressed_size, output, output_size,
+                           [this, space, address, output_size, callback](bool ok) {
+        // Decoded bytes bypassed the memory interfaces, so report them
+        if (ok && space == SSDMemorySpace::Guest) {
+            guest_memory->span_written(address, output_size);
+        } else if (ok) {
+            gpu->mark_gpu_memory_dirty(address, output_size);
         }
+        if (callback) callback(ok);
+    });
+}
+
+void SonyIOComplex::submit_compressed_read(uint64_t lba, uint32_t compressed_size, uint8_t* output,
+                                           size_t output_size, std::function<void(bool)> callback) {
+    if (!ssd_queue.is_open()) {
+        Logger::Error("SSD read with no image mounted: LBA={}", lba);
+        if (callback) callback(false);
+        return;
     }
-    
-    ssd_controller.pending_requests.clear();
+    while (!ssd_reader.submit(lba, compressed_size, output, output_size, callback)) {
+        if (ssd_queue.poll() == 0) std::this_thread::yield();
+    }
+    Logger::Debug("Queued compressed SSD read: LBA={}, {} -> {} bytes", lba, compressed_size, output_size);
+}
+
+void SonyIOComplex::ProcessSSDQueue() {
+    ssd_queue.poll();
 }
 
 bool SonyIOComplex::VerifySecureBoot(const void* bootloader, size_t size) {
@@ -347,97 +409,12 @@ bool SonyIOComplex::VerifySecureBoot(const void* bootloader, size_t size) {
 }
 
 bool SonyIOComplex::compress_kraken(const uint8_t* input, size_t input_size, std::vector<uint8_t>& output) {
-    // Simplified Kraken compression implementation
-    // TODO: use RAD Game Tools' Kraken compressor like in PS5
-    
-    output.clear();
-    output.reserve(input_size);
-    
-    // Simple RLE compression as placeholder for real Kraken
-    // TODO: Implement proper Kraken compression
-    for (size_t i = 0; i < input_size; ) {
-        uint8_t current_byte = input[i];
-        size_t run_length = 1;
-        
-        // Count consecutive identical bytes
-        while (i + run_length < input_size && 
-               input[i + run_length] == current_byte && 
-               run_length < 255) {
-            run_length++;
-        }
-        
-        if (run_length >= 3) {
-            // Encode as run: [0xFF] [length] [byte]
-            output.push_back(0xFF);
-            output.push_back(static_cast<uint8_t>(run_length));
-            output.push_back(current_byte);
-        } else {
-            // Store literal bytes
-            for (size_t j = 0; j < run_length; j++) {
-                output.push_back(input[i + j]);
-            }
-        }
-        
-        i += run_length;
-    }
-    
+    ssd_codec.compress(input, input_size, output);
     return output.size() < input_size;
 }
 
-bool SonyIOComplex::decompress_kraken(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
-    output.clear();
-    
-    for (size_t i = 0; i < input.size(); ) {
-        if (input[i] == 0xFF && i + 2 < input.size()) {
-            uint8_t run_length = input[i + 1];
-            uint8_t byte_value = input[i + 2];
-            
-            for (uint8_t j = 0; j < run_length; j++) {
-                output.push_back(byte_value);
-            }
-            
-            i += 3;
-        } else {
-            output.push_back(input[i]);
-            i++;
-        }
-    }
-    
-    return true;
-}
-
-void SonyIOComplex::apply_hrtf(float azimuth, float elevation, float* left_gain, float* right_gain) {
-    // Real HRTF implementation using measured data
-    // This is a simplified version - TODO: use extensive HRTF databases like in PS5
-    
-    float azimuth_deg = azimuth * 180.0f / M_PI;
-    float elevation_deg = elevation * 180.0f / M_PI;
-    
-    azimuth_deg = std::fmod(azimuth_deg + 360.0f, 360.0f);
-    elevation_deg = std::max(-90.0f, std::min(90.0f, elevation_deg));
-    
-    // Simplified HRTF calculation based on spherical coordinates
-    // TODO: Implement proper HRTF calculation  
-    float azimuth_rad = azimuth_deg * M_PI / 180.0f;
-    float elevation_rad = elevation_deg * M_PI / 180.0f;
-    
-    // Left ear gain calculation
-    float left_azimuth_factor = std::cos(azimuth_rad + M_PI * 0.25f);
-    float left_elevation_factor = std::cos(elevation_rad);
-    *left_gain = 0.5f + 0.5f * left_azimuth_factor * left_elevation_factor;
-    
-    // Right ear gain calculation  
-    float right_azimuth_factor = std::cos(azimuth_rad - M_PI * 0.25f);
-    float right_elevation_factor = std::cos(elevation_rad);
-    *right_gain = 0.5f + 0.5f * right_azimuth_factor * right_elevation_factor;
-    
-    // Apply head shadow effect for high frequencies
-    float head_shadow = std::exp(-std::abs(azimuth_rad) * 0.5f);
-    if (azimuth_rad > 0) {
-        *left_gain *= head_shadow;
-    } else {
-        *right_gain *= head_shadow;
-    }
+bool SonyIOComplex::decompress_kraken(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size) {
+    return SSDCodec::decompress(input, input_size, output, output_size, scheduler);
 }
 
 float SonyIOComplex::calculate_doppler_shift(const Tempest3D::AudioSource& source, 
@@ -447,52 +424,19 @@ float SonyIOComplex::calculate_doppler_shift(const Tempest3D::AudioSource& sourc
     
     if (distance < 0.001f) return 1.0f;
     
-    // Calculate radial velocity (velocity component towards listener)
+    // Radial velocity, positive when the source moves away (dx, dy, dz
+    // point from the listener to the source)
     float radial_velocity = (source.velocity[0] * dx + 
                            source.velocity[1] * dy + 
                            source.velocity[2] * dz) / distance;
     
-    // Doppler shift formula: f' = f * (c + vr) / (c + vs)
-    // Simplified: assuming listener is stationary (vr = 0)
-    // vs = source velocity
-    // TODO: Implement proper Doppler effect calculation
-    float doppler_factor = sound_speed / (sound_speed - radial_velocity);
+    // Moving source, stationary listener: f' = f * c / (c + vs)
+    float doppler_factor = sound_speed / (sound_speed + radial_velocity);
     
     // Clamp to reasonable range to avoid audio artifacts
     return std::max(0.5f, std::min(2.0f, doppler_factor));
 }
 
-void SonyIOComplex::apply_room_acoustics(float* left, float* right, size_t sample_index) {
-    // Real room acoustics simulation with multiple reflection paths
-    static std::vector<float> early_reflections_left(2400, 0.0f);  // 50ms
-    static std::vector<float> early_reflections_right(2400, 0.0f);
-    static std::vector<float> late_reverb_left(9600, 0.0f);       // 200ms
-    static std::vector<float> late_reverb_right(9600, 0.0f);
-    static size_t reflection_pos = 0;
-    static size_t reverb_pos = 0;
-    
-    // Early reflections (walls, ceiling, floor)
-    float early_left = early_reflections_left[reflection_pos];
-    float early_right = early_reflections_right[reflection_pos];
-    
-    early_reflections_left[reflection_pos] = *left * 0.3f + early_left * 0.2f;
-    early_reflections_right[reflection_pos] = *right * 0.3f + early_right * 0.2f;
-    
-    // Late reverb (diffuse reflections)
-    float late_left = late_reverb_left[reverb_pos];
-    float late_right = late_reverb_right[reverb_pos];
-    
-    late_reverb_left[reverb_pos] = (*left + early_left) * 0.1f + late_left * 0.4f;
-    late_reverb_right[reverb_pos] = (*right + early_right) * 0.1f + late_right * 0.4f;
-    
-    // Mix original signal with reflections and reverb
-    *left += early_left * 0.2f + late_left * 0.1f;
-    *right += early_right * 0.2f + late_right * 0.1f;
-    
-    reflection_pos = (reflection_pos + 1) % early_reflections_left.size();
-    reverb_pos = (reverb_pos + 1) % late_reverb_left.size();
-}
-
 SecurityProcessor::SecurityProcessor() 
     : current_level(SecurityLevel::USER), secure_boot_verified(false) {
     
@@ -1,11 +1,22 @@
 #pragma once
 
 #include "../core/types.h"
+#include "../audio/audio_hrtf.h"
+#include "../audio/audio_resampler.h"
+#include "../audio/audio_reverb.h"
+#include "ssd_cache.h"
+#include "ssd_codec.h"
+#include "ssd_queue.h"
+#include "ssd_reader.h"
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 
+class GPU;
+class Memory;
+class Scheduler;
+
 namespace PS5Emu {
 
 class SonyIOComplex {
@@ -59,6 +70,7 @@ public:
     // Tempest 3D AudioTech
     struct Tempest3D {
         struct AudioSource {
+            uint32_t id;
             float position[3];
             float velocity[3];
             float volume;
@@ -68,22 +80,17 @@ public:
         
         std::vector<AudioSource> sources;
         float listener_position[3];
-        float listener_orientation[4]; // quaternion
+        float listener_orientation[4]; // quaternion x, y, z, w
         bool hrtf_enabled;
         uint32_t output_channels;
     };
 
+    // Where a compressed SSD read lands: a guest virtual address, or an
+    // offset into GPU memory
+    enum class SSDMemorySpace { Guest, GPU };
+
     // SSD I/O Complex
     struct SSDController {
-        struct IORequest {
-            uint64_t lba;
-            uint32_t sector_count;
-            void* buffer;
-            bool is_write;
-            std::function<void(bool)> callback;
-        };
-        
-        std::vector<IORequest> pending_requests;
         uint64_t total_capacity;
         uint32_t queue_depth;
         bool compression_enabled;
@@ -94,12 +101,52 @@ private:
     std::unordered_map<uint32_t, IODevice> devices;
     DualSenseState controller_state;
     Tempest3D audio_engine;
+    AudioReverb room_reverb;
+    AudioHRIRSet hrir_set;
+    std::unique_ptr<AudioHRTFEngine> hrtf;
+    std::vector<AudioHRTFSource> hrtf_sources;
+    std::vector<float> hrtf_input;     // left channel of the block being gathered
+    std::vector<float> hrtf_left;      // binaural output of the previous block
+    std::vector<float> hrtf_right;
+    size_t hrtf_fill = 0;
+    AudioDoppler doppler{TEMPEST_SAMPLE_RATE, HRTF_BLOCK_FRAMES, AudioResampleQuality::Sinc};
     SSDController ssd_controller;
+    SSDQueue ssd_queue;
+    SSDCodec ssd_codec;
+    SSDBlockCache ssd_cache;
+    SSDReader ssd_reader{ssd_queue};
+    Scheduler* scheduler = nullptr;
+    Memory* guest_memory = nullptr;
+    GPU* gpu = nullptr;
+
+    static constexpr int TEMPEST_SAMPLE_RATE = 48000;
+    static constexpr size_t HRTF_BLOCK_FRAMES = 128;
+    static constexpr float ROOM_REVERB_WET = 0.3f;
+    static constexpr uint32_t SSD_READ_AHEAD_BLOCKS = 4;
+    
+    void render_hrtf_block();
+    // Framed SSDCodec streams; false when compression saves nothing
+    bool compress_kraken(const uint8_t* input, size_t input_size, std::vector<uint8_t>& output);
+    // Decodes into exactly output_size bytes of the caller's buffer, across
+    // the scheduler's workers for large frames
+    bool decompress_kraken(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size);
+    void submit_compressed_read(uint64_t lba, uint32_t compressed_size, uint8_t* output, size_t output_size,
+                                std::function<void(bool)> callback);
+    float calculate_doppler_shift(const Tempest3D::AudioSource& source, float dx, float dy, float dz, float distance);
     
 public:
     SonyIOComplex();
     ~SonyIOComplex();
     
+    // Worker pool for chunk-parallel decompression
+    void SetScheduler(Scheduler* sched) {
+        scheduler = sched;
+        ssd_reader.set_scheduler(sched);
+    }
+    // Destinations for compressed SSD reads that decode in place
+    void SetGuestMemory(Memory* memory) { guest_memory = memory; }
+    void SetGPU(GPU* device) { gpu = device; }
+    
     // Device management
     void RegisterDevice(const IODevice& device);
     bool ReadDevice(uint32_t device_id, uint32_t offset, void* data, size_t size);
@@ -116,11 +163,27 @@ public:
     void Add3DAudioSource(uint32_t source_id, const Tempest3D::AudioSource& source);
     void Remove3DAudioSource(uint32_t source_id);
     void SetListenerTransform(const float position[3], const float orientation[4]);
+    // Replaces the built-in responses with a PSX5HRIR file at 48 kHz
+    bool LoadHRIRSet(const std::string& path);
     
     // SSD operations
+    // Backs the SSD with a host image file; requests fail until one is mounted
+    bool MountSSD(const std::string& image_path);
     void QueueSSDRead(uint64_t lba, uint32_t sectors, void* buffer, std::function<void(bool)> callback);
     void QueueSSDWrite(uint64_t lba, uint32_t sectors, const void* buffer, std::function<void(bool)> callback);
+    // Reads a compressed frame of compressed_size bytes starting at lba and
+    // decodes it into output; the callback runs after the last chunk decodes
+    void QueueSSDCompressedRead(uint64_t lba, uint32_t compressed_size, void* output, size_t output_size,
+                                std::function<void(bool)> callback);
+    // Same, decoding straight into guest or GPU memory. The span is resolved
+    // once, here, and must stay mapped until the callback runs.
+    void QueueSSDCompressedRead(uint64_t lba, uint32_t compressed_size, SSDMemorySpace space, uint64_t address,
+                                size_t output_size, std::function<void(bool)> callback);
+    // Runs the callbacks of finished requests on the calling thread
     void ProcessSSDQueue();
+    // Decompressed-block cache and read-ahead counters
+    SSDBlockCache::Stats GetSSDCacheStats() const { return ssd_cache.get_stats(); }
+    SSDReader::Stats GetSSDReaderStats() const { return ssd_reader.get_stats(); }
     
     // Security interface
     bool ValidateSecureAccess(uint32_t device_id, uint32_t access_level);
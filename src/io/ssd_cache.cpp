@@ -0,0 +1,178 @@
+#include "ssd_cache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+uint64_t sectors_of(uint32_t compressed_size) {
+    return (static_cast<uint64_t>(compressed_size) + SSDBlockCache::SECTOR_SIZE - 1) / SSDBlockCache::SECTOR_SIZE;
+}
+
+} // namespace
+
+SSDBlockCache::SSDBlockCache() : SSDBlockCache(Config()) {}
+
+SSDBlockCache::SSDBlockCache(const Config& config)
+    : shard_count_(round_up_pow2(std::max<uint32_t>(config.shards, 1))),
+      shard_capacity_(config.capacity / shard_count_),
+      shards_(std::make_unique<Shard[]>(shard_count_)) {}
+
+SSDBlockCache::~SSDBlockCache() = default;
+
+SSDBlockCache::Shard& SSDBlockCache::shard_for(uint64_t lba) const {
+    // Neighbouring blocks land in different shards
+    return shards_[(lba * 0x9E3779B97F4A7C15ull >> 32) & (shard_count_ - 1)];
+}
+
+bool SSDBlockCache::lookup(uint64_t lba, uint32_t compressed_size, uint8_t* output, size_t raw_size) {
+    Shard& shard = shard_for(lba);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(lba);
+    if (it == shard.index.end()) {
+        shard.counters.misses++;
+        return false;
+    }
+    Block& block = shard.blocks[it->second];
+    if (block.compressed_size != compressed_size || block.data.size() != raw_size) {
+        shard.counters.misses++;
+        return false;
+    }
+    std::memcpy(output, block.data.data(), raw_size);
+    block.referenced = true;
+    if (block.read_ahead) {
+        block.read_ahead = false;
+        shard.counters.read_ahead_used++;
+    }
+    shard.counters.hits++;
+    shard.counters.hit_bytes += raw_size;
+    shard.counters.bytes_saved += compressed_size;
+    return true;
+}
+
+bool SSDBlockCache::contains(uint64_t lba, uint32_t* compressed_size) const {
+    Shard& shard = shard_for(lba);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(lba);
+    if (it == shard.index.end()) return false;
+    if (compressed_size) *compressed_size = shard.blocks[it->second].compressed_size;
+    return true;
+}
+
+void SSDBlockCache::insert(uint64_t lba, uint32_t compressed_size, const uint8_t* data, size_t raw_size,
+                           uint64_t generation, bool read_ahead) {
+    if (raw_size == 0 || raw_size > shard_capacity_) return;
+    Shard& shard = shard_for(lba);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // invalidate() bumps the generation before it sweeps the shards, so
+    // checking under the lock leaves no window for stale data
+    if (generation != generation_.load(std::memory_order_acquire)) return;
+
+    auto it = shard.index.find(lba);
+    if (it != shard.index.end()) drop(shard, it->second);
+    make_room(shard, raw_size);
+
+    uint32_t slot;
+    if (shard.free_slots.empty()) {
+        slot = static_cast<uint32_t>(shard.blocks.size());
+        shard.blocks.emplace_back();
+    } else {
+        slot = shard.free_slots.back();
+        shard.free_slots.pop_back();
+    }
+    Block& block = shard.blocks[slot];
+    block.lba = lba;
+    block.compressed_size = compressed_size;
+    block.live = true;
+    // New blocks wait a full sweep before they can go
+    block.referenced = true;
+    block.read_ahead = read_ahead;
+    block.data.assign(data, data + raw_size);
+    shard.index[lba] = slot;
+    shard.bytes += raw_size;
+    shard.counters.inserts++;
+    if (read_ahead) shard.counters.read_ahead_inserts++;
+}
+
+void SSDBlockCache::make_room(Shard& shard, size_t size) {
+    // Two passes at most: the first clears every reference bit
+    while (shard.bytes + size > shard_capacity_) {
+        if (shard.hand >= shard.blocks.size()) shard.hand = 0;
+        Block& block = shard.blocks[shard.hand];
+        if (block.live) {
+            if (block.referenced) {
+                block.referenced = false;
+            } else {
+                drop(shard, static_cast<uint32_t>(shard.hand));
+                shard.counters.evictions++;
+            }
+        }
+        ++shard.hand;
+    }
+}
+
+void SSDBlockCache::drop(Shard& shard, uint32_t slot) {
+    Block& block = shard.blocks[slot];
+    if (block.read_ahead) shard.counters.read_ahead_unused++;
+    shard.index.erase(block.lba);
+    shard.bytes -= block.data.size();
+    block.live = false;
+    block.read_ahead = false;
+    std::vector<uint8_t>().swap(block.data);
+    shard.free_slots.push_back(slot);
+}
+
+void SSDBlockCache::invalidate(uint64_t lba, uint64_t sectors) {
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    const uint64_t end = lba + sectors;
+    // Blocks are keyed by their first sector only, so every shard is swept;
+    // writes are rare next to streaming reads
+    for (size_t s = 0; s < shard_count_; ++s) {
+        Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (uint32_t slot = 0; slot < shard.blocks.size(); ++slot) {
+            const Block& block = shard.blocks[slot];
+            if (block.live && block.lba < end && lba < block.lba + sectors_of(block.compressed_size)) {
+                drop(shard, slot);
+                shard.counters.invalidations++;
+            }
+        }
+    }
+}
+
+void SSDBlockCache::clear() {
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    for (size_t s = 0; s < shard_count_; ++s) {
+        Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (uint32_t slot = 0; slot < shard.blocks.size(); ++slot) {
+            if (shard.blocks[slot].live) drop(shard, slot);
+        }
+    }
+}
+
+SSDBlockCache::Stats SSDBlockCache::get_stats() const {
+    Stats stats{};
+    for (size_t s = 0; s < shard_count_; ++s) {
+        const Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.hits += shard.counters.hits;
+        stats.misses += shard.counters.misses;
+        stats.hit_bytes += shard.counters.hit_bytes;
+        stats.bytes_saved += shard.counters.bytes_saved;
+        stats.inserts += shard.counters.inserts;
+        stats.evictions += shard.counters.evictions;
+        stats.invalidations += shard.counters.invalidations;
+        stats.read_ahead_inserts += shard.counters.read_ahead_inserts;
+        stats.read_ahead_used += shard.counters.read_ahead_used;
+        stats.read_ahead_unused += shard.counters.read_ahead_unused;
+        stats.bytes += shard.bytes;
+        stats.blocks += shard.index.size();
+    }
+    return stats;
+}
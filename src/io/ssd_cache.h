@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Size-bounded cache of decompressed SSD blocks with CLOCK eviction
+// A block is one compressed frame, keyed by its first LBA and checked
+// against the request's compressed and raw sizes; it covers the sectors
+// its compressed bytes occupy. Blocks are spread over shards by LBA, each
+// with its own lock, byte budget and clock hand. A hit sets the block's
+// reference bit, and eviction sweeps the hand clearing bits until it
+// finds a block not hit since the hand last passed it.
+// Blocks inserted by read-ahead are flagged until their first hit, so the
+// stats show how much of the read-ahead was used. Writes invalidate by
+// LBA range and bump a generation number; an insert carrying an older
+// generation is dropped, so a read that raced a write never caches stale
+// data.
+class SSDBlockCache {
+public:
+    static constexpr uint32_t SECTOR_SIZE = 512;
+
+    struct Config {
+        size_t capacity = 256u << 20;   // decompressed bytes over all shards
+        uint32_t shards = 8;            // rounded up to a power of two
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t hit_bytes;             // decompressed bytes served
+        uint64_t bytes_saved;           // compressed bytes hits did not read
+        uint64_t inserts;
+        uint64_t evictions;
+        uint64_t invalidations;         // blocks dropped by writes
+        uint64_t read_ahead_inserts;
+        uint64_t read_ahead_used;       // read-ahead blocks hit at least once
+        uint64_t read_ahead_unused;     // evicted or invalidated before any hit
+        size_t bytes;
+        size_t blocks;
+    };
+
+    SSDBlockCache();
+    explicit SSDBlockCache(const Config& config);
+    ~SSDBlockCache();
+
+    SSDBlockCache(const SSDBlockCache&) = delete;
+    SSDBlockCache& operator=(const SSDBlockCache&) = delete;
+
+    // Copies the block into output on a hit
+    bool lookup(uint64_t lba, uint32_t compressed_size, uint8_t* output, size_t raw_size);
+    // Whether a block starts at lba, and its compressed size if so
+    bool contains(uint64_t lba, uint32_t* compressed_size = nullptr) const;
+    // Adds or replaces a block. Skipped when it is larger than a shard or
+    // an invalidation happened since `generation` was read.
+    void insert(uint64_t lba, uint32_t compressed_size, const uint8_t* data, size_t raw_size, uint64_t generation,
+                bool read_ahead = false);
+    // Drops every block overlapping the sectors [lba, lba + sectors)
+    void invalidate(uint64_t lba, uint64_t sectors);
+    void clear();
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    size_t capacity() const { return shard_capacity_ * shard_count_; }
+
+    Stats get_stats() const;
+
+private:
+    struct Block {
+        uint64_t lba;
+        uint32_t compressed_size;
+        bool live;
+        bool referenced;
+        bool read_ahead;                // not hit since read-ahead added it
+        std::vector<uint8_t> data;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> index;   // lba -> block slot
+        std::vector<Block> blocks;
+        std::vector<uint32_t> free_slots;
+        size_t hand = 0;
+        size_t bytes = 0;
+        Stats counters{};
+    };
+
+    Shard& shard_for(uint64_t lba) const;
+    // Both with the shard's lock held
+    void make_room(Shard& shard, size_t size);
+    void drop(Shard& shard, uint32_t slot);
+
+    size_t shard_count_;
+    size_t shard_capacity_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<uint64_t> generation_{0};
+};
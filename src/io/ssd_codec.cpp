@@ -0,0 +1,711 @@
+#include "ssd_codec.h"
+#include "../core/scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr uint8_t CHUNK_STORED = 0;
+constexpr uint8_t CHUNK_LZ = 1;
+constexpr size_t CHUNK_HEADER_SIZE = 10;     // type, literal mode, literal count, literal bytes
+
+constexpr uint8_t LITERALS_RAW = 0;
+constexpr uint8_t LITERALS_RLE = 1;
+constexpr uint8_t LITERALS_HUFFMAN = 2;
+
+constexpr size_t MIN_MATCH = 4;
+constexpr int HASH_BITS = 15;
+constexpr int MAX_CHAIN = 32;
+
+constexpr int MAX_CODE_BITS = 11;
+constexpr size_t HUFFMAN_STREAMS = 4;
+constexpr size_t HUFFMAN_HEADER_SIZE = 128 + 2 * (HUFFMAN_STREAMS - 1);
+constexpr size_t MIN_HUFFMAN_LITERALS = 64;
+
+// Room the wide copies may overrun by
+constexpr size_t COPY_SLACK = 32;
+
+uint16_t load16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, 2);
+    return v;
+}
+
+uint32_t load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+void store16(uint8_t* p, uint16_t v) { std::memcpy(p, &v, 2); }
+void store32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, 4); }
+void store64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, 8); }
+
+unsigned trailing_zero_bytes(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return index / 8;
+#else
+    return __builtin_ctzll(x) / 8;
+#endif
+}
+
+uint32_t hash4(const uint8_t* p) {
+    return (load32(p) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+size_t match_length(const uint8_t* a, const uint8_t* b, const uint8_t* end) {
+    const uint8_t* start = a;
+    while (end - a >= 8) {
+        uint64_t diff = load64(a) ^ load64(b);
+        if (diff) return (a - start) + trailing_zero_bytes(diff);
+        a += 8;
+        b += 8;
+    }
+    while (a < end && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return a - start;
+}
+
+// ---- Huffman ----
+
+// Code lengths for the symbols with nonzero counts, at most MAX_CODE_BITS.
+// Counts are halved until the plain Huffman tree is shallow enough, which
+// costs little for 256 symbols.
+void huffman_lengths(const uint32_t counts[256], uint8_t lengths[256]) {
+    uint32_t weights[256];
+    std::copy(counts, counts + 256, weights);
+    for (;;) {
+        int symbols[256];
+        int leaves = 0;
+        for (int s = 0; s < 256; ++s) {
+            if (weights[s]) symbols[leaves++] = s;
+        }
+        std::stable_sort(symbols, symbols + leaves, [&](int a, int b) { return weights[a] < weights[b]; });
+
+        // Two-queue construction: leaves in weight order, then internal
+        // nodes, which are created in weight order too
+        uint64_t weight[511];
+        int parent[511];
+        for (int i = 0; i < leaves; ++i) weight[i] = weights[symbols[i]];
+        int leaf = 0, inner = leaves, next = leaves;
+        auto take = [&]() {
+            if (leaf < leaves && (inner >= next || weight[leaf] <= weight[inner])) return leaf++;
+            return inner++;
+        };
+        for (int k = 0; k < leaves - 1; ++k) {
+            int a = take();
+            int b = take();
+            weight[next] = weight[a] + weight[b];
+            parent[a] = parent[b] = next;
+            ++next;
+        }
+        int depth[511];
+        depth[next - 1] = 0;
+        int deepest = 0;
+        for (int i = next - 2; i >= 0; --i) {
+            depth[i] = depth[parent[i]] + 1;
+            deepest = std::max(deepest, depth[i]);
+        }
+        if (deepest <= MAX_CODE_BITS) {
+            std::fill(lengths, lengths + 256, 0);
+            for (int i = 0; i < leaves; ++i) lengths[symbols[i]] = static_cast<uint8_t>(depth[i]);
+            return;
+        }
+        for (uint32_t& w : weights) {
+            if (w) w = (w >> 1) | 1;
+        }
+    }
+}
+
+// Canonical codes, bit-reversed so the decoder can index its table with the
+// low bits of an LSB-first bit buffer
+void huffman_codes(const uint8_t lengths[256], uint16_t codes[256]) {
+    uint16_t count[MAX_CODE_BITS + 1] = {};
+    for (int s = 0; s < 256; ++s) count[lengths[s]]++;
+    count[0] = 0;
+    uint16_t next[MAX_CODE_BITS + 1] = {};
+    uint16_t code = 0;
+    for (int len = 1; len <= MAX_CODE_BITS; ++len) {
+        code = static_cast<uint16_t>((code + count[len - 1]) << 1);
+        next[len] = code;
+    }
+    for (int s = 0; s < 256; ++s) {
+        int len = lengths[s];
+        if (!len) continue;
+        uint16_t c = next[len]++;
+        uint16_t reversed = 0;
+        for (int b = 0; b < len; ++b) reversed |= ((c >> b) & 1) << (len - 1 - b);
+        codes[s] = reversed;
+    }
+}
+
+// Decode table: low bits of the buffer -> length | symbol << 8. The length
+// sits in the low bits so the shift can take the entry as it is. False for
+// a code that is not complete, so every table entry is filled.
+bool huffman_table(const uint8_t lengths[256], uint16_t table[1 << MAX_CODE_BITS]) {
+    uint32_t kraft = 0;
+    for (int s = 0; s < 256; ++s) {
+        if (lengths[s] > MAX_CODE_BITS) return false;
+        if (lengths[s]) kraft += 1u << (MAX_CODE_BITS - lengths[s]);
+    }
+    if (kraft != (1u << MAX_CODE_BITS)) return false;
+
+    uint16_t codes[256];
+    huffman_codes(lengths, codes);
+    for (int s = 0; s < 256; ++s) {
+        int len = lengths[s];
+        if (!len) continue;
+        uint16_t entry = static_cast<uint16_t>(len | (s << 8));
+        for (uint32_t fill = codes[s]; fill < (1u << MAX_CODE_BITS); fill += 1u << len) {
+            table[fill] = entry;
+        }
+    }
+    return true;
+}
+
+struct BitWriter {
+    uint8_t* p;
+    uint64_t bits = 0;
+    unsigned count = 0;
+
+    void put(uint32_t code, unsigned length) {
+        bits |= static_cast<uint64_t>(code) << count;
+        count += length;
+        if (count >= 32) {
+            store32(p, static_cast<uint32_t>(bits));
+            p += 4;
+            bits >>= 32;
+            count -= 32;
+        }
+    }
+
+    void flush() {
+        while (count > 0) {
+            *p++ = static_cast<uint8_t>(bits);
+            bits >>= 8;
+            count = count > 8 ? count - 8 : 0;
+        }
+    }
+};
+
+// LSB-first reader. Refills top the buffer up to at least 56 bits; reads
+// may run past the stream into whatever follows it up to `limit`, and past
+// `limit` feed zeros, which only a corrupt stream ever consumes.
+struct BitReader {
+    const uint8_t* p;
+    const uint8_t* start;
+    const uint8_t* end;
+    const uint8_t* limit;
+    uint64_t bits = 0;
+    unsigned count = 0;
+    size_t padding = 0;
+
+    BitReader(const uint8_t* begin, const uint8_t* stream_end, const uint8_t* readable_end)
+        : p(begin), start(begin), end(stream_end), limit(readable_end) {}
+
+    // Needs 8 readable bytes at p
+    void refill_fast() {
+        bits |= load64(p) << count;
+        p += (63 - count) >> 3;
+        count |= 56;
+    }
+
+    void refill() {
+        if (limit - p >= 8) {
+            refill_fast();
+        } else {
+            while (count < 56) {
+                if (p < limit) {
+                    bits |= static_cast<uint64_t>(*p++) << count;
+                } else {
+                    ++padding;
+                }
+                count += 8;
+            }
+        }
+    }
+
+    uint8_t decode(const uint16_t* table) {
+        unsigned entry = table[bits & ((1u << MAX_CODE_BITS) - 1)];
+        bits >>= entry & 63;
+        count -= entry & 63;
+        return static_cast<uint8_t>(entry >> 8);
+    }
+
+    bool overrun() const {
+        size_t consumed = (static_cast<size_t>(p - start) + padding) * 8 - count;
+        return consumed > static_cast<size_t>(end - start) * 8;
+    }
+};
+
+size_t stream_literals(size_t count, size_t stream) {
+    size_t per_stream = (count + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    size_t first = std::min(count, stream * per_stream);
+    return std::min(per_stream, count - first);
+}
+
+inline void decode5(BitReader& r, const uint16_t* table, uint8_t* output) {
+    output[0] = r.decode(table);
+    output[1] = r.decode(table);
+    output[2] = r.decode(table);
+    output[3] = r.decode(table);
+    output[4] = r.decode(table);
+}
+
+// Decodes symbols [from, count) of one stream one at a time. Takes the
+// reader by value so the interleaved loop's readers never have their
+// address taken and stay in registers.
+bool finish_stream(BitReader r, const uint16_t* table, uint8_t* output, size_t from, size_t count) {
+    for (size_t j = from; j < count; ++j) {
+        if (r.count < MAX_CODE_BITS) r.refill();
+        output[j] = r.decode(table);
+    }
+    return !r.overrun();
+}
+
+bool decode_huffman(const uint8_t* input, size_t size, const uint8_t* limit, uint8_t* output, size_t count) {
+    if (size < HUFFMAN_HEADER_SIZE) return false;
+    uint8_t lengths[256];
+    for (int i = 0; i < 128; ++i) {
+        lengths[2 * i] = input[i] & 15;
+        lengths[2 * i + 1] = input[i] >> 4;
+    }
+    uint16_t table[1 << MAX_CODE_BITS];
+    if (!huffman_table(lengths, table)) return false;
+
+    const uint8_t* stream = input + HUFFMAN_HEADER_SIZE;
+    const uint8_t* input_end = input + size;
+    size_t stream_sizes[HUFFMAN_STREAMS];
+    size_t total = 0;
+    for (size_t k = 0; k + 1 < HUFFMAN_STREAMS; ++k) {
+        stream_sizes[k] = load16(input + 128 + 2 * k);
+        total += stream_sizes[k];
+    }
+    if (total > static_cast<size_t>(input_end - stream)) return false;
+    stream_sizes[HUFFMAN_STREAMS - 1] = (input_end - stream) - total;
+
+    const size_t per_stream = (count + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    BitReader r0(stream, stream + stream_sizes[0], limit);
+    stream += stream_sizes[0];
+    BitReader r1(stream, stream + stream_sizes[1], limit);
+    stream += stream_sizes[1];
+    BitReader r2(stream, stream + stream_sizes[2], limit);
+    stream += stream_sizes[2];
+    BitReader r3(stream, stream + stream_sizes[3], limit);
+    uint8_t* const o0 = output;
+    uint8_t* const o1 = output + per_stream;
+    uint8_t* const o2 = output + 2 * per_stream;
+    uint8_t* const o3 = output + 3 * per_stream;
+
+    // Five 11-bit codes fit in the 56 bits a refill guarantees, so each
+    // round refills all four readers and takes five symbols from each. In a
+    // valid stream the last reader is the furthest along, but a corrupt one
+    // can run any reader ahead, so the bound checks all of them.
+    const size_t common = stream_literals(count, HUFFMAN_STREAMS - 1);
+    size_t i = 0;
+    for (; i + 5 <= common && limit - std::max(std::max(r0.p, r1.p), std::max(r2.p, r3.p)) >= 8; i += 5) {
+        r0.refill_fast();
+        r1.refill_fast();
+        r2.refill_fast();
+        r3.refill_fast();
+        decode5(r0, table, o0 + i);
+        decode5(r1, table, o1 + i);
+        decode5(r2, table, o2 + i);
+        decode5(r3, table, o3 + i);
+    }
+    return finish_stream(r0, table, o0, i, stream_literals(count, 0)) &&
+           finish_stream(r1, table, o1, i, stream_literals(count, 1)) &&
+           finish_stream(r2, table, o2, i, stream_literals(count, 2)) &&
+           finish_stream(r3, table, o3, i, stream_literals(count, 3));
+}
+
+// ---- Sequence decoding ----
+
+bool read_length(const uint8_t*& p, const uint8_t* end, size_t& length) {
+    for (;;) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        length += b;
+        if (b != 255) return true;
+        if (length > SSDCodec::CHUNK_SIZE) return false;
+    }
+}
+
+// Copies `n` bytes 32 at a time; may write up to 31 bytes past dst + n and
+// read as far past src + n. Each 16-byte step only reads bytes already in
+// place when src trails dst by at least 16.
+inline void wide_copy(uint8_t* dst, const uint8_t* src, size_t n) {
+    uint8_t* const end = dst + n;
+    do {
+        std::memcpy(dst, src, 16);
+        std::memcpy(dst + 16, src + 16, 16);
+        dst += 32;
+        src += 32;
+    } while (dst < end);
+}
+
+// Matches closer than 16 bytes. From 8 bytes away each 8-byte step reads
+// only bytes already in place. Closer still, the match repeats a short
+// pattern: lay down its first repeat of at least 8 bytes one byte at a time,
+// then copy that whole repeat forward 8 bytes at a time. Writes up to 15
+// bytes past op + length.
+inline void near_copy(uint8_t* op, size_t offset, size_t length) {
+    if (offset >= 8) {
+        // Most matches are short; copying 16 bytes blind saves a branch on
+        // the length that would mispredict half the time
+        std::memcpy(op, op - offset, 8);
+        std::memcpy(op + 8, op + 8 - offset, 8);
+        for (size_t i = 16; i < length; i += 8) std::memcpy(op + i, op + i - offset, 8);
+        return;
+    }
+    if (offset == 1) {
+        std::memset(op, op[-1], length);
+        return;
+    }
+    const size_t stride = offset * ((8 + offset - 1) / offset);
+    for (size_t i = 0; i < stride; ++i) op[i] = op[i - offset];
+    for (size_t i = stride; i < length; i += 8) std::memcpy(op + i, op + i - stride, 8);
+}
+
+} // namespace
+
+// ---- SSDCodec ----
+
+SSDCodec::SSDCodec()
+    : head_(size_t(1) << HASH_BITS),
+      chain_(CHUNK_SIZE),
+      scratch_(2 * CHUNK_SIZE + 1024) {
+    literals_.reserve(CHUNK_SIZE);
+    sequences_.reserve(CHUNK_SIZE / MIN_MATCH + 1);
+}
+
+SSDCodec::~SSDCodec() = default;
+
+size_t SSDCodec::compress_bound(size_t size) {
+    size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    return FRAME_HEADER_SIZE + chunks * 4 + chunks + size;
+}
+
+void SSDCodec::parse(const uint8_t* input, size_t size) {
+    std::fill(head_.begin(), head_.end(), 0);
+    literals_.clear();
+    sequences_.clear();
+
+    const uint8_t* const end = input + size;
+    size_t indexed = 0;     // positions below this are in the chains
+    auto index_to = [&](size_t pos) {
+        for (; indexed < pos && indexed + MIN_MATCH <= size; ++indexed) {
+            uint32_t h = hash4(input + indexed);
+            chain_[indexed] = head_[h];
+            head_[h] = static_cast<uint32_t>(indexed + 1);
+        }
+        indexed = std::max(indexed, pos);
+    };
+    auto find = [&](size_t pos, size_t& offset) {
+        index_to(pos);
+        size_t best = 0;
+        uint32_t candidate = head_[hash4(input + pos)];
+        for (int depth = 0; candidate && depth < MAX_CHAIN; ++depth) {
+            const size_t from = candidate - 1;
+            candidate = chain_[from];
+            // One byte past the best so far must match to do any better
+            if (pos + best < size && input[from + best] != input[pos + best]) continue;
+            size_t length = match_length(input + pos, input + from, end);
+            if (length > best) {
+                best = length;
+                offset = pos - from;
+                if (pos + best == size) break;
+            }
+        }
+        return best;
+    };
+
+    size_t pos = 0, anchor = 0;
+    while (pos + MIN_MATCH <= size) {
+        size_t offset = 0;
+        size_t length = find(pos, offset);
+        if (length < MIN_MATCH) {
+            ++pos;
+            continue;
+        }
+        // Lazy matching: take a literal if the next position matches longer
+        while (pos + 1 + MIN_MATCH <= size) {
+            size_t next_offset = 0;
+            size_t next_length = find(pos + 1, next_offset);
+            if (next_length <= length) break;
+            ++pos;
+            length = next_length;
+            offset = next_offset;
+        }
+        literals_.insert(literals_.end(), input + anchor, input + pos);
+        sequences_.push_back({static_cast<uint32_t>(pos - anchor), static_cast<uint32_t>(length),
+                              static_cast<uint32_t>(offset)});
+        pos += length;
+        anchor = pos;
+    }
+    literals_.insert(literals_.end(), input + anchor, end);
+    sequences_.push_back({static_cast<uint32_t>(size - anchor), 0, 0});
+}
+
+size_t SSDCodec::encode_literals(uint8_t* output, uint8_t& mode) {
+    const size_t count = literals_.size();
+    uint32_t counts[256] = {};
+    for (uint8_t b : literals_) counts[b]++;
+
+    if (count > 0 && counts[literals_[0]] == count) {
+        mode = LITERALS_RLE;
+        output[0] = literals_[0];
+        return 1;
+    }
+
+    mode = LITERALS_RAW;
+    if (count >= MIN_HUFFMAN_LITERALS) {
+        uint8_t lengths[256];
+        huffman_lengths(counts, lengths);
+        uint64_t bits = 0;
+        for (int s = 0; s < 256; ++s) bits += static_cast<uint64_t>(counts[s]) * lengths[s];
+        // Raw literals decode faster, so Huffman has to save over 3%
+        size_t estimate = HUFFMAN_HEADER_SIZE + static_cast<size_t>(bits / 8) + HUFFMAN_STREAMS;
+        if (estimate + count / 32 < count) {
+            uint16_t codes[256];
+            huffman_codes(lengths, codes);
+            for (int i = 0; i < 128; ++i) {
+                output[i] = static_cast<uint8_t>(lengths[2 * i] | (lengths[2 * i + 1] << 4));
+            }
+            uint8_t* p = output + HUFFMAN_HEADER_SIZE;
+            const size_t per_stream = (count + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+            for (size_t k = 0; k < HUFFMAN_STREAMS; ++k) {
+                BitWriter writer{p};
+                const uint8_t* symbols = literals_.data() + std::min(count, k * per_stream);
+                for (size_t j = 0, n = stream_literals(count, k); j < n; ++j) {
+                    writer.put(codes[symbols[j]], lengths[symbols[j]]);
+                }
+                writer.flush();
+                // At most 16384 literals of 11 bits, so this fits
+                if (k + 1 < HUFFMAN_STREAMS) store16(output + 128 + 2 * k, static_cast<uint16_t>(writer.p - p));
+                p = writer.p;
+            }
+            mode = LITERALS_HUFFMAN;
+            return p - output;
+        }
+    }
+    std::memcpy(output, literals_.data(), count);
+    return count;
+}
+
+size_t SSDCodec::compress_chunk(const uint8_t* input, size_t size, uint8_t* output) {
+    if (size >= MIN_MATCH) {
+        parse(input, size);
+
+        uint8_t* const chunk = scratch_.data();
+        uint8_t mode;
+        size_t literal_bytes = encode_literals(chunk + CHUNK_HEADER_SIZE, mode);
+        chunk[0] = CHUNK_LZ;
+        chunk[1] = mode;
+        store32(chunk + 2, static_cast<uint32_t>(literals_.size()));
+        store32(chunk + 6, static_cast<uint32_t>(literal_bytes));
+
+        uint8_t* p = chunk + CHUNK_HEADER_SIZE + literal_bytes;
+        auto put_length = [&](size_t length) {
+            for (; length >= 255; length -= 255) *p++ = 255;
+            *p++ = static_cast<uint8_t>(length);
+        };
+        for (const Sequence& s : sequences_) {
+            const size_t match = s.match ? s.match - MIN_MATCH : 0;
+            *p++ = static_cast<uint8_t>((std::min<size_t>(s.literals, 15) << 4) | std::min<size_t>(match, 15));
+            if (s.literals >= 15) put_length(s.literals - 15);
+            if (!s.match) break;
+            store16(p, static_cast<uint16_t>(s.offset));
+            p += 2;
+            if (match >= 15) put_length(match - 15);
+        }
+
+        const size_t compressed = p - chunk;
+        if (compressed < chunk_bound(size)) {
+            std::memcpy(output, chunk, compressed);
+            return compressed;
+        }
+    }
+    output[0] = CHUNK_STORED;
+    std::memcpy(output + 1, input, size);
+    return size + 1;
+}
+
+void SSDCodec::compress(const uint8_t* input, size_t size, std::vector<uint8_t>& output) {
+    output.resize(compress_bound(size));
+    uint8_t* out = output.data();
+    store32(out, MAGIC);
+    store64(out + 4, size);
+    uint8_t* table = out + FRAME_HEADER_SIZE;
+    size_t pos = FRAME_HEADER_SIZE + (size + CHUNK_SIZE - 1) / CHUNK_SIZE * 4;
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t n = std::min(CHUNK_SIZE, size - offset);
+        size_t compressed = compress_chunk(input + offset, n, out + pos);
+        store32(table, static_cast<uint32_t>(compressed));
+        table += 4;
+        pos += compressed;
+    }
+    output.resize(pos);
+}
+
+bool SSDCodec::frame_size(const uint8_t* input, size_t size, uint64_t& raw_size) {
+    if (size < FRAME_HEADER_SIZE || load32(input) != MAGIC) return false;
+    raw_size = load64(input + 4);
+    return true;
+}
+
+bool SSDCodec::frame_bytes(const uint8_t* input, size_t size, uint64_t& length) {
+    uint64_t raw_size;
+    if (!frame_size(input, size, raw_size)) return false;
+    const uint64_t chunks = (raw_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if ((size - FRAME_HEADER_SIZE) / 4 < chunks) return false;
+    length = FRAME_HEADER_SIZE + chunks * 4;
+    for (uint64_t c = 0; c < chunks; ++c) length += load32(input + FRAME_HEADER_SIZE + 4 * c);
+    return true;
+}
+
+bool SSDCodec::decompress(const uint8_t* input, size_t size, uint8_t* output, size_t output_size,
+                          Scheduler* scheduler) {
+    uint64_t raw_size;
+    if (!frame_size(input, size, raw_size) || raw_size != output_size) return false;
+    const size_t chunks = (output_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if ((size - FRAME_HEADER_SIZE) / 4 < chunks) return false;
+    const uint8_t* const table = input + FRAME_HEADER_SIZE;
+    size_t pos = FRAME_HEADER_SIZE + chunks * 4;
+
+    if (output_size >= PARALLEL_THRESHOLD && scheduler && scheduler->is_running()) {
+        std::vector<size_t> starts(chunks + 1);
+        starts[0] = pos;
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t compressed = load32(table + 4 * c);
+            if (compressed > size - starts[c]) return false;
+            starts[c + 1] = starts[c] + compressed;
+        }
+        if (starts[chunks] != size) return false;
+
+        // A failed chunk fails the frame, so the rest need not be decoded
+        std::atomic<bool> ok{true};
+        scheduler->parallel_for(chunks, [&](size_t c) {
+            if (!ok.load(std::memory_order_relaxed)) return;
+            size_t offset = c * CHUNK_SIZE;
+            if (!decompress_chunk(input + starts[c], starts[c + 1] - starts[c], output + offset,
+                                  std::min(CHUNK_SIZE, output_size - offset))) {
+                ok.store(false, std::memory_order_relaxed);
+            }
+        });
+        return ok.load();
+    }
+
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t compressed = load32(table + 4 * c);
+        if (compressed > size - pos) return false;
+        size_t offset = c * CHUNK_SIZE;
+        if (!decompress_chunk(input + pos, compressed, output + offset, std::min(CHUNK_SIZE, output_size - offset))) {
+            return false;
+        }
+        pos += compressed;
+    }
+    return pos == size;
+}
+
+bool SSDCodec::decompress_chunk(const uint8_t* input, size_t size, uint8_t* output, size_t raw_size) {
+    if (size < 1 || raw_size > CHUNK_SIZE) return false;
+    if (input[0] == CHUNK_STORED) {
+        if (size != raw_size + 1) return false;
+        std::memcpy(output, input + 1, raw_size);
+        return true;
+    }
+    if (input[0] != CHUNK_LZ || size < CHUNK_HEADER_SIZE) return false;
+
+    const uint8_t* const input_end = input + size;
+    const uint8_t mode = input[1];
+    const size_t literal_count = load32(input + 2);
+    const size_t literal_bytes = load32(input + 6);
+    if (literal_count > raw_size || literal_bytes > size - CHUNK_HEADER_SIZE) return false;
+    const uint8_t* const literal_section = input + CHUNK_HEADER_SIZE;
+
+    // Literals are read from the input when stored raw, else expanded here
+    alignas(16) uint8_t expanded[CHUNK_SIZE + COPY_SLACK];
+    const uint8_t* lit;
+    const uint8_t* lit_limit;
+    if (mode == LITERALS_RAW) {
+        if (literal_bytes != literal_count) return false;
+        lit = literal_section;
+        lit_limit = input_end;
+    } else if (mode == LITERALS_RLE) {
+        if (literal_bytes != 1) return false;
+        std::memset(expanded, literal_section[0], literal_count);
+        lit = expanded;
+        lit_limit = expanded + sizeof(expanded);
+    } else if (mode == LITERALS_HUFFMAN) {
+        if (!decode_huffman(literal_section, literal_bytes, input_end, expanded, literal_count)) return false;
+        lit = expanded;
+        lit_limit = expanded + sizeof(expanded);
+    } else {
+        return false;
+    }
+    const uint8_t* const lit_end = lit + literal_count;
+
+    const uint8_t* sp = literal_section + literal_bytes;
+    uint8_t* op = output;
+    uint8_t* const oend = output + raw_size;
+    for (;;) {
+        if (sp >= input_end) return false;
+        const unsigned token = *sp++;
+
+        size_t run = token >> 4;
+        if (run == 15 && !read_length(sp, input_end, run)) return false;
+        if (run > static_cast<size_t>(lit_end - lit) || run > static_cast<size_t>(oend - op)) return false;
+        if (run <= 16 && lit_limit - lit >= 16 && oend - op >= 16) {
+            std::memcpy(op, lit, 16);
+        } else if (static_cast<size_t>(lit_limit - lit) >= run + COPY_SLACK &&
+                   static_cast<size_t>(oend - op) >= run + COPY_SLACK) {
+            wide_copy(op, lit, run);
+        } else {
+            std::memcpy(op, lit, run);
+        }
+        op += run;
+        lit += run;
+
+        if (sp == input_end) {
+            // The trailing run of literals carries no match
+            return (token & 15) == 0 && op == oend && lit == lit_end;
+        }
+        if (input_end - sp < 2) return false;
+        const size_t offset = load16(sp);
+        sp += 2;
+        size_t length = token & 15;
+        if (length == 15 && !read_length(sp, input_end, length)) return false;
+        length += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - output) || length > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+
+        if (static_cast<size_t>(oend - op) >= length + COPY_SLACK) {
+            if (offset >= 16) {
+                wide_copy(op, op - offset, length);
+            } else {
+                near_copy(op, offset, length);
+            }
+        } else {
+            const uint8_t* match = op - offset;
+            for (size_t i = 0; i < length; ++i) op[i] = match[i];
+        }
+        op += length;
+    }
+}
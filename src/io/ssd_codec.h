@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Scheduler;
+
+// LZ77 + Huffman codec for SSD payloads, in independent 64 KiB chunks
+// A frame is a 12-byte header (magic, raw size), a table of 32-bit
+// compressed sizes with one entry per chunk, then the chunks back to back.
+// The table locates every chunk before any is decoded, so large frames are
+// decoded in parallel. A chunk is either stored or an LZ parse split into
+// two sections:
+//  - literals: raw, a single repeated byte, or Huffman coded (code lengths
+//    up to 11 bits, four interleaved streams so the decoder keeps four
+//    independent bit buffers busy);
+//  - sequences: LZ4-style tokens of literal run and match length nibbles,
+//    255-run length extensions and 16-bit match offsets.
+// Matches never reach outside their chunk, so any chunk decodes on its own.
+// The decoder writes straight into the caller's buffer and expands matches
+// and literal runs with wide copies that may overrun (32 bytes a step, 8 or
+// 16 for matches closer than that), falling back to exact copies only
+// within 32 bytes of the end of the output. Every length and
+// offset is checked against the buffers, so corrupt input fails cleanly.
+class SSDCodec {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr uint32_t MAGIC = 0x315A5350;   // "PSZ1"
+    static constexpr size_t FRAME_HEADER_SIZE = 12;
+    // Frames at or above this raw size are split across scheduler workers;
+    // smaller ones decode on the calling thread without any handoff
+    static constexpr size_t PARALLEL_THRESHOLD = 256 * 1024;
+
+    SSDCodec();
+    ~SSDCodec();
+
+    SSDCodec(const SSDCodec&) = delete;
+    SSDCodec& operator=(const SSDCodec&) = delete;
+
+    // Worst-case compressed size of `size` raw bytes, framed or as a chunk
+    static size_t compress_bound(size_t size);
+    static size_t chunk_bound(size_t size) { return size + 1; }
+
+    // Replaces `output` with the framed stream
+    void compress(const uint8_t* input, size_t size, std::vector<uint8_t>& output);
+    // One chunk of at most CHUNK_SIZE bytes; `output` holds chunk_bound(size).
+    // Returns the compressed size.
+    size_t compress_chunk(const uint8_t* input, size_t size, uint8_t* output);
+
+    // Raw size recorded in a frame header, or false if it is not one
+    static bool frame_size(const uint8_t* input, size_t size, uint64_t& raw_size);
+    // Total length of the frame starting at `input`, summed from its chunk
+    // table; false unless the header and table lie within `size` bytes
+    static bool frame_bytes(const uint8_t* input, size_t size, uint64_t& length);
+    // Decodes a whole frame into exactly `output_size` bytes. With a running
+    // scheduler, large frames decode one chunk per work item and this returns
+    // once the last chunk is done.
+    static bool decompress(const uint8_t* input, size_t size, uint8_t* output, size_t output_size,
+                           Scheduler* scheduler = nullptr);
+    // Decodes one chunk into exactly `raw_size` bytes
+    static bool decompress_chunk(const uint8_t* input, size_t size, uint8_t* output, size_t raw_size);
+
+private:
+    struct Sequence {
+        uint32_t literals;
+        uint32_t match;     // 0 for the trailing literal run
+        uint32_t offset;
+    };
+
+    void parse(const uint8_t* input, size_t size);
+    size_t encode_literals(uint8_t* output, uint8_t& mode);
+
+    std::vector<uint32_t> head_;        // hash -> last position + 1
+    std::vector<uint32_t> chain_;       // position -> previous position + 1
+    std::vector<uint8_t> literals_;
+    std::vector<Sequence> sequences_;
+    std::vector<uint8_t> scratch_;
+};
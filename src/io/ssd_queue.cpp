@@ -0,0 +1,466 @@
+#include "ssd_queue.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define PSX5_SSD_IO_URING 1
+#endif
+
+// ---- SSDSlotRing ----
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+SSDSlotRing::SSDSlotRing(size_t capacity)
+    : mask_(round_up_pow2(std::max<size_t>(capacity, 2)) - 1),
+      cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool SSDSlotRing::push(uint32_t slot) {
+    uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells_[pos & mask_];
+        uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.slot = slot;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool SSDSlotRing::pop(uint32_t& slot) {
+    uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells_[pos & mask_];
+        uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot = cell.slot;
+                cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// ---- io_uring ----
+
+#ifdef PSX5_SSD_IO_URING
+
+// A raw io_uring instance: the kernel headers and two syscalls, no liburing
+struct SSDQueue::Uring {
+    int fd = -1;
+    void* sq_map = MAP_FAILED;
+    size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    bool setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return false;
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_map) sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) return false;
+        if (single_map) {
+            cq_map = sq_map;
+        } else {
+            cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                          IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) return false;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sq_map);
+        char* cq = static_cast<char*>(cq_map);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    ~Uring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_map != MAP_FAILED && cq_map != sq_map) munmap(cq_map, cq_map_size);
+        if (sq_map != MAP_FAILED) munmap(sq_map, sq_map_size);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // Only the backend thread touches the SQ tail, so a plain read is current
+    void push(int file, const Slot& slot, uint32_t index) {
+        unsigned tail = *sq_tail;
+        unsigned i = tail & sq_mask;
+        io_uring_sqe& sqe = sqes[i];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = slot.is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<uint64_t>(&slot.rest);
+        sqe.len = 1;
+        sqe.off = slot.offset + slot.done;
+        sqe.user_data = index;
+        sq_array[i] = i;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete) {
+        unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+        for (;;) {
+            long r = syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+            if (r >= 0 || errno != EINTR) return static_cast<int>(r);
+        }
+    }
+};
+
+#else
+
+struct SSDQueue::Uring {};
+
+#endif
+
+// ---- SSDQueue ----
+
+SSDQueue::SSDQueue() = default;
+
+SSDQueue::~SSDQueue() {
+    close();
+}
+
+bool SSDQueue::open(const std::string& path, const Config& config) {
+    close();
+    config_ = config;
+    config_.queue_depth = std::max(1u, config_.queue_depth);
+    config_.max_requests = std::max<size_t>(config_.max_requests, config_.queue_depth);
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (config_.create ? O_CREAT : 0), 0644);
+    if (fd_ < 0) return false;
+
+    slots_.assign(config_.max_requests, Slot{});
+    free_slots_.clear();
+    for (size_t i = slots_.size(); i-- > 0;) free_slots_.push_back(static_cast<uint32_t>(i));
+    for (auto& ring : submit_rings_) ring = std::make_unique<SSDSlotRing>(slots_.size());
+    complete_ring_ = std::make_unique<SSDSlotRing>(slots_.size());
+
+    backend_ = Backend::ThreadPool;
+#ifdef PSX5_SSD_IO_URING
+    if (config_.backend != Backend::ThreadPool) {
+        // queue_depth bounds what is in flight, so the SQ never overflows
+        // and the default CQ of twice that never drops a completion
+        auto ring = std::make_unique<Uring>();
+        if (ring->setup(config_.queue_depth)) {
+            uring_ = std::move(ring);
+            backend_ = Backend::IoUring;
+        }
+    }
+#endif
+    if (config_.backend == Backend::IoUring && backend_ != Backend::IoUring) {
+        close();
+        return false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    if (backend_ == Backend::IoUring) {
+        workers_.emplace_back(&SSDQueue::uring_loop, this);
+    } else {
+        int threads = static_cast<int>(std::min<uint32_t>(config_.queue_depth, std::max(1, config_.threads)));
+        for (int i = 0; i < threads; ++i) workers_.emplace_back(&SSDQueue::pool_loop, this);
+    }
+    return true;
+}
+
+void SSDQueue::close() {
+    if (!workers_.empty()) {
+        drain();
+        running_.store(false, std::memory_order_release);
+        work_signal_.fetch_add(1, std::memory_order_seq_cst);
+        work_signal_.notify_all();
+        for (auto& worker : workers_) worker.join();
+        workers_.clear();
+    }
+    uring_.reset();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    slots_.clear();
+    free_slots_.clear();
+}
+
+bool SSDQueue::submit_read(uint64_t lba, uint32_t sectors, void* buffer, Callback callback, SSDPriority priority) {
+    return submit(lba, sectors, buffer, false, std::move(callback), priority);
+}
+
+bool SSDQueue::submit_write(uint64_t lba, uint32_t sectors, const void* buffer, Callback callback,
+                            SSDPriority priority) {
+    // The slot's iovec is shared with reads; writes never store through it
+    return submit(lba, sectors, const_cast<void*>(buffer), true, std::move(callback), priority);
+}
+
+bool SSDQueue::submit(uint64_t lba, uint32_t sectors, void* buffer, bool is_write, Callback callback,
+                      SSDPriority priority) {
+    if (!is_open() || free_slots_.empty()) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint32_t index = free_slots_.back();
+    free_slots_.pop_back();
+
+    Slot& slot = slots_[index];
+    slot.offset = lba * SECTOR_SIZE;
+    slot.io.iov_base = buffer;
+    slot.io.iov_len = static_cast<size_t>(sectors) * SECTOR_SIZE;
+    slot.rest = slot.io;
+    slot.done = 0;
+    slot.is_write = is_write;
+    slot.ok = false;
+    slot.callback = std::move(callback);
+
+    // Rings hold as many entries as there are slots, so this cannot fail
+    submit_rings_[static_cast<int>(priority)]->push(index);
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    // Paired with wait_for_work: either a worker sees the new signal before
+    // sleeping, or this sees it waiting
+    work_signal_.fetch_add(1, std::memory_order_seq_cst);
+    if (work_waiters_.load(std::memory_order_seq_cst) != 0) {
+        work_signal_.notify_one();
+    }
+    return true;
+}
+
+size_t SSDQueue::poll() {
+    if (!complete_ring_) return 0;
+    size_t count = 0;
+    uint32_t index;
+    while (complete_ring_->pop(index)) {
+        Slot& slot = slots_[index];
+        Callback callback = std::move(slot.callback);
+        slot.callback = nullptr;
+        bool ok = slot.ok;
+        (ok ? completed_ : failed_).fetch_add(1, std::memory_order_relaxed);
+        // Free the slot first so the callback may submit follow-up requests
+        free_slots_.push_back(index);
+        if (callback) callback(ok);
+        ++count;
+    }
+    return count;
+}
+
+void SSDQueue::drain() {
+    while (pending() > 0) {
+        uint32_t seen = done_signal_.load(std::memory_order_seq_cst);
+        if (poll() > 0) continue;
+        owner_waiting_.store(true, std::memory_order_seq_cst);
+        if (done_signal_.load(std::memory_order_seq_cst) == seen) {
+            done_signal_.wait(seen, std::memory_order_acquire);
+        }
+        owner_waiting_.store(false, std::memory_order_relaxed);
+    }
+}
+
+SSDQueue::Stats SSDQueue::get_stats() const {
+    Stats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.max_in_flight = max_in_flight_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool SSDQueue::take(uint32_t& index) {
+    // Reserve the in-flight place first so queue_depth holds across workers
+    uint32_t before = in_flight_.fetch_add(1, std::memory_order_acq_rel);
+    if (before < config_.queue_depth) {
+        for (auto& ring : submit_rings_) {
+            if (ring->pop(index)) {
+                uint32_t seen = max_in_flight_.load(std::memory_order_relaxed);
+                while (before + 1 > seen &&
+                       !max_in_flight_.compare_exchange_weak(seen, before + 1, std::memory_order_relaxed)) {
+                }
+                return true;
+            }
+        }
+    }
+    in_flight_.fetch_sub(1, std::memory_order_acq_rel);
+    return false;
+}
+
+void SSDQueue::finish(uint32_t index, int64_t result) {
+    Slot& slot = slots_[index];
+    const size_t bytes = slot.io.iov_len;
+    if (slot.is_write) {
+        slot.ok = result == static_cast<int64_t>(bytes);
+    } else {
+        slot.ok = result >= 0;
+        // Past the end of the backing file reads as erased flash
+        if (slot.ok && static_cast<size_t>(result) < bytes) {
+            std::memset(static_cast<uint8_t*>(slot.io.iov_base) + result, 0, bytes - result);
+        }
+    }
+    complete_ring_->push(index);
+    in_flight_.fetch_sub(1, std::memory_order_acq_rel);
+
+    done_signal_.fetch_add(1, std::memory_order_seq_cst);
+    if (owner_waiting_.load(std::memory_order_seq_cst)) {
+        done_signal_.notify_one();
+    }
+}
+
+void SSDQueue::wait_for_work(uint32_t seen) {
+    work_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    if (work_signal_.load(std::memory_order_seq_cst) == seen && running_.load(std::memory_order_acquire)) {
+        work_signal_.wait(seen, std::memory_order_acquire);
+    }
+    work_waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void SSDQueue::uring_loop() {
+#ifdef PSX5_SSD_IO_URING
+    Uring& ring = *uring_;
+    unsigned unsubmitted = 0;   // SQEs the kernel has not taken yet
+    for (;;) {
+        uint32_t seen = work_signal_.load(std::memory_order_seq_cst);
+
+        unsigned queued = 0;
+        uint32_t index;
+        while (take(index)) {
+            ring.push(fd_, slots_[index], index);
+            ++queued;
+        }
+
+        unsubmitted += queued;
+        if (unsubmitted > 0) {
+            int taken = ring.enter(unsubmitted, 0);
+            if (taken > 0) {
+                unsubmitted -= taken;
+                batches_.fetch_add(1, std::memory_order_relaxed);
+            } else if (taken < 0 && errno != EAGAIN && errno != EBUSY) {
+                // Not a transient shortage: fail what the kernel refused and
+                // take it back out of the SQ
+                const unsigned tail = *ring.sq_tail;
+                for (unsigned i = tail - unsubmitted; i != tail; ++i) {
+                    finish(static_cast<uint32_t>(ring.sqes[i & ring.sq_mask].user_data), -EIO);
+                }
+                __atomic_store_n(ring.sq_tail, tail - unsubmitted, __ATOMIC_RELEASE);
+                unsubmitted = 0;
+            }
+        }
+
+        // With nothing new to submit, sleep in the kernel until a request
+        // completes; a submission arriving meanwhile waits at most that long
+        if (queued == 0 && in_flight_.load(std::memory_order_acquire) > unsubmitted) {
+            ring.enter(0, 1);
+        }
+
+        unsigned head = *ring.cq_head;
+        const unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+            const uint32_t index = static_cast<uint32_t>(cqe.user_data);
+            Slot& slot = slots_[index];
+            if (cqe.res > 0 && static_cast<size_t>(cqe.res) < slot.rest.iov_len) {
+                // A short transfer is not the end of the file: queue the
+                // rest, as pool_loop does. It keeps its in-flight place, so
+                // the SQ still has room.
+                slot.done += static_cast<size_t>(cqe.res);
+                slot.rest.iov_base = static_cast<uint8_t*>(slot.rest.iov_base) + cqe.res;
+                slot.rest.iov_len -= static_cast<size_t>(cqe.res);
+                ring.push(fd_, slot, index);
+                ++unsubmitted;
+                continue;
+            }
+            finish(index, cqe.res < 0 ? cqe.res : static_cast<int64_t>(slot.done + cqe.res));
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+
+        if (in_flight_.load(std::memory_order_acquire) == 0 && queued == 0) {
+            if (!running_.load(std::memory_order_acquire)) return;
+            wait_for_work(seen);
+        }
+    }
+#endif
+}
+
+void SSDQueue::pool_loop() {
+    for (;;) {
+        uint32_t seen = work_signal_.load(std::memory_order_seq_cst);
+        uint32_t index;
+        if (!take(index)) {
+            if (!running_.load(std::memory_order_acquire)) return;
+            wait_for_work(seen);
+            continue;
+        }
+
+        Slot& slot = slots_[index];
+        uint8_t* data = static_cast<uint8_t*>(slot.io.iov_base);
+        size_t done = 0;
+        int64_t result = 0;
+        while (done < slot.io.iov_len) {
+            ssize_t n = slot.is_write
+                ? ::pwrite(fd_, data + done, slot.io.iov_len - done, static_cast<off_t>(slot.offset + done))
+                : ::pread(fd_, data + done, slot.io.iov_len - done, static_cast<off_t>(slot.offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                result = -errno;
+                break;
+            }
+            if (n == 0) break;
+            done += static_cast<size_t>(n);
+        }
+        finish(index, result < 0 ? result : static_cast<int64_t>(done));
+    }
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+enum class SSDPriority { High, Normal, Low };
+
+// Bounded lock-free queue of request slot numbers (Vyukov's array queue)
+// Every cell carries a sequence number saying whose turn it is, so any
+// number of producers and consumers only ever race on their own counter.
+class SSDSlotRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SSDSlotRing(size_t capacity);
+
+    SSDSlotRing(const SSDSlotRing&) = delete;
+    SSDSlotRing& operator=(const SSDSlotRing&) = delete;
+
+    bool push(uint32_t slot);   // false when full
+    bool pop(uint32_t& slot);   // false when empty
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        uint32_t slot;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE) std::atomic<uint64_t> enqueue_pos_{0};
+    alignas(CACHE_LINE) std::atomic<uint64_t> dequeue_pos_{0};
+};
+
+// SSD backed by a host file, driven through submission and completion queues
+// The owning (emulation) thread submits requests into one ring per priority
+// and later calls poll(), which runs the callbacks of finished requests on
+// that thread. Meanwhile a backend drains the rings highest priority first
+// and never keeps more than queue_depth requests in flight:
+//  - io_uring (Linux): one thread turns everything it may take into SQEs,
+//    submits them with a single io_uring_enter and reaps the completions;
+//  - thread pool: queue_depth workers (capped by `threads`) each
+//    pread/pwrite one request at a time, for hosts without io_uring.
+// Requests live in a fixed slot table and the rings pass slot numbers.
+// submit_*() hands slots out and poll() takes them back, so both belong to
+// the owning thread. Both backends carry on after a short transfer and only
+// stop at the end of the file; reads past it come back zero-filled.
+class SSDQueue {
+public:
+    static constexpr uint32_t SECTOR_SIZE = 512;
+    static constexpr int PRIORITY_COUNT = 3;
+
+    enum class Backend { Auto, IoUring, ThreadPool };
+
+    struct Config {
+        uint32_t queue_depth = 32;
+        size_t max_requests = 1024;     // submitted and not yet polled
+        Backend backend = Backend::Auto;
+        int threads = 16;               // thread-pool backend only
+        bool create = false;            // create the image when it is missing
+    };
+
+    struct Stats {
+        uint64_t submitted;
+        uint64_t completed;
+        uint64_t failed;
+        uint64_t rejected;          // submits that found every slot taken
+        uint64_t batches;           // io_uring_enter calls that submitted
+        uint32_t max_in_flight;
+    };
+
+    using Callback = std::function<void(bool)>;
+
+    SSDQueue();
+    ~SSDQueue();
+
+    SSDQueue(const SSDQueue&) = delete;
+    SSDQueue& operator=(const SSDQueue&) = delete;
+
+    // Opens the backing file (false when it is missing, unless
+    // Config::create) and starts the backend.
+    // Backend::Auto falls back to the thread pool when io_uring is missing.
+    bool open(const std::string& path, const Config& config);
+    // Finishes and polls everything submitted, then stops the backend
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+    Backend backend() const { return backend_; }
+    uint32_t queue_depth() const { return config_.queue_depth; }
+
+    // False, with nothing queued, when every request slot is taken
+    bool submit_read(uint64_t lba, uint32_t sectors, void* buffer, Callback callback,
+                     SSDPriority priority = SSDPriority::Normal);
+    bool submit_write(uint64_t lba, uint32_t sectors, const void* buffer, Callback callback,
+                      SSDPriority priority = SSDPriority::Normal);
+
+    // Runs the callbacks of finished requests; returns how many ran
+    size_t poll();
+    // Blocks until every submitted request has finished and been polled
+    void drain();
+    // Submitted and not yet polled
+    size_t pending() const { return slots_.size() - free_slots_.size(); }
+    // Whether the next submit would be refused
+    bool full() const { return free_slots_.empty(); }
+
+    Stats get_stats() const;
+
+private:
+    struct Slot {
+        uint64_t offset;
+        iovec io;
+        iovec rest;             // what a short transfer left to do
+        size_t done;
+        bool is_write;
+        bool ok;
+        Callback callback;
+    };
+
+    struct Uring;
+
+    bool submit(uint64_t lba, uint32_t sectors, void* buffer, bool is_write, Callback callback,
+                SSDPriority priority);
+    // Backend side: claims an in-flight place and the most urgent request
+    bool take(uint32_t& slot);
+    void finish(uint32_t slot, int64_t result);
+    void wait_for_work(uint32_t seen);
+    void uring_loop();
+    void pool_loop();
+
+    Config config_;
+    Backend backend_ = Backend::Auto;
+    int fd_ = -1;
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;      // owning thread only
+    std::unique_ptr<SSDSlotRing> submit_rings_[PRIORITY_COUNT];
+    std::unique_ptr<SSDSlotRing> complete_ring_;
+
+    std::unique_ptr<Uring> uring_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> in_flight_{0};
+
+    // Submissions wake idle backend threads; completions wake drain()
+    std::atomic<uint32_t> work_signal_{0};
+    std::atomic<uint32_t> work_waiters_{0};
+    std::atomic<uint32_t> done_signal_{0};
+    std::atomic<bool> owner_waiting_{false};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint32_t> max_in_flight_{0};
+};
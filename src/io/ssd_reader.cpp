@@ -0,0 +1,236 @@
+#include "ssd_reader.h"
+#include "ssd_cache.h"
+#include "ssd_codec.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t sectors_of(uint64_t bytes) {
+    return (bytes + SSDQueue::SECTOR_SIZE - 1) / SSDQueue::SECTOR_SIZE;
+}
+
+} // namespace
+
+SSDReader::SSDReader(SSDQueue& queue) : queue_(queue) {}
+
+// Requests still in flight hold staging buffers and call back into the
+// reader, so finish them while it and its cache are still here. Owners
+// usually declare the queue first, which destroys it after the reader.
+SSDReader::~SSDReader() {
+    queue_.drain();
+}
+
+void SSDReader::set_cache(SSDBlockCache* cache, uint32_t read_ahead) {
+    cache_ = cache;
+    read_ahead_blocks_ = cache ? read_ahead : 0;
+    for (Stream& stream : streams_) stream = Stream{};
+}
+
+std::vector<uint8_t>* SSDReader::acquire_staging(size_t size) {
+    std::vector<uint8_t>* buffer;
+    if (free_staging_.empty()) {
+        staging_.push_back(std::make_unique<std::vector<uint8_t>>());
+        buffer = staging_.back().get();
+        stats_.staging_buffers++;
+    } else {
+        buffer = free_staging_.back();
+        free_staging_.pop_back();
+    }
+    // Buffers only grow, so a reused one is not cleared again
+    if (buffer->size() < size) buffer->resize(size);
+    return buffer;
+}
+
+bool SSDReader::submit(uint64_t lba, uint32_t compressed_size, uint8_t* output, size_t output_size,
+                       Callback callback, SSDPriority priority) {
+    // Refused before the cache is asked, so a caller retrying a full queue
+    // is not counted as a miss each time
+    if (queue_.full()) return false;
+    const uint32_t sectors = static_cast<uint32_t>(sectors_of(compressed_size));
+
+    if (cache_) {
+        Window* window = window_covering(lba, sectors);
+        if (window && !cache_->contains(lba)) {
+            window->waiters.push_back({lba, compressed_size, output, output_size, std::move(callback)});
+            stats_.requests++;
+            stats_.read_ahead_joined++;
+            note_request(lba, sectors);
+            return true;
+        }
+        if (cache_->lookup(lba, compressed_size, output, output_size)) {
+            stats_.requests++;
+            stats_.decoded_bytes += output_size;
+            note_request(lba, sectors);
+            if (callback) callback(true);
+            return true;
+        }
+    }
+
+    const uint64_t generation = cache_ ? cache_->generation() : 0;
+    std::vector<uint8_t>* staging = acquire_staging(static_cast<size_t>(sectors) * SSDQueue::SECTOR_SIZE);
+    auto done = [this, staging, lba, compressed_size, output, output_size, generation, callback](bool ok) {
+        // The queue polls on the owning thread, which helps the scheduler's
+        // workers and continues only once the last chunk is decoded
+        ok = ok && SSDCodec::decompress(staging->data(), compressed_size, output, output_size, scheduler_);
+        free_staging_.push_back(staging);
+        if (ok) {
+            if (cache_) cache_->insert(lba, compressed_size, output, output_size, generation);
+            stats_.decoded_bytes += output_size;
+        } else {
+            stats_.failed++;
+        }
+        if (callback) callback(ok);
+    };
+    if (!queue_.submit_read(lba, sectors, staging->data(), std::move(done), priority)) {
+        free_staging_.push_back(staging);
+        return false;
+    }
+    stats_.requests++;
+    stats_.compressed_bytes += compressed_size;
+    note_request(lba, sectors);
+    return true;
+}
+
+bool SSDReader::submit_write(uint64_t lba, uint32_t sectors, const void* buffer, Callback callback,
+                             SSDPriority priority) {
+    if (queue_.full()) return false;
+    invalidate(lba, sectors);
+    return queue_.submit_write(lba, sectors, buffer, [this, lba, sectors, callback](bool ok) {
+        invalidate(lba, sectors);
+        if (callback) callback(ok);
+    }, priority);
+}
+
+void SSDReader::invalidate(uint64_t lba, uint64_t sectors) {
+    // Windows in flight keep the old generation, so nothing they read is
+    // cached and no new request joins them
+    if (cache_) cache_->invalidate(lba, sectors);
+}
+
+SSDReader::Window* SSDReader::window_covering(uint64_t lba, uint64_t sectors) {
+    for (const auto& window : windows_) {
+        if (window->generation == cache_->generation() && lba >= window->lba &&
+            lba + sectors <= window->lba + window->sectors) {
+            return window.get();
+        }
+    }
+    return nullptr;
+}
+
+void SSDReader::note_request(uint64_t lba, uint64_t sectors) {
+    if (read_ahead_blocks_ == 0) return;
+    ++use_clock_;
+    Stream* stream = nullptr;
+    for (Stream& s : streams_) {
+        if (s.id && s.next_lba == lba) {
+            stream = &s;
+            break;
+        }
+    }
+    if (!stream) {
+        // Start a stream in place of the one idle longest
+        Stream* oldest = &streams_[0];
+        for (Stream& s : streams_) {
+            if (s.last_use < oldest->last_use) oldest = &s;
+        }
+        *oldest = Stream{next_stream_id_++, lba + sectors, lba + sectors, use_clock_, 1, false, false};
+        return;
+    }
+    stream->next_lba = lba + sectors;
+    stream->ahead_lba = std::max(stream->ahead_lba, stream->next_lba);
+    stream->last_use = use_clock_;
+    stream->run++;
+    if (stream->run >= SEQUENTIAL_RUN) read_ahead(*stream, sectors);
+}
+
+void SSDReader::read_ahead(Stream& stream, uint64_t block_sectors) {
+    if (stream.ahead_in_flight || stream.ahead_failed) return;
+    const uint64_t window_sectors = std::min<uint64_t>(read_ahead_blocks_ * block_sectors, MAX_WINDOW_SECTORS);
+    // Blocks still cached from an earlier pass need no reading
+    uint32_t cached_size;
+    while (stream.ahead_lba < stream.next_lba + window_sectors && cache_->contains(stream.ahead_lba, &cached_size)) {
+        stream.ahead_lba += sectors_of(cached_size);
+    }
+    // Keep about one window's worth of blocks ahead of the stream
+    if (stream.ahead_lba >= stream.next_lba + window_sectors) return;
+
+    auto window = std::make_unique<Window>();
+    window->lba = stream.ahead_lba;
+    window->sectors = window_sectors;
+    window->stream_id = stream.id;
+    window->generation = cache_->generation();
+    window->staging = acquire_staging(window_sectors * SSDQueue::SECTOR_SIZE);
+    Window* pending = window.get();
+    // Low priority, so demand reads overtake it; a full queue just skips it
+    if (!queue_.submit_read(window->lba, static_cast<uint32_t>(window_sectors), window->staging->data(),
+                            [this, pending](bool ok) { finish_read_ahead(pending, ok); }, SSDPriority::Low)) {
+        free_staging_.push_back(window->staging);
+        return;
+    }
+    stream.ahead_in_flight = true;
+    windows_.push_back(std::move(window));
+    stats_.read_ahead_reads++;
+    stats_.read_ahead_bytes += window_sectors * SSDQueue::SECTOR_SIZE;
+}
+
+void SSDReader::finish_read_ahead(Window* pending, bool ok) {
+    std::unique_ptr<Window> window;
+    for (auto it = windows_.begin(); it != windows_.end(); ++it) {
+        if (it->get() == pending) {
+            window = std::move(*it);
+            windows_.erase(it);
+            break;
+        }
+    }
+    const uint8_t* data = window->staging->data();
+    const size_t size = window->sectors * SSDQueue::SECTOR_SIZE;
+
+    // Whole frames go into the cache. The first one the window cuts off,
+    // or anything that is not a frame, is where the next window starts.
+    size_t pos = 0;
+    while (ok && pos < size) {
+        uint64_t length, raw_size;
+        if (!SSDCodec::frame_bytes(data + pos, size - pos, length) || length > size - pos) break;
+        SSDCodec::frame_size(data + pos, size - pos, raw_size);
+        if (raw_size == 0 || raw_size > cache_->capacity()) break;
+        const uint64_t lba = window->lba + pos / SSDQueue::SECTOR_SIZE;
+        if (!cache_->contains(lba)) {
+            if (read_ahead_output_.size() < raw_size) read_ahead_output_.resize(raw_size);
+            if (!SSDCodec::decompress(data + pos, length, read_ahead_output_.data(), raw_size, scheduler_)) break;
+            cache_->insert(lba, static_cast<uint32_t>(length), read_ahead_output_.data(), raw_size,
+                           window->generation, true);
+            stats_.read_ahead_blocks++;
+        }
+        pos += sectors_of(length) * SSDQueue::SECTOR_SIZE;
+    }
+
+    for (Stream& stream : streams_) {
+        if (stream.id != window->stream_id) continue;
+        stream.ahead_in_flight = false;
+        // A window with no whole frame in it would come back every time
+        if (pos == 0) stream.ahead_failed = true;
+        stream.ahead_lba = std::max<uint64_t>(stream.ahead_lba, window->lba + pos / SSDQueue::SECTOR_SIZE);
+    }
+
+    // The window is out of windows_, so callbacks that submit more requests
+    // cannot join it while its waiters are served
+    for (Waiter& waiter : window->waiters) {
+        bool served = ok && cache_->lookup(waiter.lba, waiter.compressed_size, waiter.output, waiter.output_size);
+        if (!served && ok) {
+            const size_t offset = (waiter.lba - window->lba) * SSDQueue::SECTOR_SIZE;
+            served = SSDCodec::decompress(data + offset, waiter.compressed_size, waiter.output, waiter.output_size,
+                                          scheduler_);
+            if (served) {
+                cache_->insert(waiter.lba, waiter.compressed_size, waiter.output, waiter.output_size,
+                               window->generation);
+            }
+        }
+        if (served) {
+            stats_.decoded_bytes += waiter.output_size;
+        } else {
+            stats_.failed++;
+        }
+        if (waiter.callback) waiter.callback(served);
+    }
+    free_staging_.push_back(window->staging);
+}
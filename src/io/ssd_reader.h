@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ssd_queue.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Scheduler;
+class SSDBlockCache;
+
+// Compressed SSD reads that decode straight into their destination
+// Each request reads its SSDCodec frame into a staging buffer and, when the
+// queue reports it, decodes the frame directly into the caller's span
+// (guest or GPU memory as a host pointer), chunk-parallel on the scheduler
+// for large frames. That is one DMA into staging and one decode per byte,
+// with no intermediate vectors. Staging buffers are pooled: a request takes
+// one when submitted and gives it back before its callback runs, so the
+// pool grows to the most requests ever in flight and then stops
+// allocating. Like SSDQueue, submit() and the callbacks (run from
+// queue.poll()) belong to the queue's owning thread.
+//
+// With a block cache attached, decoded frames are kept and a repeat read
+// is a copy. The reader also follows up to MAX_STREAMS sequential streams
+// (each request starting where the last one of the stream ended); once a
+// stream has SEQUENTIAL_RUN requests in a row it reads ahead one window of
+// read_ahead blocks at low priority. Frames are assumed packed back to
+// back on sector boundaries, so the window is split into frames by their
+// chunk tables and every whole frame is decoded into the cache. A request
+// that lands in a window still in flight waits for it instead of reading
+// the same sectors again.
+class SSDReader {
+public:
+    using Callback = SSDQueue::Callback;
+
+    static constexpr size_t MAX_STREAMS = 4;
+    static constexpr uint32_t SEQUENTIAL_RUN = 2;
+    static constexpr uint64_t MAX_WINDOW_SECTORS = (8u << 20) / SSDQueue::SECTOR_SIZE;
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t failed;            // read or decode errors
+        uint64_t compressed_bytes;  // read into staging on demand
+        uint64_t decoded_bytes;     // written to destinations
+        uint64_t staging_buffers;   // allocated over the reader's lifetime
+        uint64_t read_ahead_reads;  // windows submitted
+        uint64_t read_ahead_bytes;  // bytes read by those windows
+        uint64_t read_ahead_blocks; // frames they decoded into the cache
+        uint64_t read_ahead_joined; // requests that waited on a window
+    };
+
+    explicit SSDReader(SSDQueue& queue);
+    // Drains the queue, running every callback still outstanding
+    ~SSDReader();
+
+    SSDReader(const SSDReader&) = delete;
+    SSDReader& operator=(const SSDReader&) = delete;
+
+    void set_scheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
+    // Caches decoded frames and reads `read_ahead` blocks ahead of
+    // sequential streams (0 turns read-ahead off); nullptr detaches.
+    // Only while nothing is in flight. The cache must outlive the reader,
+    // whose destructor still finishes reads into it.
+    void set_cache(SSDBlockCache* cache, uint32_t read_ahead = 4);
+
+    // Reads the compressed_size-byte frame at lba and decodes exactly
+    // output_size bytes into output, which must stay valid until the
+    // callback runs. A cache hit copies and runs the callback before this
+    // returns. False, with nothing queued or copied, when the queue is full.
+    bool submit(uint64_t lba, uint32_t compressed_size, uint8_t* output, size_t output_size, Callback callback,
+                SSDPriority priority = SSDPriority::Normal);
+
+    // Writes sectors through the queue, keeping the cache coherent. The
+    // queue does not order reads against writes, so a read submitted after
+    // this can still read the old sectors and finish first; the range is
+    // invalidated at submit and again when the write completes, which drops
+    // whatever such a read cached. False, with nothing queued, when the
+    // queue is full.
+    bool submit_write(uint64_t lba, uint32_t sectors, const void* buffer, Callback callback,
+                      SSDPriority priority = SSDPriority::Normal);
+
+    // Drops cached frames a write to these sectors makes stale
+    void invalidate(uint64_t lba, uint64_t sectors);
+
+    // Staging buffers not currently lent to a request
+    size_t idle_staging() const { return free_staging_.size(); }
+
+    Stats get_stats() const { return stats_; }
+
+private:
+    struct Stream {
+        uint64_t id;                // 0 for an unused entry
+        uint64_t next_lba;          // where the stream's next request starts
+        uint64_t ahead_lba;         // first sector not yet read ahead
+        uint64_t last_use;
+        uint32_t run;
+        bool ahead_in_flight;
+        bool ahead_failed;          // a window held no frame; stop reading ahead
+    };
+
+    struct Waiter {
+        uint64_t lba;
+        uint32_t compressed_size;
+        uint8_t* output;
+        size_t output_size;
+        Callback callback;
+    };
+
+    struct Window {
+        uint64_t lba;
+        uint64_t sectors;
+        uint64_t stream_id;
+        uint64_t generation;        // the cache's, when it was submitted
+        std::vector<uint8_t>* staging;
+        std::vector<Waiter> waiters;
+    };
+
+    std::vector<uint8_t>* acquire_staging(size_t size);
+    Window* window_covering(uint64_t lba, uint64_t sectors);
+    void note_request(uint64_t lba, uint64_t sectors);
+    void read_ahead(Stream& stream, uint64_t block_sectors);
+    void finish_read_ahead(Window* window, bool ok);
+
+    SSDQueue& queue_;
+    Scheduler* scheduler_ = nullptr;
+    SSDBlockCache* cache_ = nullptr;
+    uint32_t read_ahead_blocks_ = 0;
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> staging_;
+    std::vector<std::vector<uint8_t>*> free_staging_;
+    std::vector<uint8_t> read_ahead_output_;    // frames decode here, then into the cache
+    Stream streams_[MAX_STREAMS] = {};
+    std::vector<std::unique_ptr<Window>> windows_;
+    uint64_t next_stream_id_ = 1;
+    uint64_t use_clock_ = 0;
+    Stats stats_{};
+};
@@ -1,13 +1,36 @@
 #include "runtime/emulator.h"
 #include "core/logger.h"
 #include "debugger.h"
+#include "gpu/gpu_frame_dump.h"
+#include "audio/audio_devices.h"
 #ifdef PSX5_ENABLE_QT_GUI
 #include "gui/main_window.h"
 #include <QApplication>
 #endif
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <vector>
 #include <iostream>
+#include <memory>
+
+// Whole-string decimal in [min, max]; rejects signs, trailing text and overflow
+static bool parse_number(const std::string& text, uint32_t min, uint32_t max, uint32_t& out){
+    if(text.empty() || text.size() > 10 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    uint64_t value = std::stoull(text);
+    if(value < min || value > max) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+static void print_usage(const char* argv0){
+    std::cout<<"Usage: "<<argv0<<" <path-to-blob> [base-addr] [--nogui|--cli] [--gpu-log=trace|debug|info|warn|error|off] [--gpu-trace=<file>]\n"
+             <<"       [--headless] [--software-render] [--dump-frames=<dir>] [--dump-format=qoi|raw] [--dump-interval=<n>] [--frame-timing=<csv>]\n"
+             <<"       [--gpu-capture=<file>] [--gpu-capture-frame=<n>]\n"
+             <<"       [--audio=default|alsa|sdl2|null|null-fast] [--audio-wav=<file>] [--audio-buffer=<frames>]\n"
+             <<"       [--audio-rate=<hz>] [--audio-resampler=sinc|linear]\n";
+}
 
 static std::vector<uint8_t> read_file(const std::string& p){ std::ifstream f(p, std::ios::binary|std::ios::ate); if(!f) return {}; auto n=(size_t)f.tellg(); std::vector<uint8_t> b(n); f.seekg(0); f.read((char*)b.data(), n); return b; }
 
@@ -16,7 +39,7 @@ int main(int argc, char** argv){
     // Check for GUI mode (default) vs command line mode
     bool useGui = true;
     for(int i=1;i<argc;++i) {
-        if(std::string(argv[i])=="--nogui" || std::string(argv[i])=="--cli") {
+        if(std::string(argv[i])=="--nogui" || std::string(argv[i])=="--cli" || std::string(argv[i])=="--headless") {
             useGui = false;
             break;
         }
@@ -40,12 +63,122 @@ int main(int argc, char** argv){
     bool nogui = false;
     for(int i=1;i<argc;++i) if(std::string(argv[i])=="--nogui") nogui=true;
     log::set_level(log::Level::Info);
-    if(argc < 2){ std::cout<<"Usage: "<<argv[0]<<" <path-to-blob> [base-addr] [--nogui|--cli]\n"; return 1; }
+    if(argc < 2){
+        print_usage(argv[0]);
+        return 1;
+    }
     auto bytes = read_file(argv[1]); if(bytes.empty()){ std::cerr<<"Failed to read "<<argv[1]<<"\n"; return 2; }
-    uint64_t base = 0x1000; if(argc>=3) base = std::stoull(argv[2], nullptr, 0);
+    uint64_t base = 0x1000;
+    if(argc>=3 && std::string(argv[2]).rfind("--",0)!=0){
+        char* end = nullptr;
+        base = std::strtoull(argv[2], &end, 0);
+        if(!std::isdigit(static_cast<unsigned char>(argv[2][0])) || *end){ std::cerr<<"Invalid base address "<<argv[2]<<"\n"; print_usage(argv[0]); return 1; }
+    }
     Emulator emu(1<<24);
+    // Headless runs to completion without a debugger prompt or window; frames
+    // go to the dumper (timing only unless --dump-frames is given)
+    bool headless = false;
+    bool dump_requested = false;
+    GPUFrameDumper::Config dump_config;
+    std::string capture_path;
+    uint32_t capture_frame = 0;
+    // Audio stays closed unless asked for; --audio-wav records the output
+    bool audio_requested = false;
+    AudioBackend audio_backend = AudioBackend::Default;
+    std::string audio_wav_path;
+    uint32_t audio_buffer = 0;
+    uint32_t audio_rate = 0;
+    AudioResampleQuality audio_resampler = AudioResampleQuality::Sinc;
+    for(int i=1;i<argc;++i){
+        std::string arg(argv[i]);
+        if(arg=="--headless"){ headless = true; continue; }
+        if(arg=="--software-render"){ emu.gpu().set_software_rendering(true); continue; }
+        if(arg.rfind("--dump-frames=",0)==0){ dump_config.directory = arg.substr(14); dump_requested = true; continue; }
+        if(arg.rfind("--frame-timing=",0)==0){ dump_config.timing_path = arg.substr(15); dump_requested = true; continue; }
+        if(arg.rfind("--dump-interval=",0)==0){
+            if(!parse_number(arg.substr(16), 1, UINT32_MAX, dump_config.interval)){ std::cerr<<"Invalid dump interval "<<arg.substr(16)<<"\n"; print_usage(argv[0]); return 1; }
+            continue;
+        }
+        if(arg.rfind("--gpu-capture=",0)==0){ capture_path = arg.substr(14); continue; }
+        if(arg.rfind("--gpu-capture-frame=",0)==0){
+            if(!parse_number(arg.substr(20), 0, UINT32_MAX, capture_frame)){ std::cerr<<"Invalid capture frame "<<arg.substr(20)<<"\n"; print_usage(argv[0]); return 1; }
+            continue;
+        }
+        if(arg.rfind("--audio=",0)==0){
+            if(!Audio::parse_backend(arg.substr(8), audio_backend)){ std::cerr<<"Unknown audio backend "<<arg.substr(8)<<"\n"; return 1; }
+            audio_requested = true;
+            continue;
+        }
+        if(arg.rfind("--audio-wav=",0)==0){ audio_wav_path = arg.substr(12); audio_requested = true; continue; }
+        if(arg.rfind("--audio-buffer=",0)==0){
+            if(!parse_number(arg.substr(15), 1, 1u << 20, audio_buffer)){ std::cerr<<"Invalid audio buffer "<<arg.substr(15)<<"\n"; print_usage(argv[0]); return 1; }
+            continue;
+        }
+        if(arg.rfind("--audio-rate=",0)==0){
+            if(!parse_number(arg.substr(13), 8000, 384000, audio_rate)){ std::cerr<<"Invalid audio rate "<<arg.substr(13)<<"\n"; print_usage(argv[0]); return 1; }
+            continue;
+        }
+        if(arg.rfind("--audio-resampler=",0)==0){
+            if(!Audio::parse_resample_quality(arg.substr(18), audio_resampler)){ std::cerr<<"Unknown resampler "<<arg.substr(18)<<"\n"; return 1; }
+            continue;
+        }
+        if(arg.rfind("--dump-format=",0)==0){
+            if(!GPUFrameDumper::parse_format(arg.substr(14), dump_config.format)){ std::cerr<<"Unknown dump format "<<arg.substr(14)<<"\n"; return 1; }
+            continue;
+        }
+        if(arg.rfind("--gpu-log=",0)==0){
+            GPULogLevel lvl;
+            if(!GPUEventLog::parse_level(arg.substr(10), lvl)){ std::cerr<<"Unknown GPU log level "<<arg.substr(10)<<"\n"; return 1; }
+            emu.gpu().get_event_log().set_level(lvl);
+            if(lvl==GPULogLevel::Trace) log::set_level(log::Level::Trace);
+            else if(lvl==GPULogLevel::Debug) log::set_level(log::Level::Debug);
+        } else if(arg.rfind("--gpu-trace=",0)==0){
+            if(!emu.gpu().get_event_log().start_trace(arg.substr(12))){ std::cerr<<"Failed to open GPU trace "<<arg.substr(12)<<"\n"; return 1; }
+        }
+    }
+    if(!capture_path.empty()) emu.gpu().request_capture(capture_path, capture_frame);
+    if(audio_requested){
+        AudioFormat format{48000, 2, 32, true, static_cast<int>(audio_buffer), static_cast<int>(audio_rate), audio_resampler};
+        bool opened = audio_wav_path.empty()
+            ? emu.audio().initialize(format, audio_backend)
+            : emu.audio().initialize(format, std::make_unique<WavFileAudioDevice>(audio_wav_path));
+        if(!opened){ std::cerr<<"Failed to open audio output\n"; return 1; }
+    }
     if(!emu.load_module(bytes, base)){ std::cerr<<"load_module failed\n"; return 3; }
+    
+    std::unique_ptr<GPUFrameDumper> dumper;
+    if(headless || dump_requested){
+        dumper = std::make_unique<GPUFrameDumper>(dump_config);
+        if(!dumper->open()) return 1;
+        emu.gpu().get_presenter().set_sink(dumper.get());
+    }
+    if(headless){
+        // Every frame reaches the dumper, so dumps do not depend on timing
+        emu.gpu().get_presenter().set_mode(GPUPresenter::Mode::FIFO);
+        emu.run_until_halt();
+        emu.gpu().get_presenter().wait_idle();
+        emu.gpu().get_presenter().set_sink(nullptr);
+        auto stats = dumper->get_stats();
+        auto presenter = emu.gpu().get_presenter().get_stats();
+        std::cout<<"Frames: "<<stats.frames<<" (dumped "<<stats.dumped<<", dropped "<<presenter.dropped<<")";
+        if(stats.frames > 1){
+            std::cout<<", avg frame "<<stats.total_frame_time_us / (stats.frames - 1)<<" us, max "<<stats.max_frame_time_us<<" us";
+        }
+        std::cout<<"\n";
+        if(audio_requested){
+            auto audio = emu.audio().get_stats();
+            std::cout<<"Audio: dropped "<<audio.dropped_frames<<" frames, "<<audio.underruns<<" underruns, latency "
+                     <<audio.latency_ms<<" ms (target "<<audio.target_ms<<" ms), stretch "<<audio.stretch<<"\n";
+            emu.audio().shutdown();
+        }
+        return 0;
+    }
+    
+    // Without a dumper, frames go to a window when Vulkan can present to one
+    if(!dumper) emu.gpu().open_window();
     Debugger dbg(emu);
     dbg.repl();
+    if(dumper) emu.gpu().get_presenter().set_sink(nullptr);
+    emu.gpu().close_window();
     return 0;
 }
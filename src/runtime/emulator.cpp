@@ -7,6 +7,11 @@ Emulator::Emulator(size_t mem_size)
     // Invalidate JIT/code cache on writes to memory pages (simple heuristic)
     // TODO: Implement more sophisticated cache invalidation
     mem_.set_write_observer([this](size_t addr, size_t len){ this->cpu_.invalidate_code_at(addr, len); });
+
+    // GPU DMA reads/writes guest memory directly and splits large transfers across workers
+    sched_.initialize();
+    gpu_.set_guest_memory(&mem_);
+    gpu_.set_scheduler(&sched_);
 }
 
 
@@ -0,0 +1,151 @@
+// GPU frame replay
+// Loads a capture written by `psx5 --gpu-capture=<file>` and runs its frame
+// repeatedly from the same starting state, timing each run. The memory the
+// frame leaves behind is hashed after every run so nondeterministic output
+// shows up next to the timings. Replays run on a scheduler like the
+// emulator's, so compute workgroups, large DMA and pipeline compiles take
+// the same parallel path; --threads=0 times the serial path instead.
+#include "gpu/gpu.h"
+#include "core/memory.h"
+#include "core/scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Whole-string decimal in [min, max]
+static bool parse_number(const std::string& text, uint32_t min, uint32_t max, uint32_t& out) {
+    if (text.empty() || text.size() > 10 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    uint64_t value = std::stoull(text);
+    if (value < min || value > max) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+static void print_usage(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " <capture> [--iterations=<n>] [--warmup=<n>] [--threads=<n>] [--software-render]\n"
+              << "  --threads=<n>  scheduler workers (default: hardware threads, 0 = serial)\n";
+}
+
+static uint64_t hash_ranges(GPU& gpu, const GPUCapture& capture) {
+    uint64_t hash = 0xcbf29ce484222325ULL;   // FNV-1a
+    for (const auto& range : capture.memory) {
+        if (range.space != GPUCapture::SPACE_GPU) continue;
+        const uint8_t* data = gpu.get_gpu_memory_ptr(range.address);
+        for (size_t i = 0; data && i < range.data.size(); ++i) {
+            hash = (hash ^ data[i]) * 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    uint32_t iterations = 10;
+    uint32_t warmup = 1;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    bool software = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg(argv[i]);
+        bool ok = true;
+        if (arg.rfind("--iterations=", 0) == 0) ok = parse_number(arg.substr(13), 1, UINT32_MAX, iterations);
+        else if (arg.rfind("--warmup=", 0) == 0) ok = parse_number(arg.substr(9), 0, UINT32_MAX, warmup);
+        else if (arg.rfind("--threads=", 0) == 0) ok = parse_number(arg.substr(10), 0, 1024, threads);
+        else if (arg == "--software-render") software = true;
+        else ok = false;
+        if (!ok) {
+            std::cerr << "Invalid option " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    GPUCapture capture;
+    if (!capture.load(argv[1])) {
+        std::cerr << "Failed to load capture " << argv[1] << "\n";
+        return 2;
+    }
+
+    // Guest memory only needs to reach the highest range the frame read.
+    // Ranges are recorded at the addresses DMA used; Memory maps the user
+    // range at PS5_USER_MEMORY_BASE onto physical 0, so those count from there.
+    size_t guest_size = 0;
+    for (const auto& range : capture.memory) {
+        if (range.space == GPUCapture::SPACE_GUEST) {
+            uint64_t end = range.address + range.data.size();
+            if (range.address >= PS5_USER_MEMORY_BASE && end <= PS5_USER_MEMORY_BASE + PS5_USER_MEMORY_SIZE) {
+                end -= PS5_USER_MEMORY_BASE;
+            }
+            guest_size = std::max(guest_size, static_cast<size_t>(end));
+        }
+    }
+    // Outlives the GPU, whose async work may still be queued on it
+    Scheduler scheduler;
+    if (threads > 0) {
+        scheduler.initialize(static_cast<int>(threads));
+    }
+    std::unique_ptr<Memory> guest;
+    GPU gpu;
+    if (threads > 0) {
+        gpu.set_scheduler(&scheduler);
+    }
+    if (guest_size > 0) {
+        guest = std::make_unique<Memory>(guest_size);
+        gpu.set_guest_memory(guest.get());
+    }
+    gpu.set_software_rendering(software);
+
+    std::vector<GPU::Command> commands;
+    commands.reserve(capture.commands.size());
+    for (const auto& cmd : capture.commands) {
+        commands.push_back({cmd.opcode, cmd.arg0, cmd.arg1, cmd.arg2, cmd.arg3});
+    }
+
+    std::cout << "Frame " << capture.frame_number << ": " << commands.size() << " commands, "
+              << capture.shaders.size() << " shaders, " << capture.memory.size() << " memory ranges, "
+              << (threads > 0 ? std::to_string(threads) + " scheduler threads" : std::string("serial")) << "\n";
+
+    std::vector<double> times_ms;
+    uint64_t first_hash = 0;
+    bool deterministic = true;
+    for (uint32_t run = 0; run < warmup + iterations; ++run) {
+        if (!gpu.restore_capture(capture)) {
+            std::cerr << "Failed to restore capture\n";
+            return 3;
+        }
+        auto start = std::chrono::steady_clock::now();
+        gpu.submit(commands);
+        gpu.get_dma_engine().wait_idle();
+        gpu.sync_with_vulkan();
+        auto end = std::chrono::steady_clock::now();
+
+        uint64_t hash = hash_ranges(gpu, capture);
+        if (run == 0) {
+            first_hash = hash;
+        } else if (hash != first_hash) {
+            deterministic = false;
+        }
+        if (run >= warmup) {
+            times_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+    }
+
+    std::sort(times_ms.begin(), times_ms.end());
+    double total = 0;
+    for (double t : times_ms) total += t;
+    std::printf("%u runs: min %.3f ms, median %.3f ms, avg %.3f ms, max %.3f ms\n",
+                iterations, times_ms.front(), times_ms[times_ms.size() / 2],
+                total / times_ms.size(), times_ms.back());
+    std::printf("Output hash %016llx (%s)\n", static_cast<unsigned long long>(first_hash),
+                deterministic ? "identical every run" : "DIFFERS between runs");
+    return deterministic ? 0 : 4;
+}
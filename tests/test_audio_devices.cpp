@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../src/audio/audio.h"
+#include "../src/audio/audio_devices.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static AudioFormat stereo_float() {
+    AudioFormat format;
+    format.sample_rate = 48000;
+    format.channels = 2;
+    format.bits_per_sample = 32;
+    format.is_float = true;
+    return format;
+}
+
+static std::vector<float> make_signal(size_t frames) {
+    std::vector<float> signal(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        signal[i * 2] = 0.5f * std::sin(i * 0.01f);
+        signal[i * 2 + 1] = 0.25f * std::cos(i * 0.03f);
+    }
+    return signal;
+}
+
+static std::vector<uint8_t> read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+// Pushes in chunks the ring can always take, then shuts down, which plays
+// out everything still queued
+static void render_to_wav(Audio& audio, const std::filesystem::path& path, const std::vector<float>& signal,
+                          const AudioFormat& format = stereo_float()) {
+    audio.initialize(format, std::make_unique<WavFileAudioDevice>(path.string()));
+    const size_t CHUNK = 1024;
+    const size_t frames = signal.size() / 2;
+    for (size_t pos = 0; pos < frames; pos += CHUNK) {
+        while (audio.get_queued_frames() > 4096) {
+            std::this_thread::yield();
+        }
+        audio.push_samples(signal.data() + pos * 2, static_cast<int>(std::min(CHUNK, frames - pos)));
+    }
+    audio.shutdown();
+}
+
+// With no effects enabled the file is the input, bit for bit
+static void test_wav_passthrough(const std::filesystem::path& dir) {
+    const size_t FRAMES = 48 * 1024;
+    std::vector<float> signal = make_signal(FRAMES);
+    Audio audio;
+    render_to_wav(audio, dir / "passthrough.wav", signal);
+
+    std::vector<uint8_t> file = read_file(dir / "passthrough.wav");
+    EXPECT_EQ(file.size(), 44 + signal.size() * sizeof(float));
+    if (file.size() != 44 + signal.size() * sizeof(float)) return;
+    EXPECT_EQ(std::memcmp(file.data(), "RIFF", 4), 0);
+    EXPECT_EQ(file[20], 3);     // IEEE float
+    EXPECT_EQ(file[22], 2);     // channels
+    EXPECT_EQ(std::memcmp(file.data() + 44, signal.data(), signal.size() * sizeof(float)), 0);
+}
+
+// A length that is not a whole number of blocks still reaches the file in
+// full: the partial last block is played at shutdown
+static void test_wav_partial_block(const std::filesystem::path& dir) {
+    const size_t FRAMES = 10 * 1024 + 100;
+    std::vector<float> signal = make_signal(FRAMES);
+    Audio audio;
+    render_to_wav(audio, dir / "partial.wav", signal);
+
+    std::vector<uint8_t> file = read_file(dir / "partial.wav");
+    EXPECT_EQ(file.size(), 44 + signal.size() * sizeof(float));
+    if (file.size() != 44 + signal.size() * sizeof(float)) return;
+    EXPECT_EQ(std::memcmp(file.data() + 44, signal.data(), signal.size() * sizeof(float)), 0);
+}
+
+// The same input through the full effect chain gives the same file twice
+static void test_wav_deterministic(const std::filesystem::path& dir) {
+    const size_t FRAMES = 32 * 1024;
+    std::vector<float> signal = make_signal(FRAMES);
+    for (const char* name : {"fx_a.wav", "fx_b.wav"}) {
+        Audio audio;
+        audio.set_reverb(1, 0.4f);
+        audio.set_compressor(true, -12.0f, 4.0f, 5.0f, 80.0f);
+        audio.set_limiter(true, -1.0f, 50.0f);
+        audio.enable_surround(true);
+        audio.add_audio_source(1, 2.0f, 0.0f, 1.0f, 0.3f);
+        render_to_wav(audio, dir / name, signal);
+    }
+    std::vector<uint8_t> a = read_file(dir / "fx_a.wav");
+    std::vector<uint8_t> b = read_file(dir / "fx_b.wav");
+    EXPECT_EQ(a.size(), 44 + FRAMES * 2 * sizeof(float));
+    EXPECT_EQ(a == b, true);
+}
+
+// A 44.1 kHz device gets the 48 kHz input converted: the header carries the
+// device rate and the length scales with it, to within a frame
+static void test_wav_resampled(const std::filesystem::path& dir) {
+    const size_t FRAMES = 48 * 1024;
+    std::vector<float> signal = make_signal(FRAMES);
+    AudioFormat format = stereo_float();
+    format.output_sample_rate = 44100;
+    Audio audio;
+    render_to_wav(audio, dir / "resampled.wav", signal, format);
+
+    std::vector<uint8_t> file = read_file(dir / "resampled.wav");
+    if (file.size() < 44) return;
+    uint32_t rate;
+    std::memcpy(&rate, file.data() + 24, sizeof(rate));
+    EXPECT_EQ(rate, 44100u);
+    double frames = (file.size() - 44) / (2.0 * sizeof(float));
+    double expected = FRAMES * 44100.0 / 48000.0;
+    EXPECT_EQ(std::fabs(frames - expected) <= 1.0, true);
+}
+
+// Real-time pacing renders about one second of audio per second
+static void test_null_real_time() {
+    NullAudioDevice device(NullAudioDevice::Pacing::RealTime);
+    device.initialize(stereo_float());
+    size_t rendered = 0;
+    device.set_render_callback([&](float*, size_t frames) { rendered += frames; });
+    auto start = std::chrono::steady_clock::now();
+    device.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    device.stop();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double expected = seconds * 48000;
+    EXPECT_EQ(device.get_frames_consumed(), rendered);
+    EXPECT_EQ(rendered > expected * 0.5 && rendered < expected * 1.5 + 256, true);
+}
+
+// Pull-model output is paced: frame-sized bursts keep playing with the
+// ring held near its target and the rate correction within bounds
+static void test_paced_output() {
+    Audio audio;
+    AudioFormat format = stereo_float();
+    format.latency_min_ms = 20;
+    format.latency_max_ms = 100;
+    audio.initialize(format, AudioBackend::Null);
+    std::vector<float> signal = make_signal(800);
+    auto next = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < 30; ++frame) {
+        audio.push_samples(signal.data(), 800);
+        next += std::chrono::microseconds(16667);
+        std::this_thread::sleep_until(next);
+    }
+    Audio::Stats stats = audio.get_stats();
+    audio.shutdown();
+    EXPECT_EQ(stats.target_ms >= 20.0 && stats.target_ms <= 100.0, true);
+    EXPECT_EQ(std::abs(stats.stretch - 1.0) <= AudioLatencyController::MAX_STRETCH, true);
+    EXPECT_EQ(stats.latency_ms > 0.0, true);
+}
+
+// Unthrottled leaves the pushing to Audio's thread
+static void test_null_unthrottled() {
+    NullAudioDevice device(NullAudioDevice::Pacing::Unthrottled);
+    device.initialize(stereo_float());
+    EXPECT_EQ(device.set_render_callback([](float*, size_t) {}), false);
+    std::vector<float> block(512, 0.0f);
+    device.write_samples(block.data(), 256);
+    EXPECT_EQ(device.get_frames_consumed(), 256u);
+    EXPECT_EQ(device.get_latency(), 0.0);
+}
+
+// The GUI and the headless summary poll from their own threads while the
+// emulator starts and stops audio; a poll never sees a torn-down device
+static void test_poll_during_shutdown() {
+    Audio audio;
+    std::atomic<bool> polling{true};
+    std::thread poller([&] {
+        while (polling.load()) {
+            audio.get_output_latency();
+            audio.get_stats();
+        }
+    });
+    bool all_started = true;
+    for (int i = 0; i < 20; ++i) {
+        all_started = audio.initialize(stereo_float(), AudioBackend::Null) && all_started;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        audio.shutdown();
+    }
+    polling = false;
+    poller.join();
+    EXPECT_EQ(all_started, true);
+    EXPECT_EQ(audio.get_output_latency(), 0.0);
+}
+
+int main(){
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "psx5_audio_devices_test";
+    std::filesystem::create_directories(dir);
+
+    test_wav_passthrough(dir);
+    test_wav_partial_block(dir);
+    test_wav_deterministic(dir);
+    test_wav_resampled(dir);
+    test_null_real_time();
+    test_null_unthrottled();
+    test_paced_output();
+    test_poll_during_shutdown();
+
+    std::filesystem::remove_all(dir);
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
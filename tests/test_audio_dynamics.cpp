@@ -0,0 +1,91 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/audio/audio_dynamics.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+// Noise with loud bursts, so the envelope both attacks and releases
+static std::vector<float> make_signal(size_t frames, int channels, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> signal(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        float level = (i / 1000) % 3 == 1 ? 1.8f : 0.2f;
+        for (int c = 0; c < channels; ++c) {
+            signal[i * channels + c] = noise(rng) * level;
+        }
+    }
+    return signal;
+}
+
+// Vectorized output against the scalar reference, in uneven blocks so the
+// SIMD tails and the envelope carried across calls are both exercised
+static void test_matches_scalar(int channels, float ratio, float attack_ms) {
+    const size_t FRAMES = 20000;
+    std::vector<float> simd = make_signal(FRAMES, channels, 1234 + channels);
+    std::vector<float> scalar = simd;
+
+    AudioDynamics a, b;
+    a.configure(-12.0f, ratio, attack_ms, 80.0f, 48000);
+    b.configure(-12.0f, ratio, attack_ms, 80.0f, 48000);
+    size_t block = 1;
+    for (size_t pos = 0; pos < FRAMES; pos += block, block = block % 517 + 3) {
+        size_t n = std::min(block, FRAMES - pos);
+        a.process(simd.data() + pos * channels, n, channels);
+        b.process_scalar(scalar.data() + pos * channels, n, channels);
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < simd.size(); ++i) {
+        if (std::abs(simd[i] - scalar[i]) > 1e-6f * std::max(1.0f, std::abs(scalar[i]))) ++mismatches;
+    }
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(a.envelope(), b.envelope());
+}
+
+// Zero attack and an infinite ratio must hold every sample at the threshold
+static void test_limiter_ceiling() {
+    std::vector<float> signal = make_signal(10000, 2, 99);
+    AudioDynamics limiter;
+    limiter.configure(-6.0f, AudioDynamics::RATIO_INFINITE, 0.0f, 50.0f, 48000);
+    limiter.process(signal.data(), 10000, 2);
+
+    float ceiling = limiter.threshold() * (1.0f + 1e-6f);
+    size_t over = 0;
+    for (float s : signal) {
+        if (std::abs(s) > ceiling) ++over;
+    }
+    EXPECT_EQ(over, 0u);
+}
+
+// Below the threshold nothing changes
+static void test_transparent_below_threshold() {
+    std::vector<float> signal(512, 0.1f);
+    AudioDynamics compressor;
+    compressor.configure(-6.0f, 4.0f, 5.0f, 50.0f, 48000);
+    compressor.process(signal.data(), 256, 2);
+    EXPECT_EQ(signal[0], 0.1f);
+    EXPECT_EQ(signal[511], 0.1f);
+}
+
+int main(){
+    for (int channels : {1, 2, 6}) {
+        test_matches_scalar(channels, 4.0f, 10.0f);
+        test_matches_scalar(channels, AudioDynamics::RATIO_INFINITE, 0.0f);
+    }
+    test_limiter_ceiling();
+    test_transparent_below_threshold();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/audio/audio_fft.h"
+#include "../src/audio/audio_hrtf.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const float PI = 3.14159265358979323846f;
+
+// Forward transform against a direct DFT, and the round trip
+static void test_fft(size_t size) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> x(size), re(size / 2 + 1), im(size / 2 + 1), y(size);
+    for (float& v : x) v = noise(rng);
+
+    AudioFFT fft(size);
+    fft.forward(x.data(), re.data(), im.data());
+    double worst = 0;
+    for (size_t k = 0; k <= size / 2; ++k) {
+        double dr = 0, di = 0;
+        for (size_t n = 0; n < size; ++n) {
+            double angle = -2.0 * 3.14159265358979323846 * k * n / size;
+            dr += x[n] * std::cos(angle);
+            di += x[n] * std::sin(angle);
+        }
+        worst = std::max(worst, std::hypot(dr - re[k], di - im[k]));
+    }
+    EXPECT_EQ(worst < 1e-4, true);
+
+    fft.inverse(re.data(), im.data(), y.data());
+    worst = 0;
+    for (size_t n = 0; n < size; ++n) worst = std::max(worst, static_cast<double>(std::abs(y[n] - x[n])));
+    EXPECT_EQ(worst < 1e-5, true);
+}
+
+// A source parked on a grid direction must come out as the plain
+// time-domain convolution with that direction's responses, across block
+// boundaries and partitions
+static void test_matches_direct_convolution() {
+    AudioHRIRSet set;
+    set.make_spherical_head(48000);
+    const size_t BLOCK = 64;   // 256-tap responses: four partitions
+    const size_t BLOCKS = 12;
+    AudioHRTFEngine engine(set, BLOCK);
+    EXPECT_EQ(engine.block_frames(), BLOCK);
+
+    const size_t elevation = 2, azimuth = 7;
+    const float gain = 0.8f;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> input(BLOCK * BLOCKS);
+    for (float& v : input) v = noise(rng);
+
+    // What the engine convolves: the first block fades in from silence
+    std::vector<float> scaled(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        scaled[i] = input[i] * (i < BLOCK ? gain * (i + 1) / BLOCK : gain);
+    }
+
+    std::vector<float> left(input.size()), right(input.size());
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        AudioHRTFSource source{1, azimuth * set.azimuth_step() * PI / 180.0f,
+                               (set.elevation_min() + elevation * set.elevation_step()) * PI / 180.0f, gain,
+                               input.data() + b * BLOCK};
+        engine.process({source}, left.data() + b * BLOCK, right.data() + b * BLOCK);
+    }
+
+    double worst = 0;
+    for (int side = 0; side < 2; ++side) {
+        const float* ir = side == 0 ? set.left(elevation, azimuth) : set.right(elevation, azimuth);
+        const std::vector<float>& out = side == 0 ? left : right;
+        for (size_t n = 0; n < input.size(); ++n) {
+            double expected = 0;
+            for (size_t t = 0; t < set.length() && t <= n; ++t) expected += ir[t] * scaled[n - t];
+            worst = std::max(worst, std::abs(expected - out[n]));
+        }
+    }
+    EXPECT_EQ(worst < 1e-4, true);
+}
+
+// Sources to the right are louder and earlier in the right ear
+static void test_lateralization() {
+    AudioHRIRSet set;
+    set.make_spherical_head(48000);
+    const float* l = set.left(2, 9);    // 90 degrees right, level
+    const float* r = set.right(2, 9);
+    double el = 0, er = 0;
+    size_t peak_l = 0, peak_r = 0;
+    for (size_t n = 0; n < set.length(); ++n) {
+        el += l[n] * l[n];
+        er += r[n] * r[n];
+        if (std::abs(l[n]) > std::abs(l[peak_l])) peak_l = n;
+        if (std::abs(r[n]) > std::abs(r[peak_r])) peak_r = n;
+    }
+    EXPECT_EQ(er > el, true);
+    EXPECT_EQ(peak_r < peak_l, true);
+}
+
+// Removed sources drop out, and the mix is silent once nothing plays
+static void test_source_removal() {
+    AudioHRIRSet set;
+    set.make_spherical_head(48000);
+    AudioHRTFEngine engine(set, 128);
+    std::vector<float> input(128, 0.5f), left(128), right(128);
+    engine.process({{1, 0.3f, 0.0f, 1.0f, input.data()}, {2, -1.0f, 0.2f, 1.0f, input.data()}},
+                   left.data(), right.data());
+    for (int i = 0; i < 4; ++i) {
+        engine.process({}, left.data(), right.data());
+    }
+    float peak = 0;
+    for (size_t i = 0; i < 128; ++i) peak = std::max(peak, std::max(std::abs(left[i]), std::abs(right[i])));
+    EXPECT_EQ(peak, 0.0f);
+}
+
+// A source that jumps to a new direction fades between the two filters
+// over the block: it starts where the old direction would have been and
+// ends exactly where the new one is
+static void test_moving_source_crossfades() {
+    AudioHRIRSet set;
+    set.make_spherical_head(48000);
+    const size_t BLOCK = 128;
+    const size_t BLOCKS = 6;
+    const float from = -PI * 0.5f, to = PI * 0.5f;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> input(BLOCK * BLOCKS);
+    for (float& v : input) v = noise(rng);
+
+    // Moving, parked at the old direction, parked at the new one
+    AudioHRTFEngine moving(set, BLOCK), before(set, BLOCK), after(set, BLOCK);
+    std::vector<float> left[3], right[3];
+    AudioHRTFEngine* engines[3] = {&moving, &before, &after};
+    for (int e = 0; e < 3; ++e) {
+        left[e].resize(input.size());
+        right[e].resize(input.size());
+        for (size_t b = 0; b < BLOCKS; ++b) {
+            float azimuth = e == 1 || (e == 0 && b < BLOCKS - 1) ? from : to;
+            engines[e]->process({{1, azimuth, 0.0f, 1.0f, input.data() + b * BLOCK}},
+                                left[e].data() + b * BLOCK, right[e].data() + b * BLOCK);
+        }
+    }
+
+    size_t start = (BLOCKS - 1) * BLOCK, last = BLOCKS * BLOCK - 1;
+    // Every block before the move matches the parked source
+    double worst = 0;
+    for (size_t n = 0; n < start; ++n) worst = std::max(worst, static_cast<double>(std::abs(left[0][n] - left[1][n])));
+    EXPECT_EQ(worst < 1e-5, true);
+    // The first sample of the moving block is within one step of the old
+    // filter, not the new one; the last sample is all new
+    for (int side = 0; side < 2; ++side) {
+        const std::vector<float>* out = side == 0 ? left : right;
+        float jump = std::abs(out[2][start] - out[1][start]);
+        EXPECT_EQ(std::abs(out[0][start] - out[1][start]) <= jump / BLOCK + 1e-5f, true);
+        EXPECT_EQ(std::abs(out[0][last] - out[2][last]) < 1e-5f, true);
+    }
+}
+
+// Writes a PSX5HRIR header and `floats` samples of data
+static void write_hrir(const char* path, uint32_t length, uint32_t azimuths, uint32_t elevations, size_t floats) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    uint32_t header[6] = {1, 48000, length, azimuths, elevations, 0};
+    float angles[2] = {0.0f, 10.0f};
+    file.write("PSX5HRIR", 8);
+    file.write(reinterpret_cast<const char*>(header), 5 * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(angles), sizeof(angles));
+    std::vector<float> data(floats, 0.25f);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(float)));
+}
+
+// Sets load whole; a header promising more responses than the file holds is
+// rejected before allocating
+static void test_hrir_load() {
+    const char* path = "test_audio_hrtf.hrir";
+    AudioHRIRSet set;
+    write_hrir(path, 32, 4, 2, 32 * 4 * 2 * 2);
+    EXPECT_EQ(set.load(path), true);
+    EXPECT_EQ(set.length(), 32u);
+    EXPECT_EQ(set.right(1, 3)[31], 0.25f);
+
+    write_hrir(path, 65536, 3600, 1800, 16);
+    EXPECT_EQ(set.load(path), false);
+    write_hrir(path, 32, 4, 2, 32 * 4 * 2 * 2 - 1);
+    EXPECT_EQ(set.load(path), false);
+    EXPECT_EQ(set.length(), 32u);
+    std::remove(path);
+}
+
+int main(){
+    for (size_t size : {4, 8, 64, 256, 1024}) {
+        test_fft(size);
+    }
+    test_matches_direct_convolution();
+    test_lateralization();
+    test_source_removal();
+    test_moving_source_crossfades();
+    test_hrir_load();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
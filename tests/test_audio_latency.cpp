@@ -0,0 +1,101 @@
+#include <cmath>
+#include <iostream>
+#include "../src/audio/audio_latency.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const int RATE = 48000;
+static const size_t BLOCK = 128;
+
+// A producer that pushes `burst` frames every `burst_frames` of wall
+// clock, running `skew` fast, against a device taking 128-frame blocks on
+// its own clock
+struct Simulation {
+    AudioLatencyController controller;
+    double queued = 0;
+    double produced_at = 0;     // wall-clock frame of the next burst
+    size_t burst = 800;
+    double skew = 0.0;
+    uint64_t late_underruns = 0;   // after `settle_seconds`
+    double max_queued = 0;
+
+    void run(double seconds, double settle_seconds, bool producing = true) {
+        const size_t blocks = static_cast<size_t>(seconds * RATE / BLOCK);
+        const double start = produced_at;
+        double now = start;
+        for (size_t b = 0; b < blocks; ++b) {
+            now += BLOCK;
+            while (producing && produced_at <= now) {
+                queued += burst;
+                produced_at += burst / (1.0 + skew);
+            }
+            max_queued = std::max(max_queued, queued);
+            if (!controller.update(static_cast<size_t>(queued), BLOCK)) continue;
+            double needed = BLOCK * controller.stretch();
+            if (queued < needed) {
+                queued = 0;
+                controller.underrun();
+                if (now - start > settle_seconds * RATE) ++late_underruns;
+            } else {
+                queued -= needed;
+            }
+        }
+        if (!producing) produced_at = now;
+    }
+};
+
+// A producer 0.3% fast is absorbed by stretching, not by growing latency
+static void test_clock_drift() {
+    Simulation sim;
+    sim.controller.configure(RATE, 20, 150);
+    sim.skew = 0.003;
+    sim.run(120.0, 5.0);
+    EXPECT_EQ(sim.late_underruns, 0u);
+    EXPECT_EQ(std::abs(sim.controller.stretch() - 1.003) < 0.001, true);
+    EXPECT_EQ(sim.max_queued < 150.0 * RATE / 1000, true);
+}
+
+// 50 ms bursts starve a 20 ms target. The ring swings half a burst either
+// side of its mean, so the target climbs past 25 ms and then holds without
+// further underruns.
+static void test_bursty_producer() {
+    Simulation sim;
+    sim.controller.configure(RATE, 20, 150);
+    sim.burst = 2400;
+    sim.run(60.0, 20.0);
+    EXPECT_EQ(sim.controller.underruns() > 0, true);
+    EXPECT_EQ(sim.late_underruns, 0u);
+    double target_ms = 1000.0 * sim.controller.target_frames() / RATE;
+    EXPECT_EQ(target_ms > 25.0 && target_ms <= 60.0, true);
+    EXPECT_EQ(std::abs(sim.controller.stretch() - 1.0) <= AudioLatencyController::MAX_STRETCH, true);
+}
+
+// A stalled producer costs one underrun, not one per block, and playback
+// waits for the ring to refill to the target before resuming
+static void test_stall() {
+    Simulation sim;
+    sim.controller.configure(RATE, 20, 150);
+    sim.run(5.0, 0.0);
+    uint64_t before = sim.controller.underruns();
+    sim.run(1.0, 0.0, false);
+    EXPECT_EQ(sim.controller.underruns(), before + 1);
+    EXPECT_EQ(sim.controller.update(0, BLOCK), false);
+    EXPECT_EQ(sim.controller.update(sim.controller.target_frames(), BLOCK), true);
+}
+
+int main(){
+    test_clock_drift();
+    test_bursty_producer();
+    test_stall();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../src/audio/audio_ring.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+// Fill, drain and wrap on one thread
+static void test_single_thread() {
+    AudioRingBuffer ring(6, 2);
+    EXPECT_EQ(ring.capacity(), 8u);
+
+    float in[20];
+    for (int i = 0; i < 20; ++i) in[i] = float(i);
+    EXPECT_EQ(ring.write(in, 10), 8u);            // clipped to capacity
+    EXPECT_EQ(ring.read_available(), 8u);
+    EXPECT_EQ(ring.write_available(), 0u);
+
+    float out[20] = {};
+    EXPECT_EQ(ring.read(out, 5), 5u);
+    EXPECT_EQ(out[9], 9.0f);
+    EXPECT_EQ(ring.write(in, 5), 5u);             // wraps
+    AudioRingBuffer::Region r = ring.prepare_read(8);
+    EXPECT_EQ(r.first_frames, 3u);
+    EXPECT_EQ(r.second_frames, 5u);
+    EXPECT_EQ(r.first[0], 10.0f);
+    EXPECT_EQ(r.second[9], 9.0f);
+    ring.commit_read(r.frames());
+    EXPECT_EQ(ring.read_available(), 0u);
+}
+
+// A producer pushing odd-sized blocks and a consumer draining fixed periods
+// must see every frame exactly once, in order
+static void test_two_threads() {
+    constexpr uint64_t TOTAL_FRAMES = 4000000;
+    constexpr size_t PERIOD = 256;
+    AudioRingBuffer ring(1024, 2);
+
+    std::thread producer([&] {
+        uint64_t next = 0;
+        size_t block = 1;
+        while (next < TOTAL_FRAMES) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(block, TOTAL_FRAMES - next));
+            AudioRingBuffer::Region r = ring.prepare_write(want);
+            if (r.frames() == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < r.frames(); ++i) {
+                float* frame = i < r.first_frames ? r.first + i * 2 : r.second + (i - r.first_frames) * 2;
+                frame[0] = static_cast<float>(next & 0xFFFFF);
+                frame[1] = -frame[0];
+                ++next;
+            }
+            ring.commit_write(r.frames());
+            block = block % 509 + 1;
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t errors = 0;
+    while (expected < TOTAL_FRAMES) {
+        uint32_t seen = ring.data_signal();
+        size_t want = static_cast<size_t>(std::min<uint64_t>(PERIOD, TOTAL_FRAMES - expected));
+        if (ring.read_available() < want) {
+            ring.wait_for_data(seen);
+            continue;
+        }
+        AudioRingBuffer::Region r = ring.prepare_read(want);
+        for (size_t i = 0; i < r.frames(); ++i) {
+            const float* frame = i < r.first_frames ? r.first + i * 2 : r.second + (i - r.first_frames) * 2;
+            if (frame[0] != static_cast<float>(expected & 0xFFFFF) || frame[1] != -frame[0]) ++errors;
+            ++expected;
+        }
+        ring.commit_read(r.frames());
+    }
+    producer.join();
+
+    EXPECT_EQ(errors, 0u);
+    EXPECT_EQ(expected, TOTAL_FRAMES);
+    EXPECT_EQ(ring.read_available(), 0u);
+}
+
+int main(){
+    test_single_thread();
+    test_two_threads();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
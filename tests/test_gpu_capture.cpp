@@ -0,0 +1,212 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../src/gpu/gpu_capture.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+// Offsets into the file header
+static const size_t VERSION_OFFSET = 8;
+static const size_t STATE_COUNT_OFFSET = 20;
+
+static std::string capture_path(const char* name) {
+    return "/tmp/psx5_gpu_capture_" + std::string(name) + "_" + std::to_string(getpid()) + ".cap";
+}
+
+static std::vector<uint8_t> read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string& path, const std::vector<uint8_t>& data, size_t size) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(size));
+}
+
+template <typename T>
+static void poke(std::vector<uint8_t>& data, size_t offset, T value) {
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+// A small frame with every kind of record: ranges that end in a partial
+// page, mix zero and non-zero pages, and sit in both memory spaces
+static GPUCapture make_capture() {
+    GPUCapture capture;
+    capture.frame_number = 1234;
+    for (int i = 0; i < 300; ++i) capture.state.push_back(static_cast<uint8_t>(i * 7));
+
+    GPUCapture::Shader shader{};
+    shader.id = 5;
+    shader.shader_type = 2;
+    shader.resource_usage = 0x13;
+    shader.constant_buffer_size = 256;
+    shader.bytecode = {1, 2, 3, 4};
+    shader.spirv = {0x07230203, 0x10000, 0, 9, 0};
+    shader.texture_bindings = {0, 1};
+    shader.buffer_bindings = {7};
+    capture.shaders.push_back(shader);
+    capture.shaders.push_back(GPUCapture::Shader{9, 0, 0, 0, {}, {}, {}, {}, {}});
+
+    GPUCapture::MemoryRange gpu{GPUCapture::SPACE_GPU, 0x100000, std::vector<uint8_t>(3 * GPUCapture::PAGE_SIZE + 100)};
+    for (size_t i = 0; i < GPUCapture::PAGE_SIZE; ++i) gpu.data[i] = static_cast<uint8_t>(i);
+    gpu.data[3 * GPUCapture::PAGE_SIZE + 99] = 0xAB;   // page 1 and 2 stay zero
+    capture.memory.push_back(gpu);
+    capture.memory.push_back({GPUCapture::SPACE_GUEST, 0x400000, std::vector<uint8_t>(64, 0x5A)});
+    capture.memory.push_back({GPUCapture::SPACE_GPU, 0x800000, std::vector<uint8_t>(GPUCapture::PAGE_SIZE)});
+
+    capture.commands.push_back({0x10, 1, 2, 3, 4});
+    capture.commands.push_back({0x50, 0x100000, 0x200000, 4096, 0});
+    return capture;
+}
+
+static bool same_shader(const GPUCapture::Shader& a, const GPUCapture::Shader& b) {
+    return a.id == b.id && a.shader_type == b.shader_type && a.resource_usage == b.resource_usage &&
+           a.constant_buffer_size == b.constant_buffer_size && a.bytecode == b.bytecode && a.spirv == b.spirv &&
+           a.texture_bindings == b.texture_bindings && a.sampler_bindings == b.sampler_bindings &&
+           a.buffer_bindings == b.buffer_bindings;
+}
+
+// Everything saved comes back, zero pages included, and the zero pages
+// take no room in the file
+static void test_round_trip() {
+    std::string path = capture_path("round_trip");
+    GPUCapture saved = make_capture();
+    EXPECT_EQ(saved.save(path), true);
+
+    GPUCapture loaded;
+    EXPECT_EQ(loaded.load(path), true);
+    EXPECT_EQ(loaded.frame_number, 1234u);
+    EXPECT_EQ(loaded.state == saved.state, true);
+    EXPECT_EQ(loaded.shaders.size(), 2u);
+    if (loaded.shaders.size() == 2) {
+        EXPECT_EQ(same_shader(loaded.shaders[0], saved.shaders[0]), true);
+        EXPECT_EQ(same_shader(loaded.shaders[1], saved.shaders[1]), true);
+    }
+    EXPECT_EQ(loaded.memory.size(), 3u);
+    for (size_t i = 0; i < loaded.memory.size() && i < saved.memory.size(); ++i) {
+        EXPECT_EQ(loaded.memory[i].space, saved.memory[i].space);
+        EXPECT_EQ(loaded.memory[i].address, saved.memory[i].address);
+        EXPECT_EQ(loaded.memory[i].data == saved.memory[i].data, true);
+    }
+    EXPECT_EQ(loaded.commands.size(), 2u);
+    if (loaded.commands.size() == 2) {
+        EXPECT_EQ(loaded.commands[1].opcode, 0x50u);
+        EXPECT_EQ(loaded.commands[1].arg1, 0x200000u);
+        EXPECT_EQ(loaded.commands[1].arg2, 4096u);
+    }
+    EXPECT_EQ(loaded.covers(GPUCapture::SPACE_GUEST, 0x400010, 16), true);
+    EXPECT_EQ(loaded.covers(GPUCapture::SPACE_GPU, 0x400010, 16), false);
+
+    // Two stored pages of the first range, none of the last
+    EXPECT_EQ(read_file(path).size() < 2 * GPUCapture::PAGE_SIZE + 1024, true);
+    std::remove(path.c_str());
+}
+
+// Cutting the file anywhere, header included, fails the load
+static void test_truncated() {
+    std::string path = capture_path("truncated");
+    EXPECT_EQ(make_capture().save(path), true);
+    std::vector<uint8_t> data = read_file(path);
+    size_t accepted = 0;
+    for (size_t size = 0; size < data.size(); ++size) {
+        write_file(path, data, size);
+        GPUCapture capture;
+        accepted += capture.load(path);
+    }
+    EXPECT_EQ(accepted, 0u);
+    std::remove(path.c_str());
+}
+
+// Wrong magic or version, and counts the file cannot hold, are refused
+// before anything is allocated for them
+static void test_bad_headers() {
+    std::string path = capture_path("bad_header");
+    EXPECT_EQ(make_capture().save(path), true);
+    const std::vector<uint8_t> good = read_file(path);
+    GPUCapture capture;
+
+    std::vector<uint8_t> data = good;
+    data[0] = 'X';
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    data = good;
+    poke<uint32_t>(data, VERSION_OFFSET, GPUCapture::VERSION + 1);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    data = good;
+    poke<uint32_t>(data, STATE_COUNT_OFFSET, 0xFFFFFFF0u);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    // Shader count follows the state block
+    const size_t shader_count = STATE_COUNT_OFFSET + sizeof(uint32_t) + 300;
+    data = good;
+    poke<uint32_t>(data, shader_count, 0x7FFFFFFFu);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    // A file holding nothing but a header and huge counts
+    data.assign(good.begin(), good.begin() + STATE_COUNT_OFFSET);
+    data.resize(STATE_COUNT_OFFSET + 8, 0xFF);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    EXPECT_EQ(capture.load(capture_path("missing")), false);
+    write_file(path, good, good.size());
+    EXPECT_EQ(capture.load(path), true);
+    std::remove(path.c_str());
+}
+
+// A range claiming more than all of GPU and user memory, or a page index
+// past the range's end, is corrupt
+static void test_bad_ranges() {
+    std::string path = capture_path("bad_range");
+    GPUCapture small;
+    small.memory.push_back({GPUCapture::SPACE_GPU, 0x1000, std::vector<uint8_t>(100, 1)});
+    EXPECT_EQ(small.save(path), true);
+    const std::vector<uint8_t> good = read_file(path);
+    // Header, empty state, no shaders, range count, then space and address
+    const size_t range_size = STATE_COUNT_OFFSET + 4 + 4 + 4 + 4 + 8;
+    const size_t first_page = range_size + 8 + 4;
+    GPUCapture capture;
+
+    std::vector<uint8_t> data = good;
+    poke<uint64_t>(data, range_size, 1ULL << 40);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    data = good;
+    poke<uint32_t>(data, first_page, 1);
+    write_file(path, data, data.size());
+    EXPECT_EQ(capture.load(path), false);
+
+    write_file(path, good, good.size());
+    EXPECT_EQ(capture.load(path), true);
+    EXPECT_EQ(capture.memory.size() == 1 && capture.memory[0].data == small.memory[0].data, true);
+    std::remove(path.c_str());
+}
+
+int main(){
+    test_round_trip();
+    test_truncated();
+    test_bad_headers();
+    test_bad_ranges();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <vector>
+#include "../src/gpu/gpu_dirty_tracker.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint64_t PAGE = GPUDirtyTracker::PAGE_SIZE;
+
+// Runs are merged across pages and words and clipped to the range
+static void test_collect_runs() {
+    GPUDirtyTracker tracker(1 << 20);
+    tracker.mark(PAGE * 2, PAGE * 3);
+    tracker.mark(PAGE * 63, PAGE * 2);
+    std::vector<GPUDirtyTracker::Range> ranges;
+    uint64_t collected = tracker.collect_and_clear(0, PAGE * 100, ranges);
+    EXPECT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].address, PAGE * 2);
+    EXPECT_EQ(ranges[0].size, PAGE * 3);
+    EXPECT_EQ(ranges[1].address, PAGE * 63);
+    EXPECT_EQ(ranges[1].size, PAGE * 2);
+    EXPECT_EQ(collected, PAGE * 5);
+    EXPECT_EQ(tracker.is_dirty(0, 1 << 20), false);
+}
+
+// Collecting a range that starts and ends mid-page reports those pages but
+// leaves them dirty for whoever owns the rest of them; whole pages inside
+// the range are cleared
+static void test_partial_pages_stay_dirty() {
+    GPUDirtyTracker tracker(1 << 20);
+    tracker.mark(PAGE + 100, 10);       // first page of the range
+    tracker.mark(PAGE * 2 + 5, 10);     // fully inside
+    tracker.mark(PAGE * 3 + 900, 10);   // last page of the range
+    std::vector<GPUDirtyTracker::Range> ranges;
+    uint64_t collected = tracker.collect_and_clear(PAGE + 100, PAGE * 2 + 200, ranges);
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].address, PAGE + 100);
+    EXPECT_EQ(ranges[0].size, PAGE * 2 + 200);
+    EXPECT_EQ(collected, PAGE * 2 + 200);
+    EXPECT_EQ(tracker.is_dirty(PAGE + 50, 1), true);
+    EXPECT_EQ(tracker.is_dirty(PAGE * 2, PAGE), false);
+    EXPECT_EQ(tracker.is_dirty(PAGE * 3 + 900, 1), true);
+
+    // A neighbour sharing the boundary page still sees its write
+    tracker.mark(5000, 1);
+    ranges.clear();
+    tracker.collect_and_clear(4196, 50, ranges);
+    EXPECT_EQ(tracker.is_dirty(5000, 1), true);
+
+    // A range inside one page clears nothing
+    ranges.clear();
+    tracker.collect_and_clear(PAGE * 3 + 8, 16, ranges);
+    EXPECT_EQ(tracker.is_dirty(PAGE * 3, PAGE), true);
+
+    // The neighbour collecting the whole page clears it
+    ranges.clear();
+    tracker.collect_and_clear(PAGE, PAGE, ranges);
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(tracker.is_dirty(PAGE, PAGE), false);
+}
+
+// The last page counts as whole when the range reaches the end of memory
+static void test_end_of_memory() {
+    GPUDirtyTracker tracker(PAGE * 4 + 100);
+    tracker.mark(PAGE * 4, 100);
+    std::vector<GPUDirtyTracker::Range> ranges;
+    tracker.collect_and_clear(PAGE * 4, 1000, ranges);
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].size, 100u);
+    EXPECT_EQ(tracker.is_dirty(0, PAGE * 5), false);
+}
+
+// A consumer of a range that is not page aligned leaves its edge pages
+// dirty, but only writes after its copy are newer than its generation
+static void test_written_since() {
+    const uint64_t group = PAGE * 64;
+    GPUDirtyTracker tracker(group * 16);
+    uint64_t address = group + 100;
+    uint64_t size = 800 * 600 * 4;      // ends mid-page
+    tracker.mark(address, size);
+
+    uint64_t copied = tracker.next_generation();
+    std::vector<GPUDirtyTracker::Range> ranges;
+    tracker.collect_and_clear(address, size, ranges);
+    EXPECT_EQ(tracker.is_dirty(address, size), true);
+    EXPECT_EQ(tracker.written_since(address, size, copied), false);
+
+    // Repeated collections stay clean until something is written
+    EXPECT_EQ(tracker.written_since(address, size, copied), false);
+    tracker.mark(address + size - 1, 1);
+    EXPECT_EQ(tracker.written_since(address, size, copied), true);
+
+    copied = tracker.next_generation();
+    EXPECT_EQ(tracker.written_since(address, size, copied), false);
+    // Pages outside the range do not count, even next to it
+    tracker.mark(address - 200, 16);
+    tracker.mark(address + size + PAGE, 16);
+    EXPECT_EQ(tracker.written_since(address, size, copied), false);
+
+    // Written pages are reported as runs clipped to the range
+    tracker.mark(address + PAGE * 10, PAGE * 2);
+    tracker.mark(address + size - 1, 1);
+    tracker.collect_and_clear(address, size, ranges);
+    ranges.clear();
+    tracker.collect_written_since(address, size, copied, ranges);
+    EXPECT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].address, group + PAGE * 10);
+    EXPECT_EQ(ranges[0].size, PAGE * 3);
+    EXPECT_EQ(ranges[1].address, (address + size - 1) & ~(PAGE - 1));
+    EXPECT_EQ(ranges[1].address + ranges[1].size, address + size);
+
+    tracker.mark_all();
+    EXPECT_EQ(tracker.written_since(0, PAGE, copied), true);
+}
+
+int main(){
+    test_collect_runs();
+    test_partial_pages_stay_dirty();
+    test_end_of_memory();
+    test_written_since();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
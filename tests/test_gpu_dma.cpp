@@ -0,0 +1,127 @@
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "../src/core/scheduler.h"
+#include "../src/gpu/gpu_dma.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint32_t PATTERN = 0x44332211;
+
+// Byte i of a fill starting at dst holds byte (i % 4) of the pattern
+static bool filled(const uint8_t* dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (dst[i] != static_cast<uint8_t>(PATTERN >> (i % 4 * 8))) return false;
+    }
+    return true;
+}
+
+// Fills keep the pattern phase at every size and misalignment, including
+// the streamed and split paths, and stay inside their range
+static void test_fill_phase(GPUDMAEngine& dma) {
+    const size_t sizes[] = {1, 3, 63, 4096 + 5, GPUDMAEngine::NON_TEMPORAL_THRESHOLD + 17,
+                            GPUDMAEngine::PARALLEL_THRESHOLD + 4099};
+    for (size_t size : sizes) {
+        for (size_t offset : {0, 1, 2, 3, 7, 13}) {
+            std::vector<uint8_t> buffer(size + 64, 0xEE);
+            dma.fill(buffer.data() + offset, PATTERN, size);
+            bool guards = true;
+            for (size_t i = 0; i < offset; ++i) guards = guards && buffer[i] == 0xEE;
+            for (size_t i = offset + size; i < buffer.size(); ++i) guards = guards && buffer[i] == 0xEE;
+            EXPECT_EQ(filled(buffer.data() + offset, size), true);
+            EXPECT_EQ(guards, true);
+        }
+    }
+}
+
+// Copies whose ranges overlap in either direction behave like memmove
+static void test_overlapping_copy(GPUDMAEngine& dma) {
+    const size_t sizes[] = {100, 4096, GPUDMAEngine::NON_TEMPORAL_THRESHOLD + 5, GPUDMAEngine::PARALLEL_THRESHOLD + 3};
+    for (size_t size : sizes) {
+        for (long shift : {-37L, 37L, -4096L, 4096L}) {
+            std::vector<uint8_t> buffer(size + 8192), expected;
+            for (size_t i = 0; i < buffer.size(); ++i) buffer[i] = static_cast<uint8_t>(i * 13 + i / 251);
+            expected = buffer;
+            uint8_t* src = buffer.data() + 4096;
+            std::memmove(expected.data() + 4096 + shift, expected.data() + 4096, size);
+            dma.copy(src + shift, src, size);
+            EXPECT_EQ(buffer == expected, true);
+        }
+    }
+}
+
+// Async transfers of mixed sizes finish out of order on the workers, but
+// completed_fence() only passes a fence once it and every earlier one are
+// done, so whatever it reports is already visible. wait_idle() (what an
+// end-of-pipe event waits on) leaves nothing in flight.
+static void test_fence_order(GPUDMAEngine& dma) {
+    const size_t count = 24;
+    std::vector<std::vector<uint8_t>> buffers(count);
+    std::vector<uint64_t> fences(count);
+    std::vector<uint8_t> source(GPUDMAEngine::PARALLEL_THRESHOLD * 2);
+    for (size_t i = 0; i < source.size(); ++i) source[i] = static_cast<uint8_t>(i * 7);
+    for (size_t i = 0; i < count; ++i) {
+        // Large and small transfers alternate so later fences can finish first
+        size_t size = i % 3 == 0 ? source.size() : 4096 + i;
+        buffers[i].assign(size, 0);
+        fences[i] = i % 2 ? dma.copy_async(buffers[i].data(), source.data(), size)
+                          : dma.fill_async(buffers[i].data(), PATTERN, size);
+        if (i) EXPECT_EQ(fences[i], fences[i - 1] + 1);
+    }
+    EXPECT_EQ(dma.submitted_fence(), fences.back());
+
+    bool visible = true, monotonic = true;
+    uint64_t last = 0;
+    while (last < fences.back()) {
+        uint64_t completed = dma.completed_fence();
+        monotonic = monotonic && completed >= last;
+        for (size_t i = 0; i < count && fences[i] <= completed; ++i) {
+            bool ok = i % 2 ? std::memcmp(buffers[i].data(), source.data(), buffers[i].size()) == 0
+                            : filled(buffers[i].data(), buffers[i].size());
+            visible = visible && ok;
+        }
+        last = completed;
+    }
+    EXPECT_EQ(visible, true);
+    EXPECT_EQ(monotonic, true);
+
+    uint64_t fence = dma.fill_async(buffers[1].data(), PATTERN, buffers[1].size());
+    dma.wait_fence(fence);
+    EXPECT_EQ(dma.is_fence_complete(fence), true);
+    EXPECT_EQ(filled(buffers[1].data(), buffers[1].size()), true);
+    dma.copy_async(buffers[0].data(), source.data(), buffers[0].size());
+    dma.wait_idle();
+    EXPECT_EQ(dma.completed_fence(), dma.submitted_fence());
+    EXPECT_EQ(std::memcmp(buffers[0].data(), source.data(), buffers[0].size()), 0);
+}
+
+int main(){
+    {
+        GPUDMAEngine dma;
+        test_fill_phase(dma);
+        test_overlapping_copy(dma);
+        test_fence_order(dma);
+    }
+    Scheduler scheduler;
+    scheduler.initialize(4);
+    {
+        GPUDMAEngine dma;
+        dma.set_scheduler(&scheduler);
+        test_fill_phase(dma);
+        test_overlapping_copy(dma);
+        test_fence_order(dma);
+        EXPECT_EQ(dma.get_stats().parallel_transfers > 0, true);
+    }
+    scheduler.shutdown();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../src/core/logger.h"
+#include "../src/gpu/gpu_event_log.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint32_t BURST = GPUEventLog::RATE_LIMIT_PER_SECOND + 15;
+
+static std::string trace_path() {
+    return "/tmp/psx5_gpu_event_log_test_" + std::to_string(getpid()) + ".bin";
+}
+
+static std::vector<GPUEventRecord> read_trace(const std::string& path) {
+    std::vector<GPUEventRecord> records;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return records;
+    GPUTraceHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "PSX5GEVT", 8) == 0) {
+        GPUEventRecord rec;
+        while (std::fread(&rec, sizeof(rec), 1, file) == 1) records.push_back(rec);
+    }
+    std::fclose(file);
+    return records;
+}
+
+// Summaries of one event type's suppressed counts
+static std::vector<GPUEventRecord> summaries(const std::vector<GPUEventRecord>& records, GPUEvent event) {
+    std::vector<GPUEventRecord> found;
+    for (const auto& rec : records) {
+        if (rec.event == static_cast<uint16_t>(GPUEvent::Suppressed) && rec.args[0] == static_cast<uint64_t>(event)) {
+            found.push_back(rec);
+        }
+    }
+    return found;
+}
+
+static void burst(GPUEventLog& log, GPUEvent event) {
+    for (uint32_t i = 0; i < BURST; ++i) log.record(GPULogLevel::Warn, event, i);
+}
+
+// The last burst of a type has no later event to report it; flush() does
+static void test_flush_reports_last_burst() {
+    std::string path = trace_path();
+    GPUEventLog log;
+    EXPECT_EQ(log.start_trace(path), true);
+    burst(log, GPUEvent::UnknownOpcode);
+    log.flush();
+    EXPECT_EQ(log.get_stats().suppressed, 15u);
+    log.stop_trace();
+
+    std::vector<GPUEventRecord> found = summaries(read_trace(path), GPUEvent::UnknownOpcode);
+    EXPECT_EQ(found.size(), 1u);
+    if (!found.empty()) EXPECT_EQ(found[0].args[1], 15u);
+    std::remove(path.c_str());
+}
+
+// Nor is it lost when the log goes away without a flush
+static void test_destructor_reports_last_burst() {
+    std::string path = trace_path();
+    {
+        GPUEventLog log;
+        EXPECT_EQ(log.start_trace(path), true);
+        burst(log, GPUEvent::DMARangeError);
+    }
+    std::vector<GPUEventRecord> found = summaries(read_trace(path), GPUEvent::DMARangeError);
+    EXPECT_EQ(found.size(), 1u);
+    if (!found.empty()) EXPECT_EQ(found[0].args[1], 15u);
+    std::remove(path.c_str());
+}
+
+// Once the window ends the writer reports the burst on its own timer, well
+// before anything flushes
+static void test_window_expiry_reports_burst() {
+    std::string path = trace_path();
+    GPUEventLog log;
+    EXPECT_EQ(log.start_trace(path), true);
+    burst(log, GPUEvent::WaitTimeout);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+    log.stop_trace();
+
+    std::vector<GPUEventRecord> records = read_trace(path);
+    std::vector<GPUEventRecord> found = summaries(records, GPUEvent::WaitTimeout);
+    EXPECT_EQ(found.size(), 1u);
+    if (!found.empty() && !records.empty()) {
+        EXPECT_EQ(found[0].args[1], 15u);
+        uint64_t after_ms = (found[0].timestamp_ns - records[0].timestamp_ns) / 1000000;
+        EXPECT_EQ(after_ms >= 1000 && after_ms < 2000, true);
+    }
+    std::remove(path.c_str());
+}
+
+int main(){
+    // The summaries are also written as text; keep them out of the output
+    log::set_level(log::Level::Fatal);
+    test_flush_reports_last_burst();
+    test_destructor_reports_last_burst();
+    test_window_expiry_reports_burst();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/gpu/gpu_frame_dump.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+namespace fs = std::filesystem;
+
+// Opcodes seen by decode_qoi: index, diff, luma, run, rgb, rgba
+static int op_counts[6];
+
+static uint32_t get_u32_be(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+// Reference decoder following the QOI specification; returns packed RGBA8
+static bool decode_qoi(const std::vector<uint8_t>& data, uint32_t& width, uint32_t& height,
+                       std::vector<uint8_t>& pixels) {
+    static const uint8_t END[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    if (data.size() < 22 || data[0] != 'q' || data[1] != 'o' || data[2] != 'i' || data[3] != 'f') return false;
+    width = get_u32_be(&data[4]);
+    height = get_u32_be(&data[8]);
+    if (data[12] != 4) return false;
+
+    uint8_t index[64][4] = {};
+    uint8_t px[4] = {0, 0, 0, 255};
+    size_t pos = 14;
+    size_t end = data.size() - 8;
+    int run = 0;
+    pixels.clear();
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+        if (run > 0) {
+            run--;
+        } else {
+            if (pos >= end) return false;
+            uint8_t op = data[pos++];
+            if (op == 0xfe) {
+                px[0] = data[pos]; px[1] = data[pos + 1]; px[2] = data[pos + 2];
+                pos += 3;
+                op_counts[4]++;
+            } else if (op == 0xff) {
+                px[0] = data[pos]; px[1] = data[pos + 1]; px[2] = data[pos + 2]; px[3] = data[pos + 3];
+                pos += 4;
+                op_counts[5]++;
+            } else if ((op & 0xc0) == 0x00) {
+                for (int c = 0; c < 4; ++c) px[c] = index[op][c];
+                op_counts[0]++;
+            } else if ((op & 0xc0) == 0x40) {
+                px[0] = static_cast<uint8_t>(px[0] + ((op >> 4) & 3) - 2);
+                px[1] = static_cast<uint8_t>(px[1] + ((op >> 2) & 3) - 2);
+                px[2] = static_cast<uint8_t>(px[2] + (op & 3) - 2);
+                op_counts[1]++;
+            } else if ((op & 0xc0) == 0x80) {
+                int dg = (op & 0x3f) - 32;
+                uint8_t second = data[pos++];
+                px[0] = static_cast<uint8_t>(px[0] + dg - 8 + (second >> 4));
+                px[1] = static_cast<uint8_t>(px[1] + dg);
+                px[2] = static_cast<uint8_t>(px[2] + dg - 8 + (second & 0x0f));
+                op_counts[2]++;
+            } else {
+                run = op & 0x3f;
+                op_counts[3]++;
+            }
+            uint32_t hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+            for (int c = 0; c < 4; ++c) index[hash][c] = px[c];
+        }
+        pixels.insert(pixels.end(), px, px + 4);
+    }
+    return pos == end && std::equal(END, END + 8, data.begin() + end);
+}
+
+// Pixels chosen to need every opcode, in rows padded past width * 4
+static void test_qoi_round_trip() {
+    const uint32_t width = 8, height = 6, pitch = width * 4 + 12;
+    std::vector<uint8_t> image(static_cast<size_t>(pitch) * height, 0xab);
+    auto set = [&](uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        uint8_t* p = &image[static_cast<size_t>(y) * pitch + x * 4];
+        p[0] = r; p[1] = g; p[2] = b; p[3] = a;
+    };
+    set(0, 0, 0, 0, 0, 255);        // run from the initial pixel
+    set(1, 0, 0, 0, 0, 255);
+    set(2, 0, 1, 1, 0, 255);        // diff
+    set(3, 0, 25, 20, 15, 255);     // luma
+    set(4, 0, 200, 50, 100, 255);   // rgb
+    set(5, 0, 200, 50, 100, 128);   // rgba
+    set(6, 0, 1, 1, 0, 255);        // index
+    set(7, 0, 25, 20, 15, 255);     // index
+    std::mt19937 rng(9);
+    for (uint32_t y = 1; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            // A long run across rows, then noise
+            if (y < 3) set(x, y, 7, 7, 7, 255);
+            else set(x, y, static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 255);
+        }
+    }
+
+    std::vector<uint8_t> encoded;
+    GPUFrameDumper::encode_qoi(image.data(), width, height, pitch, encoded);
+    uint32_t decoded_width = 0, decoded_height = 0;
+    std::vector<uint8_t> decoded;
+    std::fill(op_counts, op_counts + 6, 0);
+    EXPECT_EQ(decode_qoi(encoded, decoded_width, decoded_height, decoded), true);
+    EXPECT_EQ(decoded_width, width);
+    EXPECT_EQ(decoded_height, height);
+    for (int op = 0; op < 6; ++op) {
+        EXPECT_EQ(op_counts[op] > 0, true);
+    }
+
+    bool same = decoded.size() == static_cast<size_t>(width) * height * 4;
+    for (uint32_t y = 0; same && y < height; ++y) {
+        same = std::equal(image.begin() + y * pitch, image.begin() + y * pitch + width * 4,
+                          decoded.begin() + y * width * 4);
+    }
+    EXPECT_EQ(same, true);
+}
+
+static GPUPresentFrame make_frame(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height,
+                                  uint64_t frame_number) {
+    GPUPresentFrame frame{};
+    frame.pixels = pixels.data();
+    frame.width = width;
+    frame.height = height;
+    frame.pitch = width * 4;
+    frame.frame_number = frame_number;
+    return frame;
+}
+
+// Only frames numbered 0, N, 2N, ... are written
+static void test_interval() {
+    fs::path dir = fs::temp_directory_path() / "psx5_frame_dump_interval";
+    fs::remove_all(dir);
+    GPUFrameDumper::Config config;
+    config.directory = dir.string();
+    config.interval = 3;
+    GPUFrameDumper dumper(config);
+    EXPECT_EQ(dumper.open(), true);
+
+    std::vector<uint8_t> pixels(4 * 4 * 4, 0x40);
+    for (uint64_t n = 0; n < 8; ++n) {
+        EXPECT_EQ(dumper.present(make_frame(pixels, 4, 4, n)), true);
+    }
+    dumper.close();
+
+    GPUFrameDumper::Stats stats = dumper.get_stats();
+    EXPECT_EQ(stats.frames, 8u);
+    EXPECT_EQ(stats.dumped, 3u);
+    EXPECT_EQ(fs::exists(dir / "frame_000000.qoi"), true);
+    EXPECT_EQ(fs::exists(dir / "frame_000003.qoi"), true);
+    EXPECT_EQ(fs::exists(dir / "frame_000006.qoi"), true);
+    EXPECT_EQ(fs::exists(dir / "frame_000001.qoi"), false);
+    size_t files = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) files += entry.is_regular_file();
+    EXPECT_EQ(files, 3u);
+    fs::remove_all(dir);
+}
+
+// The raw stream appends frames until the resolution changes, then starts
+// a file named after the new size
+static void test_raw_resolution_change() {
+    fs::path dir = fs::temp_directory_path() / "psx5_frame_dump_raw";
+    fs::remove_all(dir);
+    GPUFrameDumper::Config config;
+    config.directory = dir.string();
+    config.format = GPUFrameDumper::Format::Raw;
+    GPUFrameDumper dumper(config);
+    EXPECT_EQ(dumper.open(), true);
+
+    std::vector<uint8_t> small(4 * 2 * 4, 1), large(8 * 4 * 4, 2);
+    EXPECT_EQ(dumper.present(make_frame(small, 4, 2, 0)), true);
+    EXPECT_EQ(dumper.present(make_frame(small, 4, 2, 1)), true);
+    EXPECT_EQ(dumper.present(make_frame(large, 8, 4, 2)), true);
+    EXPECT_EQ(dumper.present(make_frame(large, 8, 4, 3)), true);
+    EXPECT_EQ(dumper.present(make_frame(large, 8, 4, 4)), true);
+    dumper.close();
+
+    fs::path first = dir / "frames_000000_4x2.rgba";
+    fs::path second = dir / "frames_000002_8x4.rgba";
+    EXPECT_EQ(fs::exists(first), true);
+    EXPECT_EQ(fs::exists(second), true);
+    if (fs::exists(first) && fs::exists(second)) {
+        EXPECT_EQ(fs::file_size(first), 2u * small.size());
+        EXPECT_EQ(fs::file_size(second), 3u * large.size());
+    }
+    EXPECT_EQ(dumper.get_stats().bytes_written, 2u * small.size() + 3u * large.size());
+    fs::remove_all(dir);
+}
+
+int main(){
+    test_qoi_round_trip();
+    test_interval();
+    test_raw_resolution_change();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
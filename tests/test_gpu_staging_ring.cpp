@@ -0,0 +1,105 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/gpu/gpu_staging_ring.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint64_t RING = 1024;
+
+// Spans are aligned, run up to the end and wrap to the start once the
+// oldest ones are released
+static void test_wrap() {
+    GPUStagingRing ring(RING);
+    uint64_t offset = ~0ULL;
+    EXPECT_EQ(ring.allocate(100, 1, offset), true);
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.allocate(100, 1, offset), true);
+    EXPECT_EQ(offset, 112u);
+    EXPECT_EQ(ring.allocate(800, 2, offset), true);
+    EXPECT_EQ(offset, 224u);
+    EXPECT_EQ(ring.allocate(1, 3, offset), false);
+
+    ring.release(1);
+    EXPECT_EQ(ring.oldest_value(), 2u);
+    EXPECT_EQ(ring.allocate(225, 3, offset), false);
+    EXPECT_EQ(ring.allocate(224, 3, offset), true);
+    EXPECT_EQ(offset, 0u);
+    ring.release(3);
+    EXPECT_EQ(ring.empty(), true);
+    EXPECT_EQ(ring.allocate(RING, 4, offset), true);
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.allocate(RING + 1, 5, offset), false);
+}
+
+// Wrapped, with the newest span ending a few bytes short of the oldest:
+// rounding its end up reaches the oldest span, so nothing fits in between
+// and the space past the oldest span is still in use
+static void test_wrapped_head_rounds_onto_tail() {
+    GPUStagingRing ring(RING);
+    uint64_t offset;
+    EXPECT_EQ(ring.allocate(512, 1, offset), true);
+    EXPECT_EQ(ring.allocate(256, 2, offset), true);
+    EXPECT_EQ(offset, 512u);
+    EXPECT_EQ(ring.allocate(256, 3, offset), true);
+    EXPECT_EQ(offset, 768u);
+    ring.release(1);
+    EXPECT_EQ(ring.allocate(504, 4, offset), true);   // ends 8 below the oldest span
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.allocate(1, 5, offset), false);
+    EXPECT_EQ(ring.allocate(256, 5, offset), false);
+
+    // Once the tail moves on, the gap opens up again
+    ring.release(2);
+    EXPECT_EQ(ring.allocate(250, 5, offset), true);
+    EXPECT_EQ(offset, 512u);
+}
+
+// Random sizes and releases never hand out bytes of a span still in use
+static void test_no_overlap() {
+    GPUStagingRing ring(RING);
+    std::mt19937 rng(11);
+    std::vector<uint64_t> owner(RING, 0);   // value + 1 of the span using each byte
+    uint64_t value = 1, completed = 0;
+    bool ok = true;
+    for (int i = 0; i < 20000 && ok; ++i) {
+        if (rng() % 3 == 0 && completed + 1 < value) {
+            completed += 1 + rng() % (value - 1 - completed);
+            ring.release(completed);
+            for (auto& byte : owner) {
+                if (byte && byte - 1 <= completed) byte = 0;
+            }
+        }
+        uint64_t size = 1 + rng() % 200;
+        uint64_t offset;
+        if (!ring.allocate(size, value, offset)) {
+            if (ring.empty()) ok = false;
+            ++value;
+            continue;
+        }
+        ok = ok && offset % GPUStagingRing::ALIGNMENT == 0 && offset + size <= RING;
+        for (uint64_t b = offset; ok && b < offset + size; ++b) {
+            ok = owner[b] == 0;
+            owner[b] = value + 1;
+        }
+        if (rng() % 4 == 0) ++value;
+    }
+    EXPECT_EQ(ok, true);
+}
+
+int main(){
+    test_wrap();
+    test_wrapped_head_rounds_onto_tail();
+    test_no_overlap();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../src/io/ssd_cache.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+// Block contents follow from the LBA, so a block served for the wrong key
+// or torn by a concurrent insert shows up in any byte
+static std::vector<uint8_t> block_data(uint64_t lba, size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<uint8_t>(lba * 31 + i * 7);
+    return data;
+}
+
+static void insert(SSDBlockCache& cache, uint64_t lba, size_t size, bool read_ahead = false) {
+    std::vector<uint8_t> data = block_data(lba, size);
+    cache.insert(lba, static_cast<uint32_t>(size / 2), data.data(), size, cache.generation(), read_ahead);
+}
+
+// Hits copy the block and count what they saved; a request whose sizes do
+// not match the cached frame is a miss
+static void test_lookup() {
+    SSDBlockCache cache;
+    std::vector<uint8_t> output(4000);
+    EXPECT_EQ(cache.lookup(10, 2000, output.data(), 4000), false);
+    insert(cache, 10, 4000);
+    EXPECT_EQ(cache.lookup(10, 2000, output.data(), 4000), true);
+    EXPECT_EQ(output == block_data(10, 4000), true);
+    EXPECT_EQ(cache.lookup(10, 2001, output.data(), 4000), false);
+    EXPECT_EQ(cache.lookup(10, 2000, output.data(), 3999), false);
+    uint32_t compressed = 0;
+    EXPECT_EQ(cache.contains(10, &compressed) && compressed == 2000, true);
+
+    SSDBlockCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.hit_bytes, 4000u);
+    EXPECT_EQ(stats.bytes_saved, 2000u);
+    EXPECT_EQ(stats.blocks, 1u);
+    EXPECT_EQ(stats.bytes, 4000u);
+}
+
+// One shard of four blocks: the hand clears every bit on its first pass and
+// evicts the first block then; a block hit since survives the next sweep
+static void test_clock_eviction() {
+    SSDBlockCache::Config config;
+    config.capacity = 4000;
+    config.shards = 1;
+    SSDBlockCache cache(config);
+    for (uint64_t lba : {1, 2, 3, 4}) insert(cache, lba, 1000);
+    insert(cache, 5, 1000);
+    EXPECT_EQ(cache.contains(1), false);
+
+    std::vector<uint8_t> output(1000);
+    EXPECT_EQ(cache.lookup(2, 500, output.data(), 1000), true);
+    insert(cache, 6, 1000);
+    EXPECT_EQ(cache.contains(2), true);
+    EXPECT_EQ(cache.contains(3), false);
+    EXPECT_EQ(cache.contains(4) && cache.contains(5) && cache.contains(6), true);
+
+    // Too big for a shard: not cached and nothing evicted for it
+    insert(cache, 7, 5000);
+    SSDBlockCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(cache.contains(7), false);
+    EXPECT_EQ(stats.evictions, 2u);
+    EXPECT_EQ(stats.blocks, 4u);
+    EXPECT_EQ(stats.bytes, 4000u);
+}
+
+// Writes drop the blocks whose sectors they overlap, and an insert read
+// before a write is refused afterwards
+static void test_invalidate() {
+    SSDBlockCache cache;
+    insert(cache, 100, 4000);   // 2000 compressed bytes: sectors 100-103
+    insert(cache, 104, 4000);
+    cache.invalidate(90, 10);
+    EXPECT_EQ(cache.contains(100), true);
+    cache.invalidate(103, 1);
+    EXPECT_EQ(cache.contains(100), false);
+    EXPECT_EQ(cache.contains(104), true);
+
+    uint64_t generation = cache.generation();
+    cache.invalidate(5000, 1);
+    std::vector<uint8_t> data = block_data(200, 1000);
+    cache.insert(200, 500, data.data(), data.size(), generation);
+    EXPECT_EQ(cache.contains(200), false);
+
+    cache.clear();
+    SSDBlockCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(stats.invalidations, 1u);
+    EXPECT_EQ(stats.blocks, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+// Read-ahead blocks count once when first hit, or as unused when they go
+// without one
+static void test_read_ahead_counters() {
+    SSDBlockCache::Config config;
+    config.capacity = 3000;
+    config.shards = 1;
+    SSDBlockCache cache(config);
+    insert(cache, 1, 1000, true);
+    insert(cache, 2, 1000, true);
+    insert(cache, 3, 1000, true);
+    std::vector<uint8_t> output(1000);
+    cache.lookup(1, 500, output.data(), 1000);
+    cache.lookup(1, 500, output.data(), 1000);
+    insert(cache, 4, 1000);
+    insert(cache, 5, 1000);
+
+    SSDBlockCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(stats.read_ahead_inserts, 3u);
+    EXPECT_EQ(stats.read_ahead_used, 1u);
+    EXPECT_EQ(stats.read_ahead_unused, 1u);     // block 2; block 1 was used
+    cache.clear();
+    EXPECT_EQ(cache.get_stats().read_ahead_unused, 2u);
+}
+
+// Threads hitting, inserting and invalidating across shards always get
+// intact blocks and the budget holds
+static void test_concurrent() {
+    SSDBlockCache::Config config;
+    config.capacity = 256 * 1024;
+    SSDBlockCache cache(config);
+    std::atomic<int> corrupt{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            std::vector<uint8_t> output(8192);
+            for (int i = 0; i < 20000; ++i) {
+                uint64_t lba = rng() % 512;
+                size_t size = 1024 + lba % 8 * 1024;
+                switch (rng() % 8) {
+                case 0: insert(cache, lba, size); break;
+                case 1: if (t == 0) cache.invalidate(lba, 4); break;
+                default:
+                    if (cache.lookup(lba, static_cast<uint32_t>(size / 2), output.data(), size) &&
+                        std::memcmp(output.data(), block_data(lba, size).data(), size) != 0) {
+                        corrupt++;
+                    }
+                    break;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    SSDBlockCache::Stats stats = cache.get_stats();
+    EXPECT_EQ(corrupt.load(), 0);
+    EXPECT_EQ(stats.bytes <= cache.capacity(), true);
+    EXPECT_EQ(stats.hits > 0 && stats.evictions > 0, true);
+}
+
+int main(){
+    test_lookup();
+    test_clock_eviction();
+    test_invalidate();
+    test_read_ahead_counters();
+    test_concurrent();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../src/core/scheduler.h"
+#include "../src/io/ssd_codec.h"
+#ifdef __unix__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint8_t GUARD = 0xCD;
+static const size_t GUARD_BYTES = 64;
+
+// Block-compressed texture: 8-byte blocks whose endpoints drift slowly and
+// whose index bits repeat across smooth areas and are noise elsewhere
+static std::vector<uint8_t> texture_like(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> data(size);
+    uint16_t c0 = 0x7BEF, c1 = 0x39E7;
+    uint32_t indices = 0;
+    for (size_t i = 0; i < size; ++i) {
+        size_t k = i % 8;
+        if (k == 0) {
+            if (rng() % 4 == 0) {
+                c0 = static_cast<uint16_t>(c0 + rng() % 64 - 32);
+                c1 = static_cast<uint16_t>(c1 + rng() % 64 - 32);
+            }
+            if (rng() % 2) indices = rng();
+        }
+        if (k < 2) data[i] = static_cast<uint8_t>(c0 >> (8 * k));
+        else if (k < 4) data[i] = static_cast<uint8_t>(c1 >> (8 * (k - 2)));
+        else data[i] = static_cast<uint8_t>(indices >> (8 * (k - 4)));
+    }
+    return data;
+}
+
+// Interleaved vertices: position, normal and UV floats on a smooth surface,
+// with a 16-bit index buffer of small deltas after them
+static std::vector<uint8_t> mesh_like(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> data(size);
+    size_t vertex_bytes = size * 3 / 4 / 32 * 32;
+    for (size_t v = 0; v * 32 < vertex_bytes; ++v) {
+        float u = (v % 64) / 64.0f, w = (v / 64) / 64.0f;
+        float attributes[8] = {u, std::sin(u * 6.0f) * std::cos(w * 4.0f), w, 0.0f, 1.0f, 0.0f, u, w};
+        std::memcpy(data.data() + v * 32, attributes, 32);
+    }
+    uint16_t index = 0;
+    for (size_t i = vertex_bytes; i + 1 < size; i += 2) {
+        index = static_cast<uint16_t>(index + rng() % 8);
+        std::memcpy(data.data() + i, &index, 2);
+    }
+    return data;
+}
+
+// Runs of repeats at every distance, short literal runs and noise, so the
+// parse produces every kind of match and overlap
+static std::vector<uint8_t> mixed(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> data;
+    data.reserve(size);
+    while (data.size() < size) {
+        switch (rng() % 5) {
+        case 0: {   // noise
+            for (size_t n = 1 + rng() % 40; n > 0; --n) data.push_back(static_cast<uint8_t>(rng()));
+            break;
+        }
+        case 1: {   // byte run
+            uint8_t b = static_cast<uint8_t>(rng());
+            data.insert(data.end(), 1 + rng() % 300, b);
+            break;
+        }
+        case 2:     // short-period overlapping repeat
+        case 3: {   // far repeat
+            if (data.empty()) break;
+            size_t distance = 1 + rng() % std::min<size_t>(data.size(), rng() % 2 ? 20 : 70000);
+            size_t n = 4 + rng() % 500;
+            for (size_t i = 0; i < n; ++i) data.push_back(data[data.size() - distance]);
+            break;
+        }
+        default: {  // skewed text, good for Huffman
+            for (size_t n = 1 + rng() % 200; n > 0; --n) data.push_back("eeetaoinshrdlu  "[rng() % 16]);
+            break;
+        }
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+// Compresses, decodes into a guarded buffer and checks the bytes and that
+// nothing was written past the end
+static size_t round_trip(SSDCodec& codec, const std::vector<uint8_t>& data, bool& ok) {
+    std::vector<uint8_t> compressed;
+    codec.compress(data.data(), data.size(), compressed);
+    ok = compressed.size() <= SSDCodec::compress_bound(data.size());
+    uint64_t raw_size = 0;
+    ok = ok && SSDCodec::frame_size(compressed.data(), compressed.size(), raw_size) && raw_size == data.size();
+    uint64_t frame_bytes = 0;
+    ok = ok && SSDCodec::frame_bytes(compressed.data(), compressed.size(), frame_bytes) &&
+         frame_bytes == compressed.size();
+
+    std::vector<uint8_t> output(data.size() + GUARD_BYTES, GUARD);
+    ok = ok && SSDCodec::decompress(compressed.data(), compressed.size(), output.data(), data.size());
+    ok = ok && std::equal(data.begin(), data.end(), output.begin());
+    for (size_t i = data.size(); i < output.size(); ++i) ok = ok && output[i] == GUARD;
+    return compressed.size();
+}
+
+static void test_edge_sizes() {
+    SSDCodec codec;
+    std::mt19937 rng(1);
+    int failures = 0;
+    for (size_t size : {0, 1, 3, 4, 5, 15, 16, 17, 31, 32, 33, 64, 255, 256, 1000, 65535, 65536, 65537, 200000}) {
+        for (int kind = 0; kind < 3; ++kind) {
+            std::vector<uint8_t> data = kind == 0 ? std::vector<uint8_t>(size, 7) : mixed(size, rng);
+            if (kind == 2) for (uint8_t& b : data) b = static_cast<uint8_t>(rng());
+            bool ok;
+            round_trip(codec, data, ok);
+            failures += !ok;
+        }
+    }
+    EXPECT_EQ(failures, 0);
+}
+
+// Random sizes and contents, each decoded and checked
+static void test_fuzz_round_trip() {
+    SSDCodec codec;
+    std::mt19937 rng(2);
+    int failures = 0;
+    for (int iteration = 0; iteration < 300; ++iteration) {
+        size_t size = rng() % 3 == 0 ? rng() % 300000 : rng() % 2000;
+        std::vector<uint8_t> data;
+        switch (iteration % 3) {
+        case 0: data = mixed(size, rng); break;
+        case 1: data = texture_like(size, rng); break;
+        default: data = mesh_like(size, rng); break;
+        }
+        bool ok;
+        round_trip(codec, data, ok);
+        failures += !ok;
+    }
+    EXPECT_EQ(failures, 0);
+}
+
+// Flipped bytes and truncation never write outside the output or crash;
+// the decoder either fails or produces some bytes of the right length
+static void test_corrupt_input() {
+    SSDCodec codec;
+    std::mt19937 rng(3);
+    std::vector<uint8_t> data = mixed(150000, rng);
+    std::vector<uint8_t> compressed;
+    codec.compress(data.data(), data.size(), compressed);
+
+    int rejected = 0, overruns = 0;
+    std::vector<uint8_t> output(data.size() + GUARD_BYTES);
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        std::vector<uint8_t> damaged = compressed;
+        if (iteration % 4 == 0) {
+            damaged.resize(rng() % damaged.size());
+        } else {
+            for (int flips = 1 + rng() % 4; flips > 0; --flips) {
+                damaged[SSDCodec::FRAME_HEADER_SIZE + rng() % (damaged.size() - SSDCodec::FRAME_HEADER_SIZE)] ^=
+                    static_cast<uint8_t>(1 + rng() % 255);
+            }
+        }
+        std::fill(output.begin(), output.end(), GUARD);
+        rejected += !SSDCodec::decompress(damaged.data(), damaged.size(), output.data(), data.size());
+        for (size_t i = data.size(); i < output.size(); ++i) overruns += output[i] != GUARD;
+    }
+    EXPECT_EQ(overruns, 0);
+    EXPECT_EQ(rejected > 1000, true);
+
+    // A frame for a different size is refused outright
+    EXPECT_EQ(SSDCodec::decompress(compressed.data(), compressed.size(), output.data(), data.size() - 1), false);
+}
+
+// A chunk placed flush against an unreadable page, so any read past its
+// end faults even without a sanitizer
+class GuardedChunk {
+public:
+    explicit GuardedChunk(size_t size) : size_(size) {
+#ifdef __unix__
+        page_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        void* map = mmap(nullptr, 2 * page_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map != MAP_FAILED && size <= page_) {
+            base_ = static_cast<uint8_t*>(map);
+            mprotect(base_ + page_, page_, PROT_NONE);
+            data_ = base_ + page_ - size;
+            return;
+        }
+        if (map != MAP_FAILED) munmap(map, 2 * page_);
+#endif
+        heap_.resize(size);
+        data_ = heap_.data();
+    }
+    ~GuardedChunk() {
+#ifdef __unix__
+        if (base_) munmap(base_, 2 * page_);
+#endif
+    }
+    uint8_t* data() { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    size_t size_;
+    size_t page_ = 0;
+    uint8_t* base_ = nullptr;
+    uint8_t* data_ = nullptr;
+    std::vector<uint8_t> heap_;
+};
+
+// A crafted Huffman section whose third stream starts one byte before the
+// last and parses ahead of it: the 0xFF byte and three zero bits are one
+// 11-bit code to the third reader but three 1-bit codes to the last, and
+// the all-ones tail is 11-bit codes to both. The interleaved loop must stop
+// refilling before the third reader runs off the end of the chunk.
+static void test_corrupt_huffman_streams() {
+    const size_t raw_size = 4096;
+    // Symbol 0 gets a 1-bit code, 1-127 8 bits and 128-135 11 bits
+    uint8_t lengths[256] = {};
+    lengths[0] = 1;
+    for (int i = 1; i < 128; ++i) lengths[i] = 8;
+    for (int i = 128; i < 136; ++i) lengths[i] = 11;
+    const uint16_t sizes[3] = {0, 0, 1};
+
+    // Every stream length over a few refills, so the loop's last round
+    // lands at each offset from the end
+    int rejected = 0;
+    for (size_t stream_bytes = 960; stream_bytes < 1000; ++stream_bytes) {
+        std::vector<uint8_t> chunk;
+        chunk.push_back(1);     // LZ chunk
+        chunk.push_back(2);     // Huffman literals
+        const uint32_t counts[2] = {static_cast<uint32_t>(raw_size), static_cast<uint32_t>(128 + 6 + stream_bytes)};
+        chunk.insert(chunk.end(), reinterpret_cast<const uint8_t*>(counts), reinterpret_cast<const uint8_t*>(counts + 2));
+        for (int i = 0; i < 128; ++i) chunk.push_back(static_cast<uint8_t>(lengths[2 * i] | lengths[2 * i + 1] << 4));
+        chunk.insert(chunk.end(), reinterpret_cast<const uint8_t*>(sizes), reinterpret_cast<const uint8_t*>(sizes + 3));
+        chunk.push_back(0xFF);
+        chunk.push_back(0xF8);
+        chunk.resize(chunk.size() + stream_bytes - 2, 0xFF);
+
+        GuardedChunk guarded(chunk.size());
+        std::memcpy(guarded.data(), chunk.data(), chunk.size());
+        std::vector<uint8_t> output(raw_size + GUARD_BYTES);
+        rejected += !SSDCodec::decompress_chunk(guarded.data(), guarded.size(), output.data(), raw_size);
+    }
+    EXPECT_EQ(rejected, 40);
+}
+
+// Structured data compresses well; noise costs one byte per chunk
+static void test_ratio() {
+    SSDCodec codec;
+    std::mt19937 rng(4);
+    bool ok;
+    size_t texture = round_trip(codec, texture_like(1 << 20, rng), ok);
+    EXPECT_EQ(ok && texture < (1u << 20) * 2 / 3, true);
+    size_t mesh = round_trip(codec, mesh_like(1 << 20, rng), ok);
+    EXPECT_EQ(ok && mesh < (1u << 20) * 2 / 3, true);
+
+    std::vector<uint8_t> noise(1 << 20);
+    for (uint8_t& b : noise) b = static_cast<uint8_t>(rng());
+    size_t stored = round_trip(codec, noise, ok);
+    EXPECT_EQ(ok && stored == SSDCodec::compress_bound(noise.size()), true);
+}
+
+// Chunks decoded across workers match the single-thread decode, and a
+// corrupt chunk anywhere in the frame fails the whole request
+static void test_parallel_decode() {
+    SSDCodec codec;
+    std::mt19937 rng(5);
+    std::vector<uint8_t> data = mixed(40 * SSDCodec::CHUNK_SIZE + 12345, rng);
+    std::vector<uint8_t> compressed;
+    codec.compress(data.data(), data.size(), compressed);
+
+    Scheduler scheduler;
+    scheduler.initialize(4);
+    std::vector<uint8_t> serial(data.size()), parallel(data.size() + GUARD_BYTES, GUARD);
+    EXPECT_EQ(SSDCodec::decompress(compressed.data(), compressed.size(), serial.data(), serial.size()), true);
+    EXPECT_EQ(SSDCodec::decompress(compressed.data(), compressed.size(), parallel.data(), data.size(), &scheduler),
+              true);
+    EXPECT_EQ(std::equal(data.begin(), data.end(), serial.begin()), true);
+    EXPECT_EQ(std::equal(data.begin(), data.end(), parallel.begin()), true);
+    int overruns = 0;
+    for (size_t i = data.size(); i < parallel.size(); ++i) overruns += parallel[i] != GUARD;
+    EXPECT_EQ(overruns, 0);
+
+    // Below the threshold the scheduler is not used and the result is the same
+    std::vector<uint8_t> small(data.begin(), data.begin() + SSDCodec::PARALLEL_THRESHOLD / 2);
+    codec.compress(small.data(), small.size(), compressed);
+    std::vector<uint8_t> output(small.size());
+    EXPECT_EQ(SSDCodec::decompress(compressed.data(), compressed.size(), output.data(), output.size(), &scheduler),
+              true);
+    EXPECT_EQ(output == small, true);
+
+    // Damage the last chunk and the table entry of the first
+    codec.compress(data.data(), data.size(), compressed);
+    std::vector<uint8_t> damaged = compressed;
+    damaged[damaged.size() - 3] ^= 0x5A;
+    damaged[damaged.size() - 40] ^= 0xA5;
+    bool ok = SSDCodec::decompress(damaged.data(), damaged.size(), parallel.data(), data.size(), &scheduler);
+    EXPECT_EQ(ok && std::equal(data.begin(), data.end(), parallel.begin()), false);
+    damaged = compressed;
+    damaged[SSDCodec::FRAME_HEADER_SIZE] ^= 1;
+    EXPECT_EQ(SSDCodec::decompress(damaged.data(), damaged.size(), parallel.data(), data.size(), &scheduler), false);
+    scheduler.shutdown();
+}
+
+int main(){
+    test_edge_sizes();
+    test_fuzz_round_trip();
+    test_corrupt_input();
+    test_corrupt_huffman_streams();
+    test_ratio();
+    test_parallel_decode();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,168 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../src/io/ssd_queue.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint64_t SECTORS = 8192;      // 4 MiB backing file
+static const uint32_t MAX_SECTORS = 8;
+
+// Every 32-bit word of a sector holds its LBA and its index, so a read from
+// the wrong place or a torn read shows up anywhere in the buffer
+static uint32_t pattern(uint64_t lba, size_t word) {
+    return static_cast<uint32_t>(lba * 2654435761u) ^ static_cast<uint32_t>(word);
+}
+
+static std::string make_image() {
+    std::string path = "/tmp/psx5_ssd_queue_test_" + std::to_string(getpid()) + ".img";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::vector<uint32_t> sector(SSDQueue::SECTOR_SIZE / 4);
+    for (uint64_t lba = 0; lba < SECTORS; ++lba) {
+        for (size_t w = 0; w < sector.size(); ++w) sector[w] = pattern(lba, w);
+        std::fwrite(sector.data(), SSDQueue::SECTOR_SIZE, 1, file);
+    }
+    std::fclose(file);
+    return path;
+}
+
+static bool check_sectors(const uint8_t* data, uint64_t lba, uint32_t sectors) {
+    const size_t words = SSDQueue::SECTOR_SIZE / 4;
+    for (uint32_t s = 0; s < sectors; ++s) {
+        for (size_t w = 0; w < words; ++w) {
+            uint32_t value;
+            std::memcpy(&value, data + s * SSDQueue::SECTOR_SIZE + w * 4, 4);
+            if (value != pattern(lba + s, w)) return false;
+        }
+    }
+    return true;
+}
+
+// 4000 random reads of 1-8 sectors, kept `depth` deep by submitting from the
+// callbacks: every callback fires once with good data and in-flight
+// requests never exceed the depth, which io_uring actually reaches
+static void test_random_reads(const std::string& path, SSDQueue::Backend backend, uint32_t depth) {
+    const size_t READS = 4000;
+    SSDQueue queue;
+    SSDQueue::Config config;
+    config.queue_depth = depth;
+    config.backend = backend;
+    EXPECT_EQ(queue.open(path, config), true);
+    EXPECT_EQ(queue.backend() == backend, true);
+
+    std::mt19937 rng(depth);
+    std::vector<std::vector<uint8_t>> buffers(depth, std::vector<uint8_t>(MAX_SECTORS * SSDQueue::SECTOR_SIZE));
+    std::vector<uint64_t> lbas(depth);
+    std::vector<uint32_t> counts(depth);
+    size_t issued = 0, callbacks = 0, bad = 0;
+
+    std::function<void(size_t)> issue = [&](size_t b) {
+        if (issued == READS) return;
+        ++issued;
+        counts[b] = 1 + rng() % MAX_SECTORS;
+        lbas[b] = rng() % (SECTORS - counts[b] + 1);
+        queue.submit_read(lbas[b], counts[b], buffers[b].data(), [&, b](bool ok) {
+            ++callbacks;
+            if (!ok || !check_sectors(buffers[b].data(), lbas[b], counts[b])) ++bad;
+            issue(b);
+        });
+    };
+    for (size_t b = 0; b < depth; ++b) issue(b);
+    queue.drain();
+
+    EXPECT_EQ(callbacks, READS);
+    EXPECT_EQ(bad, 0u);
+    SSDQueue::Stats stats = queue.get_stats();
+    EXPECT_EQ(stats.completed, READS);
+    EXPECT_EQ(stats.max_in_flight <= depth, true);
+    // Pool workers only overlap when the host has the cores to run them
+    if (backend == SSDQueue::Backend::IoUring) EXPECT_EQ(stats.max_in_flight, depth);
+    queue.close();
+}
+
+// Writes land where they were aimed, reads past the end come back zeroed and
+// a request beyond the slot table is turned away without being queued, the
+// same on either backend
+static void test_write_read_back(const std::string& path, SSDQueue::Backend backend) {
+    SSDQueue queue;
+    SSDQueue::Config config;
+    config.backend = backend;
+    config.queue_depth = 4;
+    config.max_requests = 4;
+    EXPECT_EQ(queue.open(path, config), true);
+
+    std::vector<uint8_t> out(2 * SSDQueue::SECTOR_SIZE, 0xA5);
+    bool written = false;
+    EXPECT_EQ(queue.submit_write(100, 2, out.data(), [&](bool ok) { written = ok; }), true);
+    queue.drain();
+    EXPECT_EQ(written, true);
+
+    std::vector<uint8_t> in(3 * SSDQueue::SECTOR_SIZE, 0xFF);
+    std::vector<uint8_t> tail(2 * SSDQueue::SECTOR_SIZE, 0xFF);
+    int done = 0;
+    queue.submit_read(99, 3, in.data(), [&](bool ok) { done += ok; });
+    queue.submit_read(SECTORS - 1, 2, tail.data(), [&](bool ok) { done += ok; });
+    queue.submit_read(0, 1, in.data() + 0, nullptr, SSDPriority::Low);
+    queue.submit_read(0, 1, in.data() + 0, nullptr, SSDPriority::Low);
+    EXPECT_EQ(queue.submit_read(0, 1, in.data(), nullptr), false);
+    queue.drain();
+    EXPECT_EQ(done, 2);
+    EXPECT_EQ(in[SSDQueue::SECTOR_SIZE], 0xA5);
+    EXPECT_EQ(in[3 * SSDQueue::SECTOR_SIZE - 1], 0xA5);
+    EXPECT_EQ(check_sectors(tail.data(), SECTORS - 1, 1), true);
+    EXPECT_EQ(tail[SSDQueue::SECTOR_SIZE], 0);
+    EXPECT_EQ(queue.get_stats().rejected, 1u);
+}
+
+// A missing image is an error, not a fresh empty one, unless creation is
+// asked for
+static void test_missing_image() {
+    std::string path = "/tmp/psx5_ssd_queue_missing_" + std::to_string(getpid()) + ".img";
+    std::remove(path.c_str());
+    SSDQueue queue;
+    SSDQueue::Config config;
+    EXPECT_EQ(queue.open(path, config), false);
+    EXPECT_EQ(queue.is_open(), false);
+    EXPECT_EQ(std::fopen(path.c_str(), "rb") == nullptr, true);
+
+    config.create = true;
+    EXPECT_EQ(queue.open(path, config), true);
+    queue.close();
+    std::remove(path.c_str());
+}
+
+int main(){
+    std::string path = make_image();
+    // io_uring may be missing from the host kernel or blocked by a sandbox
+    SSDQueue probe;
+    SSDQueue::Config config;
+    config.backend = SSDQueue::Backend::IoUring;
+    bool have_uring = probe.open(path, config);
+    probe.close();
+    if (!have_uring) std::cout << "io_uring unavailable, testing the thread pool only" << std::endl;
+
+    for (uint32_t depth : {1u, 32u, 128u}) {
+        if (have_uring) test_random_reads(path, SSDQueue::Backend::IoUring, depth);
+        test_random_reads(path, SSDQueue::Backend::ThreadPool, depth);
+    }
+    // Random reads first: this rewrites sectors 100 and 101
+    if (have_uring) test_write_read_back(path, SSDQueue::Backend::IoUring);
+    test_write_read_back(path, SSDQueue::Backend::ThreadPool);
+    std::remove(path.c_str());
+    test_missing_image();
+
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../src/core/memory.h"
+#include "../src/core/scheduler.h"
+#include "../src/io/ssd_cache.h"
+#include "../src/io/ssd_codec.h"
+#include "../src/io/ssd_reader.h"
+
+// Simple assertion helper
+static int tests_run = 0;
+static int tests_failed = 0;
+#define EXPECT_EQ(a,b) do { ++tests_run; if((a)!=(b)){ std::cerr<<"Test failed: Expected "<<(b)<<" got "<<(a)<<" at "<<__FILE__<<":"<<__LINE__<<"\n"; ++tests_failed; }} while(0)
+
+static const uint8_t GUARD = 0xCD;
+static const size_t GUARD_BYTES = 4096;
+
+struct Asset {
+    uint64_t lba;
+    uint32_t compressed_size;
+    size_t raw_size;
+    size_t dest;        // offset of its span in the destination arena
+};
+
+// Repeating records with some noise, so frames mix every chunk type
+static std::vector<uint8_t> asset_data(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = rng() % 8 == 0 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>(i % 48 + (i >> 12));
+    }
+    return data;
+}
+
+// Writes compressed assets at sector-aligned LBAs and lays out their
+// destinations back to back with a guard gap between them
+static std::string make_image(std::vector<Asset>& assets, size_t& arena_size) {
+    std::string path = "/tmp/psx5_ssd_reader_test_" + std::to_string(getpid()) + ".img";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::mt19937 rng(7);
+    SSDCodec codec;
+    std::vector<uint8_t> compressed;
+    uint64_t lba = 0;
+    arena_size = GUARD_BYTES;
+    for (size_t raw_size : {1000, 4096, 65536, 100000, 300000, 1500000, 12345, 70000}) {
+        codec.compress(asset_data(raw_size, rng).data(), raw_size, compressed);
+        assets.push_back({lba, static_cast<uint32_t>(compressed.size()), raw_size, arena_size});
+        uint64_t sectors = (compressed.size() + SSDQueue::SECTOR_SIZE - 1) / SSDQueue::SECTOR_SIZE;
+        compressed.resize(sectors * SSDQueue::SECTOR_SIZE, 0);
+        std::fwrite(compressed.data(), compressed.size(), 1, file);
+        lba += sectors;
+        arena_size += raw_size + GUARD_BYTES;
+    }
+    std::fclose(file);
+    return path;
+}
+
+// A level's worth of 64 KiB blocks packed back to back, for streaming
+static std::string make_stream_image(std::vector<Asset>& blocks, std::vector<uint8_t>& raw) {
+    std::string path = "/tmp/psx5_ssd_reader_stream_" + std::to_string(getpid()) + ".img";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::mt19937 rng(8);
+    SSDCodec codec;
+    std::vector<uint8_t> compressed;
+    uint64_t lba = 0;
+    for (size_t b = 0; b < 64; ++b) {
+        std::vector<uint8_t> data = asset_data(SSDCodec::CHUNK_SIZE, rng);
+        codec.compress(data.data(), data.size(), compressed);
+        blocks.push_back({lba, static_cast<uint32_t>(compressed.size()), data.size(), raw.size()});
+        raw.insert(raw.end(), data.begin(), data.end());
+        uint64_t sectors = (compressed.size() + SSDQueue::SECTOR_SIZE - 1) / SSDQueue::SECTOR_SIZE;
+        compressed.resize(sectors * SSDQueue::SECTOR_SIZE, 0);
+        std::fwrite(compressed.data(), compressed.size(), 1, file);
+        lba += sectors;
+    }
+    std::fclose(file);
+    return path;
+}
+
+// The copy-based path: read the sectors into a fresh vector, decode into
+// another and copy that into the destination
+static void read_by_copy(SSDQueue& queue, const Asset& asset, uint8_t* arena, bool& ok) {
+    uint32_t sectors = (asset.compressed_size + SSDQueue::SECTOR_SIZE - 1) / SSDQueue::SECTOR_SIZE;
+    std::vector<uint8_t> stored(static_cast<size_t>(sectors) * SSDQueue::SECTOR_SIZE);
+    bool read_ok = false;
+    queue.submit_read(asset.lba, sectors, stored.data(), [&](bool result) { read_ok = result; });
+    queue.drain();
+    std::vector<uint8_t> decompressed(asset.raw_size);
+    ok = read_ok && SSDCodec::decompress(stored.data(), asset.compressed_size, decompressed.data(), asset.raw_size);
+    std::memcpy(arena + asset.dest, decompressed.data(), asset.raw_size);
+}
+
+// Every asset decoded in place, all in flight at once and repeatedly, lands
+// exactly where the copy-based path puts it and touches nothing else, and
+// the staging pool stops growing once it covers the requests in flight
+static void test_matches_copy_path(const std::string& path, const std::vector<Asset>& assets, size_t arena_size,
+                                   Scheduler* scheduler) {
+    SSDQueue queue;
+    EXPECT_EQ(queue.open(path, SSDQueue::Config()), true);
+    std::vector<uint8_t> expected(arena_size, GUARD), direct(arena_size, GUARD);
+    bool all_ok = true;
+    for (const Asset& asset : assets) {
+        bool ok;
+        read_by_copy(queue, asset, expected.data(), ok);
+        all_ok = all_ok && ok;
+    }
+    EXPECT_EQ(all_ok, true);
+
+    SSDReader reader(queue);
+    reader.set_scheduler(scheduler);
+    size_t callbacks = 0, failures = 0;
+    for (int round = 0; round < 5; ++round) {
+        std::fill(direct.begin(), direct.end(), GUARD);
+        for (const Asset& asset : assets) {
+            bool queued = reader.submit(asset.lba, asset.compressed_size, direct.data() + asset.dest, asset.raw_size,
+                                        [&](bool ok) {
+                ++callbacks;
+                failures += !ok;
+            });
+            EXPECT_EQ(queued, true);
+        }
+        queue.drain();
+        EXPECT_EQ(direct == expected, true);
+    }
+    EXPECT_EQ(callbacks, assets.size() * 5);
+    EXPECT_EQ(failures, 0u);
+
+    SSDReader::Stats stats = reader.get_stats();
+    EXPECT_EQ(stats.requests, assets.size() * 5);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_EQ(stats.staging_buffers, assets.size());
+    EXPECT_EQ(reader.idle_staging(), assets.size());
+    size_t raw_total = 0;
+    for (const Asset& asset : assets) raw_total += asset.raw_size;
+    EXPECT_EQ(stats.decoded_bytes, raw_total * 5);
+    queue.close();
+}
+
+// A wrong size or a damaged frame fails the request and still returns its
+// staging buffer; reads past the end decode nothing
+static void test_failures(const std::string& path, const std::vector<Asset>& assets) {
+    SSDQueue queue;
+    EXPECT_EQ(queue.open(path, SSDQueue::Config()), true);
+    SSDReader reader(queue);
+    const Asset& asset = assets[3];
+    std::vector<uint8_t> output(asset.raw_size + GUARD_BYTES, GUARD);
+    int failed = 0;
+    auto count = [&](bool ok) { failed += !ok; };
+
+    reader.submit(asset.lba, asset.compressed_size, output.data(), asset.raw_size - 1, count);
+    reader.submit(asset.lba, asset.compressed_size - 1, output.data(), asset.raw_size, count);
+    reader.submit(asset.lba + 1, asset.compressed_size, output.data(), asset.raw_size, count);
+    reader.submit(1u << 30, asset.compressed_size, output.data(), asset.raw_size, count);
+    queue.drain();
+    EXPECT_EQ(failed, 4);
+    EXPECT_EQ(reader.get_stats().failed, 4u);
+    EXPECT_EQ(reader.idle_staging(), reader.get_stats().staging_buffers);
+    bool guard_ok = true;
+    for (size_t i = asset.raw_size; i < output.size(); ++i) guard_ok = guard_ok && output[i] == GUARD;
+    EXPECT_EQ(guard_ok, true);
+    queue.close();
+}
+
+// Owners hold the queue before the reader, as SonyIOComplex does, so the
+// reader goes first; destroying one with reads in flight still finishes
+// every read into the destination before anything is freed
+struct ReaderOwner {
+    SSDQueue queue;
+    SSDReader reader{queue};
+};
+
+static void test_destroy_in_flight(const std::string& path, const std::vector<Asset>& assets, size_t arena_size,
+                                   Scheduler* scheduler) {
+    std::vector<uint8_t> expected(arena_size, GUARD), direct(arena_size, GUARD);
+    {
+        SSDQueue queue;
+        EXPECT_EQ(queue.open(path, SSDQueue::Config()), true);
+        for (const Asset& asset : assets) {
+            bool ok;
+            read_by_copy(queue, asset, expected.data(), ok);
+        }
+    }
+
+    auto owner = std::make_unique<ReaderOwner>();
+    SSDQueue::Config config;
+    config.queue_depth = 2;
+    EXPECT_EQ(owner->queue.open(path, config), true);
+    owner->reader.set_scheduler(scheduler);
+    size_t callbacks = 0, failures = 0;
+    for (const Asset& asset : assets) {
+        owner->reader.submit(asset.lba, asset.compressed_size, direct.data() + asset.dest, asset.raw_size,
+                             [&](bool ok) {
+            ++callbacks;
+            failures += !ok;
+        });
+    }
+    EXPECT_EQ(owner->queue.pending() > 0, true);
+    owner.reset();
+    EXPECT_EQ(callbacks, assets.size());
+    EXPECT_EQ(failures, 0u);
+    EXPECT_EQ(direct == expected, true);
+}
+
+// Streaming a level one block at a time: after the first blocks the stream
+// is detected and read-ahead decodes the rest into the cache before they
+// are asked for, so most requests never reach the SSD. A second pass is
+// all hits, and a write makes its block read from the SSD again.
+static void test_read_ahead() {
+    std::vector<Asset> blocks;
+    std::vector<uint8_t> raw;
+    std::string path = make_stream_image(blocks, raw);
+    SSDQueue queue;
+    EXPECT_EQ(queue.open(path, SSDQueue::Config()), true);
+    SSDBlockCache cache;
+    SSDReader reader(queue);
+    reader.set_cache(&cache, 4);
+
+    std::vector<uint8_t> output(raw.size());
+    int failures = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        std::fill(output.begin(), output.end(), 0);
+        for (const Asset& block : blocks) {
+            reader.submit(block.lba, block.compressed_size, output.data() + block.dest, block.raw_size,
+                          [&](bool ok) { failures += !ok; });
+            queue.drain();
+        }
+        EXPECT_EQ(output == raw, true);
+        if (pass == 0) {
+            SSDReader::Stats stats = reader.get_stats();
+            SSDBlockCache::Stats cached = cache.get_stats();
+            EXPECT_EQ(stats.read_ahead_blocks >= 55, true);
+            EXPECT_EQ(cached.hits + stats.read_ahead_joined >= 55, true);
+            EXPECT_EQ(cached.read_ahead_used >= 55, true);
+            EXPECT_EQ(stats.compressed_bytes < stats.read_ahead_bytes / 4, true);
+        }
+    }
+    EXPECT_EQ(failures, 0);
+
+    // The second pass read nothing: every block was cached
+    SSDBlockCache::Stats cached = cache.get_stats();
+    EXPECT_EQ(cached.hits >= 64 + 55, true);
+    EXPECT_EQ(cached.evictions, 0u);
+    uint64_t submitted = queue.get_stats().submitted;
+
+    const Asset& block = blocks[10];
+    reader.invalidate(block.lba + 1, 1);
+    EXPECT_EQ(cache.contains(block.lba), false);
+    bool ok = false;
+    reader.submit(block.lba, block.compressed_size, output.data() + block.dest, block.raw_size,
+                  [&](bool result) { ok = result; });
+    queue.drain();
+    EXPECT_EQ(ok, true);
+    EXPECT_EQ(queue.get_stats().submitted > submitted, true);
+    EXPECT_EQ(output == raw, true);
+    queue.close();
+    std::remove(path.c_str());
+}
+
+// The same teardown with the cache attached, laid out like SonyIOComplex:
+// read-ahead windows and the requests waiting on them are still in flight
+// when the owner goes, and finish into a cache that is still alive
+struct CachedReaderOwner {
+    SSDQueue queue;
+    SSDBlockCache cache;
+    SSDReader reader{queue};
+};
+
+static void test_destroy_read_ahead_in_flight() {
+    std::vector<Asset> blocks;
+    std::vector<uint8_t> raw;
+    std::string path = make_stream_image(blocks, raw);
+    auto owner = std::make_unique<CachedReaderOwner>();
+    SSDQueue::Config config;
+    config.queue_depth = 1;
+    config.backend = SSDQueue::Backend::ThreadPool;
+    config.threads = 1;
+    EXPECT_EQ(owner->queue.open(path, config), true);
+    owner->reader.set_cache(&owner->cache, 4);
+
+    std::vector<uint8_t> output(raw.size());
+    size_t callbacks = 0, failures = 0;
+    for (size_t b = 0; b < 16; ++b) {
+        const Asset& block = blocks[b];
+        owner->reader.submit(block.lba, block.compressed_size, output.data() + block.dest, block.raw_size,
+                             [&](bool ok) {
+            ++callbacks;
+            failures += !ok;
+        });
+    }
+    EXPECT_EQ(owner->reader.get_stats().read_ahead_reads > 0, true);
+    EXPECT_EQ(owner->queue.pending() > 0, true);
+    owner.reset();
+    EXPECT_EQ(callbacks, 16u);
+    EXPECT_EQ(failures, 0u);
+    EXPECT_EQ(std::equal(output.begin(), output.begin() + blocks[16].dest, raw.begin()), true);
+    std::remove(path.c_str());
+}
+
+// Reads submitted after a write to the same sectors can still be served
+// from the old sectors and finish first: with one busy worker, demand reads
+// run ahead of the low-priority write, and the read-ahead window they start
+// over the written block queues up with it. Whatever they cached must not
+// outlive the write.
+static void test_write_overlaps_read() {
+    std::vector<Asset> blocks;
+    std::vector<uint8_t> raw;
+    std::string path = make_stream_image(blocks, raw);
+    SSDQueue::Config config;
+    config.queue_depth = 1;
+    config.backend = SSDQueue::Backend::ThreadPool;
+    config.threads = 1;
+    SSDQueue queue;
+    EXPECT_EQ(queue.open(path, config), true);
+    SSDBlockCache cache;
+    SSDReader reader(queue);
+    reader.set_cache(&cache, 4);
+
+    // The new contents of block 20: a frame of zeros, padded to its sectors
+    const Asset& block = blocks[20];
+    const uint32_t sectors = static_cast<uint32_t>((block.compressed_size + SSDQueue::SECTOR_SIZE - 1) /
+                                                   SSDQueue::SECTOR_SIZE);
+    std::vector<uint8_t> zeros(block.raw_size, 0), frame;
+    SSDCodec codec;
+    codec.compress(zeros.data(), zeros.size(), frame);
+    const uint32_t frame_size = static_cast<uint32_t>(frame.size());
+    frame.resize(static_cast<size_t>(sectors) * SSDQueue::SECTOR_SIZE, 0);
+
+    // Keep the only worker busy so the next two wait in their rings
+    std::vector<uint8_t> busy(16u << 20);
+    queue.submit_read(0, static_cast<uint32_t>(busy.size() / SSDQueue::SECTOR_SIZE), busy.data(), nullptr,
+                      SSDPriority::Low);
+    bool written = false, read = false;
+    int failures = 0;
+    std::vector<uint8_t> output(block.raw_size), earlier(raw.size());
+    EXPECT_EQ(reader.submit_write(block.lba, sectors, frame.data(), [&](bool ok) { written = ok; },
+                                  SSDPriority::Low), true);
+    EXPECT_EQ(reader.submit(block.lba, block.compressed_size, output.data(), output.size(),
+                            [&](bool ok) { read = ok; }), true);
+    // The two blocks before it make a stream, which reads ahead over it
+    for (size_t b = 18; b < 20; ++b) {
+        reader.submit(blocks[b].lba, blocks[b].compressed_size, earlier.data() + blocks[b].dest,
+                      blocks[b].raw_size, [&](bool ok) { failures += !ok; });
+    }
+    EXPECT_EQ(reader.get_stats().read_ahead_reads, 1u);
+    queue.drain();
+    EXPECT_EQ(written, true);
+    EXPECT_EQ(read, true);
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(std::equal(output.begin(), output.end(), raw.begin() + block.dest), true);
+
+    // The old frame is gone from the cache and the next read sees the write
+    EXPECT_EQ(cache.contains(block.lba), false);
+    std::fill(output.begin(), output.end(), 0xEE);
+    read = false;
+    reader.submit(block.lba, frame_size, output.data(), output.size(), [&](bool ok) { read = ok; });
+    queue.drain();
+    EXPECT_EQ(read, true);
+    EXPECT_EQ(output == zeros, true);
+    queue.close();
+    std::remove(path.c_str());
+}
+
+// host_span() hands out write spans only for pages mapped writable: a
+// read-only mapping fails instead of aliasing the physical memory at the
+// virtual address, while never-mapped addresses stay physical
+static void test_host_span() {
+    Memory mem(1<<16);
+    // Virtual pages inside the RAM size, so aliasing would hand out a pointer
+    const uint64_t ro = 0x8000;
+    EXPECT_EQ(mem.get_vm_manager()->map_memory(ro, 0x3000, PAGE_SIZE, MemoryProtection::READ, MemoryType::SYSTEM_RAM), true);
+    EXPECT_EQ(mem.get_vm_manager()->map_memory(ro + PAGE_SIZE, 0x4000, PAGE_SIZE, MemoryProtection::READ_WRITE, MemoryType::SYSTEM_RAM), true);
+
+    EXPECT_EQ(mem.host_span(ro + 16, 32, MemoryProtection::WRITE) == nullptr, true);
+    EXPECT_EQ(mem.host_span(ro + 16, 32, MemoryProtection::READ) == mem.data() + 0x3010, true);
+    EXPECT_EQ(mem.host_span(ro + PAGE_SIZE + 8, 8, MemoryProtection::WRITE) == mem.data() + 0x4008, true);
+    // Contiguous physically, but the first page is read-only
+    EXPECT_EQ(mem.host_span(ro + PAGE_SIZE - 8, 16, MemoryProtection::WRITE) == nullptr, true);
+    EXPECT_EQ(mem.host_span(ro + PAGE_SIZE - 8, 16, MemoryProtection::READ) == mem.data() + 0x3FF8, true);
+
+    EXPECT_EQ(mem.host_span(0x2000, 64, MemoryProtection::WRITE) == mem.data() + 0x2000, true);
+    EXPECT_EQ(mem.host_span(PS5_USER_MEMORY_BASE + 0x100, 64, MemoryProtection::WRITE) == mem.data() + 0x100, true);
+    EXPECT_EQ(mem.host_span(0xFFF0, 32, MemoryProtection::WRITE) == nullptr, true);
+}
+
+int main(){
+    test_host_span();
+
+    std::vector<Asset> assets;
+    size_t arena_size;
+    std::string path = make_image(assets, arena_size);
+
+    test_matches_copy_path(path, assets, arena_size, nullptr);
+    Scheduler scheduler;
+    scheduler.initialize(4);
+    test_matches_copy_path(path, assets, arena_size, &scheduler);
+    test_destroy_in_flight(path, assets, arena_size, &scheduler);
+    scheduler.shutdown();
+    test_destroy_in_flight(path, assets, arena_size, nullptr);
+    test_failures(path, assets);
+    test_read_ahead();
+    test_destroy_read_ahead_in_flight();
+    test_write_overlaps_read();
+
+    std::remove(path.c_str());
+    if(tests_failed==0){
+        std::cout<<"All tests passed ("<<tests_run<<")"<<std::endl;
+        return 0;
+    } else {
+        std::cerr<<tests_failed<<" tests failed out of "<<tests_run<<std::endl;
+        return 1;
+    }
+}